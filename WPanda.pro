@@ -1,4 +1,5 @@
 TEMPLATE = subdirs
-SUBDIRS = app test
-
+SUBDIRS = core app test
 
+app.depends = core
+test.depends = core
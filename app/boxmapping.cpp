@@ -6,7 +6,15 @@ BoxMapping::BoxMapping( QString file,
                         const QNEPortVector &outputs ) :
   ElementMapping( elms, file ),
   boxInputs( inputs ),
-  boxOutputs( outputs ) {
+  boxOutputs( outputs ),
+  fromTemplate( false ) {
+
+}
+
+BoxMapping::BoxMapping( QString file, const BoxTemplate &boxTemplate ) :
+  ElementMapping( ElementVector( ), file ),
+  boxTemplate( boxTemplate ),
+  fromTemplate( true ) {
 
 }
 
@@ -15,6 +23,13 @@ BoxMapping::~BoxMapping( ) {
 }
 
 void BoxMapping::initialize( ) {
+  inputs.clear( );
+  outputs.clear( );
+  nestedNodes.clear( );
+  if( fromTemplate ) {
+    instantiate( );
+    return;
+  }
   ElementMapping::initialize( );
   for( QNEPort *port : boxInputs ) {
     inputs.append( map[ port->graphicElement( ) ] );
@@ -24,6 +39,48 @@ void BoxMapping::initialize( ) {
   }
 }
 
+void BoxMapping::instantiate( ) {
+  clear( );
+  /* Elements are created in the order of the template, so that the fan-in indices of the template are also
+   * indices into logicElms. */
+  const int count = boxTemplate.size( );
+  logicElms.reserve( count );
+  deletableElements.reserve( count );
+  for( int idx = 0; idx < count; ++idx ) {
+    int inputSize = boxTemplate.faninBegin[ idx + 1 ] - boxTemplate.faninBegin[ idx ];
+    LogicElement *elm = buildLogicElement( boxTemplate.ops[ idx ], inputSize, boxTemplate.values[ idx ] );
+    elm->setDelay( boxTemplate.delays[ idx ] );
+    deletableElements.append( elm );
+    logicElms.append( elm );
+  }
+  for( int idx = 0; idx < count; ++idx ) {
+    LogicElement *elm = logicElms[ idx ];
+    for( int fanin = boxTemplate.faninBegin[ idx ]; fanin < boxTemplate.faninBegin[ idx + 1 ]; ++fanin ) {
+      int pred = boxTemplate.fanins[ fanin ];
+      int input = fanin - boxTemplate.faninBegin[ idx ];
+      if( pred >= 0 ) {
+        elm->connectPredecessor( input, logicElms[ pred ], boxTemplate.faninPorts[ fanin ] );
+      }
+      else if( pred == BoxTemplate::VCC ) {
+        elm->connectPredecessor( input, &globalVCC, 0 );
+      }
+      else if( pred == BoxTemplate::GND ) {
+        elm->connectPredecessor( input, &globalGND, 0 );
+      }
+    }
+  }
+  for( int idx : boxTemplate.inputs ) {
+    inputs.append( logicElms[ idx ] );
+  }
+  for( int idx : boxTemplate.outputs ) {
+    outputs.append( logicElms[ idx ] );
+  }
+  for( int idx : boxTemplate.nestedNodes ) {
+    nestedNodes.append( logicElms[ idx ] );
+  }
+  initialized = true;
+}
+
 void BoxMapping::clearConnections( ) {
   for( LogicElement *in : inputs ) {
     in->clearPredecessors( );
@@ -34,11 +91,23 @@ void BoxMapping::clearConnections( ) {
 }
 
 LogicElement* BoxMapping::getInput( int index ) {
-  Q_ASSERT( index < boxInputs.size( ) );
+  Q_ASSERT( index < inputs.size( ) );
   return( inputs[ index ] );
 }
 
 LogicElement* BoxMapping::getOutput( int index ) {
-  Q_ASSERT( index < boxOutputs.size( ) );
+  Q_ASSERT( index < outputs.size( ) );
   return( outputs[ index ] );
 }
+
+QVector< LogicElement* > BoxMapping::boundaryNodes( ) const {
+  return( inputs + outputs + nestedNodes );
+}
+
+const QVector< BoxTemplate::NestedBox > &BoxMapping::nestedBoxes( ) const {
+  return( boxTemplate.nestedBoxes );
+}
+
+LogicElement* BoxMapping::getNode( int index ) const {
+  return( ( index >= 0 ) && ( index < logicElms.size( ) ) ? logicElms[ index ] : nullptr );
+}
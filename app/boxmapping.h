@@ -1,17 +1,30 @@
 #ifndef BOXMAPPING_H
 #define BOXMAPPING_H
 
+#include "boxtemplate.h"
 #include "elementmapping.h"
 #include "graphicelement.h"
 
 class BoxMapping : public ElementMapping {
+  friend class BoxTemplate;
+
   QNEPortVector boxInputs;
   QNEPortVector boxOutputs;
+  BoxTemplate boxTemplate;
+  bool fromTemplate;
 
   QVector< LogicElement* > inputs;
   QVector< LogicElement* > outputs;
+  QVector< LogicElement* > nestedNodes;
+
+  void instantiate( );
 public:
   BoxMapping( QString file, const ElementVector &elms, const QNEPortVector &inputs, const QNEPortVector &outputs );
+  /**
+   * @brief BoxMapping builds the instance of a box from its compiled
+   *        template, without going through the graphic elements.
+   */
+  BoxMapping( QString file, const BoxTemplate &boxTemplate );
 
   virtual ~BoxMapping( );
 
@@ -21,6 +34,20 @@ public:
 
   LogicElement* getInput( int index );
   LogicElement* getOutput( int index );
+
+  /**
+   * @brief boundaryNodes returns the pass-through nodes that connect the box
+   *        ports to the elements inside the box. A box built from a template
+   *        also returns the boundary nodes of its nested boxes.
+   */
+  QVector< LogicElement* > boundaryNodes( ) const;
+
+  /**
+   * @brief nestedBoxes returns the boxes inside a box built from a template,
+   *        and getNode( ) the element at one of the node indices they hold.
+   */
+  const QVector< BoxTemplate::NestedBox > &nestedBoxes( ) const;
+  LogicElement* getNode( int index ) const;
 };
 
 #endif // BOXMAPPING_H
@@ -5,7 +5,10 @@
 
 #include <QFileInfo>
 
-BoxPrototype::BoxPrototype( const QString &fileName ) : m_fileName( fileName ) {
+/* Incremented whenever a box file is reloaded, making every compiled template stale. */
+static int boxGeneration = 0;
+
+BoxPrototype::BoxPrototype( const QString &fileName ) : m_fileName( fileName ), templateGeneration( -1 ) {
 
 }
 
@@ -54,7 +57,13 @@ bool BoxPrototype::isInputRequired( int index ) {
 }
 
 BoxMapping* BoxPrototype::generateMapping( ) const {
-  return( new BoxMapping( fileName( ), boxImpl.elements, boxImpl.inputs, boxImpl.outputs ) );
+  if( templateGeneration != boxGeneration ) {
+    BoxMapping mapping( fileName( ), boxImpl.elements, boxImpl.inputs, boxImpl.outputs );
+    mapping.initialize( );
+    boxTemplate = BoxTemplate( mapping );
+    templateGeneration = boxGeneration;
+  }
+  return( new BoxMapping( fileName( ), boxTemplate ) );
 }
 
 void BoxPrototype::clear( ) {
@@ -66,6 +75,7 @@ void BoxPrototype::reload( ) {
 //  verifyRecursion( fname );
 
   clear( );
+  ++boxGeneration;
 
   boxImpl.loadFile( m_fileName );
   for( Box *box : boxObservers ) {
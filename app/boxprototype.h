@@ -2,6 +2,7 @@
 #define BOXPROTOTYPE_H
 
 #include "boxprototypeimpl.h"
+#include "boxtemplate.h"
 
 #include <QGraphicsItem>
 #include <QString>
@@ -17,6 +18,11 @@ class BoxPrototype {
   BoxPrototypeImpl boxImpl;
   QVector< Box* > boxObservers;
 
+  /* Compiled logic shared by all instances of the box. It is rebuilt when any box is reloaded, since this box
+   * may contain the reloaded one. */
+  mutable BoxTemplate boxTemplate;
+  mutable int templateGeneration;
+
 public:
   BoxPrototype( const QString &fileName );
   void reload( );
@@ -36,6 +42,11 @@ public:
   bool defaultInputValue( int index );
   bool isInputRequired( int index );
 
+  /**
+   * @brief generateMapping returns a new, uninitialized instance of the box.
+   *        The box logic is compiled once into a template and each instance
+   *        is a copy of it.
+   */
   BoxMapping* generateMapping( ) const;
 
 private:
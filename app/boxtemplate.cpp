@@ -0,0 +1,84 @@
+#include "box.h"
+#include "boxmapping.h"
+#include "boxtemplate.h"
+#include "nodes/qneport.h"
+
+#include <QFileInfo>
+#include <QHash>
+
+const int BoxTemplate::UNCONNECTED;
+const int BoxTemplate::GND;
+const int BoxTemplate::VCC;
+
+BoxTemplate::BoxTemplate( ) {
+  faninBegin.append( 0 );
+}
+
+BoxTemplate::BoxTemplate( const BoxMapping &mapping ) {
+  QHash< LogicElement*, int > index;
+  for( int idx = 0; idx < mapping.logicElms.size( ); ++idx ) {
+    index.insert( mapping.logicElms[ idx ], idx );
+  }
+  faninBegin.append( 0 );
+  for( LogicElement *elm : mapping.logicElms ) {
+    ops.append( elm->op( ) );
+    values.append( ( elm->outputSize( ) > 0 ) && elm->getOutputValue( 0 ) );
+    delays.append( elm->getDelay( ) );
+    for( size_t port = 0; port < elm->inputSize( ); ++port ) {
+      LogicElement *pred = elm->predecessor( port );
+      if( !pred ) {
+        fanins.append( UNCONNECTED );
+      }
+      else if( index.contains( pred ) ) {
+        fanins.append( index.value( pred ) );
+      }
+      else {
+        /* The global VCC and GND of the box or of a nested box. */
+        fanins.append( pred->getOutputValue( 0 ) ? VCC : GND );
+      }
+      faninPorts.append( elm->predecessorPort( port ) );
+    }
+    faninBegin.append( fanins.size( ) );
+  }
+  for( LogicElement *elm : mapping.inputs ) {
+    inputs.append( index.value( elm, UNCONNECTED ) );
+  }
+  for( LogicElement *elm : mapping.outputs ) {
+    outputs.append( index.value( elm, UNCONNECTED ) );
+  }
+  QVector< LogicElement* > nested;
+  mapping.collectBoundaryNodes( nested );
+  for( LogicElement *elm : nested ) {
+    nestedNodes.append( index.value( elm ) );
+  }
+  for( auto iter = mapping.boxMappings.constBegin( ); iter != mapping.boxMappings.constEnd( ); ++iter ) {
+    const Box *box = iter.key( );
+    const BoxMapping *boxMap = iter.value( );
+    const int parent = nestedBoxes.size( );
+    NestedBox nestedBox = { box->getLabel( ), -1, QVector< int >( ), QVector< QString >( ) };
+    if( nestedBox.name.isEmpty( ) ) {
+      nestedBox.name = QFileInfo( box->getFile( ) ).baseName( );
+    }
+    for( int port = 0; port < boxMap->outputs.size( ); ++port ) {
+      nestedBox.outputs.append( index.value( boxMap->outputs[ port ], UNCONNECTED ) );
+      nestedBox.outputNames.append( box->output( port )->getName( ) );
+    }
+    nestedBoxes.append( nestedBox );
+    /* The boxes inside the nested one, their nodes renumbered from its elements to ours. */
+    for( NestedBox inner : boxMap->boxTemplate.nestedBoxes ) {
+      inner.parent = inner.parent < 0 ? parent : inner.parent + parent + 1;
+      for( int &node : inner.outputs ) {
+        node = node < 0 ? UNCONNECTED : index.value( boxMap->logicElms[ node ], UNCONNECTED );
+      }
+      nestedBoxes.append( inner );
+    }
+  }
+}
+
+int BoxTemplate::size( ) const {
+  return( ops.size( ) );
+}
+
+bool BoxTemplate::isEmpty( ) const {
+  return( ops.isEmpty( ) );
+}
@@ -0,0 +1,57 @@
+#ifndef BOXTEMPLATE_H
+#define BOXTEMPLATE_H
+
+#include "simulation/logicop.h"
+
+#include <QString>
+#include <QVector>
+
+class BoxMapping;
+
+/**
+ * @brief The BoxTemplate class is the compiled logic of a box, nested boxes
+ *        included. Elements are identified by their index in the evaluation
+ *        list of the box, so an instance is built by creating the elements
+ *        in order and connecting them with the same indices.
+ */
+class BoxTemplate {
+public:
+  /* Fan-in codes for inputs that are not driven by an element of the box. */
+  static const int UNCONNECTED = -1;
+  static const int GND = -2;
+  static const int VCC = -3;
+
+  /**
+   * @brief The NestedBox struct is a box inside the box, parent being the
+   *        index of the nested box it is in, or -1. Its outputs are the
+   *        indices of the nodes at its output ports.
+   */
+  struct NestedBox {
+    QString name;
+    int parent;
+    QVector< int > outputs;
+    QVector< QString > outputNames;
+  };
+
+  BoxTemplate( );
+  explicit BoxTemplate( const BoxMapping &mapping );
+
+  int size( ) const;
+  bool isEmpty( ) const;
+
+  QVector< LogicOp > ops;
+  QVector< bool > values;
+  QVector< uint32_t > delays;
+  /* Inputs of element i are fanins[ faninBegin[ i ] ] to fanins[ faninBegin[ i + 1 ] - 1 ]. */
+  QVector< int > faninBegin;
+  QVector< int > fanins;
+  QVector< int > faninPorts;
+
+  QVector< int > inputs;
+  QVector< int > outputs;
+  QVector< int > nestedNodes;
+  /* Each nested box comes before the boxes inside it. */
+  QVector< NestedBox > nestedBoxes;
+};
+
+#endif // BOXTEMPLATE_H
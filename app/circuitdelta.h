@@ -0,0 +1,25 @@
+#ifndef CIRCUITDELTA_H
+#define CIRCUITDELTA_H
+
+#include <QVector>
+
+/**
+ * @brief The CircuitDelta struct describes an edit of the scene in terms of
+ *        element ids, so that the simulation layer can patch its mapping
+ *        instead of rebuilding it. An element replaced by another one with
+ *        the same id, as done by MorphCommand, is both removed and added.
+ */
+struct CircuitDelta {
+  /* Elements that left the scene. They may already be deleted. */
+  QVector< int > removed;
+  /* Elements that entered the scene. */
+  QVector< int > added;
+  /* Elements that stayed on the scene, but whose connections changed. */
+  QVector< int > rewired;
+
+  bool isEmpty( ) const {
+    return( removed.isEmpty( ) && added.isEmpty( ) && rewired.isEmpty( ) );
+  }
+};
+
+#endif // CIRCUITDELTA_H
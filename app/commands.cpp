@@ -174,6 +174,34 @@ QList< QGraphicsItem* > loadItems( QByteArray &itemData,
   return( items );
 }
 
+QVector< int > elementIds( const QList< QGraphicsItem* > &items ) {
+  QVector< int > ids;
+  for( QGraphicsItem *item : items ) {
+    GraphicElement *elm = qgraphicsitem_cast< GraphicElement* >( item );
+    if( elm ) {
+      ids.append( elm->id( ) );
+    }
+  }
+  return( ids );
+}
+
+/* Ids of the elements fed by the outputs of elms, elms excluded. */
+QVector< int > successorIds( const QVector< GraphicElement* > &elms ) {
+  QVector< int > ids;
+  for( GraphicElement *elm : elms ) {
+    for( QNEOutputPort *port : elm->outputs( ) ) {
+      for( QNEConnection *conn : port->connections( ) ) {
+        QNEPort *other = conn->otherPort( port );
+        if( other && other->graphicElement( ) && !elms.contains( other->graphicElement( ) ) &&
+            !ids.contains( other->graphicElement( )->id( ) ) ) {
+          ids.append( other->graphicElement( )->id( ) );
+        }
+      }
+    }
+  }
+  return( ids );
+}
+
 void deleteItems( const QList< QGraphicsItem* > &items, Editor *editor ) {
   QVector< QGraphicsItem* > itemsVec = items.toVector( );
   /* Delete items on reverse order */
@@ -227,33 +255,48 @@ DeleteItemsCommand::DeleteItemsCommand( QGraphicsItem *item, Editor *aEditor, QU
 void AddItemsCommand::undo( ) {
   COMMENT( "UNDO " + text( ).toStdString( ), 0 );
   QList< QGraphicsItem* > items = findItems( ids );
+  CircuitDelta delta;
+  delta.removed = elementIds( items );
+  delta.rewired = otherIds;
 
   saveitems( itemData, items, otherIds );
   deleteItems( items, editor );
-  emit editor->circuitHasChanged( );
+  emit editor->circuitPatched( delta );
 }
 
 
 void AddItemsCommand::redo( ) {
   COMMENT( "REDO " + text( ).toStdString( ), 0 );
   QList< QGraphicsItem* > items = loadItems( itemData, ids, editor, otherIds );
-  emit editor->circuitHasChanged( );
+  if( items.isEmpty( ) ) {
+    /* On the first redo, the items were already added by the constructor. */
+    items = findItems( ids );
+  }
+  CircuitDelta delta;
+  delta.added = elementIds( items );
+  delta.rewired = otherIds;
+  emit editor->circuitPatched( delta );
 }
 
 void DeleteItemsCommand::undo( ) {
   COMMENT( "UNDO " + text( ).toStdString( ), 0 );
-  loadItems( itemData, ids, editor, otherIds );
-  emit editor->circuitHasChanged( );
+  CircuitDelta delta;
+  delta.added = elementIds( loadItems( itemData, ids, editor, otherIds ) );
+  delta.rewired = otherIds;
+  emit editor->circuitPatched( delta );
 }
 
 void DeleteItemsCommand::redo( ) {
   COMMENT( "REDO " + text( ).toStdString( ), 0 );
   QList< QGraphicsItem* > items = findItems( ids );
+  CircuitDelta delta;
+  delta.removed = elementIds( items );
+  delta.rewired = otherIds;
 
   saveitems( itemData, items, otherIds );
 
   deleteItems( items, editor );
-  emit editor->circuitHasChanged( );
+  emit editor->circuitPatched( delta );
 }
 
 
@@ -488,7 +531,10 @@ void SplitCommand::redo( ) {
   else {
     throw std::runtime_error( ERRORMSG( QString( "Error tryng to redo %1" ).arg( text( ) ).toStdString( ) ) );
   }
-  emit editor->circuitHasChanged( );
+  CircuitDelta delta;
+  delta.added.append( node_id );
+  delta.rewired.append( elm2_id );
+  emit editor->circuitPatched( delta );
 }
 
 void SplitCommand::undo( ) {
@@ -513,7 +559,10 @@ void SplitCommand::undo( ) {
   else {
     throw std::runtime_error( ERRORMSG( QString( "Error tryng to undo %1" ).arg( text( ) ).toStdString( ) ) );
   }
-  emit editor->circuitHasChanged( );
+  CircuitDelta delta;
+  delta.removed.append( node_id );
+  delta.rewired.append( elm2_id );
+  emit editor->circuitPatched( delta );
 }
 
 MorphCommand::MorphCommand( const QVector< GraphicElement* > &elements,
@@ -539,7 +588,11 @@ void MorphCommand::undo( ) {
     oldElms[ i ] = ElementFactory::buildElement( types[ i ] );
   }
   transferConnections( newElms, oldElms );
-  emit editor->circuitHasChanged( );
+  CircuitDelta delta;
+  delta.removed = ids;
+  delta.added = ids;
+  delta.rewired = successorIds( oldElms );
+  emit editor->circuitPatched( delta );
 }
 
 void MorphCommand::redo( ) {
@@ -550,7 +603,11 @@ void MorphCommand::redo( ) {
     newElms[ i ] = ElementFactory::buildElement( newtype );
   }
   transferConnections( oldElms, newElms );
-  emit editor->circuitHasChanged( );
+  CircuitDelta delta;
+  delta.removed = ids;
+  delta.added = ids;
+  delta.rewired = successorIds( newElms );
+  emit editor->circuitPatched( delta );
 }
 
 void MorphCommand::transferConnections( QVector< GraphicElement* > from, QVector< GraphicElement* > to ) {
@@ -662,7 +719,12 @@ void ChangeInputSZCommand::redo( ) {
   for( GraphicElement *elm : serializationOrder ) {
     order.append( elm->id( ) );
   }
-  emit editor->circuitHasChanged( );
+  /* The input count of a logic element is fixed, so the resized elements are replaced. */
+  CircuitDelta delta;
+  delta.removed = elms;
+  delta.added = elms;
+  delta.rewired = successorIds( m_elements );
+  emit editor->circuitPatched( delta );
 }
 
 void ChangeInputSZCommand::undo( ) {
@@ -687,8 +749,11 @@ void ChangeInputSZCommand::undo( ) {
     }
     elm->setSelected( true );
   }
-  emit editor->circuitHasChanged( );
-
+  CircuitDelta delta;
+  delta.removed = elms;
+  delta.added = elms;
+  delta.rewired = successorIds( m_elements );
+  emit editor->circuitPatched( delta );
 }
 
 FlipCommand::FlipCommand( const QList< GraphicElement* > &aItems, int aAxis, QUndoCommand *parent ) :
@@ -51,6 +51,7 @@ Editor::Editor( QObject *parent ) : QObject( parent ), scene( nullptr ) {
   mShowWires = true;
   mShowGates = true;
   connect( this, &Editor::circuitHasChanged, simulationController, &SimulationController::reSortElms );
+  connect( this, &Editor::circuitPatched, simulationController, &SimulationController::applyDelta );
 }
 
 Editor::~Editor( ) {
@@ -31,6 +31,11 @@ public:
 signals:
   void scroll( int x, int y );
   void circuitHasChanged( );
+  /**
+   * @brief circuitPatched is emitted by the undo commands instead of
+   *        circuitHasChanged( ), with the elements they touched.
+   */
+  void circuitPatched( const CircuitDelta &delta );
 
 public slots:
   void clear( );
@@ -62,19 +62,20 @@ float Clock::getFrequency( ) const {
 
 void Clock::setFrequency( float freq ) {
   /*  qDebug() << "Clock frequency set to " << freq; */
-  if( !qFuzzyIsNull( freq ) ) {
-    int auxinterval = 1000 / ( freq * GLOBALCLK );
-    if( auxinterval > 0 ) {
-      interval = auxinterval;
-      m_frequency = static_cast< double >( freq );
-      elapsed = 0;
-      Clock::reset = true;
-      //      qDebug() << "Freq = " << freq <<  " interval = " << interval;
-    }
+  if( freq > 0 ) {
+    /* The simulation schedules edges at any frequency, the legacy tick counter toggles at most every tick. */
+    interval = qMax( static_cast< int >( 1000 / ( freq * GLOBALCLK ) ), 1 );
+    m_frequency = static_cast< double >( freq );
+    elapsed = 0;
+    Clock::reset = true;
     /*    timer.start( static_cast< int >(1000.0/freq) ); */
   }
 }
 
+int Clock::getInterval( ) const {
+  return( interval );
+}
+
 void Clock::resetClock( ) {
   setOn( true );
   elapsed = 0;
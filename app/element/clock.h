@@ -35,6 +35,10 @@ public:
   void setFrequency( float freq ) override;
   void updateClock( );
   void resetClock( );
+  /**
+   * @brief getInterval returns how many ticks the clock stays in each state.
+   */
+  int getInterval( ) const;
   QString genericProperties( ) override;
 public:
   bool getOn( ) const override;
@@ -47,4 +47,5 @@ void InputButton::setOn( const bool value ) {
   on = value;
   setPixmap( on ? ":/input/buttonOn.png" : ":/input/buttonOff.png" );
   updateLogic( );
+  emit inputChanged( on );
 }
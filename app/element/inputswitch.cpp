@@ -25,6 +25,7 @@ void InputSwitch::setOn( bool value ) {
   else {
     setPixmap( ":/input/switchOff.png" );
   }
+  emit inputChanged( on );
 }
 
 void InputSwitch::mousePressEvent( QGraphicsSceneMouseEvent *event ) {
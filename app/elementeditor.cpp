@@ -1,6 +1,7 @@
 #include "commands.h"
 #include "editor.h"
 #include "elementeditor.h"
+#include "elementinfo.h"
 #include "ui_elementeditor.h"
 #include <cmath>
 #include <QDebug>
@@ -15,6 +16,7 @@ ElementEditor::ElementEditor( QWidget *parent ) : QWidget( parent ), ui( new Ui:
   _manyFreq = tr( "<Many values>" );
   _manyTriggers = tr( "<Many triggers>" );
   _manyAudios = tr( "<Many sounds>" );
+  _manyDelays = tr( "<Many values>" );
 
   ui->setupUi( this );
   setEnabled( false );
@@ -27,6 +29,7 @@ ElementEditor::ElementEditor( QWidget *parent ) : QWidget( parent ), ui( new Ui:
   ui->comboBoxColor->installEventFilter( this );
   ui->comboBoxInputSz->installEventFilter( this );
   ui->doubleSpinBoxFrequency->installEventFilter( this );
+  ui->spinBoxDelay->installEventFilter( this );
   ui->comboBoxAudio->installEventFilter( this );
 }
 
@@ -204,6 +207,7 @@ void ElementEditor::setCurrentElements( const QVector< GraphicElement* > &elms )
   hasLabel = hasColors = hasFrequency = canChangeInputSize = hasTrigger = hasAudio = false;
   hasRotation = hasSameLabel = hasSameColors = hasSameFrequency = hasSameAudio = false;
   hasSameInputSize = hasSameTrigger = canMorph = hasSameType = hasAnyProperty = false;
+  hasDelay = hasSameDelay = false;
   hasElements = false;
   if( !elms.isEmpty( ) ) {
     hasAnyProperty = false;
@@ -215,6 +219,7 @@ void ElementEditor::setCurrentElements( const QVector< GraphicElement* > &elms )
     hasSameLabel = hasSameColors = hasSameFrequency = true;
     hasSameInputSize = hasSameTrigger = canMorph = true;
     hasSameAudio = true;
+    hasDelay = hasSameDelay = true;
     hasSameType = true;
     hasElements = true;
     GraphicElement *firstElement = m_elements.front( );
@@ -227,6 +232,7 @@ void ElementEditor::setCurrentElements( const QVector< GraphicElement* > &elms )
       maximum = std::min( maximum, elm->maxInputSz( ) );
       hasTrigger &= elm->hasTrigger( );
       hasRotation &= elm->rotatable( );
+      hasDelay &= elm->hasDelay( );
 
       hasSameLabel &= elm->getLabel( ) == firstElement->getLabel( );
       hasSameColors &= elm->getColor( ) == firstElement->getColor( );
@@ -235,6 +241,7 @@ void ElementEditor::setCurrentElements( const QVector< GraphicElement* > &elms )
       hasSameTrigger &= elm->getTrigger( ) == firstElement->getTrigger( );
       hasSameType &= elm->elementType( ) == firstElement->elementType( );
       hasSameAudio &= elm->getAudio( ) == firstElement->getAudio( );
+      hasSameDelay &= elm->getDelay( ) == firstElement->getDelay( );
       canMorph &= elm->inputSize( ) == firstElement->inputSize( );
       canMorph &= elm->outputSize( ) == firstElement->outputSize( );
 
@@ -247,7 +254,7 @@ void ElementEditor::setCurrentElements( const QVector< GraphicElement* > &elms )
     }
     canChangeInputSize = ( minimum < maximum );
     hasAnyProperty |= hasLabel | hasColors | hasFrequency | hasAudio;
-    hasAnyProperty |= canChangeInputSize | hasTrigger;
+    hasAnyProperty |= canChangeInputSize | hasTrigger | hasDelay;
 
 
     /* Labels */
@@ -310,6 +317,25 @@ void ElementEditor::setCurrentElements( const QVector< GraphicElement* > &elms )
         ui->doubleSpinBoxFrequency->setValue( 0.0 );
       }
     }
+    /* Propagation delay */
+    ui->spinBoxDelay->setVisible( hasDelay );
+    ui->spinBoxDelay->setEnabled( hasDelay );
+    ui->label_delay->setVisible( hasDelay );
+    if( hasDelay ) {
+      if( hasSameDelay ) {
+        /* -1 stands for the default delay of the type. */
+        QString defaultText = tr( "Default" );
+        if( hasSameType ) {
+          defaultText = tr( "Default (%1 ns)" ).arg( ElementInfo::defaultDelay( firstElement->elementType( ) ) );
+        }
+        ui->spinBoxDelay->setSpecialValueText( defaultText );
+        ui->spinBoxDelay->setValue( firstElement->getDelay( ) );
+      }
+      else {
+        ui->spinBoxDelay->setSpecialValueText( _manyDelays );
+        ui->spinBoxDelay->setValue( -1 );
+      }
+    }
     /* Input size */
     ui->comboBoxInputSz->clear( );
     ui->label_inputs->setVisible( canChangeInputSize );
@@ -378,6 +404,9 @@ void ElementEditor::apply( ) {
     if( elm->hasFrequency( ) && ( ui->doubleSpinBoxFrequency->text( ) != _manyFreq ) ) {
       elm->setFrequency( ui->doubleSpinBoxFrequency->value( ) );
     }
+    if( elm->hasDelay( ) && ( ui->spinBoxDelay->text( ) != _manyDelays ) ) {
+      elm->setDelay( ui->spinBoxDelay->value( ) );
+    }
     if( elm->hasTrigger( ) && ( ui->lineEditTrigger->text( ) != _manyTriggers ) ) {
       if( ui->lineEditTrigger->text( ).size( ) <= 1 ) {
         elm->setTrigger( QKeySequence( ui->lineEditTrigger->text( ) ) );
@@ -408,6 +437,10 @@ void ElementEditor::on_doubleSpinBoxFrequency_editingFinished( ) {
   apply( );
 }
 
+void ElementEditor::on_spinBoxDelay_editingFinished( ) {
+  apply( );
+}
+
 void ElementEditor::on_comboBoxColor_currentIndexChanged( int ) {
   apply( );
 }
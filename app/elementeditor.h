@@ -48,6 +48,8 @@ private slots:
 
   void on_doubleSpinBoxFrequency_editingFinished( );
 
+  void on_spinBoxDelay_editingFinished( );
+
   void on_comboBoxColor_currentIndexChanged( int index );
 
   void on_lineEditTrigger_textChanged( const QString &arg1 );
@@ -72,6 +74,7 @@ private:
   bool hasSameLabel, hasSameColors, hasSameFrequency;
   bool hasSameInputSize, hasSameTrigger, canMorph, hasSameType;
   bool hasSameAudio;
+  bool hasDelay, hasSameDelay;
   bool hasElements;
 
   QString _manyLabels;
@@ -80,6 +83,7 @@ private:
   QString _manyFreq;
   QString _manyTriggers;
   QString _manyAudios;
+  QString _manyDelays;
 
 
 };
@@ -25,6 +25,7 @@
 #include "element/xnor.h"
 #include "element/xor.h"
 #include "elementfactory.h"
+#include "elementinfo.h"
 #include "mux.h"
 #include "node.h"
 #include "qneconnection.h"
@@ -74,37 +75,7 @@ ElementType ElementFactory::textToType( QString text ) {
 }
 
 QString ElementFactory::typeToText( ElementType type ) {
-  switch( type ) {
-      case ElementType::BUTTON: return( "BUTTON" );
-      case ElementType::LED: return( "LED" );
-      case ElementType::AND: return( "AND" );
-      case ElementType::OR: return( "OR" );
-      case ElementType::CLOCK: return( "CLOCK" );
-      case ElementType::SWITCH: return( "SWITCH" );
-      case ElementType::NOT: return( "NOT" );
-      case ElementType::NAND: return( "NAND" );
-      case ElementType::NOR: return( "NOR" );
-      case ElementType::XOR: return( "XOR" );
-      case ElementType::XNOR: return( "XNOR" );
-      case ElementType::VCC: return( "VCC" );
-      case ElementType::GND: return( "GND" );
-      case ElementType::DFLIPFLOP: return( "DFLIPFLOP" );
-      case ElementType::DLATCH: return( "DLATCH" );
-      case ElementType::JKFLIPFLOP: return( "JKFLIPFLOP" );
-      case ElementType::JKLATCH: return( "JKLATCH" );
-      case ElementType::SRFLIPFLOP: return( "SRFLIPFLOP" );
-      case ElementType::TLATCH: return( "TLATCH" );
-      case ElementType::TFLIPFLOP: return( "TFLIPFLOP" );
-      case ElementType::DISPLAY: return( "DISPLAY" );
-      case ElementType::DISPLAY14: return( "DISPLAY14" );
-      case ElementType::BOX: return( "BOX" );
-      case ElementType::MUX: return( "MUX" );
-      case ElementType::DEMUX: return( "DEMUX" );
-      case ElementType::NODE: return( "NODE" );
-      case ElementType::BUZZER: return( "BUZZER" );
-      case ElementType::LEDGRID: return( "LEDGRID" );
-      case ElementType::UNKNOWN: default: return( "UNKNOWN" );
-  }
+  return( ElementInfo::typeName( type ) );
 }
 
 QString ElementFactory::translatedName( ElementType type ) {
@@ -3,6 +3,7 @@
 #include "boxmapping.h"
 #include "boxprototype.h"
 #include "clock.h"
+#include "elementfactory.h"
 #include "elementmapping.h"
 #include "qneconnection.h"
 
@@ -22,13 +23,19 @@
 #include "logicelement/logictflipflop.h"
 #include "logicelement/logicxnor.h"
 #include "logicelement/logicxor.h"
+#include "simulation/levelizer.h"
+#include "simulation/netlist.h"
 
+#include <algorithm>
 #include <QDebug>
+#include <QSet>
 
 ElementMapping::ElementMapping( const QVector< GraphicElement* > &elms, QString file ) :
   currentFile( file ),
   initialized( false ),
   elements( elms ),
+  loopIterations( static_cast< int >( Netlist::DEFAULT_ITERATION_LIMIT ) ),
+  evaluations( 0 ),
   globalGND( false ),
   globalVCC( true ) {
 }
@@ -49,22 +56,55 @@ void ElementMapping::clear( ) {
     delete boxMap;
   }
   boxMappings.clear( );
+  idMap.clear( );
+  boxIds.clear( );
+  boxPorts.clear( );
   map.clear( );
   inputMap.clear( );
   clocks.clear( );
   logicElms.clear( );
+  loops.clear( );
+  loopRanges.clear( );
+  rangeLoops.clear( );
+  loopPorts.clear( );
+  oscillating.clear( );
+  loopIndex.clear( );
 }
 
 
 
 QVector< GraphicElement* > ElementMapping::sortGraphicElements( QVector< GraphicElement* > elms ) {
-  QMap< GraphicElement*, bool > beingvisited;
-  QMap< GraphicElement*, int > priority;
-  for( GraphicElement *elm : elms ) {
-    calculatePriority( elm, beingvisited, priority );
+  /* Elements reached through connections are levelized too, even when they are not in elms. */
+  QVector< GraphicElement* > nodes( elms );
+  QHash< GraphicElement*, uint32_t > index;
+  index.reserve( nodes.size( ) );
+  for( int idx = 0; idx < nodes.size( ); ++idx ) {
+    index.insert( nodes[ idx ], static_cast< uint32_t >( idx ) );
   }
-  std::sort( elms.begin( ), elms.end( ), [ priority ]( GraphicElement *e1, GraphicElement *e2 ) {
-    return( priority[ e2 ] < priority[ e1 ] );
+  std::vector< uint32_t > begin( 1, 0 );
+  std::vector< uint32_t > successors;
+  for( int idx = 0; idx < nodes.size( ); ++idx ) {
+    for( QNEPort *port : nodes[ idx ]->outputs( ) ) {
+      for( QNEConnection *conn : port->connections( ) ) {
+        QNEPort *sucessor = conn->otherPort( port );
+        GraphicElement *elm = sucessor ? sucessor->graphicElement( ) : nullptr;
+        if( !elm ) {
+          continue;
+        }
+        auto it = index.find( elm );
+        if( it == index.end( ) ) {
+          it = index.insert( elm, static_cast< uint32_t >( nodes.size( ) ) );
+          nodes.append( elm );
+        }
+        successors.push_back( it.value( ) );
+      }
+    }
+    begin.push_back( static_cast< uint32_t >( successors.size( ) ) );
+  }
+  std::vector< int > priority;
+  Levelizer( std::move( begin ), std::move( successors ) ).levelize( priority );
+  std::sort( elms.begin( ), elms.end( ), [ &index, &priority ]( GraphicElement *e1, GraphicElement *e2 ) {
+    return( priority[ index[ e2 ] ] < priority[ index[ e1 ] ] );
   } );
 
   return( elms );
@@ -72,6 +112,7 @@ QVector< GraphicElement* > ElementMapping::sortGraphicElements( QVector< Graphic
 
 void ElementMapping::insertElement( GraphicElement *elm ) {
   LogicElement *logicElm = buildLogicElement( elm );
+  logicElm->setDelay( elm->propagationDelay( ) );
   deletableElements.append( logicElm );
   logicElms.append( logicElm );
   map.insert( elm, logicElm );
@@ -96,6 +137,7 @@ void ElementMapping::insertBox( Box *box ) {
 
 void ElementMapping::generateMap( ) {
   for( GraphicElement *elm: elements ) {
+    idMap.insert( elm->id( ), elm );
     if( elm->elementType( ) == ElementType::CLOCK ) {
       Clock *clk = dynamic_cast< Clock* >( elm );
       Q_ASSERT( clk != nullptr );
@@ -103,6 +145,7 @@ void ElementMapping::generateMap( ) {
     }
     if( elm->elementType( ) == ElementType::BOX ) {
       Box *box = dynamic_cast< Box* >( elm );
+      boxIds.insert( elm->id( ), box );
       insertBox( box );
     }
     else {
@@ -162,10 +205,51 @@ LogicElement* ElementMapping::buildLogicElement( GraphicElement *elm ) {
   }
 }
 
+LogicElement* ElementMapping::buildLogicElement( LogicOp op, int inputSize, bool value ) {
+  switch( op ) {
+      case LogicOp::INPUT:
+      return( new LogicInput( value ) );
+      case LogicOp::OUTPUT:
+      return( new LogicOutput( inputSize ) );
+      case LogicOp::NODE:
+      return( new LogicNode( ) );
+      case LogicOp::AND:
+      return( new LogicAnd( inputSize ) );
+      case LogicOp::OR:
+      return( new LogicOr( inputSize ) );
+      case LogicOp::NAND:
+      return( new LogicNand( inputSize ) );
+      case LogicOp::NOR:
+      return( new LogicNor( inputSize ) );
+      case LogicOp::XOR:
+      return( new LogicXor( inputSize ) );
+      case LogicOp::XNOR:
+      return( new LogicXnor( inputSize ) );
+      case LogicOp::NOT:
+      return( new LogicNot( ) );
+      case LogicOp::JKFLIPFLOP:
+      return( new LogicJKFlipFlop( ) );
+      case LogicOp::SRFLIPFLOP:
+      return( new LogicSRFlipFlop( ) );
+      case LogicOp::TFLIPFLOP:
+      return( new LogicTFlipFlop( ) );
+      case LogicOp::DFLIPFLOP:
+      return( new LogicDFlipFlop( ) );
+      case LogicOp::DLATCH:
+      return( new LogicDLatch( ) );
+      case LogicOp::MUX:
+      return( new LogicMux( ) );
+      case LogicOp::DEMUX:
+      return( new LogicDemux( ) );
+  }
+  throw std::runtime_error( "Unknown logic operation." );
+}
+
 void ElementMapping::initialize( ) {
   clear( );
   generateMap( );
   connectElements( );
+  mapBoxPorts( );
   initialized = true;
 }
 
@@ -174,24 +258,289 @@ void ElementMapping::sort( ) {
   validateElements( );
 }
 
-void ElementMapping::update( ) {
-  if( canRun( ) ) {
-    for( Clock *clk : clocks ) {
-      if( Clock::reset ) {
-        clk->resetClock( );
+void ElementMapping::flatten( ) {
+  QVector< LogicElement* > nodes;
+  collectBoundaryNodes( nodes );
+  QHash< LogicElement*, int > position;
+  for( int idx = 0; idx < logicElms.size( ); ++idx ) {
+    position.insert( logicElms[ idx ], idx );
+  }
+  QSet< LogicElement* > removed;
+  for( LogicElement *node : nodes ) {
+    LogicElement *pred = node->predecessor( 0 );
+    /* Global VCC and GND are not in the evaluation order, they never change. */
+    int nodePosition = position.value( node, -1 );
+    if( !node->isValid( ) || !pred || !pred->isValid( ) || ( nodePosition < 0 ) ||
+        ( position.value( pred, -1 ) >= nodePosition ) ) {
+      continue;
+    }
+    bool forward = true;
+    for( LogicElement *succ : node->sucessors( ) ) {
+      forward &= ( position.value( succ, -1 ) > nodePosition );
+    }
+    if( forward ) {
+      node->bypass( );
+      removed.insert( node );
+    }
+  }
+  if( removed.isEmpty( ) ) {
+    return;
+  }
+  logicElms.erase( std::remove_if( logicElms.begin( ), logicElms.end( ), [ &removed ]( LogicElement *elm ) {
+    return( removed.contains( elm ) );
+  } ), logicElms.end( ) );
+  for( QVector< LogicElement* > &loop : loops ) {
+    loop.erase( std::remove_if( loop.begin( ), loop.end( ), [ &removed ]( LogicElement *elm ) {
+      return( removed.contains( elm ) );
+    } ), loop.end( ) );
+  }
+  findLoopRanges( );
+  /* A removed node keeps its own input, which leads to the element that now drives its successors. */
+  for( auto iter = boxPorts.begin( ); iter != boxPorts.end( ); ++iter ) {
+    while( removed.contains( iter.value( ).first ) ) {
+      LogicElement *node = iter.value( ).first;
+      iter.value( ) = qMakePair( node->predecessor( 0 ), node->predecessorPort( 0 ) );
+    }
+  }
+}
+
+bool ElementMapping::applyDelta( const CircuitDelta &delta, const QVector< GraphicElement* > &elms,
+                                 QSet< LogicElement* > &created ) {
+  if( !initialized ) {
+    return( false );
+  }
+  /* Everything is looked up before the mapping is changed. */
+  QSet< int > removedIds;
+  for( int id : delta.removed ) {
+    if( idMap.contains( id ) ) {
+      removedIds.insert( id );
+    }
+  }
+  QVector< GraphicElement* > added;
+  QVector< GraphicElement* > rewired;
+  for( int id : delta.added + delta.rewired ) {
+    GraphicElement *elm = dynamic_cast< GraphicElement* >( ElementFactory::getItemById( id ) );
+    if( !elm ) {
+      return( false );
+    }
+    Box *box = dynamic_cast< Box* >( elm );
+    if( box && !box->getPrototype( ) ) {
+      return( false );
+    }
+    bool mapped = !removedIds.contains( id ) && ( idMap.value( id ) == elm );
+    QVector< GraphicElement* > &list = mapped ? rewired : added;
+    if( !list.contains( elm ) ) {
+      list.append( elm );
+    }
+  }
+  /* Elements whose successors changed, their priority must be recalculated. */
+  QSet< LogicElement* > dirty;
+  QSet< LogicElement* > removed;
+  for( int id : removedIds ) {
+    removeElement( id, removed, dirty );
+  }
+  dirty.subtract( removed );
+  for( GraphicElement *elm : added ) {
+    const int first = logicElms.size( );
+    idMap.insert( elm->id( ), elm );
+    if( elm->elementType( ) == ElementType::BOX ) {
+      Box *box = dynamic_cast< Box* >( elm );
+      boxIds.insert( elm->id( ), box );
+      insertBox( box );
+    }
+    else {
+      insertElement( elm );
+    }
+    for( int idx = first; idx < logicElms.size( ); ++idx ) {
+      created.insert( logicElms[ idx ] );
+      dirty.insert( logicElms[ idx ] );
+    }
+  }
+  for( GraphicElement *elm : added + rewired ) {
+    QVector< LogicElement* > inputs = inputElements( elm );
+    for( LogicElement *logicElm : inputs ) {
+      for( size_t in = 0; in < logicElm->inputSize( ); ++in ) {
+        if( logicElm->predecessor( in ) ) {
+          dirty.insert( logicElm->predecessor( in ) );
+        }
+      }
+      logicElm->clearPredecessors( );
+    }
+    for( QNEPort *in : elm->inputs( ) ) {
+      applyConnection( elm, in );
+    }
+    for( LogicElement *logicElm : inputs ) {
+      for( size_t in = 0; in < logicElm->inputSize( ); ++in ) {
+        if( logicElm->predecessor( in ) ) {
+          dirty.insert( logicElm->predecessor( in ) );
+        }
       }
-      else {
-        clk->updateClock( );
+    }
+  }
+  elements = elms;
+  mapInputs( );
+  boxPorts.clear( );
+  mapBoxPorts( );
+  for( LogicElement *elm : dirty ) {
+    elm->invalidatePriority( );
+  }
+  sort( );
+  return( true );
+}
+
+void ElementMapping::removeElement( int id, QSet< LogicElement* > &removed, QSet< LogicElement* > &dirty ) {
+  /* The graphic element may already be deleted, its address is only used as a key. */
+  GraphicElement *elm = idMap.take( id );
+  Box *box = boxIds.take( id );
+  BoxMapping *boxMap = box ? boxMappings.take( box ) : nullptr;
+  QVector< LogicElement* > logic;
+  if( boxMap ) {
+    logic = boxMap->logicElms;
+  }
+  else if( map.contains( elm ) ) {
+    logic.append( map.take( elm ) );
+  }
+  QSet< LogicElement* > elms;
+  for( LogicElement *logicElm : logic ) {
+    for( size_t in = 0; in < logicElm->inputSize( ); ++in ) {
+      if( logicElm->predecessor( in ) ) {
+        dirty.insert( logicElm->predecessor( in ) );
       }
     }
-    Clock::reset = false;
+    logicElm->clearPredecessors( );
+    logicElm->clearSucessors( );
+    elms.insert( logicElm );
+  }
+  logicElms.erase( std::remove_if( logicElms.begin( ), logicElms.end( ), [ &elms ]( LogicElement *logicElm ) {
+    return( elms.contains( logicElm ) );
+  } ), logicElms.end( ) );
+  if( boxMap ) {
+    delete boxMap;
+  }
+  else {
+    deletableElements.erase( std::remove_if( deletableElements.begin( ), deletableElements.end( ),
+                                             [ &elms ]( LogicElement *logicElm ) {
+      return( elms.contains( logicElm ) );
+    } ), deletableElements.end( ) );
+    qDeleteAll( elms );
+  }
+  removed.unite( elms );
+}
+
+QVector< LogicElement* > ElementMapping::inputElements( GraphicElement *elm ) const {
+  QVector< LogicElement* > inputs;
+  if( elm->elementType( ) == ElementType::BOX ) {
+    BoxMapping *boxMap = boxMappings.value( dynamic_cast< Box* >( elm ) );
+    for( int port = 0; boxMap && ( port < elm->inputSize( ) ); ++port ) {
+      inputs.append( boxMap->getInput( port ) );
+    }
+  }
+  else if( map.contains( elm ) ) {
+    inputs.append( map[ elm ] );
+  }
+  return( inputs );
+}
+
+void ElementMapping::mapInputs( ) {
+  inputMap.clear( );
+  clocks.clear( );
+  for( GraphicElement *elm : elements ) {
+    if( elm->elementType( ) == ElementType::CLOCK ) {
+      clocks.append( dynamic_cast< Clock* >( elm ) );
+    }
+    Input *in = dynamic_cast< Input* >( elm );
+    if( in && map.contains( elm ) ) {
+      inputMap[ in ] = map[ elm ];
+    }
+  }
+}
+
+void ElementMapping::update( ) {
+  if( canRun( ) ) {
+    updateClocks( );
     for( auto iter = inputMap.begin( ); iter != inputMap.end( ); ++iter ) {
       iter.value( )->setOutputValue( iter.key( )->getOn( ) );
     }
-    for( LogicElement *elm : logicElms ) {
-      elm->updateLogic( );
+    run( );
+  }
+}
+
+void ElementMapping::run( ) {
+  evaluations = 0;
+  if( canRun( ) ) {
+    int next = 0;
+    for( int range = 0; range < loopRanges.size( ); ++range ) {
+      updateRange( next, loopRanges[ range ].first );
+      settle( range );
+      next = loopRanges[ range ].second;
+    }
+    updateRange( next, logicElms.size( ) );
+  }
+}
+
+void ElementMapping::updateRange( int begin, int end ) {
+  evaluations += static_cast< quint64 >( qMax( end - begin, 0 ) );
+  for( int idx = begin; idx < end; ++idx ) {
+    logicElms[ idx ]->updateLogic( );
+  }
+}
+
+void ElementMapping::settle( int range ) {
+  QVector< LogicPort > ports;
+  for( int loop : rangeLoops[ range ] ) {
+    ports += loopPorts[ loop ];
+  }
+  QVector< bool > previous( ports.size( ) );
+  bool changed = true;
+  for( int pass = 0; changed && ( pass < loopIterations ); ++pass ) {
+    for( int idx = 0; idx < ports.size( ); ++idx ) {
+      previous[ idx ] = ports[ idx ].first->getOutputValue( ports[ idx ].second );
+    }
+    updateRange( loopRanges[ range ].first, loopRanges[ range ].second );
+    changed = false;
+    int idx = 0;
+    for( int loop : rangeLoops[ range ] ) {
+      bool loopChanged = false;
+      for( const LogicPort &port : loopPorts[ loop ] ) {
+        loopChanged |= ( port.first->getOutputValue( port.second ) != previous[ idx++ ] );
+      }
+      oscillating[ loop ] = loopChanged;
+      changed |= loopChanged;
+    }
+  }
+}
+
+bool ElementMapping::isSettled( ) const {
+  return( !oscillating.contains( true ) );
+}
+
+quint64 ElementMapping::lastEvaluationCount( ) const {
+  return( evaluations );
+}
+
+int ElementMapping::iterationLimit( ) const {
+  return( loopIterations );
+}
+
+void ElementMapping::setIterationLimit( int limit ) {
+  loopIterations = qMax( limit, 1 );
+}
+
+bool ElementMapping::isOscillating( LogicElement *elm ) const {
+  const int loop = loopIndex.value( elm, -1 );
+  return( ( loop >= 0 ) && oscillating[ loop ] );
+}
+
+void ElementMapping::updateClocks( ) {
+  for( Clock *clk : clocks ) {
+    if( Clock::reset ) {
+      clk->resetClock( );
+    }
+    else {
+      clk->updateClock( );
     }
   }
+  Clock::reset = false;
 }
 
 BoxMapping* ElementMapping::getBoxMapping( Box *box ) const {
@@ -204,10 +553,38 @@ LogicElement* ElementMapping::getLogicElement( GraphicElement *elm ) const {
   return( map[ elm ] );
 }
 
+LogicPort ElementMapping::getLogicPort( QNEOutputPort *port ) const {
+  Q_ASSERT( port );
+  auto iter = boxPorts.constFind( port );
+  if( iter != boxPorts.constEnd( ) ) {
+    return( iter.value( ) );
+  }
+  return( qMakePair( map.value( port->graphicElement( ) ), port->index( ) ) );
+}
+
+void ElementMapping::mapBoxPorts( ) {
+  for( auto iter = boxMappings.begin( ); iter != boxMappings.end( ); ++iter ) {
+    for( QNEOutputPort *port : iter.key( )->outputs( ) ) {
+      boxPorts.insert( port, qMakePair( iter.value( )->getOutput( port->index( ) ), 0 ) );
+    }
+  }
+}
+
+void ElementMapping::collectBoundaryNodes( QVector< LogicElement* > &nodes ) const {
+  for( BoxMapping *boxMap : boxMappings ) {
+    boxMap->collectBoundaryNodes( nodes );
+    nodes += boxMap->boundaryNodes( );
+  }
+}
+
 bool ElementMapping::canRun( ) const {
   return( initialized );
 }
 
+const QVector< QVector< LogicElement* > > &ElementMapping::feedbackLoops( ) const {
+  return( loops );
+}
+
 bool ElementMapping::canInitialize( ) const {
   for( GraphicElement *elm: elements ) {
     if( elm->elementType( ) == ElementType::BOX ) {
@@ -276,40 +653,106 @@ void ElementMapping::validateElements( ) {
 }
 
 void ElementMapping::sortLogicElements( ) {
+  QHash< LogicElement*, uint32_t > index;
+  index.reserve( logicElms.size( ) );
+  for( int idx = 0; idx < logicElms.size( ); ++idx ) {
+    index.insert( logicElms[ idx ], static_cast< uint32_t >( idx ) );
+  }
+  std::vector< uint32_t > begin( 1, 0 );
+  std::vector< uint32_t > successors;
+  std::vector< int > priority;
+  priority.reserve( logicElms.size( ) );
   for( LogicElement *elm : logicElms ) {
-    elm->calculatePriority( );
+    for( LogicElement *sucessor : elm->sucessors( ) ) {
+      auto it = index.constFind( sucessor );
+      if( it != index.constEnd( ) ) {
+        successors.push_back( it.value( ) );
+      }
+    }
+    begin.push_back( static_cast< uint32_t >( successors.size( ) ) );
+    priority.push_back( elm->getPriority( ) );
+  }
+  Levelizer levelizer( std::move( begin ), std::move( successors ) );
+  levelizer.levelize( priority );
+  for( int idx = 0; idx < logicElms.size( ); ++idx ) {
+    logicElms[ idx ]->setPriority( priority[ idx ] );
+  }
+  loops.clear( );
+  for( const std::vector< uint32_t > &component : levelizer.feedbackLoops( ) ) {
+    QVector< LogicElement* > loop;
+    loop.reserve( static_cast< int >( component.size( ) ) );
+    for( uint32_t idx : component ) {
+      loop.append( logicElms[ static_cast< int >( idx ) ] );
+    }
+    loops.append( loop );
   }
   std::sort( logicElms.begin( ),
              logicElms.end( ),
              [ ]( LogicElement *e1, LogicElement *e2 ) {
     return( *e2 < *e1 );
   } );
-
+  findLoopRanges( );
 }
 
-int ElementMapping::calculatePriority( GraphicElement *elm, QMap< GraphicElement*, bool > &beingvisited,
-                                       QMap< GraphicElement*, int > &priority ) {
-  if( !elm ) {
-    return( 0 );
+void ElementMapping::findLoopRanges( ) {
+  loopRanges.clear( );
+  rangeLoops.clear( );
+  loopPorts.clear( );
+  loopIndex.clear( );
+  oscillating.fill( false, loops.size( ) );
+  if( loops.isEmpty( ) ) {
+    return;
+  }
+  QHash< LogicElement*, int > position;
+  std::vector< int > levels;
+  levels.reserve( logicElms.size( ) );
+  for( int idx = 0; idx < logicElms.size( ); ++idx ) {
+    position.insert( logicElms[ idx ], idx );
+    levels.push_back( logicElms[ idx ]->getPriority( ) );
   }
-  if( beingvisited.contains( elm ) && ( beingvisited[ elm ] == true ) ) {
-    return( 0 );
+  std::vector< std::vector< uint32_t > > positions;
+  for( const QVector< LogicElement* > &loop : loops ) {
+    positions.emplace_back( );
+    for( LogicElement *elm : loop ) {
+      positions.back( ).push_back( static_cast< uint32_t >( position.value( elm ) ) );
+    }
   }
-  if( priority.contains( elm ) ) {
-    return( priority[ elm ] );
+  for( const auto &range : Levelizer::loopRanges( levels, positions ) ) {
+    loopRanges.append( qMakePair( static_cast< int >( range.first ), static_cast< int >( range.second ) ) );
   }
-  beingvisited[ elm ] = true;
-  int max = 0;
-  for( QNEPort *port : elm->outputs( ) ) {
-    for( QNEConnection *conn : port->connections( ) ) {
-      QNEPort *sucessor = conn->otherPort( port );
-      if( sucessor ) {
-        max = qMax( calculatePriority( sucessor->graphicElement( ), beingvisited, priority ), max );
+  rangeLoops.resize( loopRanges.size( ) );
+  loopPorts.resize( loops.size( ) );
+  for( int loop = 0; loop < loops.size( ); ++loop ) {
+    if( loops[ loop ].isEmpty( ) ) {
+      continue;
+    }
+    const int first = position.value( loops[ loop ].first( ) );
+    int range = 0;
+    while( loopRanges[ range ].second <= first ) {
+      ++range;
+    }
+    rangeLoops[ range ].append( loop );
+    for( LogicElement *elm : loops[ loop ] ) {
+      loopIndex.insert( elm, loop );
+    }
+  }
+  /* Only elements of the same loop read an output that is updated later in the evaluation order. */
+  for( const QPair< int, int > &range : loopRanges ) {
+    QSet< LogicPort > listed;
+    for( int idx = range.first; idx < range.second; ++idx ) {
+      LogicElement *elm = logicElms[ idx ];
+      const int loop = loopIndex.value( elm, -1 );
+      if( !elm->isValid( ) || ( loop < 0 ) ) {
+        continue;
+      }
+      for( size_t input = 0; input < elm->inputSize( ); ++input ) {
+        LogicPort port( elm->predecessor( input ), elm->predecessorPort( input ) );
+        const int driver = position.value( port.first, -1 );
+        if( ( driver >= idx ) && ( driver < range.second ) && !listed.contains( port ) ) {
+          listed.insert( port );
+          loopPorts[ loop ].append( port );
+        }
       }
     }
   }
-  int p = max + 1;
-  priority[ elm ] = p;
-  beingvisited[ elm ] = false;
-  return( p );
 }
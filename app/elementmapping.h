@@ -1,14 +1,17 @@
 #ifndef ELEMENTMAPPING_H
 #define ELEMENTMAPPING_H
 
+#include "circuitdelta.h"
 #include "graphicelement.h"
 #include "input.h"
 #include "logicelement.h"
 #include "logicelement/logicinput.h"
 
 #include <QGraphicsScene>
+#include <QHash>
 #include <QMap>
 #include <QObject>
+#include <QSet>
 #include <QTimer>
 
 class Clock;
@@ -19,8 +22,11 @@ class ElementMapping;
 class BoxMapping;
 typedef QMap< GraphicElement*, LogicElement* > ElementMap;
 typedef QMap< Input*, LogicElement* > InputMap;
+typedef QPair< LogicElement*, int > LogicPort;
 
 class ElementMapping {
+  friend class BoxTemplate;
+  friend class CompiledSimulation;
 public:
 
   ElementMapping( const QVector< GraphicElement* > &elms, QString file = QString( ) );
@@ -34,14 +40,82 @@ public:
 
   void sort( );
 
+  /**
+   * @brief flatten removes the pass-through nodes at the boundaries of the
+   *        boxes, nested ones included, so that box contents are wired
+   *        straight into the parent circuit. It must be called after sort( ).
+   *        A node is only removed when its predecessor is evaluated before it
+   *        and it is evaluated before all of its successors, which keeps the
+   *        simulation results identical.
+   */
+  void flatten( );
+
+  /**
+   * @brief applyDelta patches an initialized and sorted mapping after an edit
+   *        of the scene, elms being the elements now on the scene. Only the
+   *        logic of the added and rewired elements is rebuilt, and priorities
+   *        are recalculated for the elements that reach the changed ones, so
+   *        the state of every other element is kept. The new logic elements
+   *        are inserted into created. Returns false, leaving the mapping
+   *        untouched, when the delta cannot be applied in place.
+   */
+  bool applyDelta( const CircuitDelta &delta, const QVector< GraphicElement* > &elms,
+                   QSet< LogicElement* > &created );
+
+  /**
+   * @brief update runs one tick. The elements of a feedback loop are updated
+   *        again within the tick until the loop settles, or the iteration
+   *        limit is reached.
+   */
   void update( );
 
+  /**
+   * @brief run evaluates one tick from the current values of the input
+   *        elements, without reading the inputs and clocks of the scene, so
+   *        it can be called away from the GUI thread.
+   */
+  void run( );
+
+  void updateClocks( );
+
+  /**
+   * @brief lastEvaluationCount returns how many elements were updated
+   *        during the last tick, loop iterations included.
+   */
+  quint64 lastEvaluationCount( ) const;
+
+  int iterationLimit( ) const;
+  void setIterationLimit( int limit );
+
+  /**
+   * @brief isOscillating returns true when elm belongs to a feedback loop
+   *        that was still changing at the end of the last tick.
+   */
+  bool isOscillating( LogicElement *elm ) const;
+
+  /**
+   * @brief isSettled returns false while a feedback loop keeps changing
+   *        from one tick to the next.
+   */
+  bool isSettled( ) const;
+
   BoxMapping* getBoxMapping( Box *box ) const;
   LogicElement* getLogicElement( GraphicElement *elm ) const;
+  /**
+   * @brief getLogicPort returns the logic element and output index that
+   *        drive an output port of the circuit, box ports included.
+   */
+  LogicPort getLogicPort( QNEOutputPort *port ) const;
 
   bool canRun( ) const;
   bool canInitialize( ) const;
 
+  /**
+   * @brief feedbackLoops returns the groups of logic elements that depend on
+   *        each other's outputs, as found by the last sort( ).
+   */
+  const QVector< QVector< LogicElement* > > &feedbackLoops( ) const;
+
 protected:
   // Attributes
   QString currentFile;
@@ -51,7 +125,21 @@ protected:
   QVector< Clock* > clocks;
   QVector< GraphicElement* > elements;
   QMap< Box*, BoxMapping* > boxMappings;
+  /* Elements by id, kept so that elements deleted from the scene can still be found. */
+  QHash< int, GraphicElement* > idMap;
+  QHash< int, Box* > boxIds;
+  QHash< QNEOutputPort*, LogicPort > boxPorts;
   QVector< LogicElement* > logicElms;
+  QVector< QVector< LogicElement* > > loops;
+  /* Ranges of logicElms updated until the loops they hold settle, see Levelizer::loopRanges( ). */
+  QVector< QPair< int, int > > loopRanges;
+  QVector< QVector< int > > rangeLoops;
+  /* Per loop: the outputs read by an element of the loop that is updated before their driver. */
+  QVector< QVector< LogicPort > > loopPorts;
+  QVector< bool > oscillating;
+  QHash< LogicElement*, int > loopIndex;
+  int loopIterations;
+  quint64 evaluations;
 
   LogicInput globalGND;
   LogicInput globalVCC;
@@ -60,6 +148,7 @@ protected:
 
   // Methods
   LogicElement* buildLogicElement( GraphicElement *elm );
+  static LogicElement* buildLogicElement( LogicOp op, int inputSize, bool value );
 
   void setDefaultValue( GraphicElement *elm, QNEPort *in );
   void applyConnection( GraphicElement *elm, QNEPort *in );
@@ -67,10 +156,16 @@ protected:
   void connectElements( );
   void validateElements( );
   void sortLogicElements( );
-  static int calculatePriority( GraphicElement *elm, QMap< GraphicElement*, bool > &beingvisited, QMap< GraphicElement*,
-                                                                                                        int > &priority );
+  void findLoopRanges( );
+  void updateRange( int begin, int end );
+  void settle( int range );
   void insertElement( GraphicElement *elm );
   void insertBox( Box *box );
+  void mapBoxPorts( );
+  void collectBoundaryNodes( QVector< LogicElement* > &nodes ) const;
+  QVector< LogicElement* > inputElements( GraphicElement *elm ) const;
+  void removeElement( int id, QSet< LogicElement* > &removed, QSet< LogicElement* > &dirty );
+  void mapInputs( );
 
 };
 
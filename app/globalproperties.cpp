@@ -1,17 +1,10 @@
+#include "circuitloader.h"
 #include "common.h"
 #include "globalproperties.h"
 
-#include <QStringList>
-
 
 double GlobalProperties::toDouble( QString txtVersion, bool *ok ) {
-  double version;
-  if( txtVersion.contains( "-" ) ) {
-    txtVersion = txtVersion.split( "-" ).first( );
-  }
-  txtVersion = txtVersion.split( "." )[ 0 ] + "." + txtVersion.split( "." )[ 1 ];
-  version = txtVersion.toDouble( ok );
-  return( version );
+  return( CircuitLoader::parseVersion( txtVersion, ok ) );
 }
 
 double loadVersion( ) {
@@ -1,9 +1,9 @@
 #ifndef GLOBALPROPERTIES_H
 #define GLOBALPROPERTIES_H
 
-#include <QString>
+#include "simulation/simulationbackend.h"
 
-#define GLOBALCLK 10
+#include <QString>
 
 class GlobalProperties {
 public:
@@ -1,3 +1,4 @@
+#include "elementinfo.h"
 #include "graphicelement.h"
 #include "nodes/qneconnection.h"
 #include "scene.h"
@@ -50,6 +51,7 @@ GraphicElement::GraphicElement( int minInputSz, int maxInputSz, int minOutputSz,
   m_hasFrequency = false;
   m_hasLabel = false;
   m_disabled = false;
+  m_delay = -1;
   m_outputsOnTop = true;
 
   COMMENT( "Including input and output ports.", 4 );
@@ -139,6 +141,9 @@ void GraphicElement::save( QDataStream &ds ) const {
   /* <Version1.9> */
   ds << m_trigger;
   /* <\Version1.9> */
+  /* <Version2.7> */
+  ds << static_cast< qint32 >( m_delay );
+  /* <\Version2.7> */
   ds << static_cast< quint64 >( m_inputs.size( ) );
   for( QNEPort *port: m_inputs ) {
     ds << reinterpret_cast< quint64 >( port );
@@ -167,6 +172,9 @@ void GraphicElement::load( QDataStream &ds, QMap< quint64, QNEPort* > &portMap,
   /* <Version1.9> */
   loadTrigger( ds, version );
   /* <\Version1.9> */
+  /* <Version2.7> */
+  loadDelay( ds, version );
+  /* <\Version2.7> */
   loadInputPorts( ds, portMap );
   loadOutputPorts( ds, portMap );
   COMMENT( "Updating port positions.", 4 );
@@ -223,6 +231,13 @@ void GraphicElement::loadTrigger( QDataStream &ds, double version ) {
   }
 }
 
+void GraphicElement::loadDelay( QDataStream &ds, double version ) {
+  if( version >= 2.7 ) {
+    qint32 delay;
+    ds >> delay;
+    setDelay( delay );
+  }
+}
 
 void GraphicElement::loadInputPorts( QDataStream &ds, QMap< quint64, QNEPort* > &portMap ) {
   COMMENT( "Loading input ports.", 4 );
@@ -651,6 +666,25 @@ void GraphicElement::setFrequency( float ) {
 
 }
 
+int GraphicElement::getDelay( ) const {
+  return( m_delay );
+}
+
+void GraphicElement::setDelay( int delay ) {
+  m_delay = qMax( delay, -1 );
+}
+
+uint32_t GraphicElement::propagationDelay( ) {
+  if( !hasDelay( ) ) {
+    return( 0 );
+  }
+  return( m_delay >= 0 ? static_cast< uint32_t >( m_delay ) : ElementInfo::defaultDelay( elementType( ) ) );
+}
+
+bool GraphicElement::hasDelay( ) {
+  return( ElementInfo::hasDelay( elementType( ) ) );
+}
+
 void GraphicElement::setMinOutputSz( int minOutputSz ) {
   m_minOutputSz = minOutputSz;
 }
@@ -2,6 +2,7 @@
 #define GRAPHICELEMENT_H
 
 #include "common.h"
+#include "elementtype.h"
 #include "itemwithid.h"
 #include "nodes/qneport.h"
 
@@ -9,19 +10,6 @@
 #include <QGraphicsPixmapItem>
 #include <QKeySequence>
 
-enum class ElementType {
-  UNKNOWN, BUTTON, SWITCH, LED, NOT, AND, OR, NAND, NOR, CLOCK, XOR, XNOR, VCC, GND, DISPLAY,
-  DLATCH, JKLATCH, DFLIPFLOP, JKFLIPFLOP, SRFLIPFLOP, TFLIPFLOP, TLATCH, BOX, NODE, MUX, DEMUX,
-  BUZZER, DISPLAY14, LEDGRID
-};
-
-enum class ElementGroup {
-  UNKNOWN, OTHER, BOX, INPUT, GATE, MEMORY, OUTPUT, MUX, STATICINPUT
-};
-
-
-#define MAXIMUMVALIDINPUTSIZE 256
-
 class GraphicElement;
 
 typedef QVector< GraphicElement* > ElementVector;
@@ -110,6 +98,16 @@ public:
   virtual float getFrequency( ) const;
   virtual void setFrequency( float freq );
 
+  /**
+   * @brief getDelay returns the propagation delay set on this element, in
+   *        nanoseconds, or -1 when it uses the default delay of its type.
+   *        propagationDelay returns the delay the timed simulation applies.
+   */
+  int getDelay( ) const;
+  void setDelay( int delay );
+  uint32_t propagationDelay( );
+  bool hasDelay( );
+
   void setPixmap( const QString &pixmapName, QRect size = QRect( ) );
 
   bool rotatable( ) const;
@@ -162,6 +160,13 @@ public:
 
   void updateLabel( );
 
+signals:
+  /**
+   * @brief inputChanged is emitted by the input elements whenever their
+   *        value is set, so that a running simulation can pick it up.
+   */
+  void inputChanged( bool value );
+
 protected:
   void setRotatable( bool rotatable );
   void setHasLabel( bool hasLabel );
@@ -195,6 +200,7 @@ private:
   bool m_hasTrigger;
   bool m_hasAudio;
   bool m_disabled;
+  int m_delay;
   QString m_labelText;
   QKeySequence m_trigger;
 
@@ -209,6 +215,8 @@ private:
 
   void loadTrigger( QDataStream &ds, double version );
 
+  void loadDelay( QDataStream &ds, double version );
+
   void loadInputPorts( QDataStream &ds, QMap< quint64, QNEPort* > &portMap );
 
   void removePortFromMap( QNEPort *deletedPort, QMap< quint64, QNEPort* > &portMap );
@@ -0,0 +1,189 @@
+#include "logicanalyzer.h"
+#include "signalhistory.h"
+#include "simulationcontroller.h"
+
+#include <QFontMetrics>
+#include <QPainter>
+#include <QScrollBar>
+#include <QWheelEvent>
+#include <mutex>
+
+const quint64 LogicAnalyzer::MIN_SPAN = 100;
+const quint64 LogicAnalyzer::MAX_SPAN = 3600000000000ull;
+
+static QString formatTime( quint64 nanoseconds ) {
+  static const char *units[] = { "ns", "us", "ms", "s" };
+  double value = nanoseconds;
+  int unit = 0;
+  while( ( value >= 1000.0 ) && ( unit < 3 ) ) {
+    value /= 1000.0;
+    ++unit;
+  }
+  return( QString( "%1 %2" ).arg( value, 0, 'g', 4 ).arg( units[ unit ] ) );
+}
+
+LogicAnalyzer::LogicAnalyzer( SimulationController *controller, QWidget *parent ) : QAbstractScrollArea( parent ),
+  controller( controller ), m_span( 1000000000ull ) {
+  setHorizontalScrollBarPolicy( Qt::ScrollBarAlwaysOff );
+  setMinimumHeight( 4 * rowHeight( ) );
+  /* About 30 frames per second while visible. */
+  refreshTimer.setInterval( 33 );
+  connect( &refreshTimer, &QTimer::timeout, viewport( ), static_cast< void ( QWidget::* )( ) >( &QWidget::update ) );
+  connect( controller, &SimulationController::probesChanged, this, &LogicAnalyzer::updateProbes );
+  updateProbes( );
+}
+
+quint64 LogicAnalyzer::span( ) const {
+  return( m_span );
+}
+
+void LogicAnalyzer::setSpan( quint64 nanoseconds ) {
+  m_span = qBound( MIN_SPAN, nanoseconds, MAX_SPAN );
+  viewport( )->update( );
+}
+
+void LogicAnalyzer::updateProbes( ) {
+  names = controller->probeNames( );
+  updateScrollBar( );
+  viewport( )->update( );
+}
+
+int LogicAnalyzer::rowHeight( ) const {
+  return( fontMetrics( ).height( ) + 8 );
+}
+
+int LogicAnalyzer::nameWidth( ) const {
+  int width = fontMetrics( ).width( tr( "Time" ) );
+  for( const QString &name : names ) {
+    width = qMax( width, fontMetrics( ).width( name ) );
+  }
+  return( qMin( width, 200 ) + 12 );
+}
+
+void LogicAnalyzer::updateScrollBar( ) {
+  /* The first row is the time ruler, which does not scroll. */
+  const int visible = qMax( 1, viewport( )->height( ) / rowHeight( ) - 1 );
+  verticalScrollBar( )->setRange( 0, qMax( 0, names.size( ) - visible ) );
+  verticalScrollBar( )->setPageStep( visible );
+}
+
+void LogicAnalyzer::paintEvent( QPaintEvent* ) {
+  QPainter painter( viewport( ) );
+  const QPalette &pal = palette( );
+  painter.fillRect( viewport( )->rect( ), pal.color( QPalette::Base ) );
+
+  const int height = rowHeight( );
+  const int left = nameWidth( );
+  const int width = viewport( )->width( ) - left;
+  const int first = verticalScrollBar( )->value( );
+  const int count = qBound( 0, viewport( )->height( ) / height - 1, names.size( ) - first );
+  if( width <= 0 ) {
+    return;
+  }
+  const quint64 step = qMax< quint64 >( 1, m_span / static_cast< quint64 >( width ) );
+  quint64 end = 0;
+  quint64 from = 0;
+  rows.resize( static_cast< size_t >( count ) );
+  {
+    /* Only sampling holds the lock, drawing does not. */
+    std::lock_guard< std::mutex > lock( controller->historyMutex( ) );
+    const SignalHistory &history = controller->history( );
+    end = history.end( );
+    from = end > step * width ? end - step * width : 0;
+    for( int row = 0; row < count; ++row ) {
+      std::vector< signed char > &columns = rows[ static_cast< size_t >( row ) ];
+      columns.assign( static_cast< size_t >( width ), SignalHistory::UNKNOWN );
+      if( static_cast< size_t >( first + row ) < history.signalCount( ) ) {
+        history.sample( static_cast< uint32_t >( first + row ), from, step, columns );
+      }
+    }
+  }
+
+  painter.setPen( pal.color( QPalette::Text ) );
+  painter.drawText( QRect( 4, 0, left - 8, height ), Qt::AlignVCenter | Qt::AlignLeft, tr( "Time" ) );
+  painter.drawText( QRect( left, 0, width - 4, height ), Qt::AlignVCenter | Qt::AlignLeft, formatTime( from ) );
+  painter.drawText( QRect( left, 0, width - 4, height ), Qt::AlignVCenter | Qt::AlignRight, formatTime( end ) );
+  painter.drawText( QRect( left, 0, width, height ), Qt::AlignCenter, tr( "%1 / div" ).arg( formatTime( step * 100 ) ) );
+  painter.setPen( pal.color( QPalette::Mid ) );
+  for( int x = left + width - 1; x >= left; x -= 100 ) {
+    painter.drawLine( x, height, x, viewport( )->height( ) );
+  }
+  painter.drawLine( 0, height - 1, viewport( )->width( ), height - 1 );
+  painter.drawLine( left - 1, 0, left - 1, viewport( )->height( ) );
+
+  for( int row = 0; row < count; ++row ) {
+    const int y = height * ( row + 1 );
+    painter.setPen( pal.color( QPalette::Text ) );
+    painter.drawText( QRect( 4, y, left - 8, height ), Qt::AlignVCenter | Qt::AlignLeft,
+                      fontMetrics( ).elidedText( names[ first + row ], Qt::ElideLeft, left - 8 ) );
+    drawRow( painter, rows[ static_cast< size_t >( row ) ], left, y );
+  }
+}
+
+void LogicAnalyzer::drawRow( QPainter &painter, const std::vector< signed char > &columns, int x, int y ) {
+  const int high = y + 4;
+  const int low = y + rowHeight( ) - 4;
+  const QColor color = palette( ).color( QPalette::Highlight );
+  painter.setPen( color );
+  signed char previous = SignalHistory::UNKNOWN;
+  size_t start = 0;
+  /* Draws the columns with the same value as a single segment. */
+  for( size_t column = 0; column <= columns.size( ); ++column ) {
+    if( ( column < columns.size( ) ) && ( columns[ column ] == columns[ start ] ) ) {
+      continue;
+    }
+    const signed char value = columns[ start ];
+    const int x0 = x + static_cast< int >( start );
+    const int x1 = x + static_cast< int >( column ) - 1;
+    switch( value ) {
+        case 1:
+        painter.drawLine( x0, high, x1, high );
+        break;
+        case 0:
+        painter.drawLine( x0, low, x1, low );
+        break;
+        case -1:
+        painter.fillRect( QRect( QPoint( x0, high ), QPoint( x1, low ) ), QColor( 220, 50, 50, 128 ) );
+        break;
+        case SignalHistory::CHANGING:
+        painter.fillRect( QRect( QPoint( x0, high ), QPoint( x1, low ) ), color );
+        break;
+    }
+    if( ( ( previous == 0 ) || ( previous == 1 ) ) && ( ( value == 0 ) || ( value == 1 ) ) && ( previous != value ) ) {
+      painter.drawLine( x0, high, x0, low );
+    }
+    previous = value;
+    start = column;
+  }
+}
+
+void LogicAnalyzer::resizeEvent( QResizeEvent *event ) {
+  QAbstractScrollArea::resizeEvent( event );
+  updateScrollBar( );
+}
+
+void LogicAnalyzer::wheelEvent( QWheelEvent *event ) {
+  if( !( event->modifiers( ) & Qt::ControlModifier ) ) {
+    QAbstractScrollArea::wheelEvent( event );
+    return;
+  }
+  const int delta = event->angleDelta( ).y( );
+  if( delta > 0 ) {
+    setSpan( m_span / 2 );
+  }
+  else if( delta < 0 ) {
+    setSpan( m_span * 2 );
+  }
+  event->accept( );
+}
+
+void LogicAnalyzer::showEvent( QShowEvent *event ) {
+  QAbstractScrollArea::showEvent( event );
+  updateProbes( );
+  refreshTimer.start( );
+}
+
+void LogicAnalyzer::hideEvent( QHideEvent *event ) {
+  QAbstractScrollArea::hideEvent( event );
+  refreshTimer.stop( );
+}
@@ -0,0 +1,61 @@
+#ifndef LOGICANALYZER_H
+#define LOGICANALYZER_H
+
+#include <QAbstractScrollArea>
+#include <QStringList>
+#include <QTimer>
+#include <vector>
+
+class SimulationController;
+
+/**
+ * @brief The LogicAnalyzer class draws the history of the probes of a
+ *        SimulationController as waveforms ending at the latest simulated
+ *        time. Only the visible rows are drawn, each decimated to one value
+ *        per pixel column, so the cost of a frame does not depend on how
+ *        long the history is. Ctrl + wheel zooms in time.
+ */
+class LogicAnalyzer : public QAbstractScrollArea {
+  Q_OBJECT
+public:
+  explicit LogicAnalyzer( SimulationController *controller, QWidget *parent = nullptr );
+
+  /**
+   * @brief span is the simulated time shown across the view, in
+   *        nanoseconds.
+   */
+  quint64 span( ) const;
+  void setSpan( quint64 nanoseconds );
+
+  static const quint64 MIN_SPAN;
+  static const quint64 MAX_SPAN;
+
+public slots:
+  /**
+   * @brief updateProbes reads the probe names again, after
+   *        SimulationController::probesChanged( ).
+   */
+  void updateProbes( );
+
+protected:
+  void paintEvent( QPaintEvent *event ) override;
+  void resizeEvent( QResizeEvent *event ) override;
+  void wheelEvent( QWheelEvent *event ) override;
+  void showEvent( QShowEvent *event ) override;
+  void hideEvent( QHideEvent *event ) override;
+
+private:
+  SimulationController *controller;
+  QStringList names;
+  quint64 m_span;
+  QTimer refreshTimer;
+  /* One sampled row per visible probe, reused between frames. */
+  std::vector< std::vector< signed char > > rows;
+
+  int rowHeight( ) const;
+  int nameWidth( ) const;
+  void updateScrollBar( );
+  void drawRow( QPainter &painter, const std::vector< signed char > &columns, int x, int y );
+};
+
+#endif // LOGICANALYZER_H
@@ -6,8 +6,47 @@ bool LogicElement::isValid( ) const {
   return( m_isValid );
 }
 
+LogicOp LogicElement::op( ) const {
+  return( m_op );
+}
+
+size_t LogicElement::inputSize( ) const {
+  return( m_inputs.size( ) );
+}
+
+size_t LogicElement::outputSize( ) const {
+  return( m_outputs.size( ) );
+}
+
+LogicElement* LogicElement::predecessor( size_t index ) const {
+  return( m_inputs.at( index ).first );
+}
+
+int LogicElement::predecessorPort( size_t index ) const {
+  return( m_inputs.at( index ).second );
+}
+
+const QSet< LogicElement* > &LogicElement::sucessors( ) const {
+  return( m_sucessors );
+}
+
+int LogicElement::getPriority( ) const {
+  return( priority );
+}
+
+void LogicElement::setDelay( uint32_t delay ) {
+  m_delay = delay;
+}
+
+uint32_t LogicElement::getDelay( ) const {
+  return( m_delay );
+}
+
 void LogicElement::clearPredecessors( ) {
   for( auto &input: m_inputs ) {
+    if( input.first ) {
+      input.first->m_sucessors.remove( this );
+    }
     input.first = nullptr;
     input.second = 0;
   }
@@ -25,10 +64,28 @@ void LogicElement::clearSucessors( ) {
   m_sucessors.clear( );
 }
 
-LogicElement::LogicElement( size_t inputSize, size_t outputSize ) :
+void LogicElement::bypass( ) {
+  Q_ASSERT( ( m_inputs.size( ) == 1 ) && ( m_outputs.size( ) == 1 ) );
+  LogicElement *pred = m_inputs[ 0 ].first;
+  int port = m_inputs[ 0 ].second;
+  Q_ASSERT( pred );
+  pred->m_sucessors.remove( this );
+  for( LogicElement *elm : m_sucessors ) {
+    for( auto &input: elm->m_inputs ) {
+      if( input.first == this ) {
+        input = std::make_pair( pred, port );
+      }
+    }
+    pred->m_sucessors.insert( elm );
+  }
+  m_sucessors.clear( );
+}
+
+LogicElement::LogicElement( LogicOp op, size_t inputSize, size_t outputSize ) :
   m_isValid( true ),
-  beingVisited( false ),
+  m_op( op ),
   priority( -1 ),
+  m_delay( 0 ),
   m_inputs( inputSize, std::make_pair( nullptr, 0 ) ),
   m_inputvalues( inputSize, false ),
   m_outputs( outputSize, false ) {
@@ -78,22 +135,24 @@ bool LogicElement::operator<( const LogicElement &other ) {
   return( priority < other.priority );
 }
 
-int LogicElement::calculatePriority( ) {
-  if( beingVisited ) {
-    return( 0 );
-  }
-  if( priority != -1 ) {
-    return( priority );
-  }
-  beingVisited = true;
-  int max = 0;
-  for( LogicElement *s : m_sucessors ) {
-    max = qMax( s->calculatePriority( ), max );
+void LogicElement::setPriority( int value ) {
+  priority = value;
+}
+
+void LogicElement::invalidatePriority( ) {
+  std::vector< LogicElement* > stack( 1, this );
+  priority = -1;
+  while( !stack.empty( ) ) {
+    LogicElement *elm = stack.back( );
+    stack.pop_back( );
+    for( auto &input: elm->m_inputs ) {
+      LogicElement *pred = input.first;
+      if( pred && ( pred->priority != -1 ) ) {
+        pred->priority = -1;
+        stack.push_back( pred );
+      }
+    }
   }
-  int p = max + 1;
-  priority = p;
-  beingVisited = false;
-  return( p );
 }
 
 bool LogicElement::getOutputValue( size_t index ) const {
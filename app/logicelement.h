@@ -1,6 +1,8 @@
 #ifndef LOGICELEMENT_H
 #define LOGICELEMENT_H
 
+#include "simulation/logicop.h"
+
 #include <functional>
 #include <QSet>
 #include <vector>
@@ -14,18 +16,19 @@ class LogicElement {
    * @brief m_isValid is calculated at compilation time.
    */
   bool m_isValid;
-  bool beingVisited;
+  LogicOp m_op;
   int priority;
+  uint32_t m_delay;
   std::vector< std::pair< LogicElement*, int > > m_inputs;
-  std::vector< bool > m_inputvalues;
+  std::vector< uint8_t > m_inputvalues;
   std::vector< bool > m_outputs;
   QSet< LogicElement* > m_sucessors;
 
 
 protected:
-  virtual void _updateLogic( const std::vector< bool > &inputs ) = 0;
+  virtual void _updateLogic( const std::vector< uint8_t > &inputs ) = 0;
 public:
-  explicit LogicElement( size_t inputSize, size_t outputSize );
+  explicit LogicElement( LogicOp op, size_t inputSize, size_t outputSize );
 
   virtual ~LogicElement( );
 
@@ -40,14 +43,50 @@ public:
 
   bool operator<( const LogicElement &other );
 
-  int calculatePriority( );
+  /**
+   * @brief setPriority stores the priority computed by the levelizer of
+   *        ElementMapping::sort( ); -1 marks it as unknown.
+   */
+  void setPriority( int value );
+
+  /**
+   * @brief invalidatePriority clears the priority of this element and of
+   *        every element that reaches it, since the priority depends on the
+   *        successors. ElementMapping::sort( ) then recomputes only that cone.
+   */
+  void invalidatePriority( );
 
   bool isValid( ) const;
 
+  LogicOp op( ) const;
+
+  size_t inputSize( ) const;
+  size_t outputSize( ) const;
+
+  LogicElement* predecessor( size_t index ) const;
+  int predecessorPort( size_t index ) const;
+
+  const QSet< LogicElement* > &sucessors( ) const;
+
+  int getPriority( ) const;
+
+  /**
+   * @brief setDelay stores the propagation delay, in nanoseconds, that the
+   *        timed simulation gives to this element.
+   */
+  void setDelay( uint32_t delay );
+  uint32_t getDelay( ) const;
+
   void clearPredecessors( );
 
   void clearSucessors( );
 
+  /**
+   * @brief bypass connects the successors of a single input, single output
+   *        element straight to its predecessor, removing it from the graph.
+   */
+  void bypass( );
+
   void updateLogic( );
 };
 
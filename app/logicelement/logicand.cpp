@@ -1,13 +1,10 @@
 #include "logicand.h"
+#include "simulation/gatekernels.h"
 
-LogicAnd::LogicAnd( size_t inputSize )  : LogicElement( inputSize, 1 ) {
+LogicAnd::LogicAnd( size_t inputSize )  : LogicElement( LogicOp::AND, inputSize, 1 ) {
 
 }
 
-void LogicAnd::_updateLogic( const std::vector< bool > &inputs ) {
-  bool result = true;
-  for( bool in : inputs ) {
-    result &= in;
-  }
-  setOutputValue( result );
+void LogicAnd::_updateLogic( const std::vector< uint8_t > &inputs ) {
+  setOutputValue( GateKernels::reduceAnd( inputs.data( ), inputs.size( ) ) );
 }
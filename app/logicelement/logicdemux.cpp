@@ -1,10 +1,10 @@
 #include "logicdemux.h"
 
-LogicDemux::LogicDemux( ) : LogicElement( 2, 2 ) {
+LogicDemux::LogicDemux( ) : LogicElement( LogicOp::DEMUX, 2, 2 ) {
 
 }
 
-void LogicDemux::_updateLogic( const std::vector< bool > &inputs ) {
+void LogicDemux::_updateLogic( const std::vector< uint8_t > &inputs ) {
   bool data = inputs[ 0 ];
   bool choice = inputs[ 1 ];
 
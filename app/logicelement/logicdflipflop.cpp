@@ -1,14 +1,15 @@
 #include "logicdflipflop.h"
 
 LogicDFlipFlop::LogicDFlipFlop( ) :
-  LogicElement( 4, 2 ),
-  lastClk( false ) {
+  LogicElement( LogicOp::DFLIPFLOP, 4, 2 ),
+  lastClk( false ),
+  lastValue( false ) {
   setOutputValue( 0, false );
   setOutputValue( 1, true );
 
 }
 
-void LogicDFlipFlop::_updateLogic( const std::vector< bool > &inputs ) {
+void LogicDFlipFlop::_updateLogic( const std::vector< uint8_t > &inputs ) {
   bool q0 = getOutputValue( 0 );
   bool q1 = getOutputValue( 1 );
   bool D = inputs[ 0 ];
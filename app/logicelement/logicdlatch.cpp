@@ -1,12 +1,12 @@
 #include "logicdlatch.h"
 
 LogicDLatch::LogicDLatch( ) :
-  LogicElement( 2, 2 ) {
+  LogicElement( LogicOp::DLATCH, 2, 2 ) {
   setOutputValue( 0, false );
   setOutputValue( 1, true );
 }
 
-void LogicDLatch::_updateLogic( const std::vector< bool > &inputs ) {
+void LogicDLatch::_updateLogic( const std::vector< uint8_t > &inputs ) {
   bool q0 = getOutputValue( 0 );
   bool q1 = getOutputValue( 1 );
   bool D = inputs[ 0 ];
@@ -1,9 +1,9 @@
 #include "logicinput.h"
 
-LogicInput::LogicInput( bool defaultValue ) : LogicElement( 0, 1 ) {
+LogicInput::LogicInput( bool defaultValue ) : LogicElement( LogicOp::INPUT, 0, 1 ) {
   setOutputValue( 0, defaultValue );
 }
 
-void LogicInput::_updateLogic( const std::vector< bool > & ) {
+void LogicInput::_updateLogic( const std::vector< uint8_t > & ) {
   // Does nothing on update
 }
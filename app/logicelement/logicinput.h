@@ -10,7 +10,7 @@ public:
 
   /* LogicElement interface */
 protected:
-  virtual void _updateLogic( const std::vector< bool > & );
+  virtual void _updateLogic( const std::vector< uint8_t > & );
 };
 
 
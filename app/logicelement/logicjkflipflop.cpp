@@ -1,13 +1,15 @@
 #include "logicjkflipflop.h"
 
 LogicJKFlipFlop::LogicJKFlipFlop( ) :
-  LogicElement( 5, 2 ),
-  lastClk( false ) {
+  LogicElement( LogicOp::JKFLIPFLOP, 5, 2 ),
+  lastClk( false ),
+  lastJ( false ),
+  lastK( false ) {
   setOutputValue( 0, false );
   setOutputValue( 1, true );
 }
 
-void LogicJKFlipFlop::_updateLogic( const std::vector< bool > &inputs ) {
+void LogicJKFlipFlop::_updateLogic( const std::vector< uint8_t > &inputs ) {
   bool q0 = getOutputValue( 0 );
   bool q1 = getOutputValue( 1 );
   bool j = inputs[ 0 ];
@@ -1,10 +1,10 @@
 #include "logicmux.h"
 
-LogicMux::LogicMux( ) : LogicElement( 3, 1 ) {
+LogicMux::LogicMux( ) : LogicElement( LogicOp::MUX, 3, 1 ) {
 
 }
 
-void LogicMux::_updateLogic( const std::vector< bool > &inputs ) {
+void LogicMux::_updateLogic( const std::vector< uint8_t > &inputs ) {
   bool data1 = inputs[ 0 ];
   bool data2 = inputs[ 1 ];
   bool choice = inputs[ 2 ];
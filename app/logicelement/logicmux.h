@@ -9,7 +9,7 @@ public:
 
   /* LogicElement interface */
 protected:
-  virtual void _updateLogic( const std::vector< bool > &inputs );
+  virtual void _updateLogic( const std::vector< uint8_t > &inputs );
 };
 
 
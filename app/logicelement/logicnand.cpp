@@ -1,13 +1,10 @@
 #include "logicnand.h"
+#include "simulation/gatekernels.h"
 
-LogicNand::LogicNand( size_t inputSize )  : LogicElement( inputSize, 1 ) {
+LogicNand::LogicNand( size_t inputSize )  : LogicElement( LogicOp::NAND, inputSize, 1 ) {
 
 }
 
-void LogicNand::_updateLogic( const std::vector< bool > &inputs ) {
-  bool result = true;
-  for( bool in : inputs ) {
-    result &= in;
-  }
-  setOutputValue( !result );
+void LogicNand::_updateLogic( const std::vector< uint8_t > &inputs ) {
+  setOutputValue( !GateKernels::reduceAnd( inputs.data( ), inputs.size( ) ) );
 }
@@ -1,9 +1,9 @@
 #include "logicnode.h"
 
-LogicNode::LogicNode( ) : LogicElement( 1, 1 ) {
+LogicNode::LogicNode( ) : LogicElement( LogicOp::NODE, 1, 1 ) {
 
 }
 
-void LogicNode::_updateLogic( const std::vector< bool > &inputs ) {
+void LogicNode::_updateLogic( const std::vector< uint8_t > &inputs ) {
   setOutputValue( inputs[ 0 ] );
 }
@@ -1,13 +1,10 @@
 #include "logicnor.h"
+#include "simulation/gatekernels.h"
 
-LogicNor::LogicNor( size_t inputSize )  : LogicElement( inputSize, 1 ) {
+LogicNor::LogicNor( size_t inputSize )  : LogicElement( LogicOp::NOR, inputSize, 1 ) {
 
 }
 
-void LogicNor::_updateLogic( const std::vector< bool > &inputs ) {
-  bool result = false;
-  for( bool in : inputs ) {
-    result |= in;
-  }
-  setOutputValue( !result );
+void LogicNor::_updateLogic( const std::vector< uint8_t > &inputs ) {
+  setOutputValue( !GateKernels::reduceOr( inputs.data( ), inputs.size( ) ) );
 }
@@ -9,6 +9,6 @@ public:
 
   /* LogicElement interface */
 protected:
-  virtual void _updateLogic( const std::vector< bool > &inputs );
+  virtual void _updateLogic( const std::vector< uint8_t > &inputs );
 };
 #endif // LOGICNOR_H
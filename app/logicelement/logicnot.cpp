@@ -1,9 +1,9 @@
 #include "logicnot.h"
 
-LogicNot::LogicNot( ) : LogicElement( 1, 1 ) {
+LogicNot::LogicNot( ) : LogicElement( LogicOp::NOT, 1, 1 ) {
 
 }
 
-void LogicNot::_updateLogic( const std::vector< bool > &inputs ) {
+void LogicNot::_updateLogic( const std::vector< uint8_t > &inputs ) {
   setOutputValue( !inputs[ 0 ] );
 }
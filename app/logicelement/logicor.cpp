@@ -1,13 +1,10 @@
 #include "logicor.h"
+#include "simulation/gatekernels.h"
 
-LogicOr::LogicOr( size_t inputSize )  : LogicElement( inputSize, 1 ) {
+LogicOr::LogicOr( size_t inputSize )  : LogicElement( LogicOp::OR, inputSize, 1 ) {
 
 }
 
-void LogicOr::_updateLogic( const std::vector< bool > &inputs ) {
-  bool result = false;
-  for( bool in : inputs ) {
-    result |= in;
-  }
-  setOutputValue( result );
+void LogicOr::_updateLogic( const std::vector< uint8_t > &inputs ) {
+  setOutputValue( GateKernels::reduceOr( inputs.data( ), inputs.size( ) ) );
 }
@@ -1,10 +1,10 @@
 #include "logicoutput.h"
 
-LogicOutput::LogicOutput( size_t inputSz ) : LogicElement( inputSz, inputSz ) {
+LogicOutput::LogicOutput( size_t inputSz ) : LogicElement( LogicOp::OUTPUT, inputSz, inputSz ) {
 
 }
 
-void LogicOutput::_updateLogic( const std::vector< bool > &inputs ) {
+void LogicOutput::_updateLogic( const std::vector< uint8_t > &inputs ) {
   for( size_t idx = 0; idx < inputs.size( ); ++idx ) {
     setOutputValue( idx, inputs[ idx ] );
   }
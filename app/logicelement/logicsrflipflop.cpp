@@ -1,13 +1,13 @@
 #include "logicsrflipflop.h"
 
 LogicSRFlipFlop::LogicSRFlipFlop( ) :
-  LogicElement( 5, 2 ),
+  LogicElement( LogicOp::SRFLIPFLOP, 5, 2 ),
   lastClk( false ) {
   setOutputValue( 0, false );
   setOutputValue( 1, true );
 }
 
-void LogicSRFlipFlop::_updateLogic( const std::vector< bool > &inputs ) {
+void LogicSRFlipFlop::_updateLogic( const std::vector< uint8_t > &inputs ) {
   bool q0 = getOutputValue( 0 );
   bool q1 = getOutputValue( 1 );
   bool s = inputs[ 0 ];
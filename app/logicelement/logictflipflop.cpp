@@ -1,13 +1,14 @@
 #include "logictflipflop.h"
 
 LogicTFlipFlop::LogicTFlipFlop( ) :
-  LogicElement( 4, 2 ),
-  lastClk( false ) {
+  LogicElement( LogicOp::TFLIPFLOP, 4, 2 ),
+  lastClk( false ),
+  lastValue( false ) {
   setOutputValue( 0, false );
   setOutputValue( 1, true );
 }
 
-void LogicTFlipFlop::_updateLogic( const std::vector< bool > &inputs ) {
+void LogicTFlipFlop::_updateLogic( const std::vector< uint8_t > &inputs ) {
   bool q0 = getOutputValue( 0 );
   bool q1 = getOutputValue( 1 );
   bool T = inputs[ 0 ];
@@ -1,13 +1,10 @@
 #include "logicxnor.h"
+#include "simulation/gatekernels.h"
 
-LogicXnor::LogicXnor( size_t inputSize )  : LogicElement( inputSize, 1 ) {
+LogicXnor::LogicXnor( size_t inputSize )  : LogicElement( LogicOp::XNOR, inputSize, 1 ) {
 
 }
 
-void LogicXnor::_updateLogic( const std::vector< bool > &inputs ) {
-  bool result = false;
-  for( bool in : inputs ) {
-    result ^= in;
-  }
-  setOutputValue( !result );
+void LogicXnor::_updateLogic( const std::vector< uint8_t > &inputs ) {
+  setOutputValue( !GateKernels::reduceXor( inputs.data( ), inputs.size( ) ) );
 }
@@ -1,13 +1,10 @@
 #include "logicxor.h"
+#include "simulation/gatekernels.h"
 
-LogicXor::LogicXor( size_t inputSize )  : LogicElement( inputSize, 1 ) {
+LogicXor::LogicXor( size_t inputSize )  : LogicElement( LogicOp::XOR, inputSize, 1 ) {
 
 }
 
-void LogicXor::_updateLogic( const std::vector< bool > &inputs ) {
-  bool result = false;
-  for( bool in : inputs ) {
-    result ^= in;
-  }
-  setOutputValue( result );
+void LogicXor::_updateLogic( const std::vector< uint8_t > &inputs ) {
+  setOutputValue( GateKernels::reduceXor( inputs.data( ), inputs.size( ) ) );
 }
@@ -1,9 +1,208 @@
+#include "batchsimulation.h"
+#include "circuitengine.h"
+#include "circuitloader.h"
+#include "equivalencechecker.h"
 #include "mainwindow.h"
+#include "truthtablewriter.h"
+#include "vcdwriter.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QFile>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+/* Writes the truth table of the inputs and outputs of engine, named as in the batch simulation output. */
+static bool writeTruthTable( CircuitEngine &engine, const QString &fileName, bool binary ) {
+  TruthTableWriter writer( engine.getNetlist( ) );
+  const std::vector< CircuitPin > &inputs = engine.inputs( );
+  for( size_t input = 0; input < inputs.size( ); ++input ) {
+    writer.addInput( inputs[ input ].label.isEmpty( ) ? QString( "in%1" ).arg( input ) : inputs[ input ].label,
+                     inputs[ input ].signals[ 0 ] );
+  }
+  const std::vector< CircuitPin > &outputs = engine.outputs( );
+  for( size_t output = 0; output < outputs.size( ); ++output ) {
+    const QString name = outputs[ output ].label.isEmpty( ) ? QString( "out%1" ).arg( output ) : outputs[ output ].label;
+    if( !engine.isValid( static_cast< int >( output ) ) ) {
+      throw std::runtime_error( "Output " + name.toStdString( ) + " is not connected." );
+    }
+    const size_t ports = outputs[ output ].signals.size( );
+    for( size_t port = 0; port < ports; ++port ) {
+      writer.addOutput( ports == 1 ? name : QString( "%1[%2]" ).arg( name ).arg( port ), outputs[ output ].signals[ port ] );
+    }
+  }
+  writer.setFormat( binary ? TruthTableWriter::Format::BINARY : TruthTableWriter::Format::TEXT );
+  QFile file( fileName );
+  if( !file.open( QFile::WriteOnly ) ) {
+    throw std::runtime_error( "Could not open " + fileName.toStdString( ) + " for writing." );
+  }
+  return( writer.write( file ) );
+}
+
+/* Compares two circuits, see EquivalenceChecker. Returns 0 when they are equivalent, 2 when they differ, and 3 when
+ * neither could be shown. */
+static int checkEquivalence( const QString &firstFile, const QString &secondFile ) {
+  CircuitLoader loader;
+  std::shared_ptr< const CircuitModel > firstCircuit = loader.loadFile( firstFile );
+  std::shared_ptr< const CircuitModel > secondCircuit = loader.loadFile( secondFile );
+  CircuitEngine first( *firstCircuit );
+  CircuitEngine second( *secondCircuit );
+  EquivalenceChecker checker( first, second );
+  QTextStream out( stdout );
+  switch( checker.check( ) ) {
+      case EquivalenceChecker::Verdict::EQUIVALENT:
+      out << "equivalent\n";
+      return( 0 );
+      case EquivalenceChecker::Verdict::DIFFERENT: {
+      out << "different\n";
+      QStringList values;
+      for( int input = 0; input < checker.inputNames( ).size( ); ++input ) {
+        values.append( QString( "%1=%2" ).arg( checker.inputNames( )[ input ] )
+                       .arg( checker.counterexample( )[ static_cast< size_t >( input ) ] ? 1 : 0 ) );
+      }
+      out << "inputs: " << values.join( ' ' ) << "\n";
+      out << "outputs: " << checker.differingOutputs( ).join( ' ' ) << "\n";
+      return( 2 );
+    }
+      default:
+      out << "unknown: " << checker.reason( ) << "\n";
+      return( 3 );
+  }
+}
+
+/* Simulates a circuit without creating any window, see BatchSimulation. Returns 1 on errors, and 2 when the --until
+ * condition is never met. */
+static int runHeadless( int argc, char *argv[] ) {
+  QCoreApplication a( argc, argv );
+  a.setOrganizationName( "WPanda" );
+  a.setApplicationName( "WiredPanda" );
+  a.setApplicationVersion( APP_VERSION );
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription( a.applicationName( ) );
+  parser.addHelpOption( );
+  parser.addVersionOption( );
+  parser.addPositionalArgument( "file", QCoreApplication::translate( "main", "Circuit file to simulate." ) );
+
+  QCommandLineOption headlessOption( "headless", QCoreApplication::translate( "main", "Simulate without any window." ) );
+  parser.addOption( headlessOption );
+
+  QCommandLineOption stimulusOption( QStringList( ) << "s" << "stimulus",
+                                     QCoreApplication::translate( "main", "Read the input values from <stimulus>" ),
+                                     QCoreApplication::translate( "main", "stimulus file" ) );
+  parser.addOption( stimulusOption );
+
+  QCommandLineOption cyclesOption( QStringList( ) << "n" << "cycles",
+                                   QCoreApplication::translate( "main", "Simulate at most <cycles> ticks" ),
+                                   QCoreApplication::translate( "main", "cycles" ), "100" );
+  parser.addOption( cyclesOption );
+
+  QCommandLineOption untilOption( "until",
+                                  QCoreApplication::translate( "main", "Stop once the output <label> reads <value>" ),
+                                  QCoreApplication::translate( "main", "label=value" ) );
+  parser.addOption( untilOption );
+
+  QCommandLineOption outputOption( QStringList( ) << "o" << "output",
+                                   QCoreApplication::translate( "main", "Write the values to <output> text file" ),
+                                   QCoreApplication::translate( "main", "output file" ) );
+  parser.addOption( outputOption );
+
+  QCommandLineOption vcdOption( "vcd",
+                                QCoreApplication::translate( "main", "Record every signal to <vcd> Value Change Dump" ),
+                                QCoreApplication::translate( "main", "vcd file" ) );
+  parser.addOption( vcdOption );
+
+  QCommandLineOption truthTableOption( "truth-table",
+                                       QCoreApplication::translate( "main",
+                                                                    "Write the truth table of the circuit to <table> instead of simulating it" ),
+                                       QCoreApplication::translate( "main", "table file" ) );
+  parser.addOption( truthTableOption );
+
+  QCommandLineOption binaryOption( "binary",
+                                   QCoreApplication::translate( "main", "Write the truth table in the binary format" ) );
+  parser.addOption( binaryOption );
+
+  QCommandLineOption equivOption( "equiv",
+                                  QCoreApplication::translate( "main",
+                                                               "Check whether two combinational circuits are equivalent, "
+                                                               "matching their inputs and outputs by label" ) );
+  parser.addOption( equivOption );
+
+  parser.process( a );
+
+  QStringList args = parser.positionalArguments( );
+  if( args.size( ) != ( parser.isSet( equivOption ) ? 2 : 1 ) ) {
+    parser.showHelp( 1 );
+  }
+  try {
+    if( parser.isSet( equivOption ) ) {
+      return( checkEquivalence( args[ 0 ], args[ 1 ] ) );
+    }
+    CircuitLoader loader;
+    std::shared_ptr< const CircuitModel > circuit = loader.loadFile( args[ 0 ] );
+    CircuitEngine engine( *circuit );
+    if( parser.isSet( truthTableOption ) ) {
+      if( !writeTruthTable( engine, parser.value( truthTableOption ), parser.isSet( binaryOption ) ) ) {
+        throw std::runtime_error( "Could not write " + parser.value( truthTableOption ).toStdString( ) + "." );
+      }
+      return( 0 );
+    }
+    BatchSimulation batch( engine );
+    if( parser.isSet( stimulusOption ) ) {
+      QFile stimulusFile( parser.value( stimulusOption ) );
+      if( !stimulusFile.open( QFile::ReadOnly | QFile::Text ) ) {
+        throw std::runtime_error( "Could not open " + stimulusFile.fileName( ).toStdString( ) + "." );
+      }
+      QTextStream in( &stimulusFile );
+      batch.readStimulus( in );
+    }
+    if( parser.isSet( untilOption ) ) {
+      const QStringList condition = parser.value( untilOption ).split( '=' );
+      if( ( condition.size( ) != 2 ) || ( ( condition[ 1 ] != "0" ) && ( condition[ 1 ] != "1" ) ) ) {
+        throw std::runtime_error( "Invalid condition, expected <label>=0 or <label>=1." );
+      }
+      batch.setUntil( condition[ 0 ], condition[ 1 ] == "1" );
+    }
+    VcdWriter vcd;
+    if( parser.isSet( vcdOption ) ) {
+      batch.setRecorder( &vcd );
+      if( !vcd.open( parser.value( vcdOption ) ) ) {
+        throw std::runtime_error( "Could not open " + parser.value( vcdOption ).toStdString( ) + " for writing." );
+      }
+    }
+    bool ok;
+    const quint64 cycles = parser.value( cyclesOption ).toULongLong( &ok );
+    if( !ok ) {
+      throw std::runtime_error( "Invalid number of cycles." );
+    }
+    QFile outFile;
+    if( parser.isSet( outputOption ) ) {
+      outFile.setFileName( parser.value( outputOption ) );
+      ok = outFile.open( QFile::WriteOnly | QFile::Text );
+    }
+    else {
+      ok = outFile.open( stdout, QFile::WriteOnly | QFile::Text );
+    }
+    if( !ok ) {
+      throw std::runtime_error( "Could not open " + outFile.fileName( ).toStdString( ) + " for writing." );
+    }
+    QTextStream out( &outFile );
+    return( batch.run( cycles, out ) ? 0 : 2 );
+  }
+  catch( std::runtime_error &e ) {
+    std::cerr << e.what( ) << std::endl;
+    return( 1 );
+  }
+}
 
 int main( int argc, char *argv[] ) {
+  /* QApplication needs a display, so the headless modes are picked before it is created. */
+  for( int arg = 1; arg < argc; ++arg ) {
+    if( ( std::strcmp( argv[ arg ], "--headless" ) == 0 ) || ( std::strcmp( argv[ arg ], "--equiv" ) == 0 ) ) {
+      return( runHeadless( argc, argv ) );
+    }
+  }
   QApplication a( argc, argv );
   a.setOrganizationName( "WPanda" );
   a.setApplicationName( "WiredPanda" );
@@ -26,6 +225,16 @@ int main( int argc, char *argv[] ) {
                                          QCoreApplication::translate( "main", "waveform text file" ) );
   parser.addOption( waveformFileOption );
 
+  QCommandLineOption headlessOption( "headless",
+                                     QCoreApplication::translate( "main",
+                                                                  "Simulate <file> without any window, see --headless --help." ) );
+  parser.addOption( headlessOption );
+
+  QCommandLineOption equivOption( "equiv",
+                                  QCoreApplication::translate( "main",
+                                                               "Compare two circuits without any window, see --headless --help." ) );
+  parser.addOption( equivOption );
+
   parser.process( a );
 
 
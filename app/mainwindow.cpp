@@ -1,18 +1,29 @@
 #include "arduino/codegenerator.h"
+#include "box.h"
+#include "circuitengine.h"
+#include "circuitloader.h"
+#include "elementinfo.h"
 #include "elementmapping.h"
 #include "globalproperties.h"
 #include "graphicsviewzoom.h"
 #include "listitemwidget.h"
+#include "logicanalyzer.h"
 #include "mainwindow.h"
 #include "simplewaveform.h"
+#include "simulationcontroller.h"
+#include "simulationworker.h"
 #include "thememanager.h"
+#include "truthtabledialog.h"
 #include "ui_mainwindow.h"
 
 #include <QDebug>
+#include <QDockWidget>
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QKeyEvent>
 #include <QMessageBox>
 #include <QPrinter>
+#include <QProgressDialog>
 #include <QRectF>
 #include <QSaveFile>
 #include <QSettings>
@@ -24,7 +35,8 @@
 #include <stdexcept>
 
 
-MainWindow::MainWindow( QWidget *parent ) : QMainWindow( parent ), ui( new Ui::MainWindow ), undoView( nullptr ) {
+MainWindow::MainWindow( QWidget *parent ) : QMainWindow( parent ), ui( new Ui::MainWindow ), undoView( nullptr ),
+  untimedBackend( SimulationBackend::INTERPRETED ) {
   COMMENT( "WIRED PANDA Version = " << APP_VERSION << " OR " << GlobalProperties::version, 0 );
   ui->setupUi( this );
   ThemeManager::globalMngr = new ThemeManager( this );
@@ -61,6 +73,57 @@ MainWindow::MainWindow( QWidget *parent ) : QMainWindow( parent ), ui( new Ui::M
   }
   themeGroup->setExclusive( true );
 
+  /* SIMULATION SPEED */
+  QActionGroup *speedGroup = new QActionGroup( this );
+  for( QAction *action : ui->menuSpeed->actions( ) ) {
+    speedGroup->addAction( action );
+  }
+  speedGroup->setExclusive( true );
+  simulationStatistics = new QLabel( this );
+  ui->statusBar->addPermanentWidget( simulationStatistics );
+  connect( editor->getSimulationController( ), &SimulationController::statisticsUpdated, this,
+           &MainWindow::updateStatistics );
+  connect( editor->getSimulationController( ), &SimulationController::recordingStopped, this, [ this ]( ) {
+    ui->actionRecord_VCD->setChecked( false );
+  } );
+
+  /* LOGIC ANALYZER */
+  logicAnalyzer = new LogicAnalyzer( editor->getSimulationController( ), this );
+  analyzerDock = new QDockWidget( tr( "Logic Analyzer" ), this );
+  analyzerDock->setObjectName( "logicAnalyzerDock" );
+  analyzerDock->setWidget( logicAnalyzer );
+  addDockWidget( Qt::BottomDockWidgetArea, analyzerDock );
+  analyzerDock->hide( );
+  ui->menuView->addSeparator( );
+  ui->menuView->addAction( analyzerDock->toggleViewAction( ) );
+  if( settings.value( "historyMemory" ).isValid( ) ) {
+    editor->getSimulationController( )->setHistoryMemory( settings.value( "historyMemory" ).toULongLong( ) << 20 );
+  }
+  if( settings.value( "tickRate" ).isValid( ) ) {
+    setTickRate( settings.value( "tickRate" ).toUInt( ) );
+  }
+
+  /* PROPAGATION DELAYS */
+  QActionGroup *delayGroup = new QActionGroup( this );
+  for( QAction *action : ui->menuDelays->actions( ) ) {
+    delayGroup->addAction( action );
+  }
+  delayGroup->setExclusive( true );
+  settings.beginGroup( "defaultDelays" );
+  for( const QString &key : settings.childKeys( ) ) {
+    ElementType type = ElementFactory::textToType( key );
+    if( type != ElementType::UNKNOWN ) {
+      ElementInfo::setDefaultDelay( type, settings.value( key ).toUInt( ) );
+    }
+  }
+  settings.endGroup( );
+  if( settings.value( "propagationDelays" ).toString( ) == "inertial" ) {
+    setPropagationDelays( true, DelayModel::INERTIAL );
+  }
+  else if( settings.value( "propagationDelays" ).toString( ) == "transport" ) {
+    setPropagationDelays( true, DelayModel::TRANSPORT );
+  }
+
   connect( ThemeManager::globalMngr, &ThemeManager::themeChanged, this, &MainWindow::updateTheme );
   connect( ThemeManager::globalMngr, &ThemeManager::themeChanged, editor, &Editor::updateTheme );
   ThemeManager::globalMngr->initialize( );
@@ -101,6 +164,7 @@ MainWindow::MainWindow( QWidget *parent ) : QMainWindow( parent ), ui( new Ui::M
   connect( ui->graphicsView->gvzoom( ), &GraphicsViewZoom::zoomed, this, &MainWindow::zoomChanged );
   connect( editor, &Editor::scroll, this, &MainWindow::scrollView );
   connect( editor, &Editor::circuitHasChanged, this, &MainWindow::autoSave );
+  connect( editor, &Editor::circuitPatched, this, &MainWindow::autoSave );
 
   rfController = new RecentFilesController( "recentFileList", this );
   rboxController = new RecentFilesController( "recentBoxes", this );
@@ -710,6 +774,51 @@ void MainWindow::on_actionExport_to_Image_triggered( ) {
   img.save( pngFile );
 }
 
+void MainWindow::on_actionExport_Truth_Table_triggered( ) {
+  QString selectedFilter;
+  const QString textFilter = tr( "Truth table text files (*.txt)" );
+  const QString binaryFilter = tr( "Binary truth table files (*.wptt)" );
+  QString fname = QFileDialog::getSaveFileName( this, tr( "Export Truth Table" ), defaultDirectory.absolutePath( ),
+                                                textFilter + ";;" + binaryFilter, &selectedFilter );
+  if( fname.isEmpty( ) ) {
+    return;
+  }
+  const bool binary = ( selectedFilter == binaryFilter ) || fname.endsWith( ".wptt" );
+  if( !fname.endsWith( binary ? ".wptt" : ".txt" ) ) {
+    fname.append( binary ? ".wptt" : ".txt" );
+  }
+  QSaveFile file( fname );
+  if( !file.open( QFile::WriteOnly ) ) {
+    QMessageBox::warning( this, tr( "Error!" ), tr( "Could not open file in WriteOnly mode : %1." ).arg( fname ) );
+    return;
+  }
+  QProgressDialog progressDialog( tr( "Exporting the truth table..." ), tr( "Cancel" ), 0, 1000, this );
+  progressDialog.setWindowModality( Qt::WindowModal );
+  progressDialog.setMinimumDuration( 500 );
+  try {
+    const bool ok = SimpleWaveform::saveTruthTable( file, editor,
+                                                    binary ? TruthTableWriter::Format::BINARY :
+                                                    TruthTableWriter::Format::TEXT,
+                                                    [ &progressDialog ]( uint64_t rows, uint64_t total ) {
+      progressDialog.setValue( static_cast< int >( rows * 1000 / total ) );
+      return( !progressDialog.wasCanceled( ) );
+    } );
+    if( !ok ) {
+      file.cancelWriting( );
+      if( !progressDialog.wasCanceled( ) ) {
+        QMessageBox::warning( this, tr( "Error!" ), tr( "Could not export the truth table to %1." ).arg( fname ) );
+      }
+      return;
+    }
+    file.commit( );
+  }
+  catch( std::runtime_error &e ) {
+    file.cancelWriting( );
+    QMessageBox::warning( this, tr( "Error" ), tr(
+                            "<strong>Error while exporting the truth table:</strong><br>%1" ).arg( e.what( ) ) );
+  }
+}
+
 void MainWindow::retranslateUi( ) {
   ui->retranslateUi( this );
   ui->widgetElementEditor->retranslateUi( );
@@ -817,6 +926,30 @@ void MainWindow::on_actionWaveform_triggered( ) {
   wf.showWaveform( );
 }
 
+void MainWindow::on_actionTruth_Table_triggered( ) {
+  try {
+    std::unique_ptr< CircuitBdd > bdd;
+    const QVector< GraphicElement* > selected = editor->getScene( )->selectedElements( );
+    Box *box = selected.size( ) == 1 ? dynamic_cast< Box* >( selected.first( ) ) : nullptr;
+    if( box ) {
+      /* A selected box is read from its file, as the batch simulation does. */
+      CircuitLoader loader;
+      std::shared_ptr< const CircuitModel > circuit = loader.loadFile( box->getFile( ) );
+      CircuitEngine engine( *circuit );
+      bdd.reset( new CircuitBdd( engine ) );
+    }
+    else {
+      bdd = SimpleWaveform::buildCircuitBdd( editor );
+    }
+    TruthTableDialog dialog( std::move( bdd ), this );
+    dialog.exec( );
+  }
+  catch( std::runtime_error &e ) {
+    QMessageBox::warning( this, tr( "Error" ), tr( "<strong>Error while building the truth table:</strong><br>%1" )
+                          .arg( e.what( ) ) );
+  }
+}
+
 void MainWindow::on_actionPanda_Light_triggered( ) {
   ThemeManager::globalMngr->setTheme( Theme::Panda_Light );
 }
@@ -895,3 +1028,134 @@ void MainWindow::autoSave( ) {
 void MainWindow::on_actionMute_triggered( ) {
   editor->mute( ui->actionMute->isChecked( ) );
 }
+
+void MainWindow::on_actionReal_Time_triggered( ) {
+  setTickRate( SimulationWorker::REAL_TIME_RATE );
+}
+
+void MainWindow::on_actionSpeed_10x_triggered( ) {
+  setTickRate( 10 * SimulationWorker::REAL_TIME_RATE );
+}
+
+void MainWindow::on_actionSpeed_100x_triggered( ) {
+  setTickRate( 100 * SimulationWorker::REAL_TIME_RATE );
+}
+
+void MainWindow::on_actionMaximum_Speed_triggered( ) {
+  setTickRate( 0 );
+}
+
+void MainWindow::setTickRate( uint ticksPerSecond ) {
+  editor->getSimulationController( )->setTickRate( ticksPerSecond );
+  switch( ticksPerSecond ) {
+      case 0:
+      ui->actionMaximum_Speed->setChecked( true );
+      break;
+      case 10 * SimulationWorker::REAL_TIME_RATE:
+      ui->actionSpeed_10x->setChecked( true );
+      break;
+      case 100 * SimulationWorker::REAL_TIME_RATE:
+      ui->actionSpeed_100x->setChecked( true );
+      break;
+      default:
+      ui->actionReal_Time->setChecked( true );
+      break;
+  }
+  QSettings settings( QSettings::IniFormat, QSettings::UserScope,
+                      QApplication::organizationName( ), QApplication::applicationName( ) );
+  settings.setValue( "tickRate", ticksPerSecond );
+}
+
+void MainWindow::on_actionZero_Delay_triggered( ) {
+  setPropagationDelays( false );
+}
+
+void MainWindow::on_actionInertial_Delays_triggered( ) {
+  setPropagationDelays( true, DelayModel::INERTIAL );
+}
+
+void MainWindow::on_actionTransport_Delays_triggered( ) {
+  setPropagationDelays( true, DelayModel::TRANSPORT );
+}
+
+void MainWindow::setPropagationDelays( bool enabled, DelayModel model ) {
+  SimulationController *sc = editor->getSimulationController( );
+  sc->setDelayModel( model );
+  if( sc->backend( ) != SimulationBackend::TIMED ) {
+    untimedBackend = sc->backend( );
+  }
+  sc->setBackend( enabled ? SimulationBackend::TIMED : untimedBackend );
+  QString mode( "none" );
+  if( !enabled ) {
+    ui->actionZero_Delay->setChecked( true );
+  }
+  else if( model == DelayModel::TRANSPORT ) {
+    ui->actionTransport_Delays->setChecked( true );
+    mode = "transport";
+  }
+  else {
+    ui->actionInertial_Delays->setChecked( true );
+    mode = "inertial";
+  }
+  QSettings settings( QSettings::IniFormat, QSettings::UserScope,
+                      QApplication::organizationName( ), QApplication::applicationName( ) );
+  settings.setValue( "propagationDelays", mode );
+}
+
+void MainWindow::on_actionRecord_VCD_triggered( bool checked ) {
+  SimulationController *sc = editor->getSimulationController( );
+  if( !checked ) {
+    sc->stopRecording( );
+    return;
+  }
+  QString fname = QFileDialog::getSaveFileName( this, tr( "Record Waveform" ), defaultDirectory.absolutePath( ),
+                                                tr( "Value Change Dump (*.vcd)" ) );
+  if( !fname.isEmpty( ) && !fname.endsWith( ".vcd" ) ) {
+    fname.append( ".vcd" );
+  }
+  if( fname.isEmpty( ) || !sc->startRecording( fname ) ) {
+    ui->actionRecord_VCD->setChecked( false );
+    if( !fname.isEmpty( ) ) {
+      QMessageBox::warning( this, tr( "Error!" ), tr( "Could not record to \"%1\"." ).arg(
+                              fname ), QMessageBox::Ok, QMessageBox::NoButton );
+    }
+  }
+}
+
+void MainWindow::on_actionProbe_Selection_triggered( ) {
+  editor->getSimulationController( )->addProbes( editor->getScene( )->selectedItems( ) );
+  analyzerDock->show( );
+  analyzerDock->raise( );
+}
+
+void MainWindow::on_actionClear_Probes_triggered( ) {
+  editor->getSimulationController( )->clearProbes( );
+}
+
+void MainWindow::on_actionHistory_Memory_triggered( ) {
+  SimulationController *sc = editor->getSimulationController( );
+  bool ok = false;
+  int mebibytes = QInputDialog::getInt( this, tr( "History Memory" ), tr( "Memory for the probe history (MiB):" ),
+                                        static_cast< int >( sc->history( ).memoryCap( ) >> 20 ), 1, 4096, 1, &ok );
+  if( !ok ) {
+    return;
+  }
+  sc->setHistoryMemory( static_cast< size_t >( mebibytes ) << 20 );
+  QSettings settings( QSettings::IniFormat, QSettings::UserScope,
+                      QApplication::organizationName( ), QApplication::applicationName( ) );
+  settings.setValue( "historyMemory", mebibytes );
+}
+
+void MainWindow::updateStatistics( double ticksPerSecond, double evaluationsPerSecond, double speed ) {
+  if( !editor->getSimulationController( )->isRunning( ) ) {
+    simulationStatistics->clear( );
+    return;
+  }
+  QString text = tr( "%1 ticks/s, %2 gate evaluations/s (%3x real time)" ).arg( ticksPerSecond, 0, 'f', 0 )
+                 .arg( evaluationsPerSecond, 0, 'g', 3 ).arg( speed, 0, 'g', 3 );
+  const uint eliminated = editor->getSimulationController( )->eliminatedGates( );
+  if( eliminated > 0 ) {
+    text += tr( ", %1 gates optimized away" ).arg( eliminated );
+  }
+  simulationStatistics->setText( text );
+}
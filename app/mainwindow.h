@@ -8,11 +8,13 @@
 #include "listitemwidget.h"
 #include "recentfilescontroller.h"
 #include "scene.h"
+#include "simulation/simulationbackend.h"
 
 #include <QDialog>
 #include <QDir>
 #include <QFileInfo>
 #include <QGraphicsScene>
+#include <QLabel>
 #include <QMainWindow>
 #include <QSpacerItem>
 #include <QTemporaryFile>
@@ -23,6 +25,9 @@ namespace Ui {
   class MainWindow;
 }
 
+class LogicAnalyzer;
+class QDockWidget;
+
 class MainWindow : public QMainWindow {
   Q_OBJECT
 
@@ -64,6 +69,7 @@ public:
 private slots:
   bool on_actionExport_to_Arduino_triggered( );
   void on_actionExport_to_Image_triggered( );
+  void on_actionExport_Truth_Table_triggered( );
   void on_actionPrint_triggered( );
 
   void on_actionAbout_Qt_triggered( );
@@ -105,6 +111,8 @@ private slots:
 
   void on_actionWaveform_triggered( );
 
+  void on_actionTruth_Table_triggered( );
+
   void on_actionPanda_Light_triggered( );
 
   void on_actionPanda_Dark_triggered( );
@@ -121,6 +129,30 @@ private slots:
 
   void on_actionMute_triggered( );
 
+  void on_actionReal_Time_triggered( );
+
+  void on_actionSpeed_10x_triggered( );
+
+  void on_actionSpeed_100x_triggered( );
+
+  void on_actionMaximum_Speed_triggered( );
+
+  void on_actionZero_Delay_triggered( );
+
+  void on_actionInertial_Delays_triggered( );
+
+  void on_actionTransport_Delays_triggered( );
+
+  void on_actionRecord_VCD_triggered( bool checked );
+
+  void on_actionProbe_Selection_triggered( );
+
+  void on_actionClear_Probes_triggered( );
+
+  void on_actionHistory_Memory_triggered( );
+
+  void updateStatistics( double ticksPerSecond, double evaluationsPerSecond, double speed );
+
 private:
   Ui::MainWindow *ui;
   Editor *editor;
@@ -128,6 +160,9 @@ private:
   QDir defaultDirectory;
   QUndoView *undoView;
   Label *firstResult;
+  QLabel *simulationStatistics;
+  LogicAnalyzer *logicAnalyzer;
+  QDockWidget *analyzerDock;
 
   QTemporaryFile autosaveFile;
 
@@ -137,8 +172,12 @@ private:
   QAction *recentFileActs[ RecentFilesController::MaxRecentFiles ];
   QTranslator *translator;
   QVector< ListItemWidget* > boxItemWidgets, searchItemWidgets;
+  /* The backend restored when propagation delays are turned off. */
+  SimulationBackend untimedBackend;
   void createRecentFileActions( );
   void populateLeftMenu( );
+  void setTickRate( uint ticksPerSecond );
+  void setPropagationDelays( bool enabled, DelayModel model = DelayModel::INERTIAL );
   /* QWidget interface */
 protected:
   void closeEvent( QCloseEvent *e );
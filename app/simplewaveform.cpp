@@ -1,7 +1,10 @@
 #include "simplewaveform.h"
 #include "ui_simplewaveform.h"
 
+#include "globalproperties.h"
 #include "input.h"
+#include "simulation/bitparallelsimulator.h"
+#include "simulation/compiledsimulation.h"
 
 #include <cmath>
 #include <QBuffer>
@@ -15,6 +18,8 @@
 #include <QSettings>
 /* #include <QSvgGenerator> */
 #include <bitset>
+#include <memory>
+#include <stdexcept>
 #include <QValueAxis>
 
 using namespace QtCharts;
@@ -41,6 +46,107 @@ public:
   }
 };
 
+/* Compiles a circuit without memory or feedback, and finds the signals of its inputs and of the output ports, from
+ * the last port of each output to the first. Returns false for any other circuit. */
+static bool compileCombinational( ElementMapping &mapping, const QVector< GraphicElement* > &inputs,
+                                  const QVector< GraphicElement* > &outputs,
+                                  std::unique_ptr< CompiledSimulation > &compiled,
+                                  QVector< uint32_t > &inputSignals, QVector< uint32_t > &outputSignals ) {
+  if( !mapping.canInitialize( ) ) {
+    return( false );
+  }
+  mapping.initialize( );
+  mapping.sort( );
+  mapping.flatten( );
+  if( !mapping.canRun( ) ) {
+    return( false );
+  }
+  compiled.reset( new CompiledSimulation( &mapping ) );
+  if( !compiled->getNetlist( ).isCombinational( ) ) {
+    return( false );
+  }
+  for( GraphicElement *in : inputs ) {
+    LogicElement *elm = mapping.getLogicElement( in );
+    if( !elm || !compiled->contains( elm ) ) {
+      return( false );
+    }
+    inputSignals.append( compiled->outputSignal( elm ) );
+  }
+  for( GraphicElement *out : outputs ) {
+    LogicElement *elm = mapping.getLogicElement( out );
+    if( !elm || !compiled->contains( elm ) || !compiled->isValid( elm ) ) {
+      return( false );
+    }
+    for( int port = out->inputSize( ) - 1; port >= 0; --port ) {
+      outputSignals.append( compiled->inputSignal( elm, static_cast< size_t >( port ) ) );
+    }
+  }
+  return( true );
+}
+
+/* Evaluates all the input combinations 64 at a time on a private netlist. Only circuits without memory or feedback
+ * can be evaluated like this, since their outputs do not depend on the order of the input vectors. */
+static bool bitParallelResults( const QVector< GraphicElement* > &elements, const QVector< GraphicElement* > &inputs,
+                                const QVector< GraphicElement* > &outputs, QVector< QVector< uchar > > &results ) {
+  ElementMapping mapping( elements, GlobalProperties::currentFile );
+  std::unique_ptr< CompiledSimulation > compiled;
+  QVector< uint32_t > inputSignals;
+  QVector< uint32_t > outputSignals;
+  if( !compileCombinational( mapping, inputs, outputs, compiled, inputSignals, outputSignals ) ) {
+    return( false );
+  }
+  const Netlist &netlist = compiled->getNetlist( );
+  BitParallelSimulator simulator( netlist );
+  const int num_iter = results.isEmpty( ) ? 0 : results.first( ).size( );
+  for( int base = 0; base < num_iter; base += BitParallelSimulator::LANES ) {
+    for( int in = 0; in < inputSignals.size( ); ++in ) {
+      simulator.setInput( inputSignals[ in ], BitParallelSimulator::counterLanes( static_cast< uint64_t >( base ), in ) );
+    }
+    simulator.run( );
+    const int lanes = qMin( BitParallelSimulator::LANES, num_iter - base );
+    for( int out = 0; out < outputSignals.size( ); ++out ) {
+      uint64_t value = simulator.value( outputSignals[ out ] );
+      for( int lane = 0; lane < lanes; ++lane ) {
+        results[ out ][ base + lane ] = static_cast< uchar >( ( value >> lane ) & 1 );
+      }
+    }
+  }
+  return( true );
+}
+
+/* Fills results[ output port ][ iteration ] with the output values for every combination of the inputs. */
+static void simulateResults( SimulationController *sc, const QVector< GraphicElement* > &elements,
+                             const QVector< GraphicElement* > &inputs, const QVector< GraphicElement* > &outputs,
+                             QVector< QVector< uchar > > &results ) {
+  if( bitParallelResults( elements, inputs, outputs, results ) ) {
+    return;
+  }
+  // Sequential circuits are simulated one vector at a time, in order, with the main window simulator.
+  const int num_iter = results.isEmpty( ) ? 0 : results.first( ).size( );
+  for( int itr = 0; itr < num_iter; ++itr ) {
+    // For each iteration, set a distinct value for the inputs. The value is the bit values corresponding to the number
+    // of current iteration.
+    std::bitset< std::numeric_limits< unsigned int >::digits > bs( itr );
+    for( int in = 0; in < inputs.size( ); ++in ) {
+      uchar val = bs[ in ];
+      dynamic_cast< Input* >( inputs[ in ] )->setOn( val );
+    }
+    // Updating the values of the circuit logic based on current input values.
+    sc->update( );
+    sc->updateAll( );
+    // Setting the computed output values to the waveform results vector.
+    int counter = 0;
+    for( int out = 0; out < outputs.size( ); ++out ) {
+      int inSz = outputs[ out ]->inputSize( );
+      for( int port = inSz - 1; port >= 0; --port ) {
+        uchar val = outputs[ out ]->input( port )->value( );
+        results[ counter ][ itr ] = val;
+        counter++;
+      }
+    }
+  }
+}
+
 SimpleWaveform::SimpleWaveform( Editor *editor, QWidget *parent ) : QDialog( parent ), ui( new Ui::SimpleWaveform ),
   editor( editor ) {
   ui->setupUi( this );
@@ -162,28 +268,7 @@ bool SimpleWaveform::saveToTxt( QTextStream &outStream, Editor *editor ) {
   }
   // Creating vector results with the output resulting values.
   QVector< QVector< uchar > > results( outputCount, QVector< uchar >( num_iter ) );
-  for( int itr = 0; itr < num_iter; ++itr ) {
-    // For each iteration, set a distinct value for the inputs. The value is the bit values corresponding to the number
-    // of current iteration.
-    std::bitset< std::numeric_limits< unsigned int >::digits > bs( itr );
-    for( int in = 0; in < inputs.size( ); ++in ) {
-      uchar val = bs[ in ];
-      dynamic_cast< Input* >( inputs[ in ] )->setOn( val );
-    }
-    // Updating the values of the circuit logic based on current input values.
-    sc->update( );
-    sc->updateAll( );
-    // Setting the computed output values to the waveform results vector.
-    int counter = 0;
-    for( int out = 0; out < outputs.size( ); ++out ) {
-      int inSz = outputs[ out ]->inputSize( );
-      for( int port = inSz - 1; port >= 0; --port ) {
-        uchar val = outputs[ out ]->input( port )->value( );
-        results[ counter ][ itr ] = val;
-        counter++;
-      }
-    }
-  }
+  simulateResults( sc, elements, inputs, outputs, results );
   // Writing the input values at each iteration to the output stream.
   for( int in = 0; in < inputs.size( ); ++in ) {
     QString label = inputs[ in ]->getLabel( );
@@ -222,6 +307,89 @@ bool SimpleWaveform::saveToTxt( QTextStream &outStream, Editor *editor ) {
   return( true );
 }
 
+bool SimpleWaveform::saveTruthTable( QIODevice &device, Editor *editor, TruthTableWriter::Format format,
+                                     const TruthTableWriter::ProgressFunction &progress ) {
+  QVector< GraphicElement* > elements = editor->getScene( )->getElements( );
+  QVector< GraphicElement* > inputs;
+  QVector< GraphicElement* > outputs;
+  sortElements( elements, inputs, outputs, SortingKind::POSITION );
+  if( elements.isEmpty( ) || inputs.isEmpty( ) || outputs.isEmpty( ) ) {
+    return( false );
+  }
+  SCStop scst( editor->getSimulationController( ) );
+  ElementMapping mapping( elements, GlobalProperties::currentFile );
+  std::unique_ptr< CompiledSimulation > compiled;
+  QVector< uint32_t > inputSignals;
+  QVector< uint32_t > outputSignals;
+  if( !compileCombinational( mapping, inputs, outputs, compiled, inputSignals, outputSignals ) ) {
+    throw std::runtime_error( tr( "The truth table needs a circuit without memory elements or feedback loops, "
+                                  "with all of its outputs connected." ).toStdString( ) );
+  }
+  TruthTableWriter writer( compiled->getNetlist( ) );
+  for( int in = 0; in < inputs.size( ); ++in ) {
+    QString label = inputs[ in ]->getLabel( );
+    if( label.isEmpty( ) ) {
+      label = ElementFactory::translatedName( inputs[ in ]->elementType( ) );
+    }
+    writer.addInput( label, inputSignals[ in ] );
+  }
+  int counter = 0;
+  for( GraphicElement *out : outputs ) {
+    QString label = out->getLabel( );
+    if( label.isEmpty( ) ) {
+      label = ElementFactory::translatedName( out->elementType( ) );
+    }
+    for( int port = out->inputSize( ) - 1; port >= 0; --port ) {
+      writer.addOutput( out->inputSize( ) > 1 ? QString( "%1[%2]" ).arg( label ).arg( port ) : label,
+                        outputSignals[ counter++ ] );
+    }
+  }
+  writer.setFormat( format );
+  writer.setProgress( progress );
+  return( writer.write( device ) );
+}
+
+std::unique_ptr< CircuitBdd > SimpleWaveform::buildCircuitBdd( Editor *editor ) {
+  QVector< GraphicElement* > elements = editor->getScene( )->getElements( );
+  QVector< GraphicElement* > inputs;
+  QVector< GraphicElement* > outputs;
+  sortElements( elements, inputs, outputs, SortingKind::POSITION );
+  if( elements.isEmpty( ) || inputs.isEmpty( ) || outputs.isEmpty( ) ) {
+    throw std::runtime_error( tr( "The circuit needs at least one input and one output." ).toStdString( ) );
+  }
+  SCStop scst( editor->getSimulationController( ) );
+  ElementMapping mapping( elements, GlobalProperties::currentFile );
+  std::unique_ptr< CompiledSimulation > compiled;
+  QVector< uint32_t > inputSignals;
+  QVector< uint32_t > outputSignals;
+  if( !compileCombinational( mapping, inputs, outputs, compiled, inputSignals, outputSignals ) ) {
+    throw std::runtime_error( tr( "The truth table needs a circuit without memory elements or feedback loops, "
+                                  "with all of its outputs connected." ).toStdString( ) );
+  }
+  std::unique_ptr< CircuitBdd > bdd( new CircuitBdd( compiled->getNetlist( ), inputSignals.toStdVector( ),
+                                                     outputSignals.toStdVector( ) ) );
+  QStringList inputNames;
+  for( GraphicElement *in : inputs ) {
+    QString label = in->getLabel( );
+    if( label.isEmpty( ) ) {
+      label = ElementFactory::translatedName( in->elementType( ) );
+    }
+    inputNames.append( label );
+  }
+  QStringList outputNames;
+  for( GraphicElement *out : outputs ) {
+    QString label = out->getLabel( );
+    if( label.isEmpty( ) ) {
+      label = ElementFactory::translatedName( out->elementType( ) );
+    }
+    for( int port = out->inputSize( ) - 1; port >= 0; --port ) {
+      outputNames.append( out->inputSize( ) > 1 ? QString( "%1[%2]" ).arg( label ).arg( port ) : label );
+    }
+  }
+  bdd->setNames( inputNames, outputNames );
+  return( bdd );
+}
+
 void SimpleWaveform::showWaveform( ) {
   QSettings settings( QSettings::IniFormat, QSettings::UserScope,
                       QApplication::organizationName( ), QApplication::applicationName( ) );
@@ -271,7 +439,8 @@ void SimpleWaveform::showWaveform( ) {
     return;
   }
   if( inputs.size( ) > 8 ) {
-    QMessageBox::warning( parentWidget( ), tr( "Error" ), tr( "The simulation is limited to 8 inputs." ) );
+    QMessageBox::warning( parentWidget( ), tr( "Error" ),
+                          tr( "The waveform is limited to 8 inputs. Use File > Export Truth Table for larger circuits." ) );
     return;
   }
   QVector< QLineSeries* > in_series;
@@ -316,33 +485,23 @@ void SimpleWaveform::showWaveform( ) {
   //qDebug( ) << "Num iter = " << num_iter;
 /*  gap += outputs.size( ) % 2; */
   // Running simulation.
+  QVector< QVector< uchar > > results( out_series.size( ), QVector< uchar >( num_iter ) );
+  simulateResults( sc, elements, inputs, outputs, results );
   for( int itr = 0; itr < num_iter; ++itr ) {
-    // For each iteration, set a distinct value for the inputs. The value is the bit values corresponding to the number
-    // of current iteration.
+    // For each iteration, the inputs hold the bit values corresponding to the number of current iteration.
     std::bitset< std::numeric_limits< unsigned int >::digits > bs( itr );
-    //qDebug( ) << itr;
     for( int in = 0; in < inputs.size( ); ++in ) {
       float val = bs[ in ];
-      dynamic_cast< Input* >( inputs[ in ] )->setOn( not qFuzzyIsNull( val ) );
       float offset = ( in_series.size( ) - in - 1 + out_series.size( ) ) * 2 + gap + 0.5;
       in_series[ in ]->append( itr, static_cast< qreal >( offset + val ) );
       in_series[ in ]->append( itr + 1, static_cast< qreal >( offset + val ) );
     }
-    // Updating the values of the circuit logic based on current input values.
-    sc->update( );
-    sc->updateAll( );
     // Setting the computed output values to the waveform results.
-    int counter = 0;
-    for( int out = 0; out < outputs.size( ); ++out ) {
-      int inSz = outputs[ out ]->inputSize( );
-      for( int port = inSz - 1; port >= 0; --port ) {
-        float val = outputs[ out ]->input( port )->value( ) > 0;
-        float offset = ( out_series.size( ) - counter - 1 ) * 2 + 0.5;
-        out_series[ counter ]->append( itr, static_cast< qreal >( offset + val ) );
-        out_series[ counter ]->append( itr + 1, static_cast< qreal >( offset + val ) );
-/*        cout << counter << " " << out; */
-        counter++;
-      }
+    for( int counter = 0; counter < out_series.size( ); ++counter ) {
+      float val = results[ counter ][ itr ] == 1;
+      float offset = ( out_series.size( ) - counter - 1 ) * 2 + 0.5;
+      out_series[ counter ]->append( itr, static_cast< qreal >( offset + val ) );
+      out_series[ counter ]->append( itr + 1, static_cast< qreal >( offset + val ) );
     }
   }
   // Inserting input series to the chart
@@ -1,12 +1,15 @@
 #ifndef SIMPLEWAVEFORM_H
 #define SIMPLEWAVEFORM_H
 
+#include "circuitbdd.h"
 #include "editor.h"
+#include "truthtablewriter.h"
 
 #include <QChart>
 #include <QChartView>
 #include <QDialog>
 #include <QTextStream>
+#include <memory>
 
 namespace Ui {
   class SimpleWaveform;
@@ -25,6 +28,19 @@ public:
                             QVector< GraphicElement* > &outputs, SortingKind sorting );
 
   static bool saveToTxt( QTextStream &outStream, Editor *editor );
+  /**
+   * @brief saveTruthTable streams the truth table of the circuit to device,
+   *        see TruthTableWriter, without holding it in memory. It throws a
+   *        std::runtime_error for circuits with memory or feedback.
+   */
+  static bool saveTruthTable( QIODevice &device, Editor *editor, TruthTableWriter::Format format,
+                              const TruthTableWriter::ProgressFunction &progress = TruthTableWriter::ProgressFunction( ) );
+  /**
+   * @brief buildCircuitBdd builds the BDDs of the outputs of the circuit,
+   *        named and ordered as in the truth table. It throws a
+   *        std::runtime_error for circuits with memory or feedback.
+   */
+  static std::unique_ptr< CircuitBdd > buildCircuitBdd( Editor *editor );
 private slots:
   void on_radioButton_Position_clicked( );
 
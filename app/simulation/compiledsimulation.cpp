@@ -0,0 +1,323 @@
+#include "compiledsimulation.h"
+#include "elementmapping.h"
+#include "simulation/nativecompiler.h"
+#include "simulation/netlistoptimizer.h"
+#include "simulation/netlistsimulator.h"
+#include "simulation/timedsimulator.h"
+
+#include <numeric>
+#include <utility>
+
+const uint32_t CompiledSimulation::DEFAULT_PARALLEL_THRESHOLD;
+
+CompiledSimulation::CompiledSimulation( ElementMapping *mapping, SimulationBackend backend,
+                                        uint32_t parallelThreshold, DelayModel delayModel, bool optimize ) :
+  mapping( mapping ),
+  backend( backend ),
+  parallelThreshold( parallelThreshold ),
+  delayModel( delayModel ),
+  iterationLimit( Netlist::DEFAULT_ITERATION_LIMIT ),
+  optimizeNetlist( optimize ),
+  m_eliminatedGates( 0 ),
+  simulator( nullptr ),
+  timed( nullptr ),
+  native( nullptr ),
+  constantGate( -1 ) {
+  compile( );
+}
+
+CompiledSimulation::~CompiledSimulation( ) {
+  /* The native simulator calls into the library owned by the native compiler. */
+  delete simulator;
+  delete native;
+}
+
+void CompiledSimulation::compile( ) {
+  if( lower( ) ) {
+    optimize( );
+    createSimulator( );
+  }
+}
+
+void CompiledSimulation::recompile( const QSet< LogicElement* > &created ) {
+  if( !simulator ) {
+    compile( );
+    return;
+  }
+  /* The values of the lowered netlist: those of the signals and gates that were simulated, and the initial values of
+   * the removed ones. */
+  const std::vector< uint8_t > signals = simulator->values( );
+  const std::vector< uint8_t > state = simulator->stateValues( );
+  std::vector< uint8_t > values( lowered.initialValues );
+  std::vector< uint8_t > stateValues( lowered.initialState );
+  for( uint32_t signal = 0; signal < lowered.signalCount( ); ++signal ) {
+    if( signalMap[ signal ] != NetlistOptimizer::NONE ) {
+      values[ signal ] = signals[ signalMap[ signal ] ];
+    }
+  }
+  for( uint32_t gate = 0; gate < lowered.gateCount( ); ++gate ) {
+    if( gateMap[ gate ] != NetlistOptimizer::NONE ) {
+      for( uint32_t slot = 0; slot < Netlist::stateSize( netlist.ops[ gateMap[ gate ] ] ); ++slot ) {
+        stateValues[ lowered.stateBegin[ gate ] + slot ] = state[ netlist.stateBegin[ gateMap[ gate ] ] + slot ];
+      }
+    }
+  }
+  delete simulator;
+  simulator = nullptr;
+  timed = nullptr;
+  Netlist previous;
+  std::swap( previous, lowered );
+  QHash< LogicElement*, uint32_t > previousIndex;
+  previousIndex.swap( gateIndex );
+  if( !lower( ) ) {
+    return;
+  }
+  /* Removed elements may be deleted by now, so their addresses are only compared. A created element may reuse one
+   * of these addresses, which is why created elements are skipped. */
+  for( auto iter = gateIndex.constBegin( ); iter != gateIndex.constEnd( ); ++iter ) {
+    auto old = previousIndex.constFind( iter.key( ) );
+    if( ( old == previousIndex.constEnd( ) ) || created.contains( iter.key( ) ) ) {
+      continue;
+    }
+    const uint32_t gate = iter.value( );
+    const uint32_t oldGate = old.value( );
+    if( ( lowered.ops[ gate ] != previous.ops[ oldGate ] ) ||
+        ( lowered.outputSize( gate ) != previous.outputSize( oldGate ) ) ) {
+      continue;
+    }
+    for( uint32_t port = 0; port < lowered.outputSize( gate ); ++port ) {
+      lowered.initialValues[ lowered.outputSignal( gate, port ) ] = values[ previous.outputSignal( oldGate, port ) ];
+    }
+    for( uint32_t slot = 0; slot < Netlist::stateSize( lowered.ops[ gate ] ); ++slot ) {
+      lowered.initialState[ lowered.stateBegin[ gate ] + slot ] = stateValues[ previous.stateBegin[ oldGate ] + slot ];
+    }
+  }
+  optimize( );
+  createSimulator( true );
+}
+
+bool CompiledSimulation::lower( ) {
+  delete simulator;
+  simulator = nullptr;
+  timed = nullptr;
+  delete native;
+  native = nullptr;
+  lowered.clear( );
+  netlist.clear( );
+  signalMap.clear( );
+  gateMap.clear( );
+  m_eliminatedGates = 0;
+  gateIndex.clear( );
+  inputs.clear( );
+  constantGate = -1;
+  if( !mapping->canRun( ) ) {
+    return( false );
+  }
+  /* Gates keep the order of the sorted logic elements. */
+  for( LogicElement *elm : mapping->logicElms ) {
+    insertGate( elm );
+  }
+  const int count = mapping->logicElms.size( );
+  for( int gate = 0; gate < count; ++gate ) {
+    LogicElement *elm = mapping->logicElms[ gate ];
+    for( size_t idx = 0; idx < elm->inputSize( ); ++idx ) {
+      uint32_t signal = signalOf( elm->predecessor( idx ), elm->predecessorPort( idx ) );
+      lowered.setFanin( static_cast< uint32_t >( gate ), static_cast< uint32_t >( idx ), signal );
+    }
+  }
+  for( auto iter = mapping->inputMap.begin( ); iter != mapping->inputMap.end( ); ++iter ) {
+    inputs.append( qMakePair( iter.key( ), lowered.outputSignal( gateIndex[ iter.value( ) ] ) ) );
+  }
+  lowered.finalize( );
+  return( true );
+}
+
+void CompiledSimulation::optimize( ) {
+  if( !optimizeNetlist ) {
+    netlist = lowered;
+    signalMap.resize( lowered.signalCount( ) );
+    std::iota( signalMap.begin( ), signalMap.end( ), 0 );
+    gateMap.resize( lowered.gateCount( ) );
+    std::iota( gateMap.begin( ), gateMap.end( ), 0 );
+    return;
+  }
+  NetlistOptimizer optimizer( lowered );
+  for( const auto &input : inputs ) {
+    optimizer.addInput( lowered.drivers[ input.second ] );
+  }
+  /* The UI reads the ports of the elements of the scene and of the boxes. */
+  for( LogicElement *elm : mapping->map ) {
+    auto iter = gateIndex.constFind( elm );
+    if( iter != gateIndex.constEnd( ) ) {
+      optimizer.keep( iter.value( ) );
+    }
+  }
+  for( const LogicPort &port : mapping->boxPorts ) {
+    auto iter = gateIndex.constFind( port.first );
+    if( iter != gateIndex.constEnd( ) ) {
+      optimizer.keep( iter.value( ) );
+    }
+  }
+  optimizer.setPreserveTiming( backend == SimulationBackend::TIMED );
+  optimizer.optimize( netlist );
+  signalMap = optimizer.signalMap( );
+  gateMap = optimizer.gateMap( );
+  m_eliminatedGates = optimizer.eliminatedGates( );
+  for( auto &input : inputs ) {
+    input.second = signalMap[ input.second ];
+  }
+}
+
+void CompiledSimulation::createSimulator( bool edited ) {
+  /* Building a native library blocks for seconds, far too long for every edit, so the native backend interprets an
+   * edited circuit until it is compiled again. */
+  const SimulationBackend used = ( edited && ( backend == SimulationBackend::NATIVE ) ) ? SimulationBackend::COMPILED :
+                                 backend;
+  simulator = SimulatorFactory::create( netlist, used, parallelThreshold, delayModel, native );
+  timed = dynamic_cast< TimedSimulator* >( simulator );
+  simulator->setIterationLimit( iterationLimit );
+}
+
+uint32_t CompiledSimulation::insertGate( LogicElement *elm ) {
+  uint32_t gate = lowered.addGate( elm->op( ),
+                                   static_cast< uint32_t >( elm->inputSize( ) ),
+                                   static_cast< uint32_t >( elm->outputSize( ) ) );
+  gateIndex.insert( elm, gate );
+  lowered.setValid( gate, elm->isValid( ) );
+  lowered.setLevel( gate, elm->getPriority( ) );
+  lowered.setDelay( gate, elm->getDelay( ) );
+  for( size_t port = 0; port < elm->outputSize( ); ++port ) {
+    lowered.setInitialValue( lowered.outputSignal( gate, static_cast< uint32_t >( port ) ), elm->getOutputValue( port ) );
+  }
+  return( gate );
+}
+
+uint32_t CompiledSimulation::signalOf( LogicElement *pred, int port ) {
+  if( !pred ) {
+    /* Unconnected inputs only appear in invalid gates, which are never evaluated. */
+    if( constantGate < 0 ) {
+      constantGate = static_cast< int >( lowered.addGate( LogicOp::INPUT, 0, 1 ) );
+    }
+    return( lowered.outputSignal( static_cast< uint32_t >( constantGate ) ) );
+  }
+  auto iter = gateIndex.constFind( pred );
+  if( iter == gateIndex.constEnd( ) ) {
+    /* Global VCC and GND elements are not part of the sorted list. */
+    Q_ASSERT( pred->inputSize( ) == 0 );
+    return( lowered.outputSignal( insertGate( pred ), static_cast< uint32_t >( port ) ) );
+  }
+  return( lowered.outputSignal( iter.value( ), static_cast< uint32_t >( port ) ) );
+}
+
+void CompiledSimulation::update( ) {
+  if( mapping->canRun( ) && simulator ) {
+    mapping->updateClocks( );
+    for( const auto &input : inputs ) {
+      simulator->setInput( input.second, input.first->getOn( ) );
+    }
+    simulator->run( );
+  }
+}
+
+void CompiledSimulation::setInput( LogicElement *elm, bool value ) {
+  auto iter = gateIndex.constFind( elm );
+  if( simulator && ( iter != gateIndex.constEnd( ) ) ) {
+    const uint32_t signal = signalMap[ lowered.outputSignal( iter.value( ) ) ];
+    if( signal != NetlistOptimizer::NONE ) {
+      simulator->setInput( signal, value );
+    }
+  }
+}
+
+void CompiledSimulation::run( ) {
+  if( mapping->canRun( ) && simulator ) {
+    simulator->run( );
+  }
+}
+
+bool CompiledSimulation::isTimed( ) const {
+  return( timed != nullptr );
+}
+
+void CompiledSimulation::advanceTo( uint64_t time ) {
+  if( mapping->canRun( ) && timed ) {
+    timed->advanceTo( time );
+  }
+}
+
+uint64_t CompiledSimulation::nextEvent( ) const {
+  return( timed ? timed->nextEvent( ) : TimedSimulator::NEVER );
+}
+
+void CompiledSimulation::setIterationLimit( uint32_t limit ) {
+  iterationLimit = limit;
+  if( simulator ) {
+    simulator->setIterationLimit( limit );
+  }
+}
+
+bool CompiledSimulation::isValid( LogicElement *elm ) const {
+  auto iter = gateIndex.constFind( elm );
+  if( iter == gateIndex.constEnd( ) ) {
+    return( false );
+  }
+  const uint32_t gate = iter.value( );
+  if( !lowered.valid[ gate ] || !simulator ) {
+    return( lowered.valid[ gate ] );
+  }
+  /* A removed gate oscillates along with the gate that now drives its output. */
+  uint32_t simulated = gateMap[ gate ];
+  if( ( simulated == NetlistOptimizer::NONE ) && ( lowered.outputSize( gate ) > 0 ) ) {
+    const uint32_t signal = signalMap[ lowered.outputSignal( gate ) ];
+    if( signal != NetlistOptimizer::NONE ) {
+      simulated = netlist.drivers[ signal ];
+    }
+  }
+  return( ( simulated == NetlistOptimizer::NONE ) || !simulator->isOscillating( simulated ) );
+}
+
+bool CompiledSimulation::isSettled( ) const {
+  return( !simulator || simulator->isSettled( ) );
+}
+
+bool CompiledSimulation::getOutputValue( LogicElement *elm, size_t port ) const {
+  const uint32_t signal = outputSignal( elm, port );
+  return( ( signal != NetlistOptimizer::NONE ) && simulator->value( signal ) );
+}
+
+bool CompiledSimulation::getInputValue( LogicElement *elm, size_t port ) const {
+  const uint32_t signal = inputSignal( elm, port );
+  return( ( signal != NetlistOptimizer::NONE ) && simulator->value( signal ) );
+}
+
+const Netlist &CompiledSimulation::getNetlist( ) const {
+  return( netlist );
+}
+
+uint32_t CompiledSimulation::eliminatedGates( ) const {
+  return( m_eliminatedGates );
+}
+
+bool CompiledSimulation::contains( LogicElement *elm ) const {
+  return( gateIndex.contains( elm ) );
+}
+
+uint32_t CompiledSimulation::outputSignal( LogicElement *elm, size_t port ) const {
+  auto iter = gateIndex.constFind( elm );
+  if( iter == gateIndex.constEnd( ) ) {
+    return( NetlistOptimizer::NONE );
+  }
+  return( signalMap[ lowered.outputSignal( iter.value( ), static_cast< uint32_t >( port ) ) ] );
+}
+
+uint32_t CompiledSimulation::inputSignal( LogicElement *elm, size_t port ) const {
+  auto iter = gateIndex.constFind( elm );
+  if( iter == gateIndex.constEnd( ) ) {
+    return( NetlistOptimizer::NONE );
+  }
+  return( signalMap[ lowered.fanin( iter.value( ), static_cast< uint32_t >( port ) ) ] );
+}
+
+uint64_t CompiledSimulation::lastEvaluationCount( ) const {
+  return( simulator ? simulator->lastEvaluationCount( ) : 0 );
+}
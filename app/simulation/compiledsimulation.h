@@ -0,0 +1,152 @@
+#ifndef COMPILEDSIMULATION_H
+#define COMPILEDSIMULATION_H
+
+#include "simulation/netlist.h"
+#include "simulation/simulationbackend.h"
+#include "simulation/simulatorfactory.h"
+
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <QVector>
+
+class ElementMapping;
+class Input;
+class LogicElement;
+class NativeCompiler;
+class NetlistSimulator;
+class TimedSimulator;
+
+/**
+ * @brief The CompiledSimulation class lowers an initialized and sorted
+ *        ElementMapping into a flat Netlist and evaluates it with a
+ *        NetlistSimulator, producing the same results as the LogicElement
+ *        graph. The LogicElements are still used as keys, so that the UI can
+ *        query the value of any port.
+ *
+ *        The lowered netlist is then reduced by a NetlistOptimizer. Only the
+ *        logic elements of the scene and of the box ports are sure to keep
+ *        their signals, which may be aliases of other wires or constants.
+ */
+class CompiledSimulation {
+public:
+  /**
+   * @brief DEFAULT_PARALLEL_THRESHOLD is the gate count from which the
+   *        compiled backend evaluates the netlist over several threads.
+   */
+  static const uint32_t DEFAULT_PARALLEL_THRESHOLD = SimulatorFactory::DEFAULT_PARALLEL_THRESHOLD;
+
+  explicit CompiledSimulation( ElementMapping *mapping, SimulationBackend backend = SimulationBackend::COMPILED,
+                               uint32_t parallelThreshold = DEFAULT_PARALLEL_THRESHOLD,
+                               DelayModel delayModel = DelayModel::INERTIAL, bool optimize = true );
+  ~CompiledSimulation( );
+
+  void compile( );
+
+  /**
+   * @brief recompile lowers the mapping again after ElementMapping::applyDelta( ).
+   *        Every gate that is not in created keeps its output values and the
+   *        state of its sequential logic. The native backend falls back to
+   *        the netlist interpreter until the next compile( ).
+   */
+  void recompile( const QSet< LogicElement* > &created );
+
+  void update( );
+
+  /**
+   * @brief setInput and run evaluate a tick without reading the input
+   *        elements of the scene: the value of each input element is set
+   *        through its logic element beforehand.
+   */
+  void setInput( LogicElement *elm, bool value );
+  void run( );
+
+  /**
+   * @brief isTimed returns true for the TIMED backend, whose simulator runs
+   *        in simulated time: advanceTo( ) applies the events due until then,
+   *        in nanoseconds, and nextEvent( ) returns when the next one is due,
+   *        or UINT64_MAX. run( ) advances by one GLOBALCLK tick.
+   */
+  bool isTimed( ) const;
+  void advanceTo( uint64_t time );
+  uint64_t nextEvent( ) const;
+
+  /**
+   * @brief setIterationLimit sets how many times, at most, a feedback loop
+   *        is evaluated within one tick, see NetlistSimulator.
+   */
+  void setIterationLimit( uint32_t limit );
+
+  /**
+   * @brief isValid returns false for invalid elements, for elements that
+   *        are not simulated, and for elements of a feedback loop that did
+   *        not settle in the last tick.
+   */
+  bool isValid( LogicElement *elm ) const;
+  /**
+   * @brief isSettled returns false while a feedback loop keeps changing
+   *        from one tick to the next, see NetlistSimulator::isSettled( ).
+   */
+  bool isSettled( ) const;
+  bool getOutputValue( LogicElement *elm, size_t port = 0 ) const;
+  bool getInputValue( LogicElement *elm, size_t port = 0 ) const;
+
+  /**
+   * @brief getNetlist returns the netlist that is simulated, after the
+   *        optimization.
+   */
+  const Netlist &getNetlist( ) const;
+
+  /**
+   * @brief eliminatedGates returns how many gates the optimization removed
+   *        from the lowered netlist.
+   */
+  uint32_t eliminatedGates( ) const;
+
+  bool contains( LogicElement *elm ) const;
+  /**
+   * @brief outputSignal and inputSignal return the netlist signal connected
+   *        to a port of elm, for code that runs its own simulator on the
+   *        netlist, or NetlistOptimizer::NONE for removed logic and for
+   *        elements that are not simulated.
+   */
+  uint32_t outputSignal( LogicElement *elm, size_t port = 0 ) const;
+  uint32_t inputSignal( LogicElement *elm, size_t port = 0 ) const;
+
+  /**
+   * @brief lastEvaluationCount returns how many gates were evaluated during
+   *        the last call to update( ).
+   */
+  uint64_t lastEvaluationCount( ) const;
+
+private:
+  ElementMapping *mapping;
+  SimulationBackend backend;
+  uint32_t parallelThreshold;
+  DelayModel delayModel;
+  uint32_t iterationLimit;
+  bool optimizeNetlist;
+  /* The netlist built from the logic elements, and the one simulated, with the signal and gate each original one
+   * became. */
+  Netlist lowered;
+  Netlist netlist;
+  std::vector< uint32_t > signalMap;
+  std::vector< uint32_t > gateMap;
+  uint32_t m_eliminatedGates;
+  NetlistSimulator *simulator;
+  /* The simulator, when it is a TimedSimulator. */
+  TimedSimulator *timed;
+  NativeCompiler *native;
+
+  QHash< LogicElement*, uint32_t > gateIndex;
+  QVector< QPair< Input*, uint32_t > > inputs;
+  int constantGate;
+
+  bool lower( );
+  void optimize( );
+  void createSimulator( bool edited = false );
+  uint32_t insertGate( LogicElement *elm );
+  uint32_t signalOf( LogicElement *pred, int port );
+};
+
+#endif // COMPILEDSIMULATION_H
@@ -0,0 +1,5 @@
+HEADERS += \
+    $$PWD/compiledsimulation.h
+
+SOURCES += \
+    $$PWD/compiledsimulation.cpp
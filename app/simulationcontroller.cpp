@@ -2,25 +2,31 @@
 #include "boxmapping.h"
 #include "elementfactory.h"
 #include "simulationcontroller.h"
-#include "simulationcontroller.h"
+#include "simulationworker.h"
 
 #include "element/clock.h"
+#include "simulation/compiledsimulation.h"
 
 #include "nodes/qneconnection.h"
 
+#include <algorithm>
 #include <limits>
 #include <QDebug>
 #include <QGraphicsView>
 #include <QStack>
 
 SimulationController::SimulationController( Scene *scn ) : QObject( dynamic_cast< QObject* >( scn ) ), elMapping(
-    nullptr ), simulationTimer( this ) {
+    nullptr ), compiled( nullptr ), worker( nullptr ), m_backend( SimulationBackend::INTERPRETED ),
+  m_delayModel( DelayModel::INERTIAL ),
+  m_parallelThreshold( CompiledSimulation::DEFAULT_PARALLEL_THRESHOLD ),
+  m_iterationLimit( Netlist::DEFAULT_ITERATION_LIMIT ), m_flattenBoxes( false ),
+  m_optimizeNetlist( true ), m_running( false ),
+  m_tickRate( SimulationWorker::REAL_TIME_RATE ), lastTickCount( 0 ), lastEvaluationCount( 0 ),
+  lastSimulatedTime( 0 ) {
   scene = scn;
-  simulationTimer.setInterval( GLOBALCLK );
   viewTimer.setInterval( int( 1000 / 30 ) );
   viewTimer.start( );
   connect( &viewTimer, &QTimer::timeout, this, &SimulationController::updateView );
-  connect( &simulationTimer, &QTimer::timeout, this, &SimulationController::update );
 }
 
 SimulationController::~SimulationController( ) {
@@ -29,6 +35,7 @@ SimulationController::~SimulationController( ) {
 
 void SimulationController::updateScene( const QRectF &rect ) {
   if( canRun( ) ) {
+    worker->fetch( );
     const QList< QGraphicsItem* > &items = scene->items( rect );
     for( QGraphicsItem *item: items ) {
       QNEConnection *conn = qgraphicsitem_cast< QNEConnection* >( item );
@@ -41,12 +48,24 @@ void SimulationController::updateScene( const QRectF &rect ) {
           updatePort( in );
         }
       }
+      else if( elm && ( elm->elementType( ) == ElementType::CLOCK ) ) {
+        updateClock( dynamic_cast< Clock* >( elm ) );
+      }
     }
   }
 }
 
 void SimulationController::updateView( ) {
-  updateScene( scene->views( ).first( )->sceneRect( ) );
+  if( worker && worker->isRunning( ) ) {
+    if( Clock::reset ) {
+      worker->resetClocks( );
+    }
+    worker->flush( );
+    updateStatistics( );
+  }
+  if( !scene->views( ).isEmpty( ) ) {
+    updateScene( scene->views( ).first( )->sceneRect( ) );
+  }
 }
 
 void SimulationController::updateAll( ) {
@@ -54,30 +73,322 @@ void SimulationController::updateAll( ) {
 }
 
 bool SimulationController::canRun( ) {
-  if( !elMapping ) {
+  if( !elMapping || !worker ) {
     return( false );
   }
   return( elMapping->canRun( ) );
 }
 
 bool SimulationController::isRunning( ) {
-  return( this->simulationTimer.isActive( ) );
+  return( m_running );
 }
 
-void SimulationController::update( ) {
+SimulationBackend SimulationController::backend( ) const {
+  return( m_backend );
+}
+
+void SimulationController::setBackend( SimulationBackend backend ) {
+  if( m_backend != backend ) {
+    m_backend = backend;
+    if( elMapping ) {
+      reSortElms( );
+    }
+  }
+}
+
+DelayModel SimulationController::delayModel( ) const {
+  return( m_delayModel );
+}
+
+void SimulationController::setDelayModel( DelayModel model ) {
+  if( m_delayModel != model ) {
+    m_delayModel = model;
+    if( compiled && ( m_backend == SimulationBackend::TIMED ) ) {
+      reSortElms( );
+    }
+  }
+}
+
+uint SimulationController::parallelThreshold( ) const {
+  return( m_parallelThreshold );
+}
+
+void SimulationController::setParallelThreshold( uint gates ) {
+  if( m_parallelThreshold != gates ) {
+    m_parallelThreshold = gates;
+    if( compiled ) {
+      reSortElms( );
+    }
+  }
+}
+
+uint SimulationController::iterationLimit( ) const {
+  return( m_iterationLimit );
+}
+
+void SimulationController::setIterationLimit( uint limit ) {
+  m_iterationLimit = qMax( limit, 1u );
+  if( worker ) {
+    worker->pause( );
+  }
   if( elMapping ) {
-    elMapping->update( );
+    elMapping->setIterationLimit( static_cast< int >( m_iterationLimit ) );
+  }
+  if( compiled ) {
+    compiled->setIterationLimit( m_iterationLimit );
+  }
+  if( worker && m_running ) {
+    worker->resume( );
+  }
+}
+
+bool SimulationController::flattenBoxes( ) const {
+  return( m_flattenBoxes );
+}
+
+void SimulationController::setFlattenBoxes( bool flatten ) {
+  if( m_flattenBoxes != flatten ) {
+    m_flattenBoxes = flatten;
+    if( elMapping ) {
+      reSortElms( );
+    }
+  }
+}
+
+bool SimulationController::optimizeNetlist( ) const {
+  return( m_optimizeNetlist );
+}
+
+void SimulationController::setOptimizeNetlist( bool optimize ) {
+  if( m_optimizeNetlist != optimize ) {
+    m_optimizeNetlist = optimize;
+    if( elMapping ) {
+      reSortElms( );
+    }
+  }
+}
+
+uint SimulationController::eliminatedGates( ) const {
+  return( compiled ? compiled->eliminatedGates( ) : 0 );
+}
+
+uint SimulationController::tickRate( ) const {
+  return( m_tickRate );
+}
+
+void SimulationController::setTickRate( uint ticksPerSecond ) {
+  m_tickRate = ticksPerSecond;
+  if( worker ) {
+    worker->setTickRate( m_tickRate );
+  }
+}
+
+qint64 SimulationController::evaluationsPerTick( ) const {
+  if( worker ) {
+    return( worker->evaluations( ) );
+  }
+  return( -1 );
+}
+
+void SimulationController::update( ) {
+  if( !worker ) {
+    return;
+  }
+  const bool running = worker->isRunning( );
+  worker->pause( );
+  worker->step( );
+  if( running ) {
+    worker->resume( );
   }
 }
 
 void SimulationController::stop( ) {
-  simulationTimer.stop( );
+  m_running = false;
+  if( worker ) {
+    worker->pause( );
+  }
+  emit statisticsUpdated( 0.0, 0.0, 0.0 );
 }
 
 void SimulationController::start( ) {
   Clock::reset = true;
+  m_running = true;
   reSortElms( );
-  simulationTimer.start( );
+}
+
+bool SimulationController::startRecording( const QString &fileName ) {
+  if( !worker ) {
+    return( false );
+  }
+  const bool running = worker->isRunning( );
+  worker->pause( );
+  worker->stopRecording( );
+  const bool started = worker->startRecording( fileName );
+  if( running ) {
+    worker->resume( );
+  }
+  return( started );
+}
+
+void SimulationController::stopRecording( ) {
+  if( !worker || !worker->isRecording( ) ) {
+    return;
+  }
+  const bool running = worker->isRunning( );
+  worker->pause( );
+  worker->stopRecording( );
+  if( running ) {
+    worker->resume( );
+  }
+}
+
+bool SimulationController::isRecording( ) const {
+  return( worker && worker->isRecording( ) );
+}
+
+void SimulationController::addProbes( const QList< QGraphicsItem* > &items ) {
+  QVector< Probe > added;
+  for( QGraphicsItem *item : items ) {
+    GraphicElement *elm = qgraphicsitem_cast< GraphicElement* >( item );
+    QNEConnection *conn = qgraphicsitem_cast< QNEConnection* >( item );
+    if( elm && ( elm->elementGroup( ) == ElementGroup::OUTPUT ) ) {
+      for( int port = 0; port < elm->inputSize( ); ++port ) {
+        added.append( { elm->id( ), port, true } );
+      }
+    }
+    else if( elm ) {
+      for( int port = 0; port < elm->outputSize( ); ++port ) {
+        added.append( { elm->id( ), port, false } );
+      }
+    }
+    else if( conn && conn->start( ) && conn->start( )->graphicElement( ) ) {
+      /* A net is probed at the output port that drives it. */
+      added.append( { conn->start( )->graphicElement( )->id( ), conn->start( )->index( ), false } );
+    }
+  }
+  for( const Probe &probe : added ) {
+    const bool known = std::any_of( probes.begin( ), probes.end( ), [ &probe ]( const Probe &other ) {
+      return( ( other.elementId == probe.elementId ) && ( other.port == probe.port ) && ( other.input == probe.input ) );
+    } );
+    if( !known ) {
+      probes.append( probe );
+    }
+  }
+  attachHistory( );
+  emit probesChanged( );
+}
+
+void SimulationController::clearProbes( ) {
+  probes.clear( );
+  attachHistory( );
+  emit probesChanged( );
+}
+
+QStringList SimulationController::probeNames( ) const {
+  QStringList names;
+  for( const Probe &probe : probes ) {
+    QNEPort *port = probePort( probe );
+    GraphicElement *elm = port ? port->graphicElement( ) : nullptr;
+    if( !elm ) {
+      names.append( "?" );
+      continue;
+    }
+    QString name = elm->getLabel( );
+    if( name.isEmpty( ) ) {
+      name = ElementFactory::typeToText( elm->elementType( ) );
+    }
+    if( ( elm->elementType( ) == ElementType::BOX ) && !port->getName( ).isEmpty( ) ) {
+      name += "." + port->getName( );
+    }
+    else if( ( probe.input ? elm->inputSize( ) : elm->outputSize( ) ) > 1 ) {
+      name += QString( "[%1]" ).arg( probe.port );
+    }
+    names.append( name );
+  }
+  return( names );
+}
+
+const SignalHistory &SimulationController::history( ) const {
+  return( signalHistory );
+}
+
+std::mutex &SimulationController::historyMutex( ) {
+  return( m_historyMutex );
+}
+
+void SimulationController::setHistoryMemory( size_t bytes ) {
+  std::lock_guard< std::mutex > lock( m_historyMutex );
+  signalHistory.reset( signalHistory.signalCount( ), bytes );
+}
+
+quint64 SimulationController::simulatedTime( ) const {
+  return( worker ? worker->simulatedTime( ) : 0 );
+}
+
+QNEPort* SimulationController::probePort( const Probe &probe ) {
+  GraphicElement *elm = dynamic_cast< GraphicElement* >(
+    ElementFactory::getItemById( static_cast< size_t >( probe.elementId ) ) );
+  if( !elm ) {
+    return( nullptr );
+  }
+  if( probe.input ) {
+    return( probe.port < elm->inputSize( ) ? elm->input( probe.port ) : nullptr );
+  }
+  return( probe.port < elm->outputSize( ) ? elm->output( probe.port ) : nullptr );
+}
+
+void SimulationController::attachHistory( ) {
+  const int count = probes.size( );
+  for( int idx = probes.size( ) - 1; idx >= 0; --idx ) {
+    QNEPort *port = probePort( probes[ idx ] );
+    if( !port || ( port->graphicElement( )->scene( ) != scene ) ) {
+      /* The element was deleted, or its ports changed. */
+      probes.remove( idx );
+    }
+  }
+  QVector< QNEPort* > ports;
+  for( const Probe &probe : probes ) {
+    ports.append( probePort( probe ) );
+  }
+  if( !worker ) {
+    std::lock_guard< std::mutex > lock( m_historyMutex );
+    signalHistory.reset( 0, signalHistory.memoryCap( ) );
+  }
+  else {
+    const bool running = worker->isRunning( );
+    worker->pause( );
+    worker->setHistory( &signalHistory, &m_historyMutex, ports );
+    if( running ) {
+      worker->resume( );
+    }
+  }
+  if( probes.size( ) != count ) {
+    emit probesChanged( );
+  }
+}
+
+void SimulationController::deleteWorker( ) {
+  const bool recording = isRecording( );
+  delete worker;
+  worker = nullptr;
+  if( recording ) {
+    emit recordingStopped( );
+  }
+}
+
+void SimulationController::createWorker( ) {
+  deleteWorker( );
+  worker = new SimulationWorker( elMapping, compiled, scene->getElements( ), this );
+  worker->setTickRate( m_tickRate );
+  attachHistory( );
+  statisticsTimer.start( );
+  lastTickCount = 0;
+  lastEvaluationCount = 0;
+  lastSimulatedTime = 0;
+  update( );
+  if( m_running ) {
+    worker->resume( );
+  }
 }
 
 
@@ -87,21 +398,54 @@ void SimulationController::reSortElms( ) {
   if( elements.size( ) == 0 ) {
     return;
   }
-  if( elMapping ) {
-    delete elMapping;
-  }
+  clear( );
   elMapping = new ElementMapping( scene->getElements( ), GlobalProperties::currentFile );
+  elMapping->setIterationLimit( static_cast< int >( m_iterationLimit ) );
   if( elMapping->canInitialize( ) ) {
     elMapping->initialize( );
     elMapping->sort( );
-    update( );
+    if( m_flattenBoxes ) {
+      elMapping->flatten( );
+    }
+    if( m_backend != SimulationBackend::INTERPRETED ) {
+      compiled = new CompiledSimulation( elMapping, m_backend, m_parallelThreshold, m_delayModel,
+                                         m_optimizeNetlist );
+      compiled->setIterationLimit( m_iterationLimit );
+    }
+    createWorker( );
   }
   else {
     qDebug( ) << "Cannot initialize simulation!";
   }
 }
 
+void SimulationController::applyDelta( const CircuitDelta &delta ) {
+  if( !elMapping || !elMapping->canRun( ) || m_flattenBoxes ) {
+    /* Flattened boxes no longer match the graphic connections. */
+    reSortElms( );
+    return;
+  }
+  COMMENT( "PATCHING SIMULATION LAYER", 1 );
+  /* The port slots of the snapshot change with the scene, so the worker is built again. */
+  deleteWorker( );
+  QVector< GraphicElement* > elements = scene->getElements( );
+  QSet< LogicElement* > created;
+  if( elements.isEmpty( ) || !elMapping->applyDelta( delta, elements, created ) ) {
+    reSortElms( );
+    return;
+  }
+  if( compiled ) {
+    compiled->recompile( created );
+  }
+  createWorker( );
+}
+
 void SimulationController::clear( ) {
+  deleteWorker( );
+  if( compiled ) {
+    delete compiled;
+  }
+  compiled = nullptr;
   if( elMapping ) {
     delete elMapping;
   }
@@ -110,25 +454,7 @@ void SimulationController::clear( ) {
 
 void SimulationController::updatePort( QNEOutputPort *port ) {
   if( port ) {
-    GraphicElement *elm = port->graphicElement( );
-    Q_ASSERT( elm );
-    LogicElement *logElm = nullptr;
-    int portIndex = 0;
-    if( elm->elementType( ) == ElementType::BOX ) {
-      Box *box = dynamic_cast< Box* >( elm );
-      logElm = elMapping->getBoxMapping( box )->getOutput( port->index( ) );
-    }
-    else {
-      logElm = elMapping->getLogicElement( elm );
-      portIndex = port->index( );
-    }
-    Q_ASSERT( logElm );
-    if( logElm->isValid( ) ) {
-      port->setValue( logElm->getOutputValue( portIndex ) );
-    }
-    else {
-      port->setValue( -1 );
-    }
+    port->setValue( worker->value( port ) );
   }
 }
 
@@ -136,15 +462,7 @@ void SimulationController::updatePort( QNEInputPort *port ) {
   Q_ASSERT( port );
   GraphicElement *elm = port->graphicElement( );
   Q_ASSERT( elm );
-  LogicElement *logElm = elMapping->getLogicElement( elm );
-  Q_ASSERT( logElm );
-  int portIndex = port->index( );
-  if( logElm->isValid( ) ) {
-    port->setValue( logElm->getInputValue( portIndex ) );
-  }
-  else {
-    port->setValue( -1 );
-  }
+  port->setValue( worker->value( port ) );
   if( elm->elementGroup( ) == ElementGroup::OUTPUT ) {
     elm->refresh( );
   }
@@ -154,3 +472,29 @@ void SimulationController::updateConnection( QNEConnection *conn ) {
   Q_ASSERT( conn );
   updatePort( conn->start( ) );
 }
+
+void SimulationController::updateClock( Clock *clk ) {
+  Q_ASSERT( clk );
+  /* The worker owns the state of the clocks, the scene only shows it. */
+  const int value = worker->value( clk->outputs( ).first( ) );
+  if( ( value >= 0 ) && ( clk->getOn( ) != ( value == 1 ) ) ) {
+    clk->setOn( value == 1 );
+  }
+}
+
+void SimulationController::updateStatistics( ) {
+  const qint64 elapsed = statisticsTimer.elapsed( );
+  if( elapsed < 1000 ) {
+    return;
+  }
+  const quint64 ticks = worker->tickCount( );
+  const quint64 evaluations = worker->evaluationCount( );
+  const quint64 simulated = worker->simulatedTime( );
+  const double seconds = elapsed / 1000.0;
+  emit statisticsUpdated( ( ticks - lastTickCount ) / seconds, ( evaluations - lastEvaluationCount ) / seconds,
+                          ( simulated - lastSimulatedTime ) / ( seconds * 1e9 ) );
+  lastTickCount = ticks;
+  lastEvaluationCount = evaluations;
+  lastSimulatedTime = simulated;
+  statisticsTimer.restart( );
+}
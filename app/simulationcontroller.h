@@ -3,9 +3,15 @@
 
 #include "elementmapping.h"
 #include "scene.h"
+#include "signalhistory.h"
+#include "simulation/simulationbackend.h"
 
+#include <QElapsedTimer>
+#include <mutex>
 
 class Clock;
+class CompiledSimulation;
+class SimulationWorker;
 
 class SimulationController : public QObject {
   Q_OBJECT
@@ -17,9 +23,110 @@ public:
   static QVector< GraphicElement* > sortElements( QVector< GraphicElement* > elms );
 
   bool isRunning( );
+
+  SimulationBackend backend( ) const;
+  void setBackend( SimulationBackend backend );
+
+  /**
+   * @brief delayModel is how the TIMED backend handles pulses shorter than
+   *        the propagation delay of a gate.
+   */
+  DelayModel delayModel( ) const;
+  void setDelayModel( DelayModel model );
+
+  /**
+   * @brief parallelThreshold is the gate count from which the compiled
+   *        backend evaluates each level over several threads.
+   */
+  uint parallelThreshold( ) const;
+  void setParallelThreshold( uint gates );
+
+  /**
+   * @brief flattenBoxes tells whether the boundary nodes of the boxes are
+   *        removed from the simulation, see ElementMapping::flatten( ).
+   */
+  bool flattenBoxes( ) const;
+  void setFlattenBoxes( bool flatten );
+
+  /**
+   * @brief optimizeNetlist tells whether the compiled backends simplify the
+   *        netlist before simulating it, see NetlistOptimizer, and
+   *        eliminatedGates how many gates that removed.
+   */
+  bool optimizeNetlist( ) const;
+  void setOptimizeNetlist( bool optimize );
+  uint eliminatedGates( ) const;
+
+  /**
+   * @brief iterationLimit is how many times, at most, a feedback loop is
+   *        evaluated within one tick. Loops that still change after that
+   *        are shown as invalid.
+   */
+  uint iterationLimit( ) const;
+  void setIterationLimit( uint limit );
+
+  /**
+   * @brief tickRate is how many ticks run per second of wall-clock time,
+   *        0 meaning as fast as possible. Clocks keep their frequency in
+   *        simulated time whatever the rate is; at
+   *        SimulationWorker::REAL_TIME_RATE, simulated time follows the
+   *        wall clock.
+   */
+  uint tickRate( ) const;
+  void setTickRate( uint ticksPerSecond );
+
+  /**
+   * @brief evaluationsPerTick returns how many gates, or logic elements
+   *        for the interpreted backend, were evaluated in the last tick
+   *        shown.
+   */
+  qint64 evaluationsPerTick( ) const;
+
+  /**
+   * @brief startRecording writes the values of the scene to a Value Change
+   *        Dump while the simulation runs. As the recorded ports are fixed,
+   *        the recording stops when the circuit is edited, emitting
+   *        recordingStopped( ).
+   */
+  bool startRecording( const QString &fileName );
+  void stopRecording( );
+  bool isRecording( ) const;
+
+  /**
+   * @brief addProbes records the history of items in the logic analyzer:
+   *        the outputs of elements, boxes included, the inputs of output
+   *        elements, and the nets of connections. The probes are kept by
+   *        element id, so they survive edits of the circuit, but the history
+   *        starts again whenever the simulation is rebuilt.
+   */
+  void addProbes( const QList< QGraphicsItem* > &items );
+  void clearProbes( );
+  QStringList probeNames( ) const;
+
+  /**
+   * @brief history may be read from the GUI thread while holding
+   *        historyMutex( ). Its memory cap is set by setHistoryMemory( ).
+   */
+  const SignalHistory &history( ) const;
+  std::mutex &historyMutex( );
+  void setHistoryMemory( size_t bytes );
+  quint64 simulatedTime( ) const;
 signals:
+  /**
+   * @brief statisticsUpdated is emitted about once a second while the
+   *        simulation runs, with the measured tick and gate evaluation
+   *        rates and the simulated seconds that passed per second, and
+   *        once with zeros when it stops.
+   */
+  void statisticsUpdated( double ticksPerSecond, double evaluationsPerSecond, double speed );
+  void recordingStopped( );
+  void probesChanged( );
 
 public slots:
+  /**
+   * @brief update runs one tick on the calling thread, pausing the
+   *        simulation thread meanwhile if it is running.
+   */
   void update( );
   void stop( );
   void start( );
@@ -28,16 +135,51 @@ public slots:
   void updateAll( );
   bool canRun( );
   void reSortElms( );
+  /**
+   * @brief applyDelta patches the simulation layer after an edit of the
+   *        scene, keeping the state of the unchanged elements. It falls back
+   *        to reSortElms( ) when the mapping cannot be patched in place.
+   */
+  void applyDelta( const CircuitDelta &delta );
 
 private:
+  struct Probe {
+    int elementId;
+    int port;
+    bool input;
+  };
+
   void updatePort( QNEOutputPort *port );
   void updatePort( QNEInputPort *port );
   void updateConnection( QNEConnection *conn );
+  void updateClock( Clock *clk );
+  void updateStatistics( );
+  void createWorker( );
+  void deleteWorker( );
+  void attachHistory( );
+  static QNEPort* probePort( const Probe &probe );
 
   ElementMapping *elMapping;
+  CompiledSimulation *compiled;
+  /* Ticks the simulation away from the GUI thread, and holds the port values shown on the scene. */
+  SimulationWorker *worker;
+  SimulationBackend m_backend;
+  DelayModel m_delayModel;
+  uint m_parallelThreshold;
+  uint m_iterationLimit;
+  bool m_flattenBoxes;
+  bool m_optimizeNetlist;
+  bool m_running;
+  uint m_tickRate;
+  QElapsedTimer statisticsTimer;
+  quint64 lastTickCount;
+  quint64 lastEvaluationCount;
+  quint64 lastSimulatedTime;
   Scene *scene;
-  QTimer simulationTimer;
   QTimer viewTimer;
+  QVector< Probe > probes;
+  SignalHistory signalHistory;
+  std::mutex m_historyMutex;
 };
 
 #endif /* SIMULATIONCONTROLLER_H */
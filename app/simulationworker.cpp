@@ -0,0 +1,431 @@
+#include "simulationworker.h"
+
+#include "box.h"
+#include "boxmapping.h"
+#include "element/clock.h"
+#include "elementfactory.h"
+#include "signalhistory.h"
+#include "simulation/compiledsimulation.h"
+#include "vcdwriter.h"
+
+#include "nodes/qneport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace {
+  /* Input changes the GUI thread can post between two evaluations before they are kept aside. */
+  const size_t EVENT_CAPACITY = 4096;
+  /* Snapshots are published at most this often, as the scene is only repainted at 30 Hz. */
+  const std::chrono::milliseconds PUBLISH_PERIOD( 5 );
+  /* The longest the thread sleeps before looking for input changes. */
+  const std::chrono::milliseconds POLL_PERIOD( GLOBALCLK );
+  /* How far the thread may fall behind the requested rate before the missed time is given up. */
+  const std::chrono::milliseconds MAX_DELAY( 100 );
+
+  QString portName( const QString &name, int port, int size ) {
+    return( size > 1 ? name + "[" + QString::number( port ) + "]" : name );
+  }
+}
+
+const unsigned SimulationWorker::REAL_TIME_RATE;
+
+SimulationWorker::SimulationWorker( ElementMapping *mapping, CompiledSimulation *compiled,
+                                    const QVector< GraphicElement* > &elements, QObject *parent ) :
+  QThread( parent ), mapping( mapping ), compiled( compiled ), events( EVENT_CAPACITY ), rate( REAL_TIME_RATE ),
+  ticks( 0 ), evaluated( 0 ), simulated( 0 ), history( nullptr ), historyMutex( nullptr ) {
+  for( int idx = 0; idx < elements.size( ); ++idx ) {
+    GraphicElement *elm = elements[ idx ];
+    QString name = elm->getLabel( );
+    if( name.isEmpty( ) ) {
+      name = ElementFactory::typeToText( elm->elementType( ) ) + "_" + QString::number( idx );
+    }
+    int scope = -1;
+    if( elm->elementType( ) == ElementType::BOX ) {
+      scope = scopes.size( );
+      scopes.append( qMakePair( name, -1 ) );
+    }
+    for( QNEOutputPort *port : elm->outputs( ) ) {
+      LogicPort logicPort = mapping->getLogicPort( port );
+      if( logicPort.first ) {
+        QString portLabel = portName( name, port->index( ), elm->outputSize( ) );
+        if( ( scope >= 0 ) && !port->getName( ).isEmpty( ) ) {
+          /* The outputs of a box are named after the output elements inside it. */
+          portLabel = port->getName( );
+        }
+        addProbe( port, logicPort.first, logicPort.second, false, scope, portLabel );
+      }
+    }
+    if( Box *box = dynamic_cast< Box* >( elm ) ) {
+      addNestedProbes( mapping->getBoxMapping( box ), scope );
+    }
+    LogicElement *logicElm = mapping->getLogicElement( elm );
+    if( !logicElm ) {
+      continue;
+    }
+    if( elm->elementGroup( ) == ElementGroup::OUTPUT ) {
+      for( QNEInputPort *port : elm->inputs( ) ) {
+        addProbe( port, logicElm, port->index( ), true, -1, portName( name, port->index( ), elm->inputSize( ) ) );
+      }
+    }
+    if( elm->elementType( ) == ElementType::CLOCK ) {
+      Clock *clk = dynamic_cast< Clock* >( elm );
+      scheduler.addClock( static_cast< double >( clk->getFrequency( ) ), !clk->disabled( ), clk->getOn( ), now );
+      clocks.append( qMakePair( clk, logicElm ) );
+    }
+    else if( Input *in = dynamic_cast< Input* >( elm ) ) {
+      const int index = inputs.size( );
+      inputs.append( qMakePair( in, logicElm ) );
+      connect( elm, &GraphicElement::inputChanged, this, [ this, index ]( bool value ) {
+        if( isRunning( ) ) {
+          post( { EventType::INPUT, index, value ? 1.0 : 0.0 } );
+        }
+      } );
+    }
+  }
+  snapshots.reset( { std::vector< signed char >( static_cast< size_t >( probes.size( ) ), -1 ), -1 } );
+}
+
+SimulationWorker::~SimulationWorker( ) {
+  pause( );
+}
+
+void SimulationWorker::resume( ) {
+  if( isRunning( ) ) {
+    return;
+  }
+  /* Nothing reads the queue while paused, and the scene already holds the latest values. */
+  Event event;
+  while( events.pop( event ) ) {
+  }
+  pending.clear( );
+  for( const auto &input : inputs ) {
+    setInput( input.second, input.first->getOn( ) );
+  }
+  dirty = true;
+  if( Clock::reset ) {
+    for( int clock = 0; clock < clocks.size( ); ++clock ) {
+      restartClock( clock, static_cast< double >( clocks[ clock ].first->getFrequency( ) ) );
+    }
+    Clock::reset = false;
+  }
+  start( );
+}
+
+void SimulationWorker::pause( ) {
+  requestInterruption( );
+  wait( );
+}
+
+void SimulationWorker::step( ) {
+  Q_ASSERT( !isRunning( ) );
+  for( const auto &input : inputs ) {
+    setInput( input.second, input.first->getOn( ) );
+  }
+  if( Clock::reset ) {
+    for( int clock = 0; clock < clocks.size( ); ++clock ) {
+      restartClock( clock, static_cast< double >( clocks[ clock ].first->getFrequency( ) ) );
+    }
+    Clock::reset = false;
+  }
+  TimeStepper::step( );
+  simulated.store( now, std::memory_order_relaxed );
+  publish( );
+}
+
+void SimulationWorker::setTickRate( unsigned ticksPerSecond ) {
+  rate.store( ticksPerSecond, std::memory_order_relaxed );
+}
+
+unsigned SimulationWorker::tickRate( ) const {
+  return( rate.load( std::memory_order_relaxed ) );
+}
+
+quint64 SimulationWorker::tickCount( ) const {
+  return( ticks.load( std::memory_order_relaxed ) );
+}
+
+quint64 SimulationWorker::evaluationCount( ) const {
+  return( evaluated.load( std::memory_order_relaxed ) );
+}
+
+quint64 SimulationWorker::simulatedTime( ) const {
+  return( simulated.load( std::memory_order_relaxed ) );
+}
+
+void SimulationWorker::publish( ) {
+  SimulationSnapshot &snapshot = snapshots.back( );
+  for( int slot = 0; slot < probes.size( ); ++slot ) {
+    snapshot.values[ static_cast< size_t >( slot ) ] = probeValue( probes[ slot ] );
+  }
+  snapshot.evaluations = static_cast< qint64 >( lastEvaluationCount( ) );
+  snapshots.publish( );
+}
+
+void SimulationWorker::resetClocks( ) {
+  for( int clock = 0; clock < clocks.size( ); ++clock ) {
+    post( { EventType::CLOCK, clock, static_cast< double >( clocks.at( clock ).first->getFrequency( ) ) } );
+  }
+  Clock::reset = false;
+}
+
+void SimulationWorker::flush( ) {
+  int sent = 0;
+  while( ( sent < pending.size( ) ) && events.push( pending[ sent ] ) ) {
+    ++sent;
+  }
+  pending.remove( 0, sent );
+}
+
+bool SimulationWorker::fetch( ) {
+  return( snapshots.fetch( ) );
+}
+
+int SimulationWorker::value( QNEPort *port ) const {
+  auto iter = portSlots.constFind( port );
+  if( iter == portSlots.constEnd( ) ) {
+    return( -1 );
+  }
+  return( snapshots.front( ).values[ static_cast< size_t >( iter.value( ) ) ] );
+}
+
+qint64 SimulationWorker::evaluations( ) const {
+  return( snapshots.front( ).evaluations );
+}
+
+bool SimulationWorker::startRecording( const QString &fileName ) {
+  Q_ASSERT( !isRunning( ) );
+  std::unique_ptr< VcdWriter > vcd( new VcdWriter );
+  const int top = vcd->addScope( "circuit" );
+  /* A box comes before the boxes inside it, so its scope is declared first. */
+  QVector< int > scopeIds;
+  for( const auto &scope : scopes ) {
+    scopeIds.append( vcd->addScope( scope.first, scope.second < 0 ? top : scopeIds[ scope.second ] ) );
+  }
+  /* Variables are declared in slot order, so that they share their indices. */
+  for( const Probe &probe : probes ) {
+    vcd->addVariable( probe.scope < 0 ? top : scopeIds[ probe.scope ], probe.name );
+  }
+  if( !vcd->open( fileName ) ) {
+    return( false );
+  }
+  recorder = std::move( vcd );
+  record( );
+  return( true );
+}
+
+void SimulationWorker::stopRecording( ) {
+  Q_ASSERT( !isRunning( ) );
+  recorder.reset( );
+}
+
+bool SimulationWorker::isRecording( ) const {
+  return( recorder != nullptr );
+}
+
+void SimulationWorker::setHistory( SignalHistory *history, std::mutex *mutex, const QVector< QNEPort* > &ports ) {
+  Q_ASSERT( !isRunning( ) );
+  this->history = history;
+  historyMutex = mutex;
+  historySlots.clear( );
+  if( !history ) {
+    return;
+  }
+  for( QNEPort *port : ports ) {
+    historySlots.append( portSlots.value( port, -1 ) );
+  }
+  {
+    std::lock_guard< std::mutex > lock( *historyMutex );
+    history->reset( static_cast< size_t >( historySlots.size( ) ), history->memoryCap( ) );
+  }
+  appendHistory( );
+}
+
+void SimulationWorker::run( ) {
+  typedef std::chrono::steady_clock SteadyClock;
+  SteadyClock::time_point wallStart = SteadyClock::now( );
+  SteadyClock::time_point nextPublish = wallStart;
+  quint64 simulatedStart = now;
+  unsigned lastRate = rate.load( std::memory_order_relaxed );
+  while( !isInterruptionRequested( ) ) {
+    drain( );
+    const unsigned ticksPerSecond = rate.load( std::memory_order_relaxed );
+    SteadyClock::time_point wall = SteadyClock::now( );
+    if( ticksPerSecond != lastRate ) {
+      wallStart = wall;
+      simulatedStart = now;
+      lastRate = ticksPerSecond;
+    }
+    SteadyClock::time_point wake = wall + POLL_PERIOD;
+    if( ticksPerSecond == 0 ) {
+      const quint64 next = nextEvaluation( );
+      if( next != ClockScheduler::NEVER ) {
+        advanceTo( next );
+        wake = wall;
+      }
+    }
+    else {
+      /* Simulated nanoseconds per wall-clock nanosecond. */
+      const double speed = ticksPerSecond * GLOBALCLK / 1000.0;
+      const double elapsed = static_cast< double >( std::chrono::duration_cast< std::chrono::nanoseconds >(
+                                                      wall - wallStart ).count( ) );
+      quint64 target = simulatedStart + static_cast< quint64 >( elapsed * speed );
+      const quint64 maxLag = static_cast< quint64 >( std::chrono::nanoseconds( MAX_DELAY ).count( ) * speed );
+      if( target > now + maxLag ) {
+        /* Evaluations are too slow for the requested rate, so simulated time slips. */
+        target = now + maxLag;
+        wallStart = wall;
+        simulatedStart = target;
+      }
+      advanceTo( target );
+      const quint64 next = nextEvaluation( );
+      if( next != ClockScheduler::NEVER ) {
+        const std::chrono::nanoseconds untilNext( static_cast< qint64 >( ( next - simulatedStart ) / speed ) );
+        wake = std::min( wake, wallStart + std::chrono::duration_cast< SteadyClock::duration >( untilNext ) );
+      }
+    }
+    simulated.store( now, std::memory_order_relaxed );
+    if( wall >= nextPublish ) {
+      publish( );
+      nextPublish = wall + PUBLISH_PERIOD;
+    }
+    if( wake > wall ) {
+      std::this_thread::sleep_until( wake );
+    }
+  }
+  publish( );
+}
+
+void SimulationWorker::addProbe( QNEPort *port, LogicElement *elm, int index, bool input, int scope,
+                                 const QString &name ) {
+  /* The ports of nested boxes are not on the scene, and are only recorded. */
+  if( port ) {
+    portSlots.insert( port, probes.size( ) );
+  }
+  probes.append( { elm, index, input, scope, name } );
+}
+
+void SimulationWorker::addNestedProbes( const BoxMapping *boxMap, int scope ) {
+  if( !boxMap ) {
+    return;
+  }
+  const int first = scopes.size( );
+  for( const BoxTemplate::NestedBox &nestedBox : boxMap->nestedBoxes( ) ) {
+    const int nestedScope = scopes.size( );
+    scopes.append( qMakePair( nestedBox.name, nestedBox.parent < 0 ? scope : first + nestedBox.parent ) );
+    for( int port = 0; port < nestedBox.outputs.size( ); ++port ) {
+      LogicElement *node = boxMap->getNode( nestedBox.outputs[ port ] );
+      if( node ) {
+        QString portLabel = nestedBox.outputNames[ port ];
+        if( portLabel.isEmpty( ) ) {
+          portLabel = portName( nestedBox.name, port, nestedBox.outputs.size( ) );
+        }
+        addProbe( nullptr, node, 0, false, nestedScope, portLabel );
+      }
+    }
+  }
+}
+
+void SimulationWorker::record( ) {
+  for( int slot = 0; slot < probes.size( ); ++slot ) {
+    recorder->change( now, static_cast< uint32_t >( slot ), probeValue( probes[ slot ] ) );
+  }
+}
+
+signed char SimulationWorker::probeValue( const Probe &probe ) const {
+  bool value;
+  if( compiled ) {
+    if( !compiled->isValid( probe.elm ) ) {
+      return( -1 );
+    }
+    value = probe.input ? compiled->getInputValue( probe.elm, static_cast< size_t >( probe.port ) ) :
+            compiled->getOutputValue( probe.elm, static_cast< size_t >( probe.port ) );
+  }
+  else {
+    if( !probe.elm->isValid( ) || mapping->isOscillating( probe.elm ) ) {
+      return( -1 );
+    }
+    value = probe.input ? probe.elm->getInputValue( static_cast< size_t >( probe.port ) ) :
+            probe.elm->getOutputValue( static_cast< size_t >( probe.port ) );
+  }
+  return( value ? 1 : 0 );
+}
+
+void SimulationWorker::appendHistory( ) {
+  std::lock_guard< std::mutex > lock( *historyMutex );
+  for( int signal = 0; signal < historySlots.size( ); ++signal ) {
+    const int slot = historySlots[ signal ];
+    history->append( static_cast< uint32_t >( signal ), now, slot < 0 ? -1 : probeValue( probes[ slot ] ) );
+  }
+}
+
+void SimulationWorker::post( const Event &event ) {
+  pending.append( event );
+  flush( );
+}
+
+void SimulationWorker::setInput( LogicElement *elm, bool value ) {
+  if( compiled ) {
+    compiled->setInput( elm, value );
+  }
+  else {
+    elm->setOutputValue( value );
+  }
+}
+
+void SimulationWorker::restartClock( int clock, double frequency ) {
+  scheduler.restart( static_cast< uint32_t >( clock ), frequency, now );
+  setInput( clocks[ clock ].second, scheduler.value( static_cast< uint32_t >( clock ) ) );
+  dirty = true;
+}
+
+void SimulationWorker::drain( ) {
+  Event event;
+  while( events.pop( event ) ) {
+    if( event.type == EventType::CLOCK ) {
+      restartClock( event.index, event.value );
+    }
+    else {
+      setInput( inputs[ event.index ].second, event.value != 0.0 );
+      dirty = true;
+    }
+  }
+}
+
+bool SimulationWorker::isSettled( ) const {
+  return( compiled ? compiled->isSettled( ) : mapping->isSettled( ) );
+}
+
+void SimulationWorker::setClock( uint32_t clock, bool value ) {
+  setInput( clocks[ static_cast< int >( clock ) ].second, value );
+}
+
+uint64_t SimulationWorker::nextEvent( ) const {
+  /* The timed backend has gate outputs to change, the others return UINT64_MAX. */
+  return( compiled ? compiled->nextEvent( ) : ClockScheduler::NEVER );
+}
+
+void SimulationWorker::evaluate( ) {
+  if( compiled && compiled->isTimed( ) ) {
+    compiled->advanceTo( now );
+  }
+  else if( compiled ) {
+    compiled->run( );
+  }
+  else {
+    mapping->run( );
+  }
+  ticks.fetch_add( 1, std::memory_order_relaxed );
+  evaluated.fetch_add( lastEvaluationCount( ), std::memory_order_relaxed );
+  if( recorder ) {
+    record( );
+  }
+  if( history ) {
+    appendHistory( );
+  }
+}
+
+quint64 SimulationWorker::lastEvaluationCount( ) const {
+  return( compiled ? static_cast< quint64 >( compiled->lastEvaluationCount( ) ) : mapping->lastEvaluationCount( ) );
+}
@@ -0,0 +1,197 @@
+#ifndef SIMULATIONWORKER_H
+#define SIMULATIONWORKER_H
+
+#include "elementmapping.h"
+#include "globalproperties.h"
+#include "simulation/spscqueue.h"
+#include "simulation/timestepper.h"
+#include "simulation/triplebuffer.h"
+
+#include <QHash>
+#include <QPair>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class BoxMapping;
+class CompiledSimulation;
+class QNEPort;
+class SignalHistory;
+class VcdWriter;
+
+/**
+ * @brief The SimulationSnapshot struct holds the port values shown on the
+ *        scene after a tick, one per port slot, -1 meaning invalid.
+ */
+struct SimulationSnapshot {
+  std::vector< signed char > values;
+  qint64 evaluations;
+};
+
+/**
+ * @brief The SimulationWorker class runs an ElementMapping, or the
+ *        CompiledSimulation built from it, on a thread of its own. Its
+ *        TimeStepper keeps a simulated time in nanoseconds and evaluates the
+ *        circuit only when something is due, as CircuitEngine does. The
+ *        thread never touches the scene: input changes reach it through a
+ *        lock-free queue, and snapshots of the port values are published
+ *        for the GUI thread to read without locking. The mapping may only
+ *        be used by other code while paused.
+ */
+class SimulationWorker : public QThread, private TimeStepper {
+  Q_OBJECT
+public:
+  SimulationWorker( ElementMapping *mapping, CompiledSimulation *compiled, const QVector< GraphicElement* > &elements,
+                    QObject *parent = nullptr );
+  ~SimulationWorker( ) override;
+
+  /**
+   * @brief resume loads the inputs from the scene and starts the thread.
+   *        pause( ) returns once the current evaluation is done.
+   */
+  void resume( );
+  void pause( );
+
+  /**
+   * @brief step advances the simulated time by one GLOBALCLK tick on the
+   *        calling thread, reading the inputs of the scene first. The circuit
+   *        is evaluated at least once. It may only be called while paused.
+   */
+  void step( );
+
+  /**
+   * @brief REAL_TIME_RATE is the tick rate at which simulated time, see
+   *        GLOBALCLK, follows the wall clock.
+   */
+  static const unsigned REAL_TIME_RATE = 1000 / GLOBALCLK;
+
+  /**
+   * @brief setTickRate sets how many GLOBALCLK ticks of simulated time pass
+   *        per second of wall-clock time, 0 meaning that the thread jumps
+   *        from one due evaluation to the next without waiting. It may be
+   *        changed while running.
+   */
+  void setTickRate( unsigned ticksPerSecond );
+  unsigned tickRate( ) const;
+
+  /**
+   * @brief tickCount and evaluationCount return how many times the circuit
+   *        was evaluated, and how many gates that took, since the worker
+   *        was created. simulatedTime returns the current simulated time in
+   *        nanoseconds. They may be read from any thread.
+   */
+  quint64 tickCount( ) const;
+  quint64 evaluationCount( ) const;
+  quint64 simulatedTime( ) const;
+
+  /**
+   * @brief publish takes a snapshot of the current state. The thread does
+   *        it every few milliseconds and when paused; the GUI thread may do
+   *        it while paused.
+   */
+  void publish( );
+
+  /**
+   * @brief resetClocks restarts all the clocks with their current
+   *        frequency, as Clock::reset requests.
+   */
+  void resetClocks( );
+
+  /**
+   * @brief flush hands over the input changes that did not fit in the
+   *        queue yet.
+   */
+  void flush( );
+
+  /**
+   * @brief fetch makes the latest snapshot visible through value( ) and
+   *        evaluations( ), and returns false if there was none since the
+   *        previous call.
+   */
+  bool fetch( );
+  int value( QNEPort *port ) const;
+  qint64 evaluations( ) const;
+
+  /**
+   * @brief startRecording writes every port shown on the scene to a Value
+   *        Change Dump at each evaluation, the ports of a box in a scope of
+   *        its own, and those of its nested boxes in scopes within it,
+   *        until stopRecording( ) or the end of the worker. Both may only be
+   *        called while paused.
+   */
+  bool startRecording( const QString &fileName );
+  void stopRecording( );
+  bool isRecording( ) const;
+
+  /**
+   * @brief setHistory resets history to the given ports and appends their
+   *        values to it at each evaluation, holding mutex meanwhile. A null
+   *        history stops it. It may only be called while paused.
+   */
+  void setHistory( SignalHistory *history, std::mutex *mutex, const QVector< QNEPort* > &ports );
+
+protected:
+  void run( ) override;
+
+private:
+  enum class EventType : unsigned char { INPUT, CLOCK };
+
+  struct Event {
+    EventType type;
+    int index;
+    /* The new value of an input, or the frequency of a restarted clock. */
+    double value;
+  };
+
+  struct Probe {
+    LogicElement *elm;
+    int port;
+    bool input;
+    /* Where the port is shown in a recording, scope being a box in scopes, or -1. */
+    int scope;
+    QString name;
+  };
+
+  ElementMapping *mapping;
+  CompiledSimulation *compiled;
+  QVector< QPair< Input*, LogicElement* > > inputs;
+  /* Indexed like the clocks of the scheduler. */
+  QVector< QPair< Clock*, LogicElement* > > clocks;
+  QVector< Probe > probes;
+  QHash< QNEPort*, int > portSlots;
+  /* The boxes of the circuit, nested ones included, each with the index of the box it is in, or -1. */
+  QVector< QPair< QString, int > > scopes;
+  std::unique_ptr< VcdWriter > recorder;
+  SpscQueue< Event > events;
+  /* Events posted while the queue was full, in order. Only used by the GUI thread. */
+  QVector< Event > pending;
+  TripleBuffer< SimulationSnapshot > snapshots;
+  std::atomic< unsigned > rate;
+  std::atomic< quint64 > ticks;
+  std::atomic< quint64 > evaluated;
+  std::atomic< quint64 > simulated;
+  SignalHistory *history;
+  std::mutex *historyMutex;
+  /* The probe slot of each signal of the history, or -1 for a port that is not simulated. */
+  QVector< int > historySlots;
+
+  void addProbe( QNEPort *port, LogicElement *elm, int index, bool input, int scope, const QString &name );
+  void addNestedProbes( const BoxMapping *boxMap, int scope );
+  void record( );
+  void appendHistory( );
+  signed char probeValue( const Probe &probe ) const;
+  void post( const Event &event );
+  void setInput( LogicElement *elm, bool value );
+  void restartClock( int clock, double frequency );
+  void drain( );
+  void setClock( uint32_t clock, bool value ) override;
+  uint64_t nextEvent( ) const override;
+  bool isSettled( ) const override;
+  void evaluate( ) override;
+  quint64 lastEvaluationCount( ) const;
+};
+
+#endif // SIMULATIONWORKER_H
@@ -0,0 +1,202 @@
+#include "truthtabledialog.h"
+
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QTableWidget>
+#include <QTabWidget>
+#include <QVBoxLayout>
+#include <cmath>
+
+const int TruthTableDialog::MAX_FULL_INPUTS = 12;
+const int TruthTableDialog::MAX_MAP_INPUTS = 4;
+
+static QTableWidgetItem* cell( const QString &text ) {
+  QTableWidgetItem *item = new QTableWidgetItem( text );
+  item->setTextAlignment( Qt::AlignCenter );
+  item->setFlags( Qt::ItemIsEnabled | Qt::ItemIsSelectable );
+  return( item );
+}
+
+static int gray( int value ) {
+  return( value ^ ( value >> 1 ) );
+}
+
+/* The bits of value, most significant first. */
+static QString bits( int value, int count ) {
+  QString text;
+  for( int bit = count - 1; bit >= 0; --bit ) {
+    text.append( ( value >> bit ) & 1 ? '1' : '0' );
+  }
+  return( text );
+}
+
+TruthTableDialog::TruthTableDialog( std::unique_ptr< CircuitBdd > bdd, QWidget *parent ) : QDialog( parent ),
+  bdd( std::move( bdd ) ) {
+  setWindowTitle( tr( "Truth Table" ) );
+  resize( 640, 480 );
+  outputBox = new QComboBox( this );
+  outputBox->addItems( this->bdd->outputNames( ) );
+  table = new QTableWidget( this );
+  table->verticalHeader( )->hide( );
+  mapLabel = new QLabel( this );
+  map = new QTableWidget( this );
+  QWidget *mapPage = new QWidget( this );
+  QVBoxLayout *mapLayout = new QVBoxLayout( mapPage );
+  mapLayout->addWidget( mapLabel );
+  mapLayout->addWidget( map );
+  expressions = new QPlainTextEdit( this );
+  expressions->setReadOnly( true );
+  tabs = new QTabWidget( this );
+  tabs->addTab( table, tr( "Truth table" ) );
+  tabs->addTab( mapPage, tr( "Karnaugh map" ) );
+  tabs->addTab( expressions, tr( "Expressions" ) );
+  QDialogButtonBox *buttons = new QDialogButtonBox( QDialogButtonBox::Close, this );
+  connect( buttons, &QDialogButtonBox::rejected, this, &QDialog::reject );
+
+  QHBoxLayout *outputLayout = new QHBoxLayout;
+  outputLayout->addWidget( new QLabel( tr( "Output:" ), this ) );
+  outputLayout->addWidget( outputBox, 1 );
+  QVBoxLayout *layout = new QVBoxLayout( this );
+  layout->addLayout( outputLayout );
+  layout->addWidget( tabs );
+  layout->addWidget( buttons );
+
+  if( this->bdd->inputCount( ) <= static_cast< size_t >( MAX_FULL_INPUTS ) ) {
+    fillTable( );
+  }
+  tabs->setTabEnabled( 1, this->bdd->inputCount( ) <= static_cast< size_t >( MAX_MAP_INPUTS ) );
+  fillExpressions( );
+  connect( outputBox, static_cast< void ( QComboBox::* )( int ) >( &QComboBox::currentIndexChanged ), this,
+           &TruthTableDialog::showOutput );
+  showOutput( 0 );
+}
+
+void TruthTableDialog::showOutput( int output ) {
+  if( ( output < 0 ) || ( static_cast< size_t >( output ) >= bdd->outputCount( ) ) ) {
+    return;
+  }
+  if( bdd->inputCount( ) > static_cast< size_t >( MAX_FULL_INPUTS ) ) {
+    fillCubes( output );
+  }
+  else {
+    table->selectColumn( static_cast< int >( bdd->inputCount( ) ) + output );
+  }
+  if( bdd->inputCount( ) <= static_cast< size_t >( MAX_MAP_INPUTS ) ) {
+    fillMap( output );
+  }
+}
+
+void TruthTableDialog::fillTable( ) {
+  const int inputs = static_cast< int >( bdd->inputCount( ) );
+  const int outputs = static_cast< int >( bdd->outputCount( ) );
+  const int rows = 1 << inputs;
+  table->setColumnCount( inputs + outputs );
+  table->setRowCount( rows );
+  table->setHorizontalHeaderLabels( bdd->inputNames( ) + bdd->outputNames( ) );
+  /* The first input is the most significant column, as in the waveform. */
+  for( int row = 0; row < rows; ++row ) {
+    for( int in = 0; in < inputs; ++in ) {
+      table->setItem( row, in, cell( QString::number( ( row >> ( inputs - 1 - in ) ) & 1 ) ) );
+    }
+    uint64_t vector = 0;
+    for( int in = 0; in < inputs; ++in ) {
+      vector |= static_cast< uint64_t >( ( row >> ( inputs - 1 - in ) ) & 1 ) << in;
+    }
+    for( int out = 0; out < outputs; ++out ) {
+      table->setItem( row, inputs + out, cell( bdd->value( static_cast< size_t >( out ), vector ) ? "1" : "0" ) );
+    }
+  }
+  table->resizeColumnsToContents( );
+}
+
+void TruthTableDialog::fillCubes( int output ) {
+  const std::vector< BddManager::Cube > cubes = bdd->manager( ).isop( bdd->output( static_cast< size_t >( output ) ) );
+  const int inputs = static_cast< int >( bdd->inputCount( ) );
+  table->clear( );
+  table->setColumnCount( inputs + 1 );
+  table->setRowCount( static_cast< int >( cubes.size( ) ) );
+  QStringList headers = bdd->inputNames( );
+  headers.append( outputBox->itemText( output ) );
+  table->setHorizontalHeaderLabels( headers );
+  /* Each row is a product of the sum, '-' marking the inputs it does not depend on. */
+  for( int row = 0; row < static_cast< int >( cubes.size( ) ); ++row ) {
+    for( int in = 0; in < inputs; ++in ) {
+      const signed char literal = cubes[ static_cast< size_t >( row ) ][ static_cast< size_t >( in ) ];
+      table->setItem( row, in, cell( literal < 0 ? "-" : QString::number( literal ) ) );
+    }
+    table->setItem( row, inputs, cell( "1" ) );
+  }
+  table->resizeColumnsToContents( );
+}
+
+void TruthTableDialog::fillMap( int output ) {
+  const int inputs = static_cast< int >( bdd->inputCount( ) );
+  /* The first inputs select the row, the others the column, both in Gray code so that neighbors differ in one
+   * input. */
+  const int rowInputs = inputs / 2;
+  const int columnInputs = inputs - rowInputs;
+  const int rows = 1 << rowInputs;
+  const int columns = 1 << columnInputs;
+  map->clear( );
+  map->setRowCount( rows );
+  map->setColumnCount( columns );
+  QStringList rowHeaders;
+  for( int row = 0; row < rows; ++row ) {
+    rowHeaders.append( bits( gray( row ), rowInputs ) );
+  }
+  QStringList columnHeaders;
+  for( int column = 0; column < columns; ++column ) {
+    columnHeaders.append( bits( gray( column ), columnInputs ) );
+  }
+  map->setVerticalHeaderLabels( rowHeaders );
+  map->setHorizontalHeaderLabels( columnHeaders );
+  for( int row = 0; row < rows; ++row ) {
+    for( int column = 0; column < columns; ++column ) {
+      uint64_t vector = 0;
+      for( int in = 0; in < rowInputs; ++in ) {
+        vector |= static_cast< uint64_t >( ( gray( row ) >> ( rowInputs - 1 - in ) ) & 1 ) << in;
+      }
+      for( int in = 0; in < columnInputs; ++in ) {
+        vector |= static_cast< uint64_t >( ( gray( column ) >> ( columnInputs - 1 - in ) ) & 1 ) << ( rowInputs + in );
+      }
+      map->setItem( row, column, cell( bdd->value( static_cast< size_t >( output ), vector ) ? "1" : "0" ) );
+    }
+  }
+  map->resizeColumnsToContents( );
+  const QStringList names = bdd->inputNames( );
+  mapLabel->setText( tr( "Rows: %1    Columns: %2" ).arg( names.mid( 0, rowInputs ).join( ' ' ) )
+                     .arg( names.mid( rowInputs ).join( ' ' ) ) );
+}
+
+void TruthTableDialog::fillExpressions( ) {
+  BddManager &manager = bdd->manager( );
+  const QStringList inputNames = bdd->inputNames( );
+  const double rows = std::ldexp( 1.0, static_cast< int >( bdd->inputCount( ) ) );
+  QString text;
+  for( size_t out = 0; out < bdd->outputCount( ); ++out ) {
+    const BddManager::Node node = bdd->output( out );
+    text += QString( "%1 = %2\n" ).arg( bdd->outputNames( )[ static_cast< int >( out ) ] )
+            .arg( bdd->sumOfProducts( out ) );
+    text += tr( "  True for %1 of %2 input vectors, %3 BDD nodes.\n" ).arg( manager.satCount( node ), 0, 'g', 16 )
+            .arg( rows, 0, 'g', 16 ).arg( static_cast< qulonglong >( manager.size( node ) ) );
+    std::vector< bool > values;
+    if( manager.minSat( node, values ) ) {
+      QStringList set;
+      for( size_t in = 0; in < values.size( ); ++in ) {
+        if( values[ in ] ) {
+          set.append( inputNames[ static_cast< int >( in ) ] );
+        }
+      }
+      text += tr( "  Fewest inputs that set it: %1\n" ).arg( set.isEmpty( ) ? tr( "none" ) : set.join( ", " ) );
+    }
+    else {
+      text += tr( "  Never true.\n" );
+    }
+    text += "\n";
+  }
+  expressions->setPlainText( text );
+}
@@ -0,0 +1,48 @@
+#ifndef TRUTHTABLEDIALOG_H
+#define TRUTHTABLEDIALOG_H
+
+#include "circuitbdd.h"
+
+#include <QDialog>
+#include <memory>
+
+class QComboBox;
+class QLabel;
+class QPlainTextEdit;
+class QTableWidget;
+class QTabWidget;
+
+/**
+ * @brief The TruthTableDialog class shows the truth table, the Karnaugh map
+ *        and a minimized sum of products of each output of a CircuitBdd.
+ *        Everything is read from the BDDs: past MAX_FULL_INPUTS inputs the
+ *        table lists the products of the selected output instead of every
+ *        row, and the map is only drawn up to MAX_MAP_INPUTS inputs.
+ */
+class TruthTableDialog : public QDialog {
+  Q_OBJECT
+public:
+  TruthTableDialog( std::unique_ptr< CircuitBdd > bdd, QWidget *parent = nullptr );
+
+  static const int MAX_FULL_INPUTS;
+  static const int MAX_MAP_INPUTS;
+
+private slots:
+  void showOutput( int output );
+
+private:
+  std::unique_ptr< CircuitBdd > bdd;
+  QComboBox *outputBox;
+  QTabWidget *tabs;
+  QTableWidget *table;
+  QLabel *mapLabel;
+  QTableWidget *map;
+  QPlainTextEdit *expressions;
+
+  void fillTable( );
+  void fillCubes( int output );
+  void fillMap( int output );
+  void fillExpressions( );
+};
+
+#endif // TRUTHTABLEDIALOG_H
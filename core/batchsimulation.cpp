@@ -0,0 +1,171 @@
+#include "batchsimulation.h"
+#include "circuitengine.h"
+#include "vcdwriter.h"
+
+#include <QRegularExpression>
+#include <QStringList>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+  QString pinName( const CircuitPin &pin, const QString &prefix, size_t index ) {
+    return( pin.label.isEmpty( ) ? prefix + QString::number( index ) : pin.label );
+  }
+}
+
+BatchSimulation::BatchSimulation( CircuitEngine &engine ) : engine( engine ), recorder( nullptr ), untilOutput( -1 ),
+  untilValue( false ) {
+}
+
+void BatchSimulation::readStimulus( QTextStream &in ) {
+  const QRegularExpression spaces( "\\s+" );
+  for( int lineNumber = 1; !in.atEnd( ); ++lineNumber ) {
+    const QStringList words = in.readLine( ).section( '#', 0, 0 ).split( spaces, QString::SkipEmptyParts );
+    if( words.isEmpty( ) ) {
+      continue;
+    }
+    try {
+      const uint64_t time = parseTime( words.first( ) );
+      for( int word = 1; word < words.size( ); ++word ) {
+        const QStringList parts = words[ word ].split( '=' );
+        if( ( parts.size( ) != 2 ) || ( ( parts[ 1 ] != "0" ) && ( parts[ 1 ] != "1" ) ) ) {
+          throw std::runtime_error( "invalid assignment \"" + words[ word ].toStdString( ) + "\"" );
+        }
+        const int input = engine.findInput( parts[ 0 ] );
+        if( input < 0 ) {
+          throw std::runtime_error( "unknown input \"" + parts[ 0 ].toStdString( ) + "\"" );
+        }
+        stimulus.push_back( { time, input, parts[ 1 ] == "1" } );
+      }
+    }
+    catch( std::runtime_error &e ) {
+      throw std::runtime_error( "Stimulus line " + std::to_string( lineNumber ) + ": " + e.what( ) + "." );
+    }
+  }
+  std::stable_sort( stimulus.begin( ), stimulus.end( ), []( const Assignment &a1, const Assignment &a2 ) {
+    return( a1.time < a2.time );
+  } );
+}
+
+void BatchSimulation::setUntil( const QString &label, bool value ) {
+  untilOutput = engine.findOutput( label );
+  untilValue = value;
+  if( untilOutput < 0 ) {
+    throw std::runtime_error( "Unknown output \"" + label.toStdString( ) + "\"." );
+  }
+}
+
+void BatchSimulation::setRecorder( VcdWriter *vcd ) {
+  recorder = vcd;
+  if( !vcd ) {
+    return;
+  }
+  /* Scope and variable indices follow those of the engine, after the top scope. */
+  vcd->addScope( "circuit" );
+  for( const CircuitScope &scope : engine.scopes( ) ) {
+    vcd->addScope( scope.name, scope.parent < 0 ? 0 : scope.parent + 1 );
+  }
+  for( const CircuitProbe &probe : engine.probes( ) ) {
+    vcd->addVariable( probe.scope < 0 ? 0 : probe.scope + 1, probe.name );
+  }
+}
+
+bool BatchSimulation::run( uint64_t cycles, QTextStream &out ) {
+  writeHeader( out );
+  auto next = std::lower_bound( stimulus.begin( ), stimulus.end( ), engine.time( ),
+                                []( const Assignment &assignment, uint64_t time ) {
+    return( assignment.time < time );
+  } );
+  const uint64_t first = ( engine.time( ) + TICK - 1 ) / TICK;
+  for( uint64_t cycle = first; cycle < first + cycles; ++cycle ) {
+    const uint64_t start = cycle * TICK;
+    /* Assignments between two cycles happen at their own time, so that the clocks and delays in between see them. */
+    for( ; ( next != stimulus.end( ) ) && ( next->time <= start ); ++next ) {
+      advanceTo( next->time );
+      engine.setInput( next->input, next->value );
+    }
+    advanceTo( start );
+    writeValues( cycle, out );
+    if( ( untilOutput >= 0 ) && engine.isValid( untilOutput ) && ( engine.outputValue( untilOutput ) == untilValue ) ) {
+      return( true );
+    }
+  }
+  return( untilOutput < 0 );
+}
+
+uint64_t BatchSimulation::parseTime( const QString &text ) {
+  static const QRegularExpression format( "^(\\d+(?:\\.\\d+)?)(ns|us|ms|s)?$" );
+  const QRegularExpressionMatch match = format.match( text );
+  if( !match.hasMatch( ) ) {
+    throw std::runtime_error( "invalid time \"" + text.toStdString( ) + "\"" );
+  }
+  const QString unit = match.captured( 2 );
+  if( unit.isEmpty( ) ) {
+    bool ok;
+    const uint64_t cycle = match.captured( 1 ).toULongLong( &ok );
+    if( !ok ) {
+      throw std::runtime_error( "a cycle must be a whole number" );
+    }
+    return( cycle * TICK );
+  }
+  const double scale = unit == "ns" ? 1.0 : unit == "us" ? 1e3 : unit == "ms" ? 1e6 : 1e9;
+  return( static_cast< uint64_t >( match.captured( 1 ).toDouble( ) * scale + 0.5 ) );
+}
+
+void BatchSimulation::advanceTo( uint64_t time ) {
+  if( recorder ) {
+    for( uint64_t next = engine.nextEvaluation( ); ( next != ClockScheduler::NEVER ) && ( next <= time );
+         next = engine.nextEvaluation( ) ) {
+      engine.advanceTo( next );
+      record( );
+    }
+  }
+  engine.advanceTo( time );
+}
+
+void BatchSimulation::record( ) {
+  const std::vector< CircuitProbe > &probes = engine.probes( );
+  for( uint32_t probe = 0; probe < probes.size( ); ++probe ) {
+    recorder->change( engine.time( ), probe, engine.signalValue( probes[ probe ].signal ) ? 1 : 0 );
+  }
+}
+
+void BatchSimulation::writeHeader( QTextStream &out ) const {
+  out << "cycle time";
+  const std::vector< CircuitPin > &inputs = engine.inputs( );
+  for( size_t input = 0; input < inputs.size( ); ++input ) {
+    out << " " << pinName( inputs[ input ], "in", input );
+  }
+  const std::vector< CircuitPin > &outputs = engine.outputs( );
+  for( size_t output = 0; output < outputs.size( ); ++output ) {
+    const QString name = pinName( outputs[ output ], "out", output );
+    const size_t ports = outputs[ output ].signals.size( );
+    if( ports == 1 ) {
+      out << " " << name;
+      continue;
+    }
+    for( size_t port = 0; port < ports; ++port ) {
+      out << " " << name << "[" << port << "]";
+    }
+  }
+  out << "\n";
+}
+
+void BatchSimulation::writeValues( uint64_t cycle, QTextStream &out ) const {
+  out << cycle << " " << engine.time( );
+  for( size_t input = 0; input < engine.inputs( ).size( ); ++input ) {
+    out << " " << ( engine.inputValue( static_cast< int >( input ) ) ? 1 : 0 );
+  }
+  for( size_t output = 0; output < engine.outputs( ).size( ); ++output ) {
+    const bool valid = engine.isValid( static_cast< int >( output ) );
+    for( size_t port = 0; port < engine.outputs( )[ output ].signals.size( ); ++port ) {
+      if( valid ) {
+        out << " " << ( engine.outputValue( static_cast< int >( output ), static_cast< int >( port ) ) ? 1 : 0 );
+      }
+      else {
+        out << " x";
+      }
+    }
+  }
+  out << "\n";
+}
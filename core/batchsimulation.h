@@ -0,0 +1,73 @@
+#ifndef BATCHSIMULATION_H
+#define BATCHSIMULATION_H
+
+#include <QString>
+#include <QTextStream>
+#include <vector>
+
+class CircuitEngine;
+class VcdWriter;
+
+/**
+ * @brief The BatchSimulation class drives a CircuitEngine from a stimulus
+ *        script and writes the values it observes, one line per cycle, a
+ *        cycle being a GLOBALCLK tick. Each line of a script gives when its
+ *        assignments happen, then the assignments themselves:
+ *
+ *            # comments start with a hash
+ *            0      A=0 B=1
+ *            4      A=1
+ *            2500us B=0
+ *
+ *        The time is either a cycle number or a time with a unit among ns,
+ *        us, ms and s. Inputs are found by label, so the labels used cannot
+ *        hold spaces or '='. Errors throw a std::runtime_error.
+ */
+class BatchSimulation {
+public:
+  explicit BatchSimulation( CircuitEngine &engine );
+
+  void readStimulus( QTextStream &in );
+
+  /**
+   * @brief setUntil stops the run after the first cycle in which the output
+   *        with the given label reads value.
+   */
+  void setUntil( const QString &label, bool value );
+
+  /**
+   * @brief setRecorder declares the scopes and probes of the engine in vcd,
+   *        which must be new and not open yet, and reports their values to it after
+   *        every evaluation of the following runs.
+   */
+  void setRecorder( VcdWriter *vcd );
+
+  /**
+   * @brief run simulates up to cycles cycles from the current state of the
+   *        engine, and returns false if a condition was set but never met.
+   *        Ports that are not valid are written as 'x'.
+   */
+  bool run( uint64_t cycles, QTextStream &out );
+
+private:
+  struct Assignment {
+    uint64_t time;
+    int input;
+    bool value;
+  };
+
+  CircuitEngine &engine;
+  VcdWriter *recorder;
+  /* Sorted by time, assignments at the same time keep the script order. */
+  std::vector< Assignment > stimulus;
+  int untilOutput;
+  bool untilValue;
+
+  static uint64_t parseTime( const QString &text );
+  void advanceTo( uint64_t time );
+  void record( );
+  void writeHeader( QTextStream &out ) const;
+  void writeValues( uint64_t cycle, QTextStream &out ) const;
+};
+
+#endif // BATCHSIMULATION_H
@@ -0,0 +1,510 @@
+#include "bddmanager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+  /* The variable of the terminals, and of the nodes in the free list. */
+  const uint32_t TERMINAL = UINT32_MAX;
+  const uint32_t FREE = UINT32_MAX - 1;
+  const BddManager::Node NONE = UINT32_MAX;
+  const size_t INITIAL_BUCKETS = 16;
+  const size_t CACHE_SIZE = 1 << 18;
+  /* How many nodes there must be before the first collection or automatic reordering. */
+  const size_t INITIAL_THRESHOLD = 1 << 14;
+}
+
+const BddManager::Node BddManager::ZERO;
+const BddManager::Node BddManager::ONE;
+
+BddManager::BddManager( uint32_t variables ) : freeList( NONE ), liveNodes( 0 ),
+  reorderThreshold( INITIAL_THRESHOLD ), autoReorder( false ) {
+  nodes.push_back( { TERMINAL, ZERO, ZERO, UINT32_MAX, NONE } );
+  nodes.push_back( { TERMINAL, ONE, ONE, UINT32_MAX, NONE } );
+  clearCache( );
+  for( uint32_t var = 0; var < variables; ++var ) {
+    addVariable( );
+  }
+}
+
+uint32_t BddManager::addVariable( ) {
+  const uint32_t var = static_cast< uint32_t >( tables.size( ) );
+  tables.push_back( { std::vector< Node >( INITIAL_BUCKETS, NONE ), 0 } );
+  levels.push_back( static_cast< uint32_t >( order.size( ) ) );
+  order.push_back( var );
+  const Node node = makeNode( var, ZERO, ONE );
+  ref( node );
+  variables.push_back( node );
+  return( var );
+}
+
+uint32_t BddManager::variableCount( ) const {
+  return( static_cast< uint32_t >( tables.size( ) ) );
+}
+
+BddManager::Node BddManager::variable( uint32_t var ) const {
+  return( variables[ var ] );
+}
+
+BddManager::Node BddManager::ite( Node f, Node g, Node h ) {
+  if( f == ONE ) {
+    return( g );
+  }
+  if( f == ZERO ) {
+    return( h );
+  }
+  if( g == f ) {
+    g = ONE;
+  }
+  if( h == f ) {
+    h = ZERO;
+  }
+  if( g == h ) {
+    return( g );
+  }
+  if( ( g == ONE ) && ( h == ZERO ) ) {
+    return( f );
+  }
+  const size_t slot = ( f * 12582917u + g * 4256249u + h * 741457u ) & ( cache.size( ) - 1 );
+  const CacheEntry &entry = cache[ slot ];
+  if( ( entry.f == f ) && ( entry.g == g ) && ( entry.h == h ) ) {
+    return( entry.result );
+  }
+  const uint32_t var = order[ std::min( nodeLevel( f ), std::min( nodeLevel( g ), nodeLevel( h ) ) ) ];
+  const Node t = ite( cofactor( f, var, true ), cofactor( g, var, true ), cofactor( h, var, true ) );
+  const Node e = ite( cofactor( f, var, false ), cofactor( g, var, false ), cofactor( h, var, false ) );
+  const Node result = makeNode( var, e, t );
+  cache[ slot ] = { f, g, h, result };
+  return( result );
+}
+
+BddManager::Node BddManager::bddNot( Node f ) {
+  return( ite( f, ZERO, ONE ) );
+}
+
+BddManager::Node BddManager::bddAnd( Node f, Node g ) {
+  return( ite( f, g, ZERO ) );
+}
+
+BddManager::Node BddManager::bddOr( Node f, Node g ) {
+  return( ite( f, ONE, g ) );
+}
+
+BddManager::Node BddManager::bddXor( Node f, Node g ) {
+  return( ite( f, bddNot( g ), g ) );
+}
+
+void BddManager::ref( Node f ) {
+  if( !isConstant( f ) ) {
+    ++nodes[ f ].refs;
+  }
+}
+
+void BddManager::deref( Node f ) {
+  if( !isConstant( f ) ) {
+    --nodes[ f ].refs;
+  }
+}
+
+bool BddManager::isConstant( Node f ) const {
+  return( f <= ONE );
+}
+
+uint32_t BddManager::topVariable( Node f ) const {
+  return( nodes[ f ].var );
+}
+
+BddManager::Node BddManager::low( Node f ) const {
+  return( nodes[ f ].low );
+}
+
+BddManager::Node BddManager::high( Node f ) const {
+  return( nodes[ f ].high );
+}
+
+uint32_t BddManager::level( uint32_t var ) const {
+  return( levels[ var ] );
+}
+
+uint32_t BddManager::variableAt( uint32_t level ) const {
+  return( order[ level ] );
+}
+
+size_t BddManager::nodeCount( ) const {
+  return( liveNodes );
+}
+
+size_t BddManager::size( Node f ) const {
+  std::vector< bool > visited( nodes.size( ), false );
+  std::vector< Node > stack( 1, f );
+  size_t count = 0;
+  while( !stack.empty( ) ) {
+    const Node node = stack.back( );
+    stack.pop_back( );
+    if( visited[ node ] ) {
+      continue;
+    }
+    visited[ node ] = true;
+    ++count;
+    if( !isConstant( node ) ) {
+      stack.push_back( nodes[ node ].low );
+      stack.push_back( nodes[ node ].high );
+    }
+  }
+  return( count );
+}
+
+bool BddManager::evaluate( Node f, const std::vector< bool > &values ) const {
+  while( !isConstant( f ) ) {
+    f = values[ nodes[ f ].var ] ? nodes[ f ].high : nodes[ f ].low;
+  }
+  return( f == ONE );
+}
+
+double BddManager::satCount( Node f ) const {
+  /* The fraction of the assignments below each node that reach ONE. */
+  std::unordered_map< Node, double > fractions;
+  fractions[ ZERO ] = 0.0;
+  fractions[ ONE ] = 1.0;
+  std::vector< Node > stack( 1, f );
+  while( !stack.empty( ) ) {
+    const Node node = stack.back( );
+    if( fractions.count( node ) ) {
+      stack.pop_back( );
+      continue;
+    }
+    const auto low = fractions.find( nodes[ node ].low );
+    const auto high = fractions.find( nodes[ node ].high );
+    if( ( low != fractions.end( ) ) && ( high != fractions.end( ) ) ) {
+      fractions[ node ] = ( low->second + high->second ) / 2.0;
+      stack.pop_back( );
+      continue;
+    }
+    if( low == fractions.end( ) ) {
+      stack.push_back( nodes[ node ].low );
+    }
+    if( high == fractions.end( ) ) {
+      stack.push_back( nodes[ node ].high );
+    }
+  }
+  return( std::ldexp( fractions[ f ], static_cast< int >( variableCount( ) ) ) );
+}
+
+bool BddManager::minSat( Node f, std::vector< bool > &values ) const {
+  /* The fewest variables to set to reach ONE from each node. */
+  std::unordered_map< Node, uint32_t > costs;
+  costs[ ZERO ] = UINT32_MAX;
+  costs[ ONE ] = 0;
+  std::vector< Node > stack( 1, f );
+  while( !stack.empty( ) ) {
+    const Node node = stack.back( );
+    if( costs.count( node ) ) {
+      stack.pop_back( );
+      continue;
+    }
+    const auto low = costs.find( nodes[ node ].low );
+    const auto high = costs.find( nodes[ node ].high );
+    if( ( low != costs.end( ) ) && ( high != costs.end( ) ) ) {
+      costs[ node ] = std::min( low->second, high->second == UINT32_MAX ? UINT32_MAX : high->second + 1 );
+      stack.pop_back( );
+      continue;
+    }
+    if( low == costs.end( ) ) {
+      stack.push_back( nodes[ node ].low );
+    }
+    if( high == costs.end( ) ) {
+      stack.push_back( nodes[ node ].high );
+    }
+  }
+  values.assign( variableCount( ), false );
+  if( costs[ f ] == UINT32_MAX ) {
+    return( false );
+  }
+  while( !isConstant( f ) ) {
+    const uint32_t lowCost = costs[ nodes[ f ].low ];
+    const uint32_t highCost = costs[ nodes[ f ].high ];
+    if( ( highCost != UINT32_MAX ) && ( ( lowCost == UINT32_MAX ) || ( highCost + 1 < lowCost ) ) ) {
+      values[ nodes[ f ].var ] = true;
+      f = nodes[ f ].high;
+    }
+    else {
+      f = nodes[ f ].low;
+    }
+  }
+  return( true );
+}
+
+std::vector< BddManager::Cube > BddManager::isop( Node f ) {
+  Cube cube( variableCount( ), -1 );
+  std::vector< Cube > cover;
+  isop( f, f, cube, cover );
+  return( cover );
+}
+
+BddManager::Node BddManager::isop( Node lower, Node upper, Cube &cube, std::vector< Cube > &cover ) {
+  if( lower == ZERO ) {
+    return( ZERO );
+  }
+  if( upper == ONE ) {
+    cover.push_back( cube );
+    return( ONE );
+  }
+  const uint32_t var = order[ std::min( nodeLevel( lower ), nodeLevel( upper ) ) ];
+  const Node lower0 = cofactor( lower, var, false );
+  const Node lower1 = cofactor( lower, var, true );
+  const Node upper0 = cofactor( upper, var, false );
+  const Node upper1 = cofactor( upper, var, true );
+  /* The products that need the literal, then those that do not. */
+  cube[ var ] = 0;
+  const Node cover0 = isop( bddAnd( lower0, bddNot( upper1 ) ), upper0, cube, cover );
+  cube[ var ] = 1;
+  const Node cover1 = isop( bddAnd( lower1, bddNot( upper0 ) ), upper1, cube, cover );
+  cube[ var ] = -1;
+  const Node rest = bddOr( bddAnd( lower0, bddNot( cover0 ) ), bddAnd( lower1, bddNot( cover1 ) ) );
+  const Node coverRest = isop( rest, bddAnd( upper0, upper1 ), cube, cover );
+  return( bddOr( ite( variables[ var ], cover1, cover0 ), coverRest ) );
+}
+
+void BddManager::reorder( ) {
+  garbageCollect( );
+  std::vector< uint32_t > vars( order );
+  std::stable_sort( vars.begin( ), vars.end( ), [ this ]( uint32_t var1, uint32_t var2 ) {
+    return( tables[ var1 ].count > tables[ var2 ].count );
+  } );
+  for( uint32_t var : vars ) {
+    sift( var );
+  }
+  clearCache( );
+  reorderThreshold = std::max( INITIAL_THRESHOLD, 2 * liveNodes );
+}
+
+void BddManager::setAutoReorder( bool enabled ) {
+  autoReorder = enabled;
+}
+
+void BddManager::checkpoint( ) {
+  if( liveNodes < reorderThreshold ) {
+    return;
+  }
+  if( autoReorder ) {
+    reorder( );
+  }
+  else {
+    garbageCollect( );
+    reorderThreshold = std::max( INITIAL_THRESHOLD, 2 * liveNodes );
+  }
+}
+
+void BddManager::garbageCollect( ) {
+  /* Top down, so that the children of a dead node are visited after it lost its references. */
+  for( uint32_t var : order ) {
+    Subtable &table = tables[ var ];
+    for( Node &bucket : table.buckets ) {
+      Node *link = &bucket;
+      while( *link != NONE ) {
+        const Node node = *link;
+        if( nodes[ node ].refs > 0 ) {
+          link = &nodes[ node ].next;
+          continue;
+        }
+        *link = nodes[ node ].next;
+        --table.count;
+        deref( nodes[ node ].low );
+        deref( nodes[ node ].high );
+        nodes[ node ].var = FREE;
+        nodes[ node ].next = freeList;
+        freeList = node;
+        --liveNodes;
+      }
+    }
+  }
+  clearCache( );
+}
+
+uint32_t BddManager::nodeLevel( Node f ) const {
+  return( isConstant( f ) ? TERMINAL : levels[ nodes[ f ].var ] );
+}
+
+BddManager::Node BddManager::cofactor( Node f, uint32_t var, bool value ) const {
+  if( nodes[ f ].var != var ) {
+    return( f );
+  }
+  return( value ? nodes[ f ].high : nodes[ f ].low );
+}
+
+BddManager::Node BddManager::makeNode( uint32_t var, Node low, Node high ) {
+  if( low == high ) {
+    return( low );
+  }
+  const Subtable &table = tables[ var ];
+  for( Node node = table.buckets[ hash( low, high ) & ( table.buckets.size( ) - 1 ) ]; node != NONE;
+       node = nodes[ node ].next ) {
+    if( ( nodes[ node ].low == low ) && ( nodes[ node ].high == high ) ) {
+      return( node );
+    }
+  }
+  Node node = freeList;
+  if( node != NONE ) {
+    freeList = nodes[ node ].next;
+    nodes[ node ] = { var, low, high, 0, NONE };
+  }
+  else {
+    node = static_cast< Node >( nodes.size( ) );
+    nodes.push_back( { var, low, high, 0, NONE } );
+  }
+  ref( low );
+  ref( high );
+  insert( node );
+  ++liveNodes;
+  return( node );
+}
+
+void BddManager::insert( Node f ) {
+  Subtable &table = tables[ nodes[ f ].var ];
+  if( table.count >= 2 * table.buckets.size( ) ) {
+    resize( table );
+  }
+  Node &bucket = table.buckets[ hash( nodes[ f ].low, nodes[ f ].high ) & ( table.buckets.size( ) - 1 ) ];
+  nodes[ f ].next = bucket;
+  bucket = f;
+  ++table.count;
+}
+
+void BddManager::unlink( Node f ) {
+  Subtable &table = tables[ nodes[ f ].var ];
+  Node *link = &table.buckets[ hash( nodes[ f ].low, nodes[ f ].high ) & ( table.buckets.size( ) - 1 ) ];
+  while( *link != f ) {
+    link = &nodes[ *link ].next;
+  }
+  *link = nodes[ f ].next;
+  --table.count;
+}
+
+void BddManager::release( Node f ) {
+  if( isConstant( f ) || ( --nodes[ f ].refs > 0 ) ) {
+    return;
+  }
+  unlink( f );
+  const Node low = nodes[ f ].low;
+  const Node high = nodes[ f ].high;
+  nodes[ f ].var = FREE;
+  nodes[ f ].next = freeList;
+  freeList = f;
+  --liveNodes;
+  release( low );
+  release( high );
+}
+
+void BddManager::resize( Subtable &table ) {
+  std::vector< Node > buckets( table.buckets.size( ) * 2, NONE );
+  for( Node bucket : table.buckets ) {
+    for( Node node = bucket; node != NONE; ) {
+      const Node next = nodes[ node ].next;
+      Node &head = buckets[ hash( nodes[ node ].low, nodes[ node ].high ) & ( buckets.size( ) - 1 ) ];
+      nodes[ node ].next = head;
+      head = node;
+      node = next;
+    }
+  }
+  table.buckets.swap( buckets );
+}
+
+void BddManager::clearCache( ) {
+  cache.assign( CACHE_SIZE, { NONE, NONE, NONE, NONE } );
+}
+
+void BddManager::swapLevels( uint32_t level ) {
+  const uint32_t x = order[ level ];
+  const uint32_t y = order[ level + 1 ];
+  /* Only the nodes of x with a child on y change: they become nodes of y over new nodes of x. The others keep their
+   * place, as their children are below both levels. */
+  std::vector< Node > moved;
+  Subtable &table = tables[ x ];
+  for( Node &bucket : table.buckets ) {
+    Node *link = &bucket;
+    while( *link != NONE ) {
+      const Node node = *link;
+      if( ( nodes[ nodes[ node ].low ].var == y ) || ( nodes[ nodes[ node ].high ].var == y ) ) {
+        *link = nodes[ node ].next;
+        --table.count;
+        moved.push_back( node );
+      }
+      else {
+        link = &nodes[ node ].next;
+      }
+    }
+  }
+  for( Node f : moved ) {
+    const Node f0 = nodes[ f ].low;
+    const Node f1 = nodes[ f ].high;
+    const Node f00 = cofactor( f0, y, false );
+    const Node f01 = cofactor( f0, y, true );
+    const Node f10 = cofactor( f1, y, false );
+    const Node f11 = cofactor( f1, y, true );
+    const Node low = makeNode( x, f00, f10 );
+    ref( low );
+    const Node high = makeNode( x, f01, f11 );
+    ref( high );
+    nodes[ f ].var = y;
+    nodes[ f ].low = low;
+    nodes[ f ].high = high;
+    insert( f );
+    release( f0 );
+    release( f1 );
+  }
+  order[ level ] = y;
+  order[ level + 1 ] = x;
+  levels[ x ] = level + 1;
+  levels[ y ] = level;
+}
+
+void BddManager::sift( uint32_t var ) {
+  const uint32_t bottom = static_cast< uint32_t >( order.size( ) ) - 1;
+  size_t best = liveNodes;
+  uint32_t bestLevel = levels[ var ];
+  /* A direction is abandoned once the diagrams grew by a fifth over the best size. */
+  auto keep = [ this, var, &best, &bestLevel ]( ) {
+    if( liveNodes < best ) {
+      best = liveNodes;
+      bestLevel = levels[ var ];
+    }
+    return( liveNodes * 5 <= best * 6 );
+  };
+  auto down = [ this, var, bottom, &keep ]( ) {
+    while( ( levels[ var ] < bottom ) ) {
+      swapLevels( levels[ var ] );
+      if( !keep( ) ) {
+        break;
+      }
+    }
+  };
+  auto up = [ this, var, &keep ]( ) {
+    while( levels[ var ] > 0 ) {
+      swapLevels( levels[ var ] - 1 );
+      if( !keep( ) ) {
+        break;
+      }
+    }
+  };
+  /* The nearer end first. */
+  if( levels[ var ] * 2 > bottom ) {
+    down( );
+    up( );
+  }
+  else {
+    up( );
+    down( );
+  }
+  while( levels[ var ] < bestLevel ) {
+    swapLevels( levels[ var ] );
+  }
+  while( levels[ var ] > bestLevel ) {
+    swapLevels( levels[ var ] - 1 );
+  }
+}
+
+size_t BddManager::hash( Node low, Node high ) {
+  const uint64_t value = ( uint64_t( low ) * 0x9E3779B97F4A7C15ull ) ^ ( uint64_t( high ) * 0xC2B2AE3D27D4EB4Full );
+  return( static_cast< size_t >( value ^ ( value >> 32 ) ) );
+}
@@ -0,0 +1,155 @@
+#ifndef BDDMANAGER_H
+#define BDDMANAGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The BddManager class builds reduced ordered binary decision
+ *        diagrams. Nodes are shared through one unique table per variable,
+ *        so that equal functions are the same node, and the results of ite( )
+ *        are kept in a computed cache. The variable order may be improved by
+ *        sifting, which moves each variable to the level where the diagrams
+ *        are smallest by swapping adjacent levels in place: nodes keep their
+ *        meaning, so references stay valid across reorder( ).
+ *
+ *        Nodes are reference counted. Results are returned unreferenced, and
+ *        stay valid until the next garbage collection, which only happens in
+ *        reorder( ), checkpoint( ) and garbageCollect( ): every node needed
+ *        after those must be referenced with ref( ) first.
+ */
+class BddManager {
+public:
+  typedef uint32_t Node;
+
+  static const Node ZERO = 0;
+  static const Node ONE = 1;
+
+  /**
+   * @brief A Cube is a product of literals, with one entry per variable: 0
+   *        or 1 for a variable that must take that value, -1 for a variable
+   *        the product does not depend on.
+   */
+  typedef std::vector< signed char > Cube;
+
+  explicit BddManager( uint32_t variables = 0 );
+
+  uint32_t addVariable( );
+  uint32_t variableCount( ) const;
+  Node variable( uint32_t var ) const;
+
+  Node ite( Node f, Node g, Node h );
+  Node bddNot( Node f );
+  Node bddAnd( Node f, Node g );
+  Node bddOr( Node f, Node g );
+  Node bddXor( Node f, Node g );
+
+  void ref( Node f );
+  void deref( Node f );
+
+  bool isConstant( Node f ) const;
+  uint32_t topVariable( Node f ) const;
+  Node low( Node f ) const;
+  Node high( Node f ) const;
+
+  /**
+   * @brief level returns the position of a variable in the current order,
+   *        0 being the root.
+   */
+  uint32_t level( uint32_t var ) const;
+  uint32_t variableAt( uint32_t level ) const;
+
+  /**
+   * @brief nodeCount returns the number of nodes in the unique tables, and
+   *        size the number of nodes of one diagram, terminals included.
+   */
+  size_t nodeCount( ) const;
+  size_t size( Node f ) const;
+
+  /**
+   * @brief evaluate follows f along values, indexed by variable.
+   */
+  bool evaluate( Node f, const std::vector< bool > &values ) const;
+
+  /**
+   * @brief satCount returns how many assignments of all the variables make
+   *        f true. It is exact up to 2^53.
+   */
+  double satCount( Node f ) const;
+
+  /**
+   * @brief minSat finds an assignment that makes f true with the fewest
+   *        variables set, and returns false when f is unsatisfiable.
+   */
+  bool minSat( Node f, std::vector< bool > &values ) const;
+
+  /**
+   * @brief isop returns an irredundant sum of products of f, following
+   *        Minato and Morreale: no product or literal can be removed without
+   *        changing the function.
+   */
+  std::vector< Cube > isop( Node f );
+
+  /**
+   * @brief reorder sifts every variable, largest levels first, and keeps the
+   *        order with the fewest nodes.
+   */
+  void reorder( );
+
+  /**
+   * @brief setAutoReorder makes checkpoint( ) sift whenever the number of
+   *        nodes doubled since the last reordering.
+   */
+  void setAutoReorder( bool enabled );
+  void checkpoint( );
+  void garbageCollect( );
+
+private:
+  struct BddNode {
+    uint32_t var;
+    Node low;
+    Node high;
+    uint32_t refs;
+    /* The next node of the same bucket, or of the free list. */
+    Node next;
+  };
+
+  struct Subtable {
+    std::vector< Node > buckets;
+    size_t count;
+  };
+
+  struct CacheEntry {
+    Node f;
+    Node g;
+    Node h;
+    Node result;
+  };
+
+  std::vector< BddNode > nodes;
+  std::vector< Subtable > tables;
+  std::vector< uint32_t > levels;
+  std::vector< uint32_t > order;
+  std::vector< Node > variables;
+  std::vector< CacheEntry > cache;
+  Node freeList;
+  size_t liveNodes;
+  size_t reorderThreshold;
+  bool autoReorder;
+
+  uint32_t nodeLevel( Node f ) const;
+  Node cofactor( Node f, uint32_t var, bool value ) const;
+  Node makeNode( uint32_t var, Node low, Node high );
+  void insert( Node f );
+  void unlink( Node f );
+  void release( Node f );
+  void resize( Subtable &table );
+  void clearCache( );
+  void swapLevels( uint32_t level );
+  void sift( uint32_t var );
+  Node isop( Node lower, Node upper, Cube &cube, std::vector< Cube > &cover );
+  static size_t hash( Node low, Node high );
+};
+
+#endif // BDDMANAGER_H
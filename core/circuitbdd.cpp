@@ -0,0 +1,251 @@
+#include "circuitbdd.h"
+#include "circuitengine.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace {
+  const BddManager::Node UNSET = UINT32_MAX;
+}
+
+CircuitBdd::CircuitBdd( ) : nodeLimit( 0 ) {
+}
+
+CircuitBdd::CircuitBdd( const Netlist &netlist, const std::vector< uint32_t > &inputs,
+                        const std::vector< uint32_t > &outputs ) : nodeLimit( 0 ) {
+  addCircuit( netlist, inputs, outputs );
+  QStringList inputNames, outputNames;
+  for( size_t input = 0; input < inputs.size( ); ++input ) {
+    inputNames.append( QString( "in%1" ).arg( input ) );
+  }
+  for( size_t output = 0; output < outputs.size( ); ++output ) {
+    outputNames.append( QString( "out%1" ).arg( output ) );
+  }
+  setNames( inputNames, outputNames );
+}
+
+CircuitBdd::CircuitBdd( const CircuitEngine &engine ) : nodeLimit( 0 ) {
+  std::vector< uint32_t > inputs;
+  QStringList inputNames;
+  for( size_t input = 0; input < engine.inputs( ).size( ); ++input ) {
+    const CircuitPin &pin = engine.inputs( )[ input ];
+    inputs.push_back( pin.signals[ 0 ] );
+    inputNames.append( pin.label.isEmpty( ) ? QString( "in%1" ).arg( input ) : pin.label );
+  }
+  std::vector< uint32_t > outputSignals;
+  QStringList outputNames;
+  for( size_t output = 0; output < engine.outputs( ).size( ); ++output ) {
+    const CircuitPin &pin = engine.outputs( )[ output ];
+    const QString name = pin.label.isEmpty( ) ? QString( "out%1" ).arg( output ) : pin.label;
+    if( !engine.isValid( static_cast< int >( output ) ) ) {
+      throw std::runtime_error( "Output " + name.toStdString( ) + " is not connected." );
+    }
+    for( size_t port = 0; port < pin.signals.size( ); ++port ) {
+      outputSignals.push_back( pin.signals[ port ] );
+      outputNames.append( pin.signals.size( ) == 1 ? name : QString( "%1[%2]" ).arg( name ).arg( port ) );
+    }
+  }
+  addCircuit( engine.getNetlist( ), inputs, outputSignals );
+  setNames( inputNames, outputNames );
+}
+
+BddManager &CircuitBdd::manager( ) {
+  return( bdd );
+}
+
+size_t CircuitBdd::inputCount( ) const {
+  return( bdd.variableCount( ) );
+}
+
+size_t CircuitBdd::outputCount( ) const {
+  return( outputs.size( ) );
+}
+
+BddManager::Node CircuitBdd::output( size_t index ) const {
+  return( outputs[ index ] );
+}
+
+const QStringList &CircuitBdd::inputNames( ) const {
+  return( m_inputNames );
+}
+
+const QStringList &CircuitBdd::outputNames( ) const {
+  return( m_outputNames );
+}
+
+void CircuitBdd::setNodeLimit( size_t nodes ) {
+  nodeLimit = nodes;
+}
+
+void CircuitBdd::setNames( const QStringList &inputs, const QStringList &outputs ) {
+  m_inputNames = inputs;
+  m_outputNames = outputs;
+}
+
+bool CircuitBdd::value( size_t output, uint64_t row ) const {
+  std::vector< bool > values( inputCount( ) );
+  for( size_t input = 0; input < values.size( ); ++input ) {
+    values[ input ] = ( row >> input ) & 1;
+  }
+  return( bdd.evaluate( outputs[ output ], values ) );
+}
+
+QString CircuitBdd::sumOfProducts( size_t output ) {
+  if( outputs[ output ] == BddManager::ZERO ) {
+    return( "0" );
+  }
+  if( outputs[ output ] == BddManager::ONE ) {
+    return( "1" );
+  }
+  QStringList products;
+  for( const BddManager::Cube &cube : bdd.isop( outputs[ output ] ) ) {
+    QStringList literals;
+    for( size_t input = 0; input < cube.size( ); ++input ) {
+      if( cube[ input ] >= 0 ) {
+        literals.append( m_inputNames[ static_cast< int >( input ) ] + ( cube[ input ] ? "" : "'" ) );
+      }
+    }
+    products.append( literals.join( "·" ) );
+  }
+  return( products.join( " + " ) );
+}
+
+void CircuitBdd::addCircuit( const Netlist &netlist, const std::vector< uint32_t > &inputs,
+                             const std::vector< uint32_t > &outputSignals ) {
+  if( !netlist.isCombinational( ) ) {
+    throw std::runtime_error( "The circuit has memory elements or feedback loops." );
+  }
+  /* The gates that reach an output, and how many times each signal is read by them. */
+  std::vector< bool > needed( netlist.gateCount( ), false );
+  std::vector< uint32_t > readers( netlist.signalCount( ), 0 );
+  std::vector< uint32_t > stack;
+  for( uint32_t signal : outputSignals ) {
+    stack.push_back( netlist.drivers[ signal ] );
+  }
+  while( !stack.empty( ) ) {
+    const uint32_t gate = stack.back( );
+    stack.pop_back( );
+    if( needed[ gate ] ) {
+      continue;
+    }
+    needed[ gate ] = true;
+    for( uint32_t idx = netlist.faninBegin[ gate ]; idx < netlist.faninBegin[ gate + 1 ]; ++idx ) {
+      ++readers[ netlist.fanins[ idx ] ];
+      stack.push_back( netlist.drivers[ netlist.fanins[ idx ] ] );
+    }
+  }
+  for( uint32_t signal : outputSignals ) {
+    ++readers[ signal ];
+  }
+
+  while( bdd.variableCount( ) < inputs.size( ) ) {
+    bdd.addVariable( );
+  }
+  std::vector< BddManager::Node > values( netlist.signalCount( ), UNSET );
+  for( size_t input = 0; input < inputs.size( ); ++input ) {
+    values[ inputs[ input ] ] = bdd.variable( static_cast< uint32_t >( input ) );
+    bdd.ref( values[ inputs[ input ] ] );
+  }
+  /* The lowerings add the constants after the gates that read them, see CircuitEngine::lower( ). */
+  for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+    const uint32_t signal = netlist.outputBegin[ gate ];
+    if( needed[ gate ] && ( netlist.ops[ gate ] == LogicOp::INPUT ) && ( values[ signal ] == UNSET ) ) {
+      values[ signal ] = netlist.initialValues[ signal ] ? BddManager::ONE : BddManager::ZERO;
+      bdd.ref( values[ signal ] );
+    }
+  }
+  bdd.setAutoReorder( true );
+  std::vector< BddManager::Node > in;
+  for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+    if( !needed[ gate ] ) {
+      continue;
+    }
+    const uint32_t outBegin = netlist.outputBegin[ gate ];
+    const uint32_t outSize = netlist.outputSize( gate );
+    in.clear( );
+    for( uint32_t idx = netlist.faninBegin[ gate ]; idx < netlist.faninBegin[ gate + 1 ]; ++idx ) {
+      in.push_back( values[ netlist.fanins[ idx ] ] );
+    }
+    std::vector< BddManager::Node > out( outSize, BddManager::ZERO );
+    const LogicOp op = netlist.ops[ gate ];
+    if( ( op == LogicOp::INPUT ) || !netlist.valid[ gate ] ) {
+      /* Inputs and constants are already set, and gates the simulation skips keep their initial values. */
+      for( uint32_t port = 0; port < outSize; ++port ) {
+        const BddManager::Node value = values[ outBegin + port ];
+        out[ port ] = value != UNSET ? value :
+                      ( netlist.initialValues[ outBegin + port ] ? BddManager::ONE : BddManager::ZERO );
+      }
+    }
+    else {
+      switch( op ) {
+          case LogicOp::NODE:
+          out[ 0 ] = in[ 0 ];
+          break;
+          case LogicOp::OUTPUT:
+          for( uint32_t port = 0; port < outSize; ++port ) {
+            out[ port ] = in[ port ];
+          }
+          break;
+          case LogicOp::AND:
+          case LogicOp::NAND: {
+          BddManager::Node result = BddManager::ONE;
+          for( BddManager::Node node : in ) {
+            result = bdd.bddAnd( result, node );
+          }
+          out[ 0 ] = op == LogicOp::AND ? result : bdd.bddNot( result );
+          break;
+        }
+          case LogicOp::OR:
+          case LogicOp::NOR: {
+          BddManager::Node result = BddManager::ZERO;
+          for( BddManager::Node node : in ) {
+            result = bdd.bddOr( result, node );
+          }
+          out[ 0 ] = op == LogicOp::OR ? result : bdd.bddNot( result );
+          break;
+        }
+          case LogicOp::XOR:
+          case LogicOp::XNOR: {
+          BddManager::Node result = BddManager::ZERO;
+          for( BddManager::Node node : in ) {
+            result = bdd.bddXor( result, node );
+          }
+          out[ 0 ] = op == LogicOp::XOR ? result : bdd.bddNot( result );
+          break;
+        }
+          case LogicOp::NOT:
+          out[ 0 ] = bdd.bddNot( in[ 0 ] );
+          break;
+          case LogicOp::MUX:
+          out[ 0 ] = bdd.ite( in[ 2 ], in[ 1 ], in[ 0 ] );
+          break;
+          case LogicOp::DEMUX:
+          out[ 0 ] = bdd.bddAnd( in[ 0 ], bdd.bddNot( in[ 1 ] ) );
+          out[ 1 ] = bdd.bddAnd( in[ 0 ], in[ 1 ] );
+          break;
+          default:
+          throw std::runtime_error( "The circuit has memory elements." );
+      }
+    }
+    for( uint32_t port = 0; port < outSize; ++port ) {
+      if( ( values[ outBegin + port ] == UNSET ) && ( readers[ outBegin + port ] > 0 ) ) {
+        values[ outBegin + port ] = out[ port ];
+        bdd.ref( out[ port ] );
+      }
+    }
+    /* The fan-ins are released once their last reader is built. */
+    for( uint32_t idx = netlist.faninBegin[ gate ]; idx < netlist.faninBegin[ gate + 1 ]; ++idx ) {
+      const uint32_t signal = netlist.fanins[ idx ];
+      if( --readers[ signal ] == 0 ) {
+        bdd.deref( values[ signal ] );
+      }
+    }
+    bdd.checkpoint( );
+    if( ( nodeLimit > 0 ) && ( bdd.nodeCount( ) > nodeLimit ) ) {
+      throw std::runtime_error( "The BDDs grew past " + std::to_string( nodeLimit ) + " nodes." );
+    }
+  }
+  for( uint32_t signal : outputSignals ) {
+    outputs.push_back( values[ signal ] );
+  }
+}
@@ -0,0 +1,88 @@
+#ifndef CIRCUITBDD_H
+#define CIRCUITBDD_H
+
+#include "bddmanager.h"
+#include "simulation/netlist.h"
+
+#include <QStringList>
+#include <vector>
+
+class CircuitEngine;
+
+/**
+ * @brief The CircuitBdd class holds the BDD of every output of a
+ *        combinational circuit, built gate by gate from its Netlist, input i
+ *        being variable i. Only the gates that reach an output are visited,
+ *        and the BDD of a signal is released once its last reader is built.
+ *        The variables are sifted whenever the diagrams double in size. From
+ *        the BDDs, truth tables, sums of products and satisfiability queries
+ *        take time in the size of the diagrams rather than in 2^n.
+ */
+class CircuitBdd {
+public:
+  CircuitBdd( );
+
+  /**
+   * @brief CircuitBdd throws a std::runtime_error if the netlist has memory
+   *        elements or feedback loops.
+   */
+  CircuitBdd( const Netlist &netlist, const std::vector< uint32_t > &inputs, const std::vector< uint32_t > &outputs );
+
+  /**
+   * @brief CircuitBdd builds the outputs of engine, each port of an output
+   *        element being an output of its own, named as BatchSimulation
+   *        names them. It throws for an output with an unconnected port.
+   */
+  explicit CircuitBdd( const CircuitEngine &engine );
+
+  /**
+   * @brief addCircuit builds the outputs of netlist over the same variables,
+   *        after the outputs already built, input i of netlist being variable
+   *        i. This is how the outputs of two circuits are compared. It throws
+   *        a std::runtime_error if the netlist has memory elements or feedback
+   *        loops, or if the node limit is exceeded.
+   */
+  void addCircuit( const Netlist &netlist, const std::vector< uint32_t > &inputs,
+                   const std::vector< uint32_t > &outputs );
+
+  /**
+   * @brief setNodeLimit bounds the number of nodes addCircuit( ) may create,
+   *        0 meaning no limit. Some circuits, such as multipliers, have BDDs
+   *        exponential in their inputs in any order.
+   */
+  void setNodeLimit( size_t nodes );
+
+  BddManager &manager( );
+  size_t inputCount( ) const;
+  size_t outputCount( ) const;
+  BddManager::Node output( size_t index ) const;
+
+  /**
+   * @brief inputNames and outputNames are used by sumOfProducts( ), and
+   *        default to in0, in1... and out0, out1...
+   */
+  const QStringList &inputNames( ) const;
+  const QStringList &outputNames( ) const;
+  void setNames( const QStringList &inputs, const QStringList &outputs );
+
+  /**
+   * @brief value returns an output for one row of the truth table, input i
+   *        taking bit i of row, as in TruthTableWriter.
+   */
+  bool value( size_t output, uint64_t row ) const;
+
+  /**
+   * @brief sumOfProducts writes an irredundant sum of products of an output
+   *        with the input names, a quote marking a negated input.
+   */
+  QString sumOfProducts( size_t output );
+
+private:
+  BddManager bdd;
+  std::vector< BddManager::Node > outputs;
+  QStringList m_inputNames;
+  QStringList m_outputNames;
+  size_t nodeLimit;
+};
+
+#endif // CIRCUITBDD_H
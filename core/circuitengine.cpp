@@ -0,0 +1,373 @@
+#include "circuitengine.h"
+#include "elementinfo.h"
+#include "simulation/levelizer.h"
+#include "simulation/nativecompiler.h"
+#include "simulation/netlistsimulator.h"
+#include "simulation/simulatorfactory.h"
+#include "simulation/timedsimulator.h"
+
+#include <QFileInfo>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+  QString portName( const QString &name, uint32_t port, uint32_t size ) {
+    return( size > 1 ? name + "[" + QString::number( port ) + "]" : name );
+  }
+}
+
+const int CircuitEngine::UNCONNECTED;
+const int CircuitEngine::GND;
+const int CircuitEngine::VCC;
+
+CircuitEngine::CircuitEngine( const CircuitModel &circuit, SimulationBackend backend, DelayModel delayModel ) :
+  simulator( nullptr ),
+  timed( nullptr ),
+  native( nullptr ),
+  evaluations( 0 ) {
+  std::vector< Sink > boxInputs;
+  std::vector< Driver > boxOutputs;
+  instantiate( circuit, -1, boxInputs, boxOutputs );
+  lower( );
+  /* There is no LogicElement graph to interpret, INTERPRETED runs as COMPILED. */
+  simulator = SimulatorFactory::create( netlist, backend, SimulatorFactory::DEFAULT_PARALLEL_THRESHOLD, delayModel,
+                                        native );
+  timed = dynamic_cast< TimedSimulator* >( simulator );
+  reset( );
+}
+
+CircuitEngine::~CircuitEngine( ) {
+  /* The native simulator calls into the library owned by the native compiler. */
+  delete simulator;
+  delete native;
+}
+
+void CircuitEngine::reset( ) {
+  simulator->reset( );
+  resetTime( );
+  evaluations = 0;
+  for( size_t clock = 0; clock < clockPins.size( ); ++clock ) {
+    /* As SimulationWorker restarts the clocks of a new circuit, they start high. */
+    scheduler.addClock( static_cast< double >( frequencies[ clock ] ), true, true, now );
+    simulator->setInput( clockPins[ clock ].signals[ 0 ], true );
+  }
+  for( size_t input = 0; input < inputPins.size( ); ++input ) {
+    simulator->setInput( inputPins[ input ].signals[ 0 ], initialInputs[ input ] );
+  }
+}
+
+const std::vector< CircuitPin > &CircuitEngine::inputs( ) const {
+  return( inputPins );
+}
+
+const std::vector< CircuitPin > &CircuitEngine::outputs( ) const {
+  return( outputPins );
+}
+
+const std::vector< CircuitPin > &CircuitEngine::clocks( ) const {
+  return( clockPins );
+}
+
+int CircuitEngine::findInput( const QString &label ) const {
+  for( size_t input = 0; input < inputPins.size( ); ++input ) {
+    if( inputPins[ input ].label == label ) {
+      return( static_cast< int >( input ) );
+    }
+  }
+  return( -1 );
+}
+
+int CircuitEngine::findOutput( const QString &label ) const {
+  for( size_t output = 0; output < outputPins.size( ); ++output ) {
+    if( outputPins[ output ].label == label ) {
+      return( static_cast< int >( output ) );
+    }
+  }
+  return( -1 );
+}
+
+void CircuitEngine::setInput( int input, bool value ) {
+  simulator->setInput( inputPins[ static_cast< size_t >( input ) ].signals[ 0 ], value );
+  dirty = true;
+}
+
+bool CircuitEngine::inputValue( int input ) const {
+  return( simulator->value( inputPins[ static_cast< size_t >( input ) ].signals[ 0 ] ) );
+}
+
+bool CircuitEngine::isValid( int output ) const {
+  const uint32_t gate = outputPins[ static_cast< size_t >( output ) ].gate;
+  return( netlist.valid[ gate ] && !simulator->isOscillating( gate ) );
+}
+
+bool CircuitEngine::outputValue( int output, int port ) const {
+  return( simulator->value( outputPins[ static_cast< size_t >( output ) ].signals[ static_cast< size_t >( port ) ] ) );
+}
+
+
+uint64_t CircuitEngine::evaluationCount( ) const {
+  return( evaluations );
+}
+
+const Netlist &CircuitEngine::getNetlist( ) const {
+  return( netlist );
+}
+
+const std::vector< CircuitScope > &CircuitEngine::scopes( ) const {
+  return( scopeList );
+}
+
+const std::vector< CircuitProbe > &CircuitEngine::probes( ) const {
+  return( probeList );
+}
+
+bool CircuitEngine::signalValue( uint32_t signal ) const {
+  return( simulator->value( signal ) );
+}
+
+void CircuitEngine::instantiate( const CircuitModel &circuit, int scope, std::vector< Sink > &boxInputs,
+                                 std::vector< Driver > &boxOutputs ) {
+  const bool top = scope < 0;
+  const size_t count = circuit.elements.size( );
+  std::vector< std::vector< Sink > > sinks( count );
+  std::vector< std::vector< Driver > > drivers( count );
+  const uint32_t nodeDelay = ElementInfo::defaultDelay( ElementType::NODE );
+  for( size_t elm = 0; elm < count; ++elm ) {
+    const CircuitElement &element = circuit.elements[ elm ];
+    const ElementGroup group = ElementInfo::group( element.type );
+    QString name = element.label;
+    if( name.isEmpty( ) ) {
+      name = element.type == ElementType::BOX ? QFileInfo( element.file ).baseName( ) :
+             ElementInfo::typeName( element.type ) + "_" + QString::number( elm );
+    }
+    if( element.type == ElementType::BOX ) {
+      scopeList.push_back( { name, scope } );
+      instantiate( *circuit.boxes[ static_cast< size_t >( element.box ) ], static_cast< int >( scopeList.size( ) - 1 ),
+                   sinks[ elm ], drivers[ elm ] );
+    }
+    else if( !top && ( group == ElementGroup::INPUT ) ) {
+      /* Inside a box, inputs and outputs are replaced by nodes at the ports of the box, see BoxPrototypeImpl. */
+      for( uint32_t port = 0; port < element.outputSize; ++port ) {
+        const uint32_t node = addGate( LogicOp::NODE, 1, 1, nodeDelay );
+        addProbe( portName( name, port, element.outputSize ), scope, node, 0, false );
+        drivers[ elm ].push_back( Driver( static_cast< int >( node ), 0 ) );
+      }
+    }
+    else if( !top && ( group == ElementGroup::OUTPUT ) ) {
+      for( uint32_t port = 0; port < element.inputSize; ++port ) {
+        const uint32_t node = addGate( LogicOp::NODE, 1, 1, nodeDelay );
+        addProbe( portName( name, port, element.inputSize ), scope, node, 0, false );
+        sinks[ elm ].push_back( { node, 0, -1 } );
+      }
+    }
+    else {
+      const LogicOp op = ElementInfo::logicOp( element.type );
+      const uint32_t inputSize = op == LogicOp::INPUT ? 0 : element.inputSize;
+      const uint32_t outputSize = op == LogicOp::OUTPUT ? inputSize : element.outputSize;
+      const bool value = ( element.type == ElementType::VCC ) || element.on;
+      const uint32_t gate = addGate( op, inputSize, outputSize, element.propagationDelay( ), value );
+      for( uint32_t port = 0; port < inputSize; ++port ) {
+        sinks[ elm ].push_back( { gate, port, ElementInfo::defaultInputValue( element.type, static_cast< int >( port ) ) } );
+      }
+      for( uint32_t port = 0; port < outputSize; ++port ) {
+        drivers[ elm ].push_back( Driver( static_cast< int >( gate ), port ) );
+        /* An output element shows what its input ports read. */
+        addProbe( portName( name, port, outputSize ), scope, gate, port, op == LogicOp::OUTPUT );
+      }
+      const CircuitPin pin = { element.label, element.type, gate, std::vector< uint32_t >( ) };
+      if( top && ( element.type == ElementType::CLOCK ) ) {
+        clockPins.push_back( pin );
+        frequencies.push_back( element.frequency );
+      }
+      else if( top && ( group == ElementGroup::INPUT ) ) {
+        inputPins.push_back( pin );
+        initialInputs.push_back( element.on );
+      }
+      else if( top && ( group == ElementGroup::OUTPUT ) ) {
+        outputPins.push_back( pin );
+      }
+    }
+  }
+  /* An input port reads its only connection, or its default value when it has none, as in ElementMapping. */
+  std::vector< std::vector< int > > connections( count );
+  for( size_t elm = 0; elm < count; ++elm ) {
+    connections[ elm ].assign( sinks[ elm ].size( ), 0 );
+  }
+  for( const CircuitConnection &conn : circuit.connections ) {
+    const std::vector< Driver > &from = drivers[ conn.source.first ];
+    std::vector< Sink > &to = sinks[ conn.target.first ];
+    if( ( conn.source.second < from.size( ) ) && ( conn.target.second < to.size( ) ) ) {
+      const Sink &sink = to[ conn.target.second ];
+      gates[ sink.gate ].fanins[ sink.index ] = from[ conn.source.second ];
+      ++connections[ conn.target.first ][ conn.target.second ];
+    }
+  }
+  for( size_t elm = 0; elm < count; ++elm ) {
+    for( size_t port = 0; port < sinks[ elm ].size( ); ++port ) {
+      const Sink &sink = sinks[ elm ][ port ];
+      Driver &fanin = gates[ sink.gate ].fanins[ sink.index ];
+      if( connections[ elm ][ port ] > 1 ) {
+        fanin = Driver( UNCONNECTED, 0 );
+      }
+      else if( connections[ elm ][ port ] == 0 ) {
+        fanin = Driver( sink.defaultValue < 0 ? UNCONNECTED : ( sink.defaultValue ? VCC : GND ), 0 );
+      }
+    }
+  }
+  if( !top ) {
+    for( const CircuitPort &port : circuit.boxInputs( ) ) {
+      const CircuitElement &element = circuit.elements[ port.first ];
+      const uint32_t node = static_cast< uint32_t >( drivers[ port.first ][ port.second ].first );
+      /* A box clock must be connected, the other inputs default to their saved value. */
+      boxInputs.push_back( { node, 0, element.type == ElementType::CLOCK ? -1 : ( element.on ? 1 : 0 ) } );
+    }
+    for( const CircuitPort &port : circuit.boxOutputs( ) ) {
+      boxOutputs.push_back( Driver( static_cast< int >( sinks[ port.first ][ port.second ].gate ), 0 ) );
+    }
+  }
+}
+
+void CircuitEngine::addProbe( const QString &name, int scope, uint32_t gate, uint32_t port, bool input ) {
+  probeList.push_back( { name, scope, 0 } );
+  probePorts.push_back( { gate, port, input } );
+}
+
+uint32_t CircuitEngine::addGate( LogicOp op, uint32_t inputSize, uint32_t outputSize, uint32_t delay, bool value ) {
+  Gate gate;
+  gate.op = op;
+  gate.delay = delay;
+  gate.fanins.assign( inputSize, Driver( UNCONNECTED, 0 ) );
+  gate.initialValues.assign( outputSize, 0 );
+  switch( op ) {
+      case LogicOp::INPUT:
+      if( outputSize > 0 ) {
+        gate.initialValues[ 0 ] = value;
+      }
+      break;
+      case LogicOp::DLATCH:
+      case LogicOp::DFLIPFLOP:
+      case LogicOp::JKFLIPFLOP:
+      case LogicOp::SRFLIPFLOP:
+      case LogicOp::TFLIPFLOP:
+      /* Q starts low and its complement high, as in the logic elements. */
+      if( outputSize > 1 ) {
+        gate.initialValues[ 1 ] = 1;
+      }
+      break;
+      default:
+      break;
+  }
+  gates.push_back( gate );
+  return( static_cast< uint32_t >( gates.size( ) - 1 ) );
+}
+
+void CircuitEngine::lower( ) {
+  const uint32_t count = static_cast< uint32_t >( gates.size( ) );
+  std::vector< uint32_t > begin( count + 1, 0 );
+  for( const Gate &gate : gates ) {
+    for( const Driver &fanin : gate.fanins ) {
+      if( fanin.first >= 0 ) {
+        ++begin[ static_cast< size_t >( fanin.first ) + 1 ];
+      }
+    }
+  }
+  std::partial_sum( begin.begin( ), begin.end( ), begin.begin( ) );
+  std::vector< uint32_t > successors( begin.back( ) );
+  std::vector< uint32_t > next( begin.begin( ), begin.end( ) - 1 );
+  for( uint32_t gate = 0; gate < count; ++gate ) {
+    for( const Driver &fanin : gates[ gate ].fanins ) {
+      if( fanin.first >= 0 ) {
+        successors[ next[ static_cast< size_t >( fanin.first ) ]++ ] = gate;
+      }
+    }
+  }
+  std::vector< int > priorities( count, -1 );
+  Levelizer( std::move( begin ), std::move( successors ) ).levelize( priorities );
+  std::vector< uint32_t > order( count );
+  std::iota( order.begin( ), order.end( ), 0 );
+  std::stable_sort( order.begin( ), order.end( ), [ &priorities ]( uint32_t gate1, uint32_t gate2 ) {
+    return( priorities[ gate2 ] < priorities[ gate1 ] );
+  } );
+  std::vector< uint32_t > position( count );
+  for( uint32_t idx = 0; idx < count; ++idx ) {
+    position[ order[ idx ] ] = idx;
+  }
+  netlist.clear( );
+  for( uint32_t gate : order ) {
+    const Gate &source = gates[ gate ];
+    const uint32_t outputSize = static_cast< uint32_t >( source.initialValues.size( ) );
+    const uint32_t idx = netlist.addGate( source.op, static_cast< uint32_t >( source.fanins.size( ) ), outputSize );
+    bool valid = true;
+    for( const Driver &fanin : source.fanins ) {
+      valid &= ( fanin.first != UNCONNECTED );
+    }
+    netlist.setValid( idx, valid );
+    netlist.setLevel( idx, priorities[ gate ] );
+    netlist.setDelay( idx, source.delay );
+    for( uint32_t port = 0; port < outputSize; ++port ) {
+      netlist.setInitialValue( netlist.outputSignal( idx, port ), source.initialValues[ port ] != 0 );
+    }
+  }
+  /* Constant gates are added after the others, for unconnected inputs, GND and VCC. */
+  int constants[ 3 ] = { -1, -1, -1 };
+  for( uint32_t idx = 0; idx < count; ++idx ) {
+    const Gate &source = gates[ order[ idx ] ];
+    for( uint32_t in = 0; in < source.fanins.size( ); ++in ) {
+      const Driver &fanin = source.fanins[ in ];
+      if( fanin.first >= 0 ) {
+        netlist.setFanin( idx, in, netlist.outputSignal( position[ static_cast< size_t >( fanin.first ) ], fanin.second ) );
+        continue;
+      }
+      int &constant = constants[ -1 - fanin.first ];
+      if( constant < 0 ) {
+        constant = static_cast< int >( netlist.addGate( LogicOp::INPUT, 0, 1 ) );
+        netlist.setInitialValue( netlist.outputSignal( static_cast< uint32_t >( constant ) ), fanin.first == VCC );
+      }
+      netlist.setFanin( idx, in, netlist.outputSignal( static_cast< uint32_t >( constant ) ) );
+    }
+  }
+  netlist.finalize( );
+  for( std::vector< CircuitPin > *pins : { &inputPins, &clockPins } ) {
+    for( CircuitPin &pin : *pins ) {
+      pin.gate = position[ pin.gate ];
+      pin.signals.assign( 1, netlist.outputSignal( pin.gate ) );
+    }
+  }
+  for( CircuitPin &pin : outputPins ) {
+    pin.gate = position[ pin.gate ];
+    for( uint32_t port = 0; port < netlist.inputSize( pin.gate ); ++port ) {
+      pin.signals.push_back( netlist.fanin( pin.gate, port ) );
+    }
+  }
+  for( size_t probe = 0; probe < probeList.size( ); ++probe ) {
+    const ProbePort &probePort = probePorts[ probe ];
+    const uint32_t gate = position[ probePort.gate ];
+    probeList[ probe ].signal = probePort.input ? netlist.fanin( gate, probePort.port ) :
+                                netlist.outputSignal( gate, probePort.port );
+  }
+  probePorts.clear( );
+  gates.clear( );
+  gates.shrink_to_fit( );
+}
+
+void CircuitEngine::setClock( uint32_t clock, bool value ) {
+  simulator->setInput( clockPins[ clock ].signals[ 0 ], value );
+}
+
+uint64_t CircuitEngine::nextEvent( ) const {
+  return( timed ? timed->nextEvent( ) : ClockScheduler::NEVER );
+}
+
+bool CircuitEngine::isSettled( ) const {
+  return( simulator->isSettled( ) );
+}
+
+void CircuitEngine::evaluate( ) {
+  if( timed ) {
+    timed->advanceTo( now );
+  }
+  else {
+    simulator->run( );
+  }
+  evaluations += simulator->lastEvaluationCount( );
+}
@@ -0,0 +1,166 @@
+#ifndef CIRCUITENGINE_H
+#define CIRCUITENGINE_H
+
+#include "circuitmodel.h"
+#include "simulation/netlist.h"
+#include "simulation/simulationbackend.h"
+#include "simulation/timestepper.h"
+
+#include <QString>
+#include <vector>
+
+class NativeCompiler;
+class NetlistSimulator;
+class TimedSimulator;
+
+/**
+ * @brief The CircuitPin struct is an input or output element at the top of
+ *        the circuit simulated by a CircuitEngine. An input drives one
+ *        signal, an output reads one signal per input port.
+ */
+struct CircuitPin {
+  QString label;
+  ElementType type;
+  uint32_t gate;
+  std::vector< uint32_t > signals;
+};
+
+/**
+ * @brief The CircuitScope struct is a box of the circuit, parent being the
+ *        index of the box it is in, or -1 at the top of the circuit.
+ */
+struct CircuitScope {
+  QString name;
+  int parent;
+};
+
+/**
+ * @brief The CircuitProbe struct names the signal of an element output, or
+ *        of an output element at the top of the circuit, within its scope.
+ */
+struct CircuitProbe {
+  QString name;
+  int scope;
+  uint32_t signal;
+};
+
+/**
+ * @brief The CircuitEngine class simulates a CircuitModel without any
+ *        graphic element. The boxes are flattened into a single Netlist,
+ *        with a node at each of their ports as BoxMapping has, and the
+ *        netlist runs on the simulator of the chosen backend. Time goes as
+ *        in SimulationWorker, through TimeStepper. All the clocks start high
+ *        at time zero.
+ */
+class CircuitEngine : public TimeStepper {
+public:
+  explicit CircuitEngine( const CircuitModel &circuit, SimulationBackend backend = SimulationBackend::COMPILED,
+                          DelayModel delayModel = DelayModel::INERTIAL );
+  ~CircuitEngine( ) override;
+
+  /**
+   * @brief reset restores the initial state, and the input values saved in
+   *        the file.
+   */
+  void reset( );
+
+  /**
+   * @brief inputs are the switches and buttons of the circuit, outputs its
+   *        output elements, in file order. Clocks are driven by the engine.
+   */
+  const std::vector< CircuitPin > &inputs( ) const;
+  const std::vector< CircuitPin > &outputs( ) const;
+  const std::vector< CircuitPin > &clocks( ) const;
+
+  /**
+   * @brief findInput and findOutput return the index of the pin with the
+   *        given label, or -1.
+   */
+  int findInput( const QString &label ) const;
+  int findOutput( const QString &label ) const;
+
+  /**
+   * @brief setInput changes an input at the current time, it is taken into
+   *        account by the next evaluation.
+   */
+  void setInput( int input, bool value );
+  bool inputValue( int input ) const;
+
+  /**
+   * @brief isValid returns false for an output with an unconnected port, or
+   *        that reads a feedback loop that did not settle.
+   */
+  bool isValid( int output ) const;
+  bool outputValue( int output, int port = 0 ) const;
+
+  /**
+   * @brief evaluationCount returns how many gates were evaluated since the
+   *        last reset( ).
+   */
+  uint64_t evaluationCount( ) const;
+
+  const Netlist &getNetlist( ) const;
+
+  /**
+   * @brief scopes and probes describe the signals of the circuit along its
+   *        box hierarchy, as a waveform shows them.
+   */
+  const std::vector< CircuitScope > &scopes( ) const;
+  const std::vector< CircuitProbe > &probes( ) const;
+  bool signalValue( uint32_t signal ) const;
+
+private:
+  /* A driver is a gate output, or one of the constants below. */
+  typedef std::pair< int, uint32_t > Driver;
+  static const int UNCONNECTED = -1;
+  static const int GND = -2;
+  static const int VCC = -3;
+
+  /* An input port of a gate, with the value it reads when left unconnected, or -1. */
+  struct Sink {
+    uint32_t gate;
+    uint32_t index;
+    int defaultValue;
+  };
+
+  /* Where a probe reads, before the gates are sorted: an output of the gate, or an input for output elements. */
+  struct ProbePort {
+    uint32_t gate;
+    uint32_t port;
+    bool input;
+  };
+
+  struct Gate {
+    LogicOp op;
+    uint32_t delay;
+    std::vector< Driver > fanins;
+    std::vector< uint8_t > initialValues;
+  };
+
+  std::vector< Gate > gates;
+  std::vector< CircuitPin > inputPins;
+  std::vector< CircuitPin > outputPins;
+  std::vector< CircuitPin > clockPins;
+  std::vector< float > frequencies;
+  std::vector< bool > initialInputs;
+  std::vector< CircuitScope > scopeList;
+  std::vector< CircuitProbe > probeList;
+  std::vector< ProbePort > probePorts;
+  Netlist netlist;
+  NetlistSimulator *simulator;
+  TimedSimulator *timed;
+  NativeCompiler *native;
+  uint64_t evaluations;
+
+  void instantiate( const CircuitModel &circuit, int scope, std::vector< Sink > &boxInputs,
+                    std::vector< Driver > &boxOutputs );
+  void addProbe( const QString &name, int scope, uint32_t gate, uint32_t port, bool input );
+  uint32_t addGate( LogicOp op, uint32_t inputSize, uint32_t outputSize, uint32_t delay, bool value = false );
+  void lower( );
+  void setClock( uint32_t clock, bool value ) override;
+  uint64_t nextEvent( ) const override;
+  bool isSettled( ) const override;
+  void evaluate( ) override;
+};
+
+#endif // CIRCUITENGINE_H
@@ -0,0 +1,262 @@
+#include "circuitloader.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRectF>
+#include <QStringList>
+#include <stdexcept>
+
+namespace {
+  /* The item types written before each item, see GraphicElement::Type and QNEConnection::Type. */
+  const int ELEMENT_ITEM = 65536 + 3;
+  const int CONNECTION_ITEM = 65536 + 2;
+  /* How the Display and LedGrid inputs were reordered in versions 1.6 and 1.7, see Display::load( ). */
+  const std::vector< int > REMAP_1_6 = { 2, 1, 4, 5, 0, 7, 3, 6 };
+  const std::vector< int > REMAP_1_7 = { 2, 5, 4, 0, 7, 3, 6, 1 };
+
+  void remapPorts( std::vector< quint64 > &ports, const std::vector< int > &order ) {
+    if( ports.size( ) != order.size( ) ) {
+      return;
+    }
+    std::vector< quint64 > remapped( ports.size( ) );
+    for( size_t idx = 0; idx < ports.size( ); ++idx ) {
+      remapped[ static_cast< size_t >( order[ idx ] ) ] = ports[ idx ];
+    }
+    ports.swap( remapped );
+  }
+}
+
+std::shared_ptr< const CircuitModel > CircuitLoader::loadFile( const QString &fileName ) {
+  QFile file( fileName );
+  if( !file.open( QFile::ReadOnly ) ) {
+    throw std::runtime_error( "Could not open " + fileName.toStdString( ) + "." );
+  }
+  const QString path = QFileInfo( fileName ).absoluteFilePath( );
+  QDataStream ds( &file );
+  loading.insert( path );
+  try {
+    std::shared_ptr< const CircuitModel > model = load( ds, path );
+    loading.remove( path );
+    return( model );
+  }
+  catch( ... ) {
+    loading.remove( path );
+    throw;
+  }
+}
+
+std::shared_ptr< const CircuitModel > CircuitLoader::load( QDataStream &ds, const QString &fileName ) {
+  QString header;
+  ds >> header;
+  const QStringList words = header.split( " " );
+  bool ok = words.size( ) >= 2;
+  const double version = ok ? parseVersion( words.at( 1 ), &ok ) : 0.0;
+  if( !ok ) {
+    throw std::runtime_error( "Invalid file format." );
+  }
+  std::shared_ptr< CircuitModel > model = std::make_shared< CircuitModel >( );
+  model->fileName = fileName;
+  model->version = version;
+  if( version >= 1.4 ) {
+    QRectF rect;
+    ds >> rect;
+  }
+  QHash< quint64, CircuitPort > inputs;
+  QHash< quint64, CircuitPort > outputs;
+  while( !ds.atEnd( ) ) {
+    int type;
+    ds >> type;
+    if( type == ELEMENT_ITEM ) {
+      readElement( ds, *model, inputs, outputs );
+    }
+    else if( type == CONNECTION_ITEM ) {
+      readConnection( ds, *model, inputs, outputs );
+    }
+    else {
+      throw std::runtime_error( "Invalid type. Data is possibly corrupted." );
+    }
+    if( ds.status( ) != QDataStream::Ok ) {
+      throw std::runtime_error( "Corrupted DataStream!" );
+    }
+  }
+  return( model );
+}
+
+double CircuitLoader::parseVersion( const QString &text, bool *ok ) {
+  const QStringList numbers = text.split( "-" ).first( ).split( "." );
+  if( numbers.size( ) < 2 ) {
+    *ok = false;
+    return( 0.0 );
+  }
+  return( QString( numbers[ 0 ] + "." + numbers[ 1 ] ).toDouble( ok ) );
+}
+
+void CircuitLoader::readElement( QDataStream &ds, CircuitModel &model, QHash< quint64, CircuitPort > &inputs,
+                                 QHash< quint64, CircuitPort > &outputs ) {
+  const double version = model.version;
+  quint64 elmType;
+  ds >> elmType;
+  if( ( elmType == 0 ) || ( elmType > static_cast< quint64 >( ElementType::LEDGRID ) ) ) {
+    throw std::runtime_error( "Could not build element." );
+  }
+  CircuitElement elm;
+  elm.type = static_cast< ElementType >( elmType );
+  elm.delay = -1;
+  elm.frequency = 1.0f;
+  elm.on = false;
+  elm.box = -1;
+  qreal rotation;
+  ds >> elm.pos;
+  ds >> rotation;
+  if( version >= 1.2 ) {
+    ds >> elm.label;
+  }
+  if( version >= 1.3 ) {
+    /* The minimum and maximum port counts only matter to the editor. */
+    quint64 size;
+    for( int idx = 0; idx < 4; ++idx ) {
+      ds >> size;
+    }
+  }
+  if( version >= 1.9 ) {
+    /* A QKeySequence, which is a QtGui type: its key count, then the keys. */
+    quint32 count;
+    quint32 key;
+    ds >> count;
+    if( count > 4 ) {
+      throw std::runtime_error( "Corrupted DataStream!" );
+    }
+    for( quint32 idx = 0; idx < count; ++idx ) {
+      ds >> key;
+    }
+  }
+  if( version >= 2.7 ) {
+    qint32 delay;
+    ds >> delay;
+    elm.delay = qMax( delay, -1 );
+  }
+  std::vector< quint64 > inputPorts = readPorts( ds );
+  std::vector< quint64 > outputPorts = readPorts( ds );
+  QString text;
+  switch( elm.type ) {
+      case ElementType::CLOCK:
+      if( version >= 1.1 ) {
+        ds >> elm.frequency;
+      }
+      break;
+      case ElementType::SWITCH:
+      ds >> elm.on;
+      break;
+      case ElementType::LED:
+      if( version >= 1.1 ) {
+        /* The color. */
+        ds >> text;
+      }
+      break;
+      case ElementType::DISPLAY:
+      case ElementType::LEDGRID:
+      if( version < 1.6 ) {
+        remapPorts( inputPorts, REMAP_1_6 );
+      }
+      if( version < 1.7 ) {
+        remapPorts( inputPorts, REMAP_1_7 );
+      }
+      if( ( elm.type == ElementType::LEDGRID ) && ( version >= 1.1 ) ) {
+        ds >> text;
+      }
+      break;
+      case ElementType::BUZZER:
+      if( version >= 2.4 ) {
+        /* The note. */
+        ds >> text;
+      }
+      break;
+      case ElementType::BOX:
+      if( version >= 1.2 ) {
+        ds >> elm.file;
+      }
+      break;
+      default:
+      break;
+  }
+  const uint32_t index = static_cast< uint32_t >( model.elements.size( ) );
+  elm.inputSize = static_cast< uint32_t >( inputPorts.size( ) );
+  elm.outputSize = static_cast< uint32_t >( outputPorts.size( ) );
+  for( uint32_t port = 0; port < elm.inputSize; ++port ) {
+    inputs.insert( inputPorts[ port ], CircuitPort( index, port ) );
+  }
+  for( uint32_t port = 0; port < elm.outputSize; ++port ) {
+    outputs.insert( outputPorts[ port ], CircuitPort( index, port ) );
+  }
+  if( elm.type == ElementType::BOX ) {
+    elm.box = loadBox( model, elm.file );
+  }
+  model.elements.push_back( elm );
+}
+
+void CircuitLoader::readConnection( QDataStream &ds, CircuitModel &model, const QHash< quint64, CircuitPort > &inputs,
+                                    const QHash< quint64, CircuitPort > &outputs ) {
+  quint64 ptr1;
+  quint64 ptr2;
+  ds >> ptr1;
+  ds >> ptr2;
+  /* Connections to ports that were not saved are dropped, as QNEConnection::load( ) does. */
+  if( inputs.contains( ptr1 ) && outputs.contains( ptr2 ) ) {
+    model.connections.push_back( { outputs.value( ptr2 ), inputs.value( ptr1 ) } );
+  }
+  else if( outputs.contains( ptr1 ) && inputs.contains( ptr2 ) ) {
+    model.connections.push_back( { outputs.value( ptr1 ), inputs.value( ptr2 ) } );
+  }
+}
+
+std::vector< quint64 > CircuitLoader::readPorts( QDataStream &ds ) {
+  quint64 size;
+  ds >> size;
+  if( size > MAXIMUMVALIDINPUTSIZE ) {
+    throw std::runtime_error( "Corrupted DataStream!" );
+  }
+  std::vector< quint64 > ports( size );
+  QString name;
+  int flags;
+  for( quint64 &ptr : ports ) {
+    ds >> ptr;
+    ds >> name;
+    ds >> flags;
+  }
+  return( ports );
+}
+
+int CircuitLoader::loadBox( CircuitModel &model, const QString &file ) {
+  const QString path = findFile( file, model.fileName );
+  std::shared_ptr< const CircuitModel > box = boxes.value( path );
+  if( !box ) {
+    if( loading.contains( path ) ) {
+      throw std::runtime_error( "The box " + path.toStdString( ) + " contains itself." );
+    }
+    box = loadFile( path );
+    boxes.insert( path, box );
+  }
+  for( size_t idx = 0; idx < model.boxes.size( ); ++idx ) {
+    if( model.boxes[ idx ] == box ) {
+      return( static_cast< int >( idx ) );
+    }
+  }
+  model.boxes.push_back( box );
+  return( static_cast< int >( model.boxes.size( ) - 1 ) );
+}
+
+QString CircuitLoader::findFile( const QString &file, const QString &parentFile ) {
+  QFileInfo fileInfo( file );
+  const QString name = fileInfo.fileName( );
+  if( !fileInfo.isFile( ) ) {
+    fileInfo.setFile( QDir::current( ), name );
+    if( !fileInfo.isFile( ) ) {
+      fileInfo.setFile( QFileInfo( parentFile ).absoluteDir( ), name );
+      if( !fileInfo.isFile( ) ) {
+        throw std::runtime_error( "Box linked file \"" + file.toStdString( ) + "\" could not be found!" );
+      }
+    }
+  }
+  return( fileInfo.absoluteFilePath( ) );
+}
@@ -0,0 +1,49 @@
+#ifndef CIRCUITLOADER_H
+#define CIRCUITLOADER_H
+
+#include "circuitmodel.h"
+
+#include <QDataStream>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief The CircuitLoader class reads .panda files into CircuitModels,
+ *        following SerializationFunctions::load( ) and the load( ) methods of
+ *        the graphic elements, but without building any of them. The files
+ *        of the boxes are found as BoxFileHelper::findFile( ) does, and each
+ *        is read once per loader. Errors throw a std::runtime_error.
+ */
+class CircuitLoader {
+public:
+  std::shared_ptr< const CircuitModel > loadFile( const QString &fileName );
+
+  /**
+   * @brief load reads a circuit from ds, fileName being the file the boxes
+   *        are looked for next to.
+   */
+  std::shared_ptr< const CircuitModel > load( QDataStream &ds, const QString &fileName = QString( ) );
+
+  /**
+   * @brief parseVersion returns a version such as "2.7.0-beta" as a number,
+   *        only keeping the major and minor numbers.
+   */
+  static double parseVersion( const QString &text, bool *ok );
+
+private:
+  QHash< QString, std::shared_ptr< const CircuitModel > > boxes;
+  /* Files being loaded, so that a box that contains itself is reported. */
+  QSet< QString > loading;
+
+  void readElement( QDataStream &ds, CircuitModel &model, QHash< quint64, CircuitPort > &inputs,
+                    QHash< quint64, CircuitPort > &outputs );
+  void readConnection( QDataStream &ds, CircuitModel &model, const QHash< quint64, CircuitPort > &inputs,
+                       const QHash< quint64, CircuitPort > &outputs );
+  static std::vector< quint64 > readPorts( QDataStream &ds );
+  int loadBox( CircuitModel &model, const QString &file );
+  static QString findFile( const QString &file, const QString &parentFile );
+};
+
+#endif // CIRCUITLOADER_H
@@ -0,0 +1,41 @@
+#include "circuitmodel.h"
+#include "elementinfo.h"
+
+#include <algorithm>
+
+uint32_t CircuitElement::propagationDelay( ) const {
+  if( !ElementInfo::hasDelay( type ) ) {
+    return( 0 );
+  }
+  return( delay >= 0 ? static_cast< uint32_t >( delay ) : ElementInfo::defaultDelay( type ) );
+}
+
+CircuitModel::CircuitModel( ) : version( 0.0 ) {
+}
+
+std::vector< CircuitPort > CircuitModel::boxInputs( ) const {
+  return( boxPorts( ElementGroup::INPUT ) );
+}
+
+std::vector< CircuitPort > CircuitModel::boxOutputs( ) const {
+  return( boxPorts( ElementGroup::OUTPUT ) );
+}
+
+std::vector< CircuitPort > CircuitModel::boxPorts( ElementGroup group ) const {
+  std::vector< CircuitPort > ports;
+  for( uint32_t elm = 0; elm < elements.size( ); ++elm ) {
+    if( ElementInfo::group( elements[ elm ].type ) != group ) {
+      continue;
+    }
+    const uint32_t size = group == ElementGroup::INPUT ? elements[ elm ].outputSize : elements[ elm ].inputSize;
+    for( uint32_t port = 0; port < size; ++port ) {
+      ports.push_back( CircuitPort( elm, port ) );
+    }
+  }
+  std::stable_sort( ports.begin( ), ports.end( ), [ this ]( const CircuitPort &port1, const CircuitPort &port2 ) {
+    const QPointF p1 = elements[ port1.first ].pos;
+    const QPointF p2 = elements[ port2.first ].pos;
+    return( p1.y( ) < p2.y( ) || ( qFuzzyCompare( p1.y( ), p2.y( ) ) && p1.x( ) < p2.x( ) ) );
+  } );
+  return( ports );
+}
@@ -0,0 +1,79 @@
+#ifndef CIRCUITMODEL_H
+#define CIRCUITMODEL_H
+
+#include "elementtype.h"
+
+#include <QPointF>
+#include <QString>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/* An element of a circuit and the index of one of its ports. */
+typedef std::pair< uint32_t, uint32_t > CircuitPort;
+
+/**
+ * @brief The CircuitElement struct holds what the simulation needs of an
+ *        element saved in a circuit file, without any of its graphics.
+ */
+struct CircuitElement {
+  ElementType type;
+  QString label;
+  QPointF pos;
+  /* In nanoseconds, -1 meaning the default delay of the type. */
+  int delay;
+  uint32_t inputSize;
+  uint32_t outputSize;
+  /* The frequency of a clock, and whether a switch was on. */
+  float frequency;
+  bool on;
+  /* The file of a box, and its circuit in CircuitModel::boxes, or -1. */
+  QString file;
+  int box;
+
+  /**
+   * @brief propagationDelay returns the delay the timed simulation applies,
+   *        as GraphicElement::propagationDelay( ) does.
+   */
+  uint32_t propagationDelay( ) const;
+};
+
+/**
+ * @brief The CircuitConnection struct links an output port of an element to
+ *        an input port of another.
+ */
+struct CircuitConnection {
+  CircuitPort source;
+  CircuitPort target;
+};
+
+/**
+ * @brief The CircuitModel class is a circuit as saved in a .panda file,
+ *        see CircuitLoader. The circuits of its boxes are loaded once per
+ *        file and shared by all the boxes, nested ones included.
+ */
+class CircuitModel {
+public:
+  CircuitModel( );
+
+  QString fileName;
+  double version;
+  std::vector< CircuitElement > elements;
+  std::vector< CircuitConnection > connections;
+  std::vector< std::shared_ptr< const CircuitModel > > boxes;
+
+  /**
+   * @brief boxInputs and boxOutputs return the ports a box of this circuit
+   *        shows, in order: the outputs of its input elements and the
+   *        inputs of its output elements, sorted by position as
+   *        BoxPrototypeImpl does. The ports of one element keep their order.
+   */
+  std::vector< CircuitPort > boxInputs( ) const;
+  std::vector< CircuitPort > boxOutputs( ) const;
+
+private:
+  std::vector< CircuitPort > boxPorts( ElementGroup group ) const;
+};
+
+#endif // CIRCUITMODEL_H
@@ -0,0 +1,30 @@
+include($$PWD/simulation/simulation.pri)
+
+HEADERS += \
+    $$PWD/elementtype.h \
+    $$PWD/elementinfo.h \
+    $$PWD/circuitmodel.h \
+    $$PWD/circuitloader.h \
+    $$PWD/circuitengine.h \
+    $$PWD/batchsimulation.h \
+    $$PWD/vcdwriter.h \
+    $$PWD/signalhistory.h \
+    $$PWD/truthtablewriter.h \
+    $$PWD/bddmanager.h \
+    $$PWD/circuitbdd.h \
+    $$PWD/equivalencechecker.h
+
+SOURCES += \
+    $$PWD/elementinfo.cpp \
+    $$PWD/circuitmodel.cpp \
+    $$PWD/circuitloader.cpp \
+    $$PWD/circuitengine.cpp \
+    $$PWD/batchsimulation.cpp \
+    $$PWD/vcdwriter.cpp \
+    $$PWD/signalhistory.cpp \
+    $$PWD/truthtablewriter.cpp \
+    $$PWD/bddmanager.cpp \
+    $$PWD/circuitbdd.cpp \
+    $$PWD/equivalencechecker.cpp
+
+INCLUDEPATH += $$PWD
@@ -0,0 +1,14 @@
+# The simulation core only depends on QtCore, so that circuits can be loaded
+# and simulated without a display.
+
+TARGET = wpanda-core
+
+TEMPLATE = lib
+
+CONFIG += staticlib c++11
+
+QT = core
+
+QMAKE_CXXFLAGS_DEBUG += -DDEBUG=1 -Wall
+
+include(core.pri)
@@ -0,0 +1,202 @@
+#include "elementinfo.h"
+
+#include <QMap>
+#include <stdexcept>
+
+static QMap< ElementType, uint32_t > defaultDelays;
+
+ElementGroup ElementInfo::group( ElementType type ) {
+  switch( type ) {
+      case ElementType::BUTTON:
+      case ElementType::SWITCH:
+      case ElementType::CLOCK:
+      return( ElementGroup::INPUT );
+      case ElementType::VCC:
+      case ElementType::GND:
+      return( ElementGroup::STATICINPUT );
+      case ElementType::LED:
+      case ElementType::DISPLAY:
+      case ElementType::DISPLAY14:
+      case ElementType::BUZZER:
+      case ElementType::LEDGRID:
+      return( ElementGroup::OUTPUT );
+      case ElementType::NOT:
+      case ElementType::AND:
+      case ElementType::OR:
+      case ElementType::NAND:
+      case ElementType::NOR:
+      case ElementType::XOR:
+      case ElementType::XNOR:
+      case ElementType::NODE:
+      return( ElementGroup::GATE );
+      case ElementType::DLATCH:
+      case ElementType::JKLATCH:
+      case ElementType::TLATCH:
+      case ElementType::DFLIPFLOP:
+      case ElementType::JKFLIPFLOP:
+      case ElementType::SRFLIPFLOP:
+      case ElementType::TFLIPFLOP:
+      return( ElementGroup::MEMORY );
+      case ElementType::MUX:
+      case ElementType::DEMUX:
+      return( ElementGroup::MUX );
+      case ElementType::BOX:
+      return( ElementGroup::BOX );
+      case ElementType::UNKNOWN:
+      break;
+  }
+  return( ElementGroup::UNKNOWN );
+}
+
+LogicOp ElementInfo::logicOp( ElementType type ) {
+  switch( type ) {
+      case ElementType::BUTTON:
+      case ElementType::SWITCH:
+      case ElementType::CLOCK:
+      case ElementType::VCC:
+      case ElementType::GND:
+      return( LogicOp::INPUT );
+      case ElementType::LED:
+      case ElementType::DISPLAY:
+      case ElementType::DISPLAY14:
+      case ElementType::BUZZER:
+      case ElementType::LEDGRID:
+      return( LogicOp::OUTPUT );
+      case ElementType::NODE:
+      return( LogicOp::NODE );
+      case ElementType::AND:
+      return( LogicOp::AND );
+      case ElementType::OR:
+      return( LogicOp::OR );
+      case ElementType::NAND:
+      return( LogicOp::NAND );
+      case ElementType::NOR:
+      return( LogicOp::NOR );
+      case ElementType::XOR:
+      return( LogicOp::XOR );
+      case ElementType::XNOR:
+      return( LogicOp::XNOR );
+      case ElementType::NOT:
+      return( LogicOp::NOT );
+      case ElementType::MUX:
+      return( LogicOp::MUX );
+      case ElementType::DEMUX:
+      return( LogicOp::DEMUX );
+      case ElementType::DLATCH:
+      return( LogicOp::DLATCH );
+      case ElementType::DFLIPFLOP:
+      return( LogicOp::DFLIPFLOP );
+      case ElementType::JKFLIPFLOP:
+      return( LogicOp::JKFLIPFLOP );
+      case ElementType::SRFLIPFLOP:
+      return( LogicOp::SRFLIPFLOP );
+      case ElementType::TFLIPFLOP:
+      return( LogicOp::TFLIPFLOP );
+      default:
+      throw std::runtime_error( "Not implemented yet: element type " + std::to_string( static_cast< int >( type ) ) );
+  }
+}
+
+int ElementInfo::defaultInputValue( ElementType type, int port ) {
+  /* As set on the ports by the constructors of the graphic elements. */
+  switch( type ) {
+      case ElementType::DFLIPFLOP:
+      return( ( port == 2 ) || ( port == 3 ) ? 1 : -1 );
+      case ElementType::JKFLIPFLOP:
+      return( port == 1 ? -1 : 1 );
+      case ElementType::SRFLIPFLOP:
+      return( port == 1 ? -1 : ( port >= 3 ? 1 : 0 ) );
+      case ElementType::TFLIPFLOP:
+      return( port == 1 ? -1 : ( port >= 2 ? 1 : 0 ) );
+      case ElementType::DISPLAY:
+      case ElementType::DISPLAY14:
+      case ElementType::LEDGRID:
+      return( 0 );
+      default:
+      return( -1 );
+  }
+}
+
+bool ElementInfo::hasDelay( ElementType type ) {
+  /* Inputs and outputs stand for the outside of the circuit, they change as soon as they are told to. */
+  switch( group( type ) ) {
+      case ElementGroup::GATE:
+      case ElementGroup::MEMORY:
+      case ElementGroup::MUX:
+      return( true );
+      default:
+      return( false );
+  }
+}
+
+uint32_t ElementInfo::defaultDelay( ElementType type ) {
+  auto iter = defaultDelays.constFind( type );
+  if( iter != defaultDelays.constEnd( ) ) {
+    return( iter.value( ) );
+  }
+  /* Roughly in the ratios of CMOS logic, where inverting gates are the fastest. */
+  switch( type ) {
+      case ElementType::NOT:
+      return( 5 );
+      case ElementType::NAND:
+      case ElementType::NOR:
+      return( 7 );
+      case ElementType::AND:
+      case ElementType::OR:
+      return( 10 );
+      case ElementType::XOR:
+      case ElementType::XNOR:
+      case ElementType::MUX:
+      case ElementType::DEMUX:
+      return( 12 );
+      case ElementType::DLATCH:
+      case ElementType::JKLATCH:
+      case ElementType::TLATCH:
+      return( 15 );
+      case ElementType::DFLIPFLOP:
+      case ElementType::JKFLIPFLOP:
+      case ElementType::SRFLIPFLOP:
+      case ElementType::TFLIPFLOP:
+      return( 20 );
+      default:
+      return( 0 );
+  }
+}
+
+void ElementInfo::setDefaultDelay( ElementType type, uint32_t delay ) {
+  defaultDelays.insert( type, delay );
+}
+
+QString ElementInfo::typeName( ElementType type ) {
+  switch( type ) {
+      case ElementType::BUTTON: return( "BUTTON" );
+      case ElementType::LED: return( "LED" );
+      case ElementType::AND: return( "AND" );
+      case ElementType::OR: return( "OR" );
+      case ElementType::CLOCK: return( "CLOCK" );
+      case ElementType::SWITCH: return( "SWITCH" );
+      case ElementType::NOT: return( "NOT" );
+      case ElementType::NAND: return( "NAND" );
+      case ElementType::NOR: return( "NOR" );
+      case ElementType::XOR: return( "XOR" );
+      case ElementType::XNOR: return( "XNOR" );
+      case ElementType::VCC: return( "VCC" );
+      case ElementType::GND: return( "GND" );
+      case ElementType::DFLIPFLOP: return( "DFLIPFLOP" );
+      case ElementType::DLATCH: return( "DLATCH" );
+      case ElementType::JKFLIPFLOP: return( "JKFLIPFLOP" );
+      case ElementType::JKLATCH: return( "JKLATCH" );
+      case ElementType::SRFLIPFLOP: return( "SRFLIPFLOP" );
+      case ElementType::TLATCH: return( "TLATCH" );
+      case ElementType::TFLIPFLOP: return( "TFLIPFLOP" );
+      case ElementType::DISPLAY: return( "DISPLAY" );
+      case ElementType::DISPLAY14: return( "DISPLAY14" );
+      case ElementType::BOX: return( "BOX" );
+      case ElementType::MUX: return( "MUX" );
+      case ElementType::DEMUX: return( "DEMUX" );
+      case ElementType::NODE: return( "NODE" );
+      case ElementType::BUZZER: return( "BUZZER" );
+      case ElementType::LEDGRID: return( "LEDGRID" );
+      case ElementType::UNKNOWN: default: return( "UNKNOWN" );
+  }
+}
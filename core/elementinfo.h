@@ -0,0 +1,53 @@
+#ifndef ELEMENTINFO_H
+#define ELEMENTINFO_H
+
+#include "elementtype.h"
+#include "simulation/logicop.h"
+
+#include <QString>
+#include <cstdint>
+
+/**
+ * @brief The ElementInfo class describes how each type of element behaves in
+ *        a simulation, without building its graphic element.
+ */
+class ElementInfo {
+public:
+  static ElementGroup group( ElementType type );
+
+  /**
+   * @brief typeName returns the name of a type used in the files of the
+   *        application, such as "AND".
+   */
+  static QString typeName( ElementType type );
+
+  /**
+   * @brief logicOp returns the gate that simulates an element of the given
+   *        type. Boxes are made of other elements, and types that cannot be
+   *        simulated yet throw a std::runtime_error.
+   */
+  static LogicOp logicOp( ElementType type );
+
+  /**
+   * @brief defaultInputValue returns the value read by an input port left
+   *        unconnected, or -1 when the port must be connected for the
+   *        element to be valid.
+   */
+  static int defaultInputValue( ElementType type, int port );
+
+  /**
+   * @brief hasDelay returns true for the types whose elements take time to
+   *        propagate a change in the timed simulation.
+   */
+  static bool hasDelay( ElementType type );
+
+  /**
+   * @brief defaultDelay returns the propagation delay of the elements of a
+   *        type that have none of their own, in nanoseconds.
+   *        setDefaultDelay changes it for the circuits simulated afterwards.
+   */
+  static uint32_t defaultDelay( ElementType type );
+  static void setDefaultDelay( ElementType type, uint32_t delay );
+};
+
+#endif // ELEMENTINFO_H
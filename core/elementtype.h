@@ -0,0 +1,18 @@
+#ifndef ELEMENTTYPE_H
+#define ELEMENTTYPE_H
+
+/* The values of ElementType are stored in circuit files, new types must be appended. */
+enum class ElementType {
+  UNKNOWN, BUTTON, SWITCH, LED, NOT, AND, OR, NAND, NOR, CLOCK, XOR, XNOR, VCC, GND, DISPLAY,
+  DLATCH, JKLATCH, DFLIPFLOP, JKFLIPFLOP, SRFLIPFLOP, TFLIPFLOP, TLATCH, BOX, NODE, MUX, DEMUX,
+  BUZZER, DISPLAY14, LEDGRID
+};
+
+enum class ElementGroup {
+  UNKNOWN, OTHER, BOX, INPUT, GATE, MEMORY, OUTPUT, MUX, STATICINPUT
+};
+
+
+#define MAXIMUMVALIDINPUTSIZE 256
+
+#endif // ELEMENTTYPE_H
@@ -0,0 +1,245 @@
+#include "equivalencechecker.h"
+#include "circuitbdd.h"
+#include "simulation/bitparallelsimulator.h"
+
+#include <QHash>
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+/* The names BatchSimulation gives to the inputs and to the output ports of engine, with their signals. */
+static void pinNames( const CircuitEngine &engine, QStringList &inputNames, std::vector< uint32_t > &inputs,
+                      QStringList &outputNames, std::vector< uint32_t > &outputs ) {
+  if( !engine.clocks( ).empty( ) || !engine.getNetlist( ).isCombinational( ) ) {
+    throw std::runtime_error( "The equivalence check needs circuits without clocks, memory elements or feedback "
+                              "loops." );
+  }
+  for( size_t input = 0; input < engine.inputs( ).size( ); ++input ) {
+    const CircuitPin &pin = engine.inputs( )[ input ];
+    inputNames.append( pin.label.isEmpty( ) ? QString( "in%1" ).arg( input ) : pin.label );
+    inputs.push_back( pin.signals[ 0 ] );
+  }
+  for( size_t output = 0; output < engine.outputs( ).size( ); ++output ) {
+    const CircuitPin &pin = engine.outputs( )[ output ];
+    const QString name = pin.label.isEmpty( ) ? QString( "out%1" ).arg( output ) : pin.label;
+    if( !engine.isValid( static_cast< int >( output ) ) ) {
+      throw std::runtime_error( "Output " + name.toStdString( ) + " is not connected." );
+    }
+    for( size_t port = 0; port < pin.signals.size( ); ++port ) {
+      outputNames.append( pin.signals.size( ) == 1 ? name : QString( "%1[%2]" ).arg( name ).arg( port ) );
+      outputs.push_back( pin.signals[ port ] );
+    }
+  }
+}
+
+/* Orders the signals of the second circuit as the names of the first, which must be the same set. */
+static std::vector< uint32_t > matchPins( const QStringList &names, const QStringList &otherNames,
+                                          const std::vector< uint32_t > &otherSignals, const char *kind ) {
+  QHash< QString, int > index;
+  for( int pin = 0; pin < otherNames.size( ); ++pin ) {
+    if( index.contains( otherNames[ pin ] ) ) {
+      throw std::runtime_error( std::string( "The second circuit has two " ) + kind + "s named " +
+                                otherNames[ pin ].toStdString( ) + "." );
+    }
+    index.insert( otherNames[ pin ], pin );
+  }
+  std::vector< uint32_t > signals;
+  for( const QString &name : names ) {
+    if( !index.contains( name ) ) {
+      throw std::runtime_error( std::string( "The second circuit has no " ) + kind + " named " + name.toStdString( ) +
+                                "." );
+    }
+    signals.push_back( otherSignals[ static_cast< size_t >( index.take( name ) ) ] );
+  }
+  if( !index.isEmpty( ) ) {
+    throw std::runtime_error( std::string( "The first circuit has no " ) + kind + " named " +
+                              index.begin( ).key( ).toStdString( ) + "." );
+  }
+  return( signals );
+}
+
+EquivalenceChecker::EquivalenceChecker( const CircuitEngine &first, const CircuitEngine &second ) : rounds( 64 ),
+  seed( 0 ), nodeLimit( 1 << 22 ), m_provedByBdd( false ), m_simulatedVectors( 0 ) {
+  netlists[ 0 ] = &first.getNetlist( );
+  netlists[ 1 ] = &second.getNetlist( );
+  pinNames( first, m_inputNames, inputs[ 0 ], m_outputNames, outputs[ 0 ] );
+  QStringList inputNames, outputNames;
+  std::vector< uint32_t > inputSignals, outputSignals;
+  pinNames( second, inputNames, inputSignals, outputNames, outputSignals );
+  inputs[ 1 ] = matchPins( m_inputNames, inputNames, inputSignals, "input" );
+  outputs[ 1 ] = matchPins( m_outputNames, outputNames, outputSignals, "output" );
+  if( m_outputNames.isEmpty( ) ) {
+    throw std::runtime_error( "The circuits have no outputs to compare." );
+  }
+}
+
+void EquivalenceChecker::setRandomRounds( uint32_t rounds ) {
+  this->rounds = rounds;
+}
+
+void EquivalenceChecker::setSeed( uint64_t seed ) {
+  this->seed = seed;
+}
+
+void EquivalenceChecker::setNodeLimit( size_t nodes ) {
+  nodeLimit = nodes;
+}
+
+const QStringList &EquivalenceChecker::inputNames( ) const {
+  return( m_inputNames );
+}
+
+const QStringList &EquivalenceChecker::outputNames( ) const {
+  return( m_outputNames );
+}
+
+const std::vector< bool > &EquivalenceChecker::counterexample( ) const {
+  return( m_counterexample );
+}
+
+const QStringList &EquivalenceChecker::differingOutputs( ) const {
+  return( m_differingOutputs );
+}
+
+bool EquivalenceChecker::provedByBdd( ) const {
+  return( m_provedByBdd );
+}
+
+QString EquivalenceChecker::reason( ) const {
+  return( m_reason );
+}
+
+uint64_t EquivalenceChecker::simulatedVectors( ) const {
+  return( m_simulatedVectors );
+}
+
+uint64_t EquivalenceChecker::differences( BitParallelSimulator &first, BitParallelSimulator &second,
+                                          const std::vector< uint64_t > &lanes ) const {
+  for( size_t input = 0; input < lanes.size( ); ++input ) {
+    first.setInput( inputs[ 0 ][ input ], lanes[ input ] );
+    second.setInput( inputs[ 1 ][ input ], lanes[ input ] );
+  }
+  first.run( );
+  second.run( );
+  uint64_t result = 0;
+  for( size_t output = 0; output < outputs[ 0 ].size( ); ++output ) {
+    result |= first.value( outputs[ 0 ][ output ] ) ^ second.value( outputs[ 1 ][ output ] );
+  }
+  return( result );
+}
+
+void EquivalenceChecker::minimize( BitParallelSimulator &first, BitParallelSimulator &second ) {
+  /* Lane k clears the k-th input set in the counterexample, so 64 candidates are tried per run. Any that still
+   * differs is kept, until no single input can be cleared. */
+  std::vector< uint64_t > lanes( m_counterexample.size( ) );
+  bool cleared = true;
+  while( cleared ) {
+    cleared = false;
+    std::vector< size_t > set;
+    for( size_t input = 0; input < m_counterexample.size( ); ++input ) {
+      if( m_counterexample[ input ] ) {
+        set.push_back( input );
+      }
+    }
+    for( size_t base = 0; ( base < set.size( ) ) && !cleared; base += BitParallelSimulator::LANES ) {
+      for( size_t input = 0; input < lanes.size( ); ++input ) {
+        lanes[ input ] = m_counterexample[ input ] ? ~uint64_t( 0 ) : 0;
+      }
+      const size_t count = std::min< size_t >( BitParallelSimulator::LANES, set.size( ) - base );
+      for( size_t lane = 0; lane < count; ++lane ) {
+        lanes[ set[ base + lane ] ] &= ~( uint64_t( 1 ) << lane );
+      }
+      uint64_t differs = differences( first, second, lanes );
+      if( count < BitParallelSimulator::LANES ) {
+        differs &= ( uint64_t( 1 ) << count ) - 1;
+      }
+      if( differs ) {
+        for( size_t lane = 0; lane < count; ++lane ) {
+          if( ( differs >> lane ) & 1 ) {
+            m_counterexample[ set[ base + lane ] ] = false;
+            cleared = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+}
+
+EquivalenceChecker::Verdict EquivalenceChecker::prove( ) {
+  CircuitBdd bdd;
+  bdd.setNodeLimit( nodeLimit );
+  try {
+    bdd.addCircuit( *netlists[ 0 ], inputs[ 0 ], outputs[ 0 ] );
+    bdd.addCircuit( *netlists[ 1 ], inputs[ 1 ], outputs[ 1 ] );
+  }
+  catch( std::runtime_error &e ) {
+    m_reason = QString( "%1 No difference in %2 random vectors." ).arg( e.what( ) ).arg( m_simulatedVectors );
+    return( Verdict::UNKNOWN );
+  }
+  m_provedByBdd = true;
+  /* The miter: true wherever any pair of outputs differs. */
+  BddManager &manager = bdd.manager( );
+  const size_t count = static_cast< size_t >( m_outputNames.size( ) );
+  BddManager::Node miter = BddManager::ZERO;
+  for( size_t output = 0; output < count; ++output ) {
+    miter = manager.bddOr( miter, manager.bddXor( bdd.output( output ), bdd.output( count + output ) ) );
+  }
+  std::vector< bool > values;
+  if( !manager.minSat( miter, values ) ) {
+    return( Verdict::EQUIVALENT );
+  }
+  m_counterexample = values;
+  m_counterexample.resize( inputs[ 0 ].size( ), false );
+  return( Verdict::DIFFERENT );
+}
+
+EquivalenceChecker::Verdict EquivalenceChecker::check( ) {
+  m_counterexample.clear( );
+  m_differingOutputs.clear( );
+  m_provedByBdd = false;
+  m_reason.clear( );
+  m_simulatedVectors = 0;
+  BitParallelSimulator first( *netlists[ 0 ] );
+  BitParallelSimulator second( *netlists[ 1 ] );
+  std::mt19937_64 random( seed );
+  std::vector< uint64_t > lanes( inputs[ 0 ].size( ) );
+  Verdict verdict = Verdict::EQUIVALENT;
+  /* A circuit without inputs only has one vector. */
+  const uint32_t total = lanes.empty( ) ? 1 : rounds;
+  for( uint32_t round = 0; round < total; ++round ) {
+    for( uint64_t &lane : lanes ) {
+      lane = random( );
+    }
+    const uint64_t differs = differences( first, second, lanes );
+    m_simulatedVectors += BitParallelSimulator::LANES;
+    if( differs ) {
+      int lane = 0;
+      while( !( ( differs >> lane ) & 1 ) ) {
+        ++lane;
+      }
+      for( uint64_t value : lanes ) {
+        m_counterexample.push_back( ( value >> lane ) & 1 );
+      }
+      minimize( first, second );
+      verdict = Verdict::DIFFERENT;
+      break;
+    }
+  }
+  if( verdict != Verdict::DIFFERENT ) {
+    verdict = prove( );
+  }
+  if( verdict == Verdict::DIFFERENT ) {
+    for( size_t input = 0; input < lanes.size( ); ++input ) {
+      lanes[ input ] = m_counterexample[ input ] ? ~uint64_t( 0 ) : 0;
+    }
+    differences( first, second, lanes );
+    for( size_t output = 0; output < outputs[ 0 ].size( ); ++output ) {
+      if( ( first.value( outputs[ 0 ][ output ] ) ^ second.value( outputs[ 1 ][ output ] ) ) & 1 ) {
+        m_differingOutputs.append( m_outputNames[ static_cast< int >( output ) ] );
+      }
+    }
+  }
+  return( verdict );
+}
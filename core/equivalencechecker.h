@@ -0,0 +1,100 @@
+#ifndef EQUIVALENCECHECKER_H
+#define EQUIVALENCECHECKER_H
+
+#include "circuitengine.h"
+
+#include <QStringList>
+#include <vector>
+
+class BitParallelSimulator;
+
+/**
+ * @brief The EquivalenceChecker class tells whether two combinational
+ *        circuits compute the same outputs. Inputs and outputs are matched by
+ *        the names BatchSimulation gives them, each port of an output being
+ *        compared on its own.
+ *
+ *        Random vectors are simulated first, 64 at a time, since a wrong
+ *        circuit usually differs on many of them. A difference found this way
+ *        is then reduced by clearing inputs for as long as the outputs still
+ *        differ, which leaves a vector that is only locally minimal: no
+ *        single input can be cleared, but another vector may have fewer set.
+ *        Otherwise the outputs of both circuits are built as BDDs over the
+ *        same variables, which proves equivalence, or yields the
+ *        distinguishing vector with the fewest inputs set.
+ */
+class EquivalenceChecker {
+public:
+  enum class Verdict { EQUIVALENT, DIFFERENT, UNKNOWN };
+
+  /**
+   * @brief EquivalenceChecker throws a std::runtime_error if the circuits
+   *        have clocks, memory elements or feedback loops, if an output is not
+   *        connected, or if their inputs and outputs do not match.
+   */
+  EquivalenceChecker( const CircuitEngine &first, const CircuitEngine &second );
+
+  /**
+   * @brief setRandomRounds sets how many rounds of 64 random vectors are
+   *        simulated before building the BDDs.
+   */
+  void setRandomRounds( uint32_t rounds );
+  void setSeed( uint64_t seed );
+
+  /**
+   * @brief setNodeLimit bounds the BDDs, see CircuitBdd::setNodeLimit( ).
+   *        Past it, check( ) returns UNKNOWN.
+   */
+  void setNodeLimit( size_t nodes );
+
+  Verdict check( );
+
+  /**
+   * @brief inputNames and outputNames are in the order of the first circuit.
+   */
+  const QStringList &inputNames( ) const;
+  const QStringList &outputNames( ) const;
+
+  /**
+   * @brief counterexample is the distinguishing vector found by the last
+   *        check( ) that returned DIFFERENT, one value per input, and
+   *        differingOutputs the outputs that differ under it. It has the
+   *        fewest inputs set when provedByBdd( ), and is locally minimal
+   *        otherwise.
+   */
+  const std::vector< bool > &counterexample( ) const;
+  const QStringList &differingOutputs( ) const;
+
+  /**
+   * @brief provedByBdd tells whether the last verdict came from the BDDs
+   *        rather than from the random vectors, and reason explains an
+   *        UNKNOWN verdict.
+   */
+  bool provedByBdd( ) const;
+  QString reason( ) const;
+  uint64_t simulatedVectors( ) const;
+
+private:
+  const Netlist *netlists[ 2 ];
+  /* Signals of the matched inputs and output ports, per circuit. */
+  std::vector< uint32_t > inputs[ 2 ];
+  std::vector< uint32_t > outputs[ 2 ];
+  QStringList m_inputNames;
+  QStringList m_outputNames;
+  uint32_t rounds;
+  uint64_t seed;
+  size_t nodeLimit;
+  std::vector< bool > m_counterexample;
+  QStringList m_differingOutputs;
+  bool m_provedByBdd;
+  QString m_reason;
+  uint64_t m_simulatedVectors;
+
+  /* Returns the lanes in which any output differs, after setting the inputs of both simulators to lanes. */
+  uint64_t differences( BitParallelSimulator &first, BitParallelSimulator &second,
+                        const std::vector< uint64_t > &lanes ) const;
+  void minimize( BitParallelSimulator &first, BitParallelSimulator &second );
+  Verdict prove( );
+};
+
+#endif // EQUIVALENCECHECKER_H
@@ -0,0 +1,141 @@
+#include "signalhistory.h"
+
+#include <algorithm>
+
+namespace {
+  /* The fewest runs a signal keeps, whatever the memory cap. */
+  const size_t MINIMUM_CAPACITY = 16;
+}
+
+const signed char SignalHistory::UNKNOWN;
+const signed char SignalHistory::CHANGING;
+const size_t SignalHistory::DEFAULT_MEMORY_CAP;
+
+SignalHistory::SignalHistory( ) : cap( DEFAULT_MEMORY_CAP ), capacity( 0 ), allocated( 0 ), lastTime( 0 ) {
+}
+
+void SignalHistory::reset( size_t signalCount, size_t memoryCap ) {
+  cap = memoryCap;
+  capacity = signalCount > 0 ? std::max( MINIMUM_CAPACITY, memoryCap / ( signalCount * sizeof( uint64_t ) ) ) : 0;
+  /* Assigning to the old rings would keep the memory of their runs. */
+  std::vector< Ring >( signalCount ).swap( rings );
+  allocated = 0;
+  lastTime = 0;
+}
+
+size_t SignalHistory::signalCount( ) const {
+  return( rings.size( ) );
+}
+
+size_t SignalHistory::memoryCap( ) const {
+  return( cap );
+}
+
+size_t SignalHistory::memoryUsage( ) const {
+  return( allocated + rings.capacity( ) * sizeof( Ring ) );
+}
+
+void SignalHistory::append( uint32_t signal, uint64_t time, signed char value ) {
+  Ring &ring = rings[ signal ];
+  lastTime = std::max( lastTime, time );
+  if( ( ring.count > 0 ) && ( valueOf( run( signal, ring.count - 1 ) ) == value ) ) {
+    return;
+  }
+  if( ( ring.count > 0 ) && ( timeOf( run( signal, ring.count - 1 ) ) == time ) ) {
+    /* A value that lasted no time is replaced, or merged with the run before it. */
+    if( ( ring.count > 1 ) && ( valueOf( run( signal, ring.count - 2 ) ) == value ) ) {
+      --ring.count;
+    }
+    else {
+      ring.runs[ ( ring.head + ring.count - 1 ) % ring.runs.size( ) ] = pack( time, value );
+    }
+    return;
+  }
+  if( ring.count == ring.runs.size( ) ) {
+    if( ring.runs.size( ) < capacity ) {
+      /* The head stays at 0 until the ring is full, so the new run goes at the end. */
+      if( ring.runs.size( ) == ring.runs.capacity( ) ) {
+        const size_t reserved = ring.runs.capacity( );
+        ring.runs.reserve( std::min( capacity, std::max( MINIMUM_CAPACITY, 2 * reserved ) ) );
+        allocated += ( ring.runs.capacity( ) - reserved ) * sizeof( uint64_t );
+      }
+      ring.runs.push_back( 0 );
+    }
+    else {
+      ring.head = ( ring.head + 1 ) % capacity;
+      --ring.count;
+    }
+  }
+  ring.runs[ ( ring.head + ring.count ) % ring.runs.size( ) ] = pack( time, value );
+  ++ring.count;
+}
+
+uint64_t SignalHistory::begin( uint32_t signal ) const {
+  return( rings[ signal ].count > 0 ? timeOf( run( signal, 0 ) ) : lastTime );
+}
+
+uint64_t SignalHistory::end( ) const {
+  return( lastTime );
+}
+
+signed char SignalHistory::valueAt( uint32_t signal, uint64_t time ) const {
+  const size_t index = findRun( signal, time );
+  return( index < rings[ signal ].count ? valueOf( run( signal, index ) ) : UNKNOWN );
+}
+
+void SignalHistory::sample( uint32_t signal, uint64_t from, uint64_t step, std::vector< signed char > &columns ) const {
+  const size_t count = rings[ signal ].count;
+  /* The run shown at the start of the column, and the first one after it. */
+  size_t index = findRun( signal, from );
+  size_t next = index < count ? index + 1 : 0;
+  for( size_t column = 0; column < columns.size( ); ++column ) {
+    const uint64_t start = from + column * step;
+    if( start > lastTime ) {
+      columns[ column ] = UNKNOWN;
+      continue;
+    }
+    while( ( next < count ) && ( timeOf( run( signal, next ) ) <= start ) ) {
+      index = next++;
+    }
+    const signed char value = index < count ? valueOf( run( signal, index ) ) : UNKNOWN;
+    bool changed = false;
+    while( ( next < count ) && ( timeOf( run( signal, next ) ) < start + step ) ) {
+      index = next++;
+      changed = true;
+    }
+    columns[ column ] = changed ? CHANGING : value;
+  }
+}
+
+uint64_t SignalHistory::run( uint32_t signal, size_t index ) const {
+  const Ring &ring = rings[ signal ];
+  return( ring.runs[ ( ring.head + index ) % ring.runs.size( ) ] );
+}
+
+size_t SignalHistory::findRun( uint32_t signal, uint64_t time ) const {
+  /* The last run that starts at or before time, or count when there is none. */
+  size_t low = 0;
+  size_t high = rings[ signal ].count;
+  while( low < high ) {
+    const size_t middle = ( low + high ) / 2;
+    if( timeOf( run( signal, middle ) ) <= time ) {
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
+  }
+  return( low > 0 ? low - 1 : rings[ signal ].count );
+}
+
+uint64_t SignalHistory::pack( uint64_t time, signed char value ) {
+  return( ( time << 2 ) | static_cast< uint64_t >( value + 1 ) );
+}
+
+uint64_t SignalHistory::timeOf( uint64_t run ) {
+  return( run >> 2 );
+}
+
+signed char SignalHistory::valueOf( uint64_t run ) {
+  return( static_cast< signed char >( static_cast< int >( run & 3 ) - 1 ) );
+}
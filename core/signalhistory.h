@@ -0,0 +1,81 @@
+#ifndef SIGNALHISTORY_H
+#define SIGNALHISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The SignalHistory class keeps the recent values of a set of
+ *        signals in simulated time. Each signal has a ring buffer of runs,
+ *        a run being the time a value starts at, packed with the value in
+ *        64 bits, so a steady signal takes no room whatever the length of
+ *        the run. The buffers grow as runs are appended, up to their share of a
+ *        memory cap: when the ring of a signal is full, its oldest run is
+ *        dropped. It is not thread-safe.
+ */
+class SignalHistory {
+public:
+  /* Returned by valueAt( ) before the history of a signal, and by sample( ) for a column with several values. */
+  static const signed char UNKNOWN = -2;
+  static const signed char CHANGING = 2;
+  static const size_t DEFAULT_MEMORY_CAP = 64 << 20;
+
+  SignalHistory( );
+
+  /**
+   * @brief reset drops the history and caps the rings of signalCount
+   *        signals to fit memoryCap bytes, with a few runs at least.
+   */
+  void reset( size_t signalCount, size_t memoryCap = DEFAULT_MEMORY_CAP );
+  size_t signalCount( ) const;
+  size_t memoryCap( ) const;
+  size_t memoryUsage( ) const;
+
+  /**
+   * @brief append records the value of a signal at time, 1, 0 or -1 for an
+   *        invalid value. Only changes are stored, and times must not
+   *        decrease.
+   */
+  void append( uint32_t signal, uint64_t time, signed char value );
+
+  /**
+   * @brief begin returns the earliest time the history of a signal still
+   *        covers, and end the latest time appended to any signal.
+   */
+  uint64_t begin( uint32_t signal ) const;
+  uint64_t end( ) const;
+  signed char valueAt( uint32_t signal, uint64_t time ) const;
+
+  /**
+   * @brief sample decimates the history of a signal over columns of step
+   *        nanoseconds from time from. Each column holds the only value of
+   *        the signal during it, CHANGING if there were several, or UNKNOWN.
+   *        It takes one binary search, then one step per run shown.
+   */
+  void sample( uint32_t signal, uint64_t from, uint64_t step, std::vector< signed char > &columns ) const;
+
+private:
+  struct Ring {
+    /* Only wraps around once it holds capacity runs. */
+    std::vector< uint64_t > runs;
+    size_t head = 0;
+    size_t count = 0;
+  };
+
+  size_t cap;
+  /* The most runs per signal. */
+  size_t capacity;
+  std::vector< Ring > rings;
+  /* Bytes reserved by the rings. */
+  size_t allocated;
+  uint64_t lastTime;
+
+  uint64_t run( uint32_t signal, size_t index ) const;
+  size_t findRun( uint32_t signal, uint64_t time ) const;
+  static uint64_t pack( uint64_t time, signed char value );
+  static uint64_t timeOf( uint64_t run );
+  static signed char valueOf( uint64_t run );
+};
+
+#endif // SIGNALHISTORY_H
@@ -0,0 +1,79 @@
+#include "bitparallelsimulator.h"
+#include "netlistkernel.h"
+
+const int BitParallelSimulator::LANES;
+
+BitParallelSimulator::BitParallelSimulator( const Netlist &netlist ) :
+  netlist( netlist ),
+  limit( Netlist::DEFAULT_ITERATION_LIMIT ) {
+  reset( );
+}
+
+void BitParallelSimulator::reset( ) {
+  signals.resize( netlist.signalCount( ) );
+  for( uint32_t signal = 0; signal < netlist.signalCount( ); ++signal ) {
+    signals[ signal ] = netlist.initialValues[ signal ] ? LogicLanes< uint64_t >::ones( ) : 0;
+  }
+  state.resize( netlist.stateSize( ) );
+  for( uint32_t slot = 0; slot < netlist.stateSize( ); ++slot ) {
+    state[ slot ] = netlist.initialState[ slot ] ? LogicLanes< uint64_t >::ones( ) : 0;
+  }
+}
+
+void BitParallelSimulator::setInput( uint32_t signal, uint64_t lanes ) {
+  signals[ signal ] = lanes;
+}
+
+void BitParallelSimulator::run( ) {
+  uint32_t gate = 0;
+  for( uint32_t loop = 0; loop < netlist.loopCount( ); ++loop ) {
+    evaluateRange( gate, netlist.loopBegin[ loop ] );
+    const uint32_t first = netlist.loopSignalBegin( loop );
+    const uint32_t size = netlist.loopSignalEnd( loop ) - first;
+    feedback.resize( size );
+    bool changed = true;
+    for( uint32_t pass = 0; changed && ( pass < limit ); ++pass ) {
+      for( uint32_t idx = 0; idx < size; ++idx ) {
+        feedback[ idx ] = signals[ netlist.loopSignals[ first + idx ] ];
+      }
+      evaluateRange( netlist.loopBegin[ loop ], netlist.loopEnd[ loop ] );
+      changed = false;
+      for( uint32_t idx = 0; idx < size; ++idx ) {
+        changed |= ( feedback[ idx ] != signals[ netlist.loopSignals[ first + idx ] ] );
+      }
+    }
+    gate = netlist.loopEnd[ loop ];
+  }
+  evaluateRange( gate, netlist.gateCount( ) );
+}
+
+void BitParallelSimulator::setIterationLimit( uint32_t limit ) {
+  this->limit = std::max( limit, 1u );
+}
+
+void BitParallelSimulator::evaluateRange( uint32_t begin, uint32_t end ) {
+  const uint8_t *valid = netlist.valid.data( );
+  uint64_t *sig = signals.data( );
+  uint64_t *st = state.data( );
+  for( uint32_t gate = begin; gate < end; ++gate ) {
+    if( valid[ gate ] ) {
+      evaluateGate< uint64_t >( netlist, gate, sig, st );
+    }
+  }
+}
+
+uint64_t BitParallelSimulator::value( uint32_t signal ) const {
+  return( signals[ signal ] );
+}
+
+uint64_t BitParallelSimulator::counterLanes( uint64_t base, int bit ) {
+  /* Lane patterns of the six lowest bits of a 0..63 counter. */
+  static const uint64_t patterns[ 6 ] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+  };
+  if( bit < 6 ) {
+    return( patterns[ bit ] );
+  }
+  return( ( ( base >> bit ) & 1 ) ? LogicLanes< uint64_t >::ones( ) : 0 );
+}
@@ -0,0 +1,47 @@
+#ifndef BITPARALLELSIMULATOR_H
+#define BITPARALLELSIMULATOR_H
+
+#include "netlist.h"
+
+/**
+ * @brief The BitParallelSimulator class evaluates 64 independent test vectors
+ *        at once. Each signal is stored in a uint64_t, and bit N of every
+ *        signal belongs to the N-th vector.
+ */
+class BitParallelSimulator {
+public:
+  static const int LANES = 64;
+
+  explicit BitParallelSimulator( const Netlist &netlist );
+
+  void reset( );
+  void setInput( uint32_t signal, uint64_t lanes );
+  void run( );
+
+  uint64_t value( uint32_t signal ) const;
+
+  /**
+   * @brief setIterationLimit sets how many times, at most, the gates of a
+   *        feedback loop are evaluated within one run( ). A loop is
+   *        evaluated again as long as any lane changes.
+   */
+  void setIterationLimit( uint32_t limit );
+
+  /**
+   * @brief counterLanes returns the lanes of bit 'bit' of a counter that
+   *        starts at 'base' and is incremented once per lane. Lane N then
+   *        holds the vector number base + N.
+   */
+  static uint64_t counterLanes( uint64_t base, int bit );
+
+private:
+  const Netlist &netlist;
+  std::vector< uint64_t > signals;
+  std::vector< uint64_t > state;
+  std::vector< uint64_t > feedback;
+  uint32_t limit;
+
+  void evaluateRange( uint32_t begin, uint32_t end );
+};
+
+#endif // BITPARALLELSIMULATOR_H
@@ -0,0 +1,86 @@
+#include "clockscheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  const double NANOSECONDS = 1e9;
+
+  double periodOf( double frequency ) {
+    return( frequency > 0.0 ? NANOSECONDS / frequency : 0.0 );
+  }
+}
+
+const uint64_t ClockScheduler::NEVER;
+
+void ClockScheduler::clear( ) {
+  clocks.clear( );
+  heap.clear( );
+}
+
+uint32_t ClockScheduler::addClock( double frequency, bool enabled, bool value, uint64_t now ) {
+  const uint32_t clock = static_cast< uint32_t >( clocks.size( ) );
+  clocks.push_back( { periodOf( frequency ), now, 0, 0, enabled, value } );
+  schedule( clock );
+  return( clock );
+}
+
+uint32_t ClockScheduler::size( ) const {
+  return( static_cast< uint32_t >( clocks.size( ) ) );
+}
+
+void ClockScheduler::restart( uint32_t clock, double frequency, uint64_t now ) {
+  ClockData &data = clocks[ clock ];
+  data.period = periodOf( frequency );
+  data.start = now;
+  data.count = 0;
+  data.value = true;
+  ++data.generation;
+  schedule( clock );
+  dropStale( );
+}
+
+bool ClockScheduler::value( uint32_t clock ) const {
+  return( clocks[ clock ].value );
+}
+
+uint64_t ClockScheduler::nextEdge( ) const {
+  return( heap.empty( ) ? NEVER : heap.front( ).time );
+}
+
+uint32_t ClockScheduler::popEdge( ) {
+  std::pop_heap( heap.begin( ), heap.end( ), later );
+  const uint32_t clock = heap.back( ).clock;
+  heap.pop_back( );
+  clocks[ clock ].value = !clocks[ clock ].value;
+  schedule( clock );
+  dropStale( );
+  return( clock );
+}
+
+void ClockScheduler::schedule( uint32_t clock ) {
+  ClockData &data = clocks[ clock ];
+  if( !data.enabled || ( data.period <= 0.0 ) ) {
+    return;
+  }
+  ++data.count;
+  /* Computed from the restart time on each edge, so rounding errors do not add up. */
+  const double offset = std::round( static_cast< double >( data.count ) * data.period );
+  const uint64_t time = data.start + std::max( static_cast< uint64_t >( offset ), uint64_t( 1 ) );
+  heap.push_back( { time, clock, data.generation } );
+  std::push_heap( heap.begin( ), heap.end( ), later );
+}
+
+void ClockScheduler::dropStale( ) {
+  while( !heap.empty( ) && ( heap.front( ).generation != clocks[ heap.front( ).clock ].generation ) ) {
+    std::pop_heap( heap.begin( ), heap.end( ), later );
+    heap.pop_back( );
+  }
+}
+
+bool ClockScheduler::later( const Edge &e1, const Edge &e2 ) {
+  if( e1.time != e2.time ) {
+    return( e1.time > e2.time );
+  }
+  return( e1.clock > e2.clock );
+}
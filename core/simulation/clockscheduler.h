@@ -0,0 +1,75 @@
+#ifndef CLOCKSCHEDULER_H
+#define CLOCKSCHEDULER_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The ClockScheduler class keeps the edges of free-running clocks in
+ *        simulated time, counted in nanoseconds. A clock toggles every
+ *        1 / frequency seconds, and its k-th edge after a restart at time s
+ *        falls at s + round( k * 1e9 / frequency ), so edges never drift
+ *        whatever the frequency. Pending edges are kept in a min-heap
+ *        ordered by time, then by clock, so edges of several clocks that
+ *        fall at the same time come out one after the other, in a fixed
+ *        order, before any later edge.
+ */
+class ClockScheduler {
+public:
+  static const uint64_t NEVER = UINT64_MAX;
+
+  void clear( );
+
+  /**
+   * @brief addClock adds a clock whose first edge is one period after now.
+   *        Disabled clocks keep their value and are never scheduled.
+   */
+  uint32_t addClock( double frequency, bool enabled, bool value, uint64_t now );
+  uint32_t size( ) const;
+
+  /**
+   * @brief restart sets the clock high at now, then schedules its edges
+   *        from there with the given frequency.
+   */
+  void restart( uint32_t clock, double frequency, uint64_t now );
+
+  bool value( uint32_t clock ) const;
+
+  /**
+   * @brief nextEdge returns the time of the earliest pending edge, or NEVER.
+   */
+  uint64_t nextEdge( ) const;
+
+  /**
+   * @brief popEdge toggles the clock of the earliest pending edge, schedules
+   *        its following edge, and returns it.
+   */
+  uint32_t popEdge( );
+
+private:
+  struct ClockData {
+    /* Nanoseconds between two edges. */
+    double period;
+    uint64_t start;
+    uint64_t count;
+    uint32_t generation;
+    bool enabled;
+    bool value;
+  };
+
+  struct Edge {
+    uint64_t time;
+    uint32_t clock;
+    /* Edges scheduled before the last restart of their clock are stale. */
+    uint32_t generation;
+  };
+
+  std::vector< ClockData > clocks;
+  std::vector< Edge > heap;
+
+  void schedule( uint32_t clock );
+  void dropStale( );
+  static bool later( const Edge &e1, const Edge &e2 );
+};
+
+#endif // CLOCKSCHEDULER_H
@@ -0,0 +1,124 @@
+#include "eventdrivensimulator.h"
+#include "netlistkernel.h"
+
+#include <climits>
+
+EventDrivenSimulator::EventDrivenSimulator( const Netlist &netlist ) : NetlistSimulator( netlist ) {
+  int maxLevel = 0;
+  uint32_t maxOutputs = 0;
+  for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+    maxLevel = std::max( maxLevel, netlist.levels[ gate ] );
+    maxOutputs = std::max( maxOutputs, netlist.outputSize( gate ) );
+  }
+  levelQueues.resize( static_cast< size_t >( maxLevel ) + 1 );
+  previous.resize( maxOutputs );
+  reset( );
+}
+
+void EventDrivenSimulator::reset( ) {
+  NetlistSimulator::reset( );
+  for( std::vector< uint32_t > &queue : levelQueues ) {
+    queue.clear( );
+  }
+  deferred.clear( );
+  nextTick.clear( );
+  pending.assign( netlist.gateCount( ), false );
+  /* The first tick evaluates every gate, as the full sweep does. */
+  for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+    schedule( gate, INT_MAX );
+  }
+}
+
+void EventDrivenSimulator::schedule( uint32_t gate, int currentLevel ) {
+  if( pending[ gate ] || !netlist.valid[ gate ] || ( netlist.ops[ gate ] == LogicOp::INPUT ) ) {
+    return;
+  }
+  pending[ gate ] = true;
+  int level = netlist.levels[ gate ];
+  if( level < currentLevel ) {
+    levelQueues[ level ].push_back( gate );
+  }
+  else {
+    deferred.push_back( gate );
+  }
+}
+
+void EventDrivenSimulator::scheduleFanout( uint32_t signal, int currentLevel ) {
+  for( uint32_t idx = netlist.fanoutBegin[ signal ]; idx < netlist.fanoutBegin[ signal + 1 ]; ++idx ) {
+    schedule( netlist.fanouts[ idx ], currentLevel );
+  }
+}
+
+void EventDrivenSimulator::setInput( uint32_t signal, bool value ) {
+  if( signals[ signal ] != value ) {
+    signals[ signal ] = value;
+    scheduleFanout( signal, INT_MAX );
+  }
+}
+
+void EventDrivenSimulator::run( ) {
+  for( uint32_t gate : nextTick ) {
+    levelQueues[ netlist.levels[ gate ] ].push_back( gate );
+  }
+  nextTick.clear( );
+  uint64_t evaluated = 0;
+  int level = static_cast< int >( levelQueues.size( ) ) - 1;
+  for( uint32_t loop = 0; loop < netlist.loopCount( ); ++loop ) {
+    /* Loops hold whole levels, so their gates are drained as a block of levels. */
+    const int high = netlist.levels[ netlist.loopBegin[ loop ] ];
+    const int low = netlist.levels[ netlist.loopEnd[ loop ] - 1 ];
+    evaluated += drain( level, high + 1 );
+    evaluated += drain( high, low );
+    uint32_t passes = 1;
+    while( !deferred.empty( ) && ( passes < limit ) ) {
+      for( uint32_t gate : deferred ) {
+        levelQueues[ netlist.levels[ gate ] ].push_back( gate );
+      }
+      deferred.clear( );
+      evaluated += drain( high, low );
+      ++passes;
+    }
+    for( uint32_t cycle = netlist.loopCycleBegin[ loop ]; cycle < netlist.loopCycleBegin[ loop + 1 ]; ++cycle ) {
+      oscillating[ cycle ] = false;
+    }
+    /* A gate is only deferred when a loop signal of its own cycle changed, but a netlist whose cycles were cut
+     * after it was levelized may hold others. */
+    for( uint32_t gate : deferred ) {
+      if( netlist.cycleIndex[ gate ] >= 0 ) {
+        oscillating[ netlist.cycleIndex[ gate ] ] = true;
+      }
+    }
+    nextTick.insert( nextTick.end( ), deferred.begin( ), deferred.end( ) );
+    deferred.clear( );
+    level = low - 1;
+  }
+  evaluated += drain( level, 0 );
+  nextTick.insert( nextTick.end( ), deferred.begin( ), deferred.end( ) );
+  deferred.clear( );
+  evaluations = evaluated;
+}
+
+uint64_t EventDrivenSimulator::drain( int high, int low ) {
+  uint8_t *sig = signals.data( );
+  uint8_t *st = state.data( );
+  uint64_t evaluated = 0;
+  for( int level = high; level >= low; --level ) {
+    std::vector< uint32_t > &queue = levelQueues[ level ];
+    for( size_t idx = 0; idx < queue.size( ); ++idx ) {
+      uint32_t gate = queue[ idx ];
+      pending[ gate ] = false;
+      const uint32_t begin = netlist.outputBegin[ gate ];
+      const uint32_t end = netlist.outputBegin[ gate + 1 ];
+      std::copy( sig + begin, sig + end, previous.begin( ) );
+      evaluateGate< uint8_t >( netlist, gate, sig, st );
+      ++evaluated;
+      for( uint32_t signal = begin; signal < end; ++signal ) {
+        if( sig[ signal ] != previous[ signal - begin ] ) {
+          scheduleFanout( signal, level );
+        }
+      }
+    }
+    queue.clear( );
+  }
+  return( evaluated );
+}
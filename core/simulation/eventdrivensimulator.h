@@ -0,0 +1,35 @@
+#ifndef EVENTDRIVENSIMULATOR_H
+#define EVENTDRIVENSIMULATOR_H
+
+#include "netlistsimulator.h"
+
+/**
+ * @brief The EventDrivenSimulator class evaluates only the gates whose inputs
+ *        changed. Gates are queued per topological level (the priority given
+ *        by ElementMapping::sort( )) and levels are drained in the same
+ *        order as the full sweep. Connected gates never share a level, so
+ *        a change that feeds back to a level that was already drained is
+ *        deferred to the next pass over its loop, exactly as the full sweep
+ *        would see it.
+ */
+class EventDrivenSimulator : public NetlistSimulator {
+public:
+  explicit EventDrivenSimulator( const Netlist &netlist );
+
+  void reset( ) override;
+  void setInput( uint32_t signal, bool value ) override;
+  void run( ) override;
+
+private:
+  std::vector< std::vector< uint32_t > > levelQueues;
+  std::vector< uint32_t > deferred;
+  std::vector< uint32_t > nextTick;
+  std::vector< uint8_t > pending;
+  std::vector< uint8_t > previous;
+
+  void schedule( uint32_t gate, int currentLevel );
+  void scheduleFanout( uint32_t signal, int currentLevel );
+  uint64_t drain( int high, int low );
+};
+
+#endif // EVENTDRIVENSIMULATOR_H
@@ -0,0 +1,215 @@
+#include "gatekernels.h"
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define GATEKERNELS_X86
+#include <immintrin.h>
+#endif
+
+const size_t GateKernels::WIDE;
+
+namespace {
+  typedef bool (*ReduceFn)( const uint8_t*, size_t );
+
+  struct Reductions {
+    ReduceFn reduceAnd;
+    ReduceFn reduceOr;
+    ReduceFn reduceXor;
+  };
+
+  bool andScalar( const uint8_t *values, size_t size ) {
+    for( size_t idx = 0; idx < size; ++idx ) {
+      if( !values[ idx ] ) {
+        return( false );
+      }
+    }
+    return( true );
+  }
+
+  bool orScalar( const uint8_t *values, size_t size ) {
+    for( size_t idx = 0; idx < size; ++idx ) {
+      if( values[ idx ] ) {
+        return( true );
+      }
+    }
+    return( false );
+  }
+
+  bool xorScalar( const uint8_t *values, size_t size ) {
+    bool result = false;
+    for( size_t idx = 0; idx < size; ++idx ) {
+      result ^= ( values[ idx ] != 0 );
+    }
+    return( result );
+  }
+
+#ifdef GATEKERNELS_X86
+  /* Each kernel compares 16 or 32 bytes against zero at once. The number of
+   * zero bytes of a block has the same parity as the number of set bytes,
+   * since the block size is even, so the XOR kernels only count zeros. */
+
+  __attribute__( ( target( "sse2" ) ) )
+  bool andSse2( const uint8_t *values, size_t size ) {
+    const __m128i zero = _mm_setzero_si128( );
+    size_t idx = 0;
+    for( ; idx + 16 <= size; idx += 16 ) {
+      __m128i block = _mm_loadu_si128( reinterpret_cast< const __m128i* >( values + idx ) );
+      if( _mm_movemask_epi8( _mm_cmpeq_epi8( block, zero ) ) != 0 ) {
+        return( false );
+      }
+    }
+    return( andScalar( values + idx, size - idx ) );
+  }
+
+  __attribute__( ( target( "sse2" ) ) )
+  bool orSse2( const uint8_t *values, size_t size ) {
+    const __m128i zero = _mm_setzero_si128( );
+    size_t idx = 0;
+    for( ; idx + 16 <= size; idx += 16 ) {
+      __m128i block = _mm_loadu_si128( reinterpret_cast< const __m128i* >( values + idx ) );
+      if( _mm_movemask_epi8( _mm_cmpeq_epi8( block, zero ) ) != 0xFFFF ) {
+        return( true );
+      }
+    }
+    return( orScalar( values + idx, size - idx ) );
+  }
+
+  __attribute__( ( target( "sse2" ) ) )
+  bool xorSse2( const uint8_t *values, size_t size ) {
+    const __m128i zero = _mm_setzero_si128( );
+    unsigned int zeros = 0;
+    size_t idx = 0;
+    for( ; idx + 16 <= size; idx += 16 ) {
+      __m128i block = _mm_loadu_si128( reinterpret_cast< const __m128i* >( values + idx ) );
+      zeros ^= static_cast< unsigned int >( _mm_movemask_epi8( _mm_cmpeq_epi8( block, zero ) ) );
+    }
+    return( ( __builtin_parity( zeros ) != 0 ) != xorScalar( values + idx, size - idx ) );
+  }
+
+  __attribute__( ( target( "avx2" ) ) )
+  bool andAvx2( const uint8_t *values, size_t size ) {
+    const __m256i zero = _mm256_setzero_si256( );
+    size_t idx = 0;
+    for( ; idx + 32 <= size; idx += 32 ) {
+      __m256i block = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( values + idx ) );
+      if( _mm256_movemask_epi8( _mm256_cmpeq_epi8( block, zero ) ) != 0 ) {
+        return( false );
+      }
+    }
+    /* Avoids the AVX to SSE transition penalty in the tail call. */
+    _mm256_zeroupper( );
+    return( andSse2( values + idx, size - idx ) );
+  }
+
+  __attribute__( ( target( "avx2" ) ) )
+  bool orAvx2( const uint8_t *values, size_t size ) {
+    const __m256i zero = _mm256_setzero_si256( );
+    size_t idx = 0;
+    for( ; idx + 32 <= size; idx += 32 ) {
+      __m256i block = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( values + idx ) );
+      if( _mm256_movemask_epi8( _mm256_cmpeq_epi8( block, zero ) ) != -1 ) {
+        return( true );
+      }
+    }
+    /* Avoids the AVX to SSE transition penalty in the tail call. */
+    _mm256_zeroupper( );
+    return( orSse2( values + idx, size - idx ) );
+  }
+
+  __attribute__( ( target( "avx2" ) ) )
+  bool xorAvx2( const uint8_t *values, size_t size ) {
+    const __m256i zero = _mm256_setzero_si256( );
+    unsigned int zeros = 0;
+    size_t idx = 0;
+    for( ; idx + 32 <= size; idx += 32 ) {
+      __m256i block = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( values + idx ) );
+      zeros ^= static_cast< unsigned int >( _mm256_movemask_epi8( _mm256_cmpeq_epi8( block, zero ) ) );
+    }
+    _mm256_zeroupper( );
+    return( ( __builtin_parity( zeros ) != 0 ) != xorSse2( values + idx, size - idx ) );
+  }
+#endif
+
+  const Reductions &reductions( GateKernels::Isa isa ) {
+    static const Reductions scalar = { andScalar, orScalar, xorScalar };
+#ifdef GATEKERNELS_X86
+    static const Reductions sse2 = { andSse2, orSse2, xorSse2 };
+    static const Reductions avx2 = { andAvx2, orAvx2, xorAvx2 };
+    switch( isa ) {
+        case GateKernels::Isa::AVX2:
+        return( avx2 );
+        case GateKernels::Isa::SSE2:
+        return( sse2 );
+        case GateKernels::Isa::SCALAR:
+        break;
+    }
+#else
+    ( void ) isa;
+#endif
+    return( scalar );
+  }
+
+  const Reductions &bestReductions( ) {
+    static const Reductions &best = reductions( GateKernels::bestIsa( ) );
+    return( best );
+  }
+}
+
+GateKernels::Isa GateKernels::bestIsa( ) {
+  static const Isa best = isSupported( Isa::AVX2 ) ? Isa::AVX2 : ( isSupported( Isa::SSE2 ) ? Isa::SSE2 : Isa::SCALAR );
+  return( best );
+}
+
+bool GateKernels::isSupported( Isa isa ) {
+  switch( isa ) {
+      case Isa::SCALAR:
+      return( true );
+#ifdef GATEKERNELS_X86
+      case Isa::SSE2:
+      __builtin_cpu_init( );
+      return( __builtin_cpu_supports( "sse2" ) );
+      case Isa::AVX2:
+      __builtin_cpu_init( );
+      return( __builtin_cpu_supports( "avx2" ) );
+#else
+      default:
+      return( false );
+#endif
+  }
+  return( false );
+}
+
+const char* GateKernels::isaName( Isa isa ) {
+  switch( isa ) {
+      case Isa::SSE2:
+      return( "SSE2" );
+      case Isa::AVX2:
+      return( "AVX2" );
+      case Isa::SCALAR:
+      break;
+  }
+  return( "scalar" );
+}
+
+bool GateKernels::reduceAnd( Isa isa, const uint8_t *values, size_t size ) {
+  return( reductions( isa ).reduceAnd( values, size ) );
+}
+
+bool GateKernels::reduceOr( Isa isa, const uint8_t *values, size_t size ) {
+  return( reductions( isa ).reduceOr( values, size ) );
+}
+
+bool GateKernels::reduceXor( Isa isa, const uint8_t *values, size_t size ) {
+  return( reductions( isa ).reduceXor( values, size ) );
+}
+
+bool GateKernels::wideAnd( const uint8_t *values, size_t size ) {
+  return( bestReductions( ).reduceAnd( values, size ) );
+}
+
+bool GateKernels::wideOr( const uint8_t *values, size_t size ) {
+  return( bestReductions( ).reduceOr( values, size ) );
+}
+
+bool GateKernels::wideXor( const uint8_t *values, size_t size ) {
+  return( bestReductions( ).reduceXor( values, size ) );
+}
@@ -0,0 +1,75 @@
+#ifndef GATEKERNELS_H
+#define GATEKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief The GateKernels class reduces the packed input values of n-ary
+ *        gates. Each input is stored in a byte, zero meaning low. Wide
+ *        inputs are processed with SSE2 or AVX2, chosen at runtime
+ *        according to the CPU, with a scalar fallback.
+ */
+class GateKernels {
+public:
+  enum class Isa { SCALAR, SSE2, AVX2 };
+
+  /**
+   * @brief WIDE is the input size from which the vectorized kernels pay off.
+   */
+  static const size_t WIDE = 16;
+
+  static inline bool reduceAnd( const uint8_t *values, size_t size ) {
+    if( size >= WIDE ) {
+      return( wideAnd( values, size ) );
+    }
+    for( size_t idx = 0; idx < size; ++idx ) {
+      if( !values[ idx ] ) {
+        return( false );
+      }
+    }
+    return( true );
+  }
+
+  static inline bool reduceOr( const uint8_t *values, size_t size ) {
+    if( size >= WIDE ) {
+      return( wideOr( values, size ) );
+    }
+    for( size_t idx = 0; idx < size; ++idx ) {
+      if( values[ idx ] ) {
+        return( true );
+      }
+    }
+    return( false );
+  }
+
+  static inline bool reduceXor( const uint8_t *values, size_t size ) {
+    if( size >= WIDE ) {
+      return( wideXor( values, size ) );
+    }
+    bool result = false;
+    for( size_t idx = 0; idx < size; ++idx ) {
+      result ^= ( values[ idx ] != 0 );
+    }
+    return( result );
+  }
+
+  /**
+   * @brief bestIsa returns the fastest instruction set supported by the CPU.
+   */
+  static Isa bestIsa( );
+  static bool isSupported( Isa isa );
+  static const char* isaName( Isa isa );
+
+  /* Explicit variants, used to compare the implementations. */
+  static bool reduceAnd( Isa isa, const uint8_t *values, size_t size );
+  static bool reduceOr( Isa isa, const uint8_t *values, size_t size );
+  static bool reduceXor( Isa isa, const uint8_t *values, size_t size );
+
+private:
+  static bool wideAnd( const uint8_t *values, size_t size );
+  static bool wideOr( const uint8_t *values, size_t size );
+  static bool wideXor( const uint8_t *values, size_t size );
+};
+
+#endif // GATEKERNELS_H
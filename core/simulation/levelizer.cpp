@@ -0,0 +1,163 @@
+#include "levelizer.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+  const uint32_t UNVISITED = UINT32_MAX;
+}
+
+Levelizer::Levelizer( std::vector< uint32_t > begin, std::vector< uint32_t > successors ) :
+  begin( std::move( begin ) ),
+  successors( std::move( successors ) ) {
+}
+
+uint32_t Levelizer::size( ) const {
+  return( begin.empty( ) ? 0 : static_cast< uint32_t >( begin.size( ) - 1 ) );
+}
+
+void Levelizer::levelize( std::vector< int > &priorities ) const {
+  struct Frame {
+    uint32_t node;
+    uint32_t next;
+    int max;
+  };
+  const uint32_t nodes = size( );
+  priorities.resize( nodes, -1 );
+  std::vector< uint8_t > visiting( nodes, 0 );
+  std::vector< Frame > stack;
+  for( uint32_t root = 0; root < nodes; ++root ) {
+    if( priorities[ root ] != -1 ) {
+      continue;
+    }
+    visiting[ root ] = 1;
+    stack.push_back( Frame { root, begin[ root ], 0 } );
+    while( !stack.empty( ) ) {
+      Frame &frame = stack.back( );
+      if( frame.next < begin[ frame.node + 1 ] ) {
+        uint32_t succ = successors[ frame.next++ ];
+        if( visiting[ succ ] ) {
+          continue;
+        }
+        if( priorities[ succ ] != -1 ) {
+          frame.max = std::max( frame.max, priorities[ succ ] );
+          continue;
+        }
+        visiting[ succ ] = 1;
+        stack.push_back( Frame { succ, begin[ succ ], 0 } );
+      }
+      else {
+        int p = frame.max + 1;
+        priorities[ frame.node ] = p;
+        visiting[ frame.node ] = 0;
+        stack.pop_back( );
+        if( !stack.empty( ) ) {
+          stack.back( ).max = std::max( stack.back( ).max, p );
+        }
+      }
+    }
+  }
+}
+
+std::vector< std::vector< uint32_t > > Levelizer::feedbackLoops( ) const {
+  /* Tarjan's algorithm, with the recursion replaced by a stack of frames. */
+  struct Frame {
+    uint32_t node;
+    uint32_t next;
+  };
+  const uint32_t nodes = size( );
+  std::vector< uint32_t > index( nodes, UNVISITED );
+  std::vector< uint32_t > low( nodes, 0 );
+  std::vector< uint8_t > onStack( nodes, 0 );
+  std::vector< uint32_t > component;
+  std::vector< Frame > stack;
+  std::vector< std::vector< uint32_t > > loops;
+  uint32_t counter = 0;
+  for( uint32_t root = 0; root < nodes; ++root ) {
+    if( index[ root ] != UNVISITED ) {
+      continue;
+    }
+    index[ root ] = low[ root ] = counter++;
+    onStack[ root ] = 1;
+    component.push_back( root );
+    stack.push_back( Frame { root, begin[ root ] } );
+    while( !stack.empty( ) ) {
+      Frame &frame = stack.back( );
+      uint32_t node = frame.node;
+      if( frame.next < begin[ node + 1 ] ) {
+        uint32_t succ = successors[ frame.next++ ];
+        if( index[ succ ] == UNVISITED ) {
+          index[ succ ] = low[ succ ] = counter++;
+          onStack[ succ ] = 1;
+          component.push_back( succ );
+          stack.push_back( Frame { succ, begin[ succ ] } );
+        }
+        else if( onStack[ succ ] ) {
+          low[ node ] = std::min( low[ node ], index[ succ ] );
+        }
+        continue;
+      }
+      stack.pop_back( );
+      if( !stack.empty( ) ) {
+        uint32_t parent = stack.back( ).node;
+        low[ parent ] = std::min( low[ parent ], low[ node ] );
+      }
+      if( low[ node ] != index[ node ] ) {
+        continue;
+      }
+      size_t first = component.size( );
+      do {
+        --first;
+      } while( component[ first ] != node );
+      std::vector< uint32_t > loop( component.begin( ) + first, component.end( ) );
+      component.resize( first );
+      for( uint32_t member : loop ) {
+        onStack[ member ] = 0;
+      }
+      bool cyclic = loop.size( ) > 1;
+      for( uint32_t edge = begin[ node ]; !cyclic && ( edge < begin[ node + 1 ] ); ++edge ) {
+        cyclic = ( successors[ edge ] == node );
+      }
+      if( cyclic ) {
+        loops.push_back( std::move( loop ) );
+      }
+    }
+  }
+  return( loops );
+}
+
+std::vector< std::pair< uint32_t, uint32_t > > Levelizer::loopRanges( const std::vector< int > &levels,
+                                                                     const std::vector< std::vector< uint32_t > > &loops ) {
+  /* Levels spanned by each loop, highest level first. */
+  std::vector< std::pair< int, int > > spans;
+  for( const std::vector< uint32_t > &loop : loops ) {
+    if( loop.empty( ) ) {
+      continue;
+    }
+    int high = levels[ loop.front( ) ];
+    int low = high;
+    for( uint32_t node : loop ) {
+      high = std::max( high, levels[ node ] );
+      low = std::min( low, levels[ node ] );
+    }
+    spans.push_back( std::make_pair( high, low ) );
+  }
+  std::sort( spans.begin( ), spans.end( ), [ ]( const std::pair< int, int > &first, const std::pair< int, int > &second ) {
+    return( first.first > second.first );
+  } );
+  std::vector< std::pair< uint32_t, uint32_t > > ranges;
+  auto position = [ &levels ]( int level ) {
+    /* First position whose level is not above level. */
+    return( static_cast< uint32_t >( std::lower_bound( levels.begin( ), levels.end( ), level, std::greater< int >( ) ) -
+                                     levels.begin( ) ) );
+  };
+  for( size_t idx = 0; idx < spans.size( ); ) {
+    int high = spans[ idx ].first;
+    int low = spans[ idx ].second;
+    for( ++idx; ( idx < spans.size( ) ) && ( spans[ idx ].first >= low ); ++idx ) {
+      low = std::min( low, spans[ idx ].second );
+    }
+    ranges.push_back( std::make_pair( position( high ), position( low - 1 ) ) );
+  }
+  return( ranges );
+}
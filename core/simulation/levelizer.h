@@ -0,0 +1,52 @@
+#ifndef LEVELIZER_H
+#define LEVELIZER_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The Levelizer class sorts a directed graph given over dense node
+ *        indices, the successors of node n being successors[ begin[ n ] ]
+ *        to successors[ begin[ n + 1 ] - 1 ]. Both passes use explicit
+ *        stacks, so deep chains cannot overflow the call stack.
+ */
+class Levelizer {
+public:
+  Levelizer( std::vector< uint32_t > begin, std::vector< uint32_t > successors );
+
+  uint32_t size( ) const;
+
+  /**
+   * @brief levelize fills the priorities that are -1 with one more than the
+   *        highest priority of the successors, so sinks get 1 and sorting by
+   *        descending priority evaluates every node before its successors.
+   *        Nodes are visited depth first in index order, and an edge closing
+   *        a loop counts as 0, so connected nodes never share a priority even
+   *        inside a feedback loop. Priorities that are already known are kept
+   *        and reused, which allows recomputing only an invalidated cone.
+   */
+  void levelize( std::vector< int > &priorities ) const;
+
+  /**
+   * @brief feedbackLoops returns the strongly connected components that hold
+   *        a cycle, that is, with more than one node or with a self-loop.
+   */
+  std::vector< std::vector< uint32_t > > feedbackLoops( ) const;
+
+  /**
+   * @brief loopRanges returns the ranges [first, second) of an evaluation
+   *        order, sorted by descending level, that must be iterated together
+   *        for the given loops to settle. Ranges always hold whole levels,
+   *        so they do not depend on the order of the nodes within a level,
+   *        and loops whose levels overlap share a range.
+   */
+  static std::vector< std::pair< uint32_t, uint32_t > > loopRanges( const std::vector< int > &levels,
+                                                                    const std::vector< std::vector< uint32_t > > &loops );
+
+private:
+  std::vector< uint32_t > begin;
+  std::vector< uint32_t > successors;
+};
+
+#endif // LEVELIZER_H
@@ -0,0 +1,16 @@
+#ifndef LOGICOP_H
+#define LOGICOP_H
+
+#include <cstdint>
+
+/**
+ * @brief The LogicOp enum identifies the behaviour of a logic element,
+ *        independently of the graphic element that generated it.
+ *        It is used as the gate opcode of the compiled netlist.
+ */
+enum class LogicOp : uint8_t {
+  INPUT, NODE, OUTPUT, AND, OR, NAND, NOR, XOR, XNOR, NOT, MUX, DEMUX,
+  DLATCH, DFLIPFLOP, JKFLIPFLOP, SRFLIPFLOP, TFLIPFLOP
+};
+
+#endif // LOGICOP_H
@@ -0,0 +1,164 @@
+#include "nativecompiler.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QProcess>
+#include <QStandardPaths>
+
+namespace {
+  /* Compiling a large circuit at -O2 takes much longer and barely runs faster than -O1. */
+  const QStringList compilerFlags = { "-O1", "-shared", "-fPIC", "-w" };
+  const int compilerTimeout = 120000;
+  /* Libraries kept in the cache, the least recently used ones being removed first. */
+  const int cacheCapacity = 32;
+
+#if defined( Q_OS_WIN )
+  const char *const librarySuffix = ".dll";
+#elif defined( Q_OS_MAC )
+  const char *const librarySuffix = ".dylib";
+#else
+  const char *const librarySuffix = ".so";
+#endif
+}
+
+NativeCompiler::NativeCompiler( ) : step( nullptr ) {
+}
+
+NativeCompiler::~NativeCompiler( ) {
+  if( library.isLoaded( ) ) {
+    library.unload( );
+  }
+}
+
+bool NativeCompiler::build( const Netlist &netlist ) {
+  step = nullptr;
+  QString compiler = findCompiler( );
+  if( compiler.isEmpty( ) ) {
+    error = QObject::tr( "No C++ compiler was found." );
+    return( false );
+  }
+  QByteArray source = QByteArray::fromStdString( NativeSimulator::generateSource( netlist ) );
+  QCryptographicHash hash( QCryptographicHash::Sha1 );
+  hash.addData( source );
+  hash.addData( compiler.toUtf8( ) );
+  hash.addData( compilerFlags.join( " " ).toUtf8( ) );
+  QString key = QString::fromLatin1( hash.result( ).toHex( ) );
+
+  QDir cache( cacheDirectory( ) );
+  if( !cache.mkpath( "." ) ) {
+    error = QObject::tr( "Could not create the cache directory %1." ).arg( cache.path( ) );
+    return( false );
+  }
+  QString libraryFile = cache.filePath( key + librarySuffix );
+  if( !QFile::exists( libraryFile ) ) {
+    /* Other processes may build the same netlist at the same time, so the files being written are their own. */
+    QString sourceFile = cache.filePath( QString( "%1.%2.cpp" ).arg( key ).arg( QCoreApplication::applicationPid( ) ) );
+    QFile file( sourceFile );
+    if( !file.open( QFile::WriteOnly | QFile::Truncate ) ) {
+      error = QObject::tr( "Could not write %1." ).arg( sourceFile );
+      return( false );
+    }
+    file.write( source );
+    file.close( );
+    bool compiled = compile( compiler, sourceFile, libraryFile );
+    QFile::remove( sourceFile );
+    if( !compiled ) {
+      return( false );
+    }
+    pruneCache( cache );
+  }
+  else {
+    /* The modification time orders the cache by last use. */
+    QFile file( libraryFile );
+    if( file.open( QFile::Append ) ) {
+      file.setFileTime( QDateTime::currentDateTime( ), QFileDevice::FileModificationTime );
+    }
+  }
+  library.setFileName( libraryFile );
+  if( !library.load( ) ) {
+    error = library.errorString( );
+    return( false );
+  }
+  step = reinterpret_cast< NativeSimulator::StepFunction >( library.resolve( NativeSimulator::STEP_SYMBOL ) );
+  if( !step ) {
+    error = library.errorString( );
+    library.unload( );
+    return( false );
+  }
+  return( true );
+}
+
+bool NativeCompiler::compile( const QString &compiler, const QString &sourceFile, const QString &libraryFile ) {
+  /* Builds into a temporary file, so that an interrupted build never leaves a broken library in the cache. */
+  QString temporaryFile = QString( "%1.%2.tmp" ).arg( libraryFile ).arg( QCoreApplication::applicationPid( ) );
+  QProcess process;
+  process.setProcessChannelMode( QProcess::MergedChannels );
+  process.start( compiler, QStringList( compilerFlags ) << "-o" << temporaryFile << sourceFile );
+  if( !process.waitForStarted( ) ) {
+    error = QObject::tr( "Could not start %1." ).arg( compiler );
+    return( false );
+  }
+  if( !process.waitForFinished( compilerTimeout ) ) {
+    process.kill( );
+    process.waitForFinished( );
+    QFile::remove( temporaryFile );
+    error = QObject::tr( "%1 timed out." ).arg( compiler );
+    return( false );
+  }
+  if( ( process.exitStatus( ) != QProcess::NormalExit ) || ( process.exitCode( ) != 0 ) ) {
+    QFile::remove( temporaryFile );
+    error = QString::fromLocal8Bit( process.readAll( ) );
+    return( false );
+  }
+  QFile::remove( libraryFile );
+  if( !QFile::rename( temporaryFile, libraryFile ) ) {
+    QFile::remove( temporaryFile );
+    /* Another process may have put the same library in place first. */
+    if( !QFile::exists( libraryFile ) ) {
+      error = QObject::tr( "Could not write %1." ).arg( libraryFile );
+      return( false );
+    }
+  }
+  return( true );
+}
+
+void NativeCompiler::pruneCache( const QDir &cache ) {
+  const QFileInfoList libraries = cache.entryInfoList( QStringList( ) << QString( "*" ) + librarySuffix, QDir::Files,
+                                                       QDir::Time );
+  for( int idx = cacheCapacity; idx < libraries.size( ); ++idx ) {
+    /* A library still loaded elsewhere may not be removable, and is tried again next time. */
+    QFile::remove( libraries[ idx ].absoluteFilePath( ) );
+  }
+}
+
+NativeSimulator::StepFunction NativeCompiler::stepFunction( ) const {
+  return( step );
+}
+
+QString NativeCompiler::errorString( ) const {
+  return( error );
+}
+
+QString NativeCompiler::findCompiler( ) {
+  for( const char *variable : { "WPANDA_CXX", "CXX" } ) {
+    QString compiler = QString::fromLocal8Bit( qgetenv( variable ) );
+    if( !compiler.isEmpty( ) ) {
+      QString path = QStandardPaths::findExecutable( compiler );
+      return( path.isEmpty( ) ? compiler : path );
+    }
+  }
+  for( const char *name : { "c++", "g++", "clang++" } ) {
+    QString path = QStandardPaths::findExecutable( name );
+    if( !path.isEmpty( ) ) {
+      return( path );
+    }
+  }
+  return( QString( ) );
+}
+
+QString NativeCompiler::cacheDirectory( ) {
+  return( QDir( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) ).filePath( "native" ) );
+}
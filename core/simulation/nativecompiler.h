@@ -0,0 +1,50 @@
+#ifndef NATIVECOMPILER_H
+#define NATIVECOMPILER_H
+
+#include "nativesimulator.h"
+
+#include <QLibrary>
+#include <QString>
+
+class QDir;
+
+/**
+ * @brief The NativeCompiler class builds the C++ translation of a netlist
+ *        with the compiler installed on the host and loads the resulting
+ *        shared library. Libraries are cached by the hash of their source,
+ *        so a circuit that was already simulated is not compiled again, and
+ *        the least recently used ones are removed past a few dozen. The
+ *        library stays loaded while the NativeCompiler exists.
+ */
+class NativeCompiler {
+public:
+  NativeCompiler( );
+  ~NativeCompiler( );
+
+  /**
+   * @brief build returns false when no compiler is available or when the
+   *        source could not be compiled or loaded. See errorString( ).
+   */
+  bool build( const Netlist &netlist );
+
+  NativeSimulator::StepFunction stepFunction( ) const;
+  QString errorString( ) const;
+
+  /**
+   * @brief findCompiler returns the C++ compiler given by the WPANDA_CXX or
+   *        CXX environment variables, or the first of c++, g++ and clang++
+   *        found in the PATH. It returns an empty string if there is none.
+   */
+  static QString findCompiler( );
+  static QString cacheDirectory( );
+
+private:
+  QLibrary library;
+  NativeSimulator::StepFunction step;
+  QString error;
+
+  bool compile( const QString &compiler, const QString &sourceFile, const QString &libraryFile );
+  static void pruneCache( const QDir &cache );
+};
+
+#endif // NATIVECOMPILER_H
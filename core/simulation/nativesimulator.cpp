@@ -0,0 +1,273 @@
+#include "nativesimulator.h"
+
+#include <algorithm>
+#include <sstream>
+
+const char *const NativeSimulator::STEP_SYMBOL = "wpanda_step";
+
+namespace {
+  /* The sequential elements are emitted as inline functions, which are the uint8_t instances of evaluateGate( ). */
+  const char *const prelude =
+    "#include <stdint.h>\n"
+    "\n"
+    "struct NativeState {\n"
+    "  uint8_t *signals;\n"
+    "  uint8_t *state;\n"
+    "  uint8_t *oscillating;\n"
+    "  uint32_t *passes;\n"
+    "  uint32_t iterationLimit;\n"
+    "};\n"
+    "\n"
+    "static inline uint8_t sel( uint8_t mask, uint8_t ifSet, uint8_t ifClear ) {\n"
+    "  return( ( mask & ifSet ) | ( ( mask ^ 1 ) & ifClear ) );\n"
+    "}\n"
+    "\n"
+    "static inline void dlatch( uint8_t *out, uint8_t D, uint8_t enable ) {\n"
+    "  out[ 0 ] = sel( enable, D, out[ 0 ] );\n"
+    "  out[ 1 ] = sel( enable, D ^ 1, out[ 1 ] );\n"
+    "}\n"
+    "\n"
+    "static inline void async( uint8_t *out, uint8_t prst, uint8_t clr, uint8_t q0, uint8_t q1 ) {\n"
+    "  uint8_t reset = ( prst & clr ) ^ 1;\n"
+    "  out[ 0 ] = sel( reset, prst ^ 1, q0 );\n"
+    "  out[ 1 ] = sel( reset, clr ^ 1, q1 );\n"
+    "}\n"
+    "\n"
+    "static inline void dflipflop( uint8_t *out, uint8_t *st, uint8_t D, uint8_t clk, uint8_t prst, uint8_t clr ) {\n"
+    "  uint8_t edge = clk & ( st[ 0 ] ^ 1 );\n"
+    "  async( out, prst, clr, sel( edge, st[ 1 ], out[ 0 ] ), sel( edge, st[ 1 ] ^ 1, out[ 1 ] ) );\n"
+    "  st[ 0 ] = clk;\n"
+    "  st[ 1 ] = D;\n"
+    "}\n"
+    "\n"
+    "static inline void jkflipflop( uint8_t *out, uint8_t *st, uint8_t j, uint8_t clk, uint8_t k, uint8_t prst,\n"
+    "                               uint8_t clr ) {\n"
+    "  uint8_t edge = clk & ( st[ 0 ] ^ 1 );\n"
+    "  uint8_t both = st[ 1 ] & st[ 2 ];\n"
+    "  uint8_t none = ( st[ 1 ] | st[ 2 ] ) ^ 1;\n"
+    "  uint8_t next0 = ( both & out[ 1 ] ) | ( st[ 1 ] & ( st[ 2 ] ^ 1 ) ) | ( none & out[ 0 ] );\n"
+    "  uint8_t next1 = ( both & out[ 0 ] ) | ( st[ 2 ] & ( st[ 1 ] ^ 1 ) ) | ( none & out[ 1 ] );\n"
+    "  async( out, prst, clr, sel( edge, next0, out[ 0 ] ), sel( edge, next1, out[ 1 ] ) );\n"
+    "  st[ 0 ] = clk;\n"
+    "  st[ 1 ] = j;\n"
+    "  st[ 2 ] = k;\n"
+    "}\n"
+    "\n"
+    "static inline void srflipflop( uint8_t *out, uint8_t *st, uint8_t s, uint8_t clk, uint8_t r, uint8_t prst,\n"
+    "                               uint8_t clr ) {\n"
+    "  uint8_t edge = clk & ( st[ 0 ] ^ 1 );\n"
+    "  async( out, prst, clr, sel( edge, s | ( ( r ^ 1 ) & out[ 0 ] ), out[ 0 ] ),\n"
+    "         sel( edge, r | ( ( s ^ 1 ) & out[ 1 ] ), out[ 1 ] ) );\n"
+    "  st[ 0 ] = clk;\n"
+    "}\n"
+    "\n"
+    "static inline void tflipflop( uint8_t *out, uint8_t *st, uint8_t T, uint8_t clk, uint8_t prst, uint8_t clr ) {\n"
+    "  uint8_t toggle = clk & ( st[ 0 ] ^ 1 ) & st[ 1 ];\n"
+    "  async( out, prst, clr, out[ 0 ] ^ toggle, sel( toggle, out[ 0 ], out[ 1 ] ) );\n"
+    "  st[ 0 ] = clk;\n"
+    "  st[ 1 ] = T;\n"
+    "}\n"
+    "\n";
+
+  void writeSignal( std::ostream &out, uint32_t signal ) {
+    out << "s[ " << signal << " ]";
+  }
+
+  void writeInputs( std::ostream &out, const Netlist &netlist, uint32_t gate ) {
+    for( uint32_t idx = 0; idx < netlist.inputSize( gate ); ++idx ) {
+      out << ", ";
+      writeSignal( out, netlist.fanin( gate, idx ) );
+    }
+  }
+
+  void writeReduction( std::ostream &out, const Netlist &netlist, uint32_t gate, const char *op, const char *empty,
+                       bool negate ) {
+    writeSignal( out, netlist.outputSignal( gate ) );
+    out << " = ";
+    if( negate ) {
+      out << "( ";
+    }
+    if( netlist.inputSize( gate ) == 0 ) {
+      out << empty;
+    }
+    for( uint32_t idx = 0; idx < netlist.inputSize( gate ); ++idx ) {
+      if( idx > 0 ) {
+        out << " " << op << " ";
+      }
+      writeSignal( out, netlist.fanin( gate, idx ) );
+    }
+    if( negate ) {
+      out << " ) ^ 1";
+    }
+    out << ";\n";
+  }
+
+  void writeSequential( std::ostream &out, const Netlist &netlist, uint32_t gate, const char *function ) {
+    out << function << "( s + " << netlist.outputBegin[ gate ];
+    if( Netlist::stateSize( netlist.ops[ gate ] ) > 0 ) {
+      out << ", st + " << netlist.stateBegin[ gate ];
+    }
+    writeInputs( out, netlist, gate );
+    out << " );\n";
+  }
+
+  void writeLoopBegin( std::ostream &out, const Netlist &netlist, uint32_t loop ) {
+    const uint32_t first = netlist.loopSignalBegin( loop );
+    const uint32_t size = netlist.loopSignalEnd( loop ) - first;
+    out << "  {\n";
+    out << "    uint32_t pass = 0;\n";
+    out << "    uint8_t changed;\n";
+    out << "    uint8_t f[ " << std::max( size, 1u ) << " ];\n";
+    out << "    do {\n";
+    for( uint32_t idx = 0; idx < size; ++idx ) {
+      out << "      f[ " << idx << " ] = ";
+      writeSignal( out, netlist.loopSignals[ first + idx ] );
+      out << ";\n";
+    }
+  }
+
+  void writeLoopEnd( std::ostream &out, const Netlist &netlist, uint32_t loop ) {
+    const uint32_t first = netlist.loopSignalBegin( loop );
+    const uint32_t size = netlist.loopSignalEnd( loop ) - first;
+    out << "      changed = 0;\n";
+    for( uint32_t idx = 0; idx < size; ++idx ) {
+      out << "      changed |= f[ " << idx << " ] ^ ";
+      writeSignal( out, netlist.loopSignals[ first + idx ] );
+      out << ";\n";
+    }
+    out << "      ++pass;\n";
+    out << "    } while( changed && ( pass < nativeState->iterationLimit ) );\n";
+    out << "    nativeState->passes[ " << loop << " ] = pass;\n";
+    /* f still holds the loop signals from before the last pass. */
+    for( uint32_t cycle = netlist.loopCycleBegin[ loop ]; cycle < netlist.loopCycleBegin[ loop + 1 ]; ++cycle ) {
+      out << "    nativeState->oscillating[ " << cycle << " ] = 0";
+      for( uint32_t idx = netlist.cycleSignalBegin[ cycle ]; idx < netlist.cycleSignalBegin[ cycle + 1 ]; ++idx ) {
+        out << " | ( f[ " << idx - first << " ] ^ ";
+        writeSignal( out, netlist.loopSignals[ idx ] );
+        out << " )";
+      }
+      out << ";\n";
+    }
+    out << "  }\n";
+  }
+}
+
+NativeSimulator::NativeSimulator( const Netlist &netlist, StepFunction step ) :
+  NetlistSimulator( netlist ),
+  step( step ),
+  passes( netlist.loopCount( ), 0 ) {
+}
+
+void NativeSimulator::run( ) {
+  NativeState nativeState = { signals.data( ), state.data( ), oscillating.data( ), passes.data( ), limit };
+  step( &nativeState );
+  evaluations = validGates;
+  for( uint32_t loop = 0; loop < netlist.loopCount( ); ++loop ) {
+    evaluations += ( passes[ loop ] - 1 ) * loopGates[ loop ];
+  }
+}
+
+std::string NativeSimulator::generateSource( const Netlist &netlist ) {
+  std::ostringstream out;
+  out << "/* Generated by WiRedPanda: " << netlist.gateCount( ) << " gates, " << netlist.signalCount( )
+      << " signals. */\n";
+  out << prelude;
+  out << "extern \"C\" void " << STEP_SYMBOL << "( struct NativeState *nativeState ) {\n";
+  out << "  uint8_t *s = nativeState->signals;\n";
+  out << "  uint8_t *st = nativeState->state;\n";
+  out << "  ( void ) st;\n";
+  /* Each loop is a do-while block that runs its gates until the loop signals, saved in f, stop changing. */
+  uint32_t loop = 0;
+  const char *indent = "  ";
+  for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+    if( ( loop < netlist.loopCount( ) ) && ( gate == netlist.loopEnd[ loop ] ) ) {
+      writeLoopEnd( out, netlist, loop++ );
+      indent = "  ";
+    }
+    if( ( loop < netlist.loopCount( ) ) && ( gate == netlist.loopBegin[ loop ] ) ) {
+      writeLoopBegin( out, netlist, loop );
+      indent = "      ";
+    }
+    if( !netlist.valid[ gate ] ) {
+      continue;
+    }
+    std::ostringstream line;
+    switch( netlist.ops[ gate ] ) {
+        case LogicOp::INPUT:
+        break;
+        case LogicOp::NODE:
+        case LogicOp::OUTPUT:
+        for( uint32_t idx = 0; idx < netlist.inputSize( gate ); ++idx ) {
+          writeSignal( line, netlist.outputSignal( gate, idx ) );
+          line << " = ";
+          writeSignal( line, netlist.fanin( gate, idx ) );
+          line << ";\n";
+        }
+        break;
+        case LogicOp::AND:
+        case LogicOp::NAND:
+        writeReduction( line, netlist, gate, "&", "1", netlist.ops[ gate ] == LogicOp::NAND );
+        break;
+        case LogicOp::OR:
+        case LogicOp::NOR:
+        writeReduction( line, netlist, gate, "|", "0", netlist.ops[ gate ] == LogicOp::NOR );
+        break;
+        case LogicOp::XOR:
+        case LogicOp::XNOR:
+        writeReduction( line, netlist, gate, "^", "0", netlist.ops[ gate ] == LogicOp::XNOR );
+        break;
+        case LogicOp::NOT:
+        writeSignal( line, netlist.outputSignal( gate ) );
+        line << " = ";
+        writeSignal( line, netlist.fanin( gate ) );
+        line << " ^ 1;\n";
+        break;
+        case LogicOp::MUX:
+        writeSignal( line, netlist.outputSignal( gate ) );
+        line << " = sel( ";
+        writeSignal( line, netlist.fanin( gate, 2 ) );
+        line << ", ";
+        writeSignal( line, netlist.fanin( gate, 1 ) );
+        line << ", ";
+        writeSignal( line, netlist.fanin( gate, 0 ) );
+        line << " );\n";
+        break;
+        case LogicOp::DEMUX: {
+        /* Both inputs are read before any output is written, the outputs may feed back. */
+        line << "{ uint8_t data = ";
+        writeSignal( line, netlist.fanin( gate, 0 ) );
+        line << ", choice = ";
+        writeSignal( line, netlist.fanin( gate, 1 ) );
+        line << "; ";
+        writeSignal( line, netlist.outputSignal( gate, 0 ) );
+        line << " = data & ( choice ^ 1 ); ";
+        writeSignal( line, netlist.outputSignal( gate, 1 ) );
+        line << " = data & choice; }\n";
+        break;
+      }
+        case LogicOp::DLATCH:
+        writeSequential( line, netlist, gate, "dlatch" );
+        break;
+        case LogicOp::DFLIPFLOP:
+        writeSequential( line, netlist, gate, "dflipflop" );
+        break;
+        case LogicOp::JKFLIPFLOP:
+        writeSequential( line, netlist, gate, "jkflipflop" );
+        break;
+        case LogicOp::SRFLIPFLOP:
+        writeSequential( line, netlist, gate, "srflipflop" );
+        break;
+        case LogicOp::TFLIPFLOP:
+        writeSequential( line, netlist, gate, "tflipflop" );
+        break;
+    }
+    if( !line.str( ).empty( ) ) {
+      out << indent << line.str( );
+    }
+  }
+  if( loop < netlist.loopCount( ) ) {
+    writeLoopEnd( out, netlist, loop );
+  }
+  out << "}\n";
+  return( out.str( ) );
+}
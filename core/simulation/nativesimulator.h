@@ -0,0 +1,49 @@
+#ifndef NATIVESIMULATOR_H
+#define NATIVESIMULATOR_H
+
+#include "netlistsimulator.h"
+
+#include <string>
+
+/**
+ * @brief NativeState is the argument of the generated step function. Its
+ *        layout must match the declaration emitted by
+ *        NativeSimulator::generateSource( ).
+ */
+struct NativeState {
+  uint8_t *signals;
+  uint8_t *state;
+  uint8_t *oscillating;
+  uint32_t *passes;
+  uint32_t iterationLimit;
+};
+
+/**
+ * @brief The NativeSimulator class runs a netlist that was translated to C++
+ *        and compiled into a shared library. Each tick is a single call to
+ *        the step function of the library, which evaluates the valid gates
+ *        in order and iterates the feedback loops, exactly as
+ *        NetlistSimulator::run( ) does.
+ */
+class NativeSimulator : public NetlistSimulator {
+public:
+  typedef void ( *StepFunction )( NativeState* );
+
+  static const char *const STEP_SYMBOL;
+
+  NativeSimulator( const Netlist &netlist, StepFunction step );
+
+  void run( ) override;
+
+  /**
+   * @brief generateSource returns the C++ translation of the netlist. It
+   *        defines an extern "C" function named STEP_SYMBOL.
+   */
+  static std::string generateSource( const Netlist &netlist );
+
+private:
+  StepFunction step;
+  std::vector< uint32_t > passes;
+};
+
+#endif // NATIVESIMULATOR_H
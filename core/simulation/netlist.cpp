@@ -0,0 +1,228 @@
+#include "levelizer.h"
+#include "netlist.h"
+
+#include <algorithm>
+
+const uint32_t Netlist::DEFAULT_ITERATION_LIMIT;
+
+Netlist::Netlist( ) {
+  clear( );
+}
+
+void Netlist::clear( ) {
+  ops.clear( );
+  valid.clear( );
+  levels.clear( );
+  delays.clear( );
+  faninBegin.assign( 1, 0 );
+  outputBegin.assign( 1, 0 );
+  stateBegin.assign( 1, 0 );
+  fanins.clear( );
+  drivers.clear( );
+  initialValues.clear( );
+  initialState.clear( );
+  fanoutBegin.assign( 1, 0 );
+  fanouts.clear( );
+  loopBegin.clear( );
+  loopEnd.clear( );
+  loopCycleBegin.assign( 1, 0 );
+  cycleSignalBegin.assign( 1, 0 );
+  loopSignals.clear( );
+  cycleIndex.clear( );
+}
+
+uint32_t Netlist::addGate( LogicOp op, uint32_t inputSize, uint32_t outputSize ) {
+  uint32_t gate = gateCount( );
+  ops.push_back( op );
+  valid.push_back( true );
+  levels.push_back( 0 );
+  delays.push_back( 0 );
+  fanins.resize( fanins.size( ) + inputSize, 0 );
+  faninBegin.push_back( static_cast< uint32_t >( fanins.size( ) ) );
+  outputBegin.push_back( outputBegin.back( ) + outputSize );
+  stateBegin.push_back( stateBegin.back( ) + stateSize( op ) );
+  drivers.resize( drivers.size( ) + outputSize, gate );
+  initialValues.resize( initialValues.size( ) + outputSize, false );
+  initialState.resize( stateBegin.back( ), false );
+  return( gate );
+}
+
+void Netlist::setFanin( uint32_t gate, uint32_t index, uint32_t signal ) {
+  fanins[ faninBegin[ gate ] + index ] = signal;
+}
+
+void Netlist::setValid( uint32_t gate, bool value ) {
+  valid[ gate ] = value;
+}
+
+void Netlist::setLevel( uint32_t gate, int level ) {
+  levels[ gate ] = level;
+}
+
+void Netlist::setDelay( uint32_t gate, uint32_t delay ) {
+  delays[ gate ] = delay;
+}
+
+void Netlist::setInitialValue( uint32_t signal, bool value ) {
+  initialValues[ signal ] = value;
+}
+
+void Netlist::finalize( ) {
+  std::vector< std::vector< uint32_t > > readers( signalCount( ) );
+  for( uint32_t gate = 0; gate < gateCount( ); ++gate ) {
+    for( uint32_t idx = faninBegin[ gate ]; idx < faninBegin[ gate + 1 ]; ++idx ) {
+      std::vector< uint32_t > &list = readers[ fanins[ idx ] ];
+      if( list.empty( ) || ( list.back( ) != gate ) ) {
+        list.push_back( gate );
+      }
+    }
+  }
+  fanoutBegin.assign( 1, 0 );
+  fanouts.clear( );
+  for( const std::vector< uint32_t > &list : readers ) {
+    fanouts.insert( fanouts.end( ), list.begin( ), list.end( ) );
+    fanoutBegin.push_back( static_cast< uint32_t >( fanouts.size( ) ) );
+  }
+  findLoops( );
+}
+
+void Netlist::findLoops( ) {
+  loopBegin.clear( );
+  loopEnd.clear( );
+  loopCycleBegin.assign( 1, 0 );
+  cycleSignalBegin.assign( 1, 0 );
+  loopSignals.clear( );
+  cycleIndex.assign( gateCount( ), -1 );
+  std::vector< uint32_t > begin( 1, 0 );
+  std::vector< uint32_t > successors;
+  for( uint32_t gate = 0; gate < gateCount( ); ++gate ) {
+    successors.insert( successors.end( ), fanouts.begin( ) + fanoutBegin[ outputBegin[ gate ] ],
+                       fanouts.begin( ) + fanoutBegin[ outputBegin[ gate + 1 ] ] );
+    begin.push_back( static_cast< uint32_t >( successors.size( ) ) );
+  }
+  std::vector< std::vector< uint32_t > > cycles = Levelizer( begin, successors ).feedbackLoops( );
+  if( cycles.empty( ) ) {
+    return;
+  }
+  for( const auto &range : Levelizer::loopRanges( levels, cycles ) ) {
+    loopBegin.push_back( range.first );
+    loopEnd.push_back( range.second );
+  }
+  /* Cycles are numbered loop by loop. */
+  std::vector< std::pair< uint32_t, uint32_t > > order;
+  for( uint32_t cycle = 0; cycle < cycles.size( ); ++cycle ) {
+    uint32_t loop = static_cast< uint32_t >( std::upper_bound( loopBegin.begin( ), loopBegin.end( ),
+                                                               cycles[ cycle ].front( ) ) - loopBegin.begin( ) ) - 1;
+    order.push_back( std::make_pair( loop, cycle ) );
+  }
+  std::sort( order.begin( ), order.end( ) );
+  for( uint32_t idx = 0; idx < order.size( ); ++idx ) {
+    for( uint32_t gate : cycles[ order[ idx ].second ] ) {
+      cycleIndex[ gate ] = static_cast< int >( idx );
+    }
+    while( loopCycleBegin.size( ) <= order[ idx ].first ) {
+      loopCycleBegin.push_back( idx );
+    }
+  }
+  while( loopCycleBegin.size( ) <= loopCount( ) ) {
+    loopCycleBegin.push_back( static_cast< uint32_t >( order.size( ) ) );
+  }
+  /* Only gates of the same cycle read a signal driven later in the evaluation order. */
+  std::vector< std::vector< uint32_t > > signals( order.size( ) );
+  std::vector< uint8_t > listed( signalCount( ), false );
+  for( uint32_t loop = 0; loop < loopCount( ); ++loop ) {
+    for( uint32_t gate = loopBegin[ loop ]; gate < loopEnd[ loop ]; ++gate ) {
+      if( !valid[ gate ] || ( cycleIndex[ gate ] < 0 ) ) {
+        continue;
+      }
+      for( uint32_t idx = faninBegin[ gate ]; idx < faninBegin[ gate + 1 ]; ++idx ) {
+        uint32_t signal = fanins[ idx ];
+        if( ( drivers[ signal ] >= gate ) && ( drivers[ signal ] < loopEnd[ loop ] ) && !listed[ signal ] ) {
+          listed[ signal ] = true;
+          signals[ cycleIndex[ gate ] ].push_back( signal );
+        }
+      }
+    }
+  }
+  for( const std::vector< uint32_t > &list : signals ) {
+    loopSignals.insert( loopSignals.end( ), list.begin( ), list.end( ) );
+    cycleSignalBegin.push_back( static_cast< uint32_t >( loopSignals.size( ) ) );
+  }
+}
+
+uint32_t Netlist::gateCount( ) const {
+  return( static_cast< uint32_t >( ops.size( ) ) );
+}
+
+uint32_t Netlist::loopCount( ) const {
+  return( static_cast< uint32_t >( loopBegin.size( ) ) );
+}
+
+uint32_t Netlist::cycleCount( ) const {
+  return( static_cast< uint32_t >( cycleSignalBegin.size( ) - 1 ) );
+}
+
+uint32_t Netlist::loopSignalBegin( uint32_t loop ) const {
+  return( cycleSignalBegin[ loopCycleBegin[ loop ] ] );
+}
+
+uint32_t Netlist::loopSignalEnd( uint32_t loop ) const {
+  return( cycleSignalBegin[ loopCycleBegin[ loop + 1 ] ] );
+}
+
+uint32_t Netlist::signalCount( ) const {
+  return( outputBegin.back( ) );
+}
+
+uint32_t Netlist::stateSize( ) const {
+  return( stateBegin.back( ) );
+}
+
+uint32_t Netlist::inputSize( uint32_t gate ) const {
+  return( faninBegin[ gate + 1 ] - faninBegin[ gate ] );
+}
+
+uint32_t Netlist::outputSize( uint32_t gate ) const {
+  return( outputBegin[ gate + 1 ] - outputBegin[ gate ] );
+}
+
+uint32_t Netlist::fanin( uint32_t gate, uint32_t index ) const {
+  return( fanins[ faninBegin[ gate ] + index ] );
+}
+
+uint32_t Netlist::outputSignal( uint32_t gate, uint32_t port ) const {
+  return( outputBegin[ gate ] + port );
+}
+
+bool Netlist::isSequential( uint32_t gate ) const {
+  return( ( ops[ gate ] == LogicOp::DLATCH ) || ( stateSize( ops[ gate ] ) > 0 ) );
+}
+
+bool Netlist::isCombinational( ) const {
+  for( uint32_t gate = 0; gate < gateCount( ); ++gate ) {
+    if( isSequential( gate ) ) {
+      return( false );
+    }
+    for( uint32_t idx = faninBegin[ gate ]; idx < faninBegin[ gate + 1 ]; ++idx ) {
+      uint32_t driver = drivers[ fanins[ idx ] ];
+      if( ( driver >= gate ) && ( ops[ driver ] != LogicOp::INPUT ) ) {
+        return( false );
+      }
+    }
+  }
+  return( true );
+}
+
+uint32_t Netlist::stateSize( LogicOp op ) {
+  switch( op ) {
+      case LogicOp::DFLIPFLOP:
+      case LogicOp::TFLIPFLOP:
+      return( 2 );
+      case LogicOp::JKFLIPFLOP:
+      return( 3 );
+      case LogicOp::SRFLIPFLOP:
+      return( 1 );
+      default:
+      return( 0 );
+  }
+}
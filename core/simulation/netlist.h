@@ -0,0 +1,123 @@
+#ifndef NETLIST_H
+#define NETLIST_H
+
+#include "logicop.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The Netlist class is a flat, structure-of-arrays representation of a
+ *        sorted logic circuit. Gates are stored in evaluation order and
+ *        identified by dense indices. Each gate reads its inputs from, and
+ *        writes its outputs to, a packed signal array owned by the engine
+ *        that runs the netlist, so the same netlist may be evaluated over
+ *        several independent signal arrays.
+ */
+class Netlist {
+public:
+  /**
+   * @brief DEFAULT_ITERATION_LIMIT is how many times, at most, the gates of a
+   *        feedback loop are evaluated within one tick.
+   */
+  static const uint32_t DEFAULT_ITERATION_LIMIT = 32;
+
+  Netlist( );
+
+  void clear( );
+
+  /**
+   * @brief addGate appends a gate and allocates its output signals. Its
+   *        fan-in slots must be filled later with setFanin( ).
+   */
+  uint32_t addGate( LogicOp op, uint32_t inputSize, uint32_t outputSize );
+  void setFanin( uint32_t gate, uint32_t index, uint32_t signal );
+  void setValid( uint32_t gate, bool valid );
+  void setLevel( uint32_t gate, int level );
+  /**
+   * @brief setDelay sets the propagation delay of a gate, in nanoseconds,
+   *        which only the timed simulation takes into account.
+   */
+  void setDelay( uint32_t gate, uint32_t delay );
+  void setInitialValue( uint32_t signal, bool value );
+
+  /**
+   * @brief finalize builds the fan-out table and finds the feedback loops.
+   *        It must be called after all gates are added and connected.
+   */
+  void finalize( );
+
+  uint32_t gateCount( ) const;
+  uint32_t loopCount( ) const;
+  uint32_t cycleCount( ) const;
+
+  /**
+   * @brief loopSignalBegin and loopSignalEnd address the loop signals of all
+   *        the cycles of a loop in loopSignals.
+   */
+  uint32_t loopSignalBegin( uint32_t loop ) const;
+  uint32_t loopSignalEnd( uint32_t loop ) const;
+  uint32_t signalCount( ) const;
+  uint32_t stateSize( ) const;
+
+  uint32_t inputSize( uint32_t gate ) const;
+  uint32_t outputSize( uint32_t gate ) const;
+  uint32_t fanin( uint32_t gate, uint32_t index = 0 ) const;
+  uint32_t outputSignal( uint32_t gate, uint32_t port = 0 ) const;
+
+  bool isSequential( uint32_t gate ) const;
+
+  /**
+   * @brief isCombinational returns true when the netlist has no sequential
+   *        element and no feedback loop, so that a single sweep computes the
+   *        outputs from the inputs alone.
+   */
+  bool isCombinational( ) const;
+
+  /**
+   * @brief stateSize returns how many state slots (last clock, last data...)
+   *        a gate of the given kind needs between two evaluations.
+   */
+  static uint32_t stateSize( LogicOp op );
+
+  /* Per gate tables. The *Begin tables have gateCount( ) + 1 entries. */
+  std::vector< LogicOp > ops;
+  std::vector< uint8_t > valid;
+  std::vector< int > levels;
+  std::vector< uint32_t > delays;
+  std::vector< uint32_t > faninBegin;
+  std::vector< uint32_t > outputBegin;
+  std::vector< uint32_t > stateBegin;
+
+  /* Signal indices read by each gate, addressed through faninBegin. */
+  std::vector< uint32_t > fanins;
+
+  /* Per signal tables. fanoutBegin has signalCount( ) + 1 entries. */
+  std::vector< uint32_t > drivers;
+  std::vector< uint8_t > initialValues;
+
+  /* Per state slot table, addressed through stateBegin. */
+  std::vector< uint8_t > initialState;
+  std::vector< uint32_t > fanoutBegin;
+  std::vector< uint32_t > fanouts;
+
+  /* Per loop tables. Gates [loopBegin, loopEnd) are evaluated again until the loop signals of their cycles stop
+   * changing. The cycles of a loop are [loopCycleBegin[ loop ], loopCycleBegin[ loop + 1 ]). */
+  std::vector< uint32_t > loopBegin;
+  std::vector< uint32_t > loopEnd;
+  std::vector< uint32_t > loopCycleBegin;
+
+  /* Per cycle table. A cycle is a set of gates that depend on each other. Its loop signals, the outputs that are read
+   * by a gate of the cycle evaluated before their driver, are addressed through cycleSignalBegin. */
+  std::vector< uint32_t > cycleSignalBegin;
+  std::vector< uint32_t > loopSignals;
+
+  /* Per gate table: the cycle of each gate, or -1. */
+  std::vector< int > cycleIndex;
+
+private:
+  void findLoops( );
+};
+
+#endif // NETLIST_H
@@ -0,0 +1,320 @@
+#ifndef NETLISTKERNEL_H
+#define NETLISTKERNEL_H
+
+#include "netlist.h"
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * @brief LogicLanes describes the word type used to store signals. A signal
+ *        word holds one independent simulation per bit that is set in ones( ).
+ *        uint8_t stores a single boolean, uint64_t stores 64 test vectors.
+ */
+template< typename W >
+struct LogicLanes;
+
+template< >
+struct LogicLanes< uint8_t > {
+  static inline uint8_t ones( ) {
+    return( 1 );
+  }
+};
+
+template< >
+struct LogicLanes< uint64_t > {
+  static inline uint64_t ones( ) {
+    return( ~static_cast< uint64_t >( 0 ) );
+  }
+};
+
+template< typename W >
+inline W laneSelect( W mask, W ifSet, W ifClear ) {
+  return( ( mask & ifSet ) | ( ( mask ^ LogicLanes< W >::ones( ) ) & ifClear ) );
+}
+
+/**
+ * @brief evaluateGate evaluates a single gate of the netlist over the signal
+ *        and state words. It mirrors the _updateLogic( ) implementations of
+ *        the LogicElement classes, written with bitwise operations so that
+ *        every lane is an independent simulation.
+ */
+template< typename W >
+inline void evaluateGate( const Netlist &netlist, uint32_t gate, W *signals, W *state ) {
+  const W ones = LogicLanes< W >::ones( );
+  const uint32_t *in = netlist.fanins.data( ) + netlist.faninBegin[ gate ];
+  const uint32_t inSize = netlist.faninBegin[ gate + 1 ] - netlist.faninBegin[ gate ];
+  W *out = signals + netlist.outputBegin[ gate ];
+  W *st = state + netlist.stateBegin[ gate ];
+  switch( netlist.ops[ gate ] ) {
+      case LogicOp::INPUT:
+      break;
+      case LogicOp::NODE:
+      out[ 0 ] = signals[ in[ 0 ] ];
+      break;
+      case LogicOp::OUTPUT:
+      for( uint32_t idx = 0; idx < inSize; ++idx ) {
+        out[ idx ] = signals[ in[ idx ] ];
+      }
+      break;
+      case LogicOp::AND:
+      case LogicOp::NAND: {
+      W result = ones;
+      for( uint32_t idx = 0; idx < inSize; ++idx ) {
+        result &= signals[ in[ idx ] ];
+      }
+      out[ 0 ] = ( netlist.ops[ gate ] == LogicOp::AND ) ? result : ( result ^ ones );
+      break;
+    }
+      case LogicOp::OR:
+      case LogicOp::NOR: {
+      W result = 0;
+      for( uint32_t idx = 0; idx < inSize; ++idx ) {
+        result |= signals[ in[ idx ] ];
+      }
+      out[ 0 ] = ( netlist.ops[ gate ] == LogicOp::OR ) ? result : ( result ^ ones );
+      break;
+    }
+      case LogicOp::XOR:
+      case LogicOp::XNOR: {
+      W result = 0;
+      for( uint32_t idx = 0; idx < inSize; ++idx ) {
+        result ^= signals[ in[ idx ] ];
+      }
+      out[ 0 ] = ( netlist.ops[ gate ] == LogicOp::XOR ) ? result : ( result ^ ones );
+      break;
+    }
+      case LogicOp::NOT:
+      out[ 0 ] = signals[ in[ 0 ] ] ^ ones;
+      break;
+      case LogicOp::MUX:
+      out[ 0 ] = laneSelect< W >( signals[ in[ 2 ] ], signals[ in[ 1 ] ], signals[ in[ 0 ] ] );
+      break;
+      case LogicOp::DEMUX: {
+      W data = signals[ in[ 0 ] ];
+      W choice = signals[ in[ 1 ] ];
+      out[ 0 ] = data & ( choice ^ ones );
+      out[ 1 ] = data & choice;
+      break;
+    }
+      case LogicOp::DLATCH: {
+      W D = signals[ in[ 0 ] ];
+      W enable = signals[ in[ 1 ] ];
+      out[ 0 ] = laneSelect< W >( enable, D, out[ 0 ] );
+      out[ 1 ] = laneSelect< W >( enable, D ^ ones, out[ 1 ] );
+      break;
+    }
+      case LogicOp::DFLIPFLOP: {
+      /* state: lastClk, lastValue */
+      W D = signals[ in[ 0 ] ];
+      W clk = signals[ in[ 1 ] ];
+      W prst = signals[ in[ 2 ] ];
+      W clr = signals[ in[ 3 ] ];
+      W edge = clk & ( st[ 0 ] ^ ones );
+      W q0 = laneSelect< W >( edge, st[ 1 ], out[ 0 ] );
+      W q1 = laneSelect< W >( edge, st[ 1 ] ^ ones, out[ 1 ] );
+      W async = ( prst & clr ) ^ ones;
+      out[ 0 ] = laneSelect< W >( async, prst ^ ones, q0 );
+      out[ 1 ] = laneSelect< W >( async, clr ^ ones, q1 );
+      st[ 0 ] = clk;
+      st[ 1 ] = D;
+      break;
+    }
+      case LogicOp::JKFLIPFLOP: {
+      /* state: lastClk, lastJ, lastK */
+      W j = signals[ in[ 0 ] ];
+      W clk = signals[ in[ 1 ] ];
+      W k = signals[ in[ 2 ] ];
+      W prst = signals[ in[ 3 ] ];
+      W clr = signals[ in[ 4 ] ];
+      W edge = clk & ( st[ 0 ] ^ ones );
+      W both = st[ 1 ] & st[ 2 ];
+      W none = ( st[ 1 ] | st[ 2 ] ) ^ ones;
+      W next0 = ( both & out[ 1 ] ) | ( st[ 1 ] & ( st[ 2 ] ^ ones ) ) | ( none & out[ 0 ] );
+      W next1 = ( both & out[ 0 ] ) | ( st[ 2 ] & ( st[ 1 ] ^ ones ) ) | ( none & out[ 1 ] );
+      W q0 = laneSelect< W >( edge, next0, out[ 0 ] );
+      W q1 = laneSelect< W >( edge, next1, out[ 1 ] );
+      W async = ( prst & clr ) ^ ones;
+      out[ 0 ] = laneSelect< W >( async, prst ^ ones, q0 );
+      out[ 1 ] = laneSelect< W >( async, clr ^ ones, q1 );
+      st[ 0 ] = clk;
+      st[ 1 ] = j;
+      st[ 2 ] = k;
+      break;
+    }
+      case LogicOp::SRFLIPFLOP: {
+      /* state: lastClk */
+      W s = signals[ in[ 0 ] ];
+      W clk = signals[ in[ 1 ] ];
+      W r = signals[ in[ 2 ] ];
+      W prst = signals[ in[ 3 ] ];
+      W clr = signals[ in[ 4 ] ];
+      W edge = clk & ( st[ 0 ] ^ ones );
+      W q0 = laneSelect< W >( edge, s | ( ( r ^ ones ) & out[ 0 ] ), out[ 0 ] );
+      W q1 = laneSelect< W >( edge, r | ( ( s ^ ones ) & out[ 1 ] ), out[ 1 ] );
+      W async = ( prst & clr ) ^ ones;
+      out[ 0 ] = laneSelect< W >( async, prst ^ ones, q0 );
+      out[ 1 ] = laneSelect< W >( async, clr ^ ones, q1 );
+      st[ 0 ] = clk;
+      break;
+    }
+      case LogicOp::TFLIPFLOP: {
+      /* state: lastClk, lastValue */
+      W T = signals[ in[ 0 ] ];
+      W clk = signals[ in[ 1 ] ];
+      W prst = signals[ in[ 2 ] ];
+      W clr = signals[ in[ 3 ] ];
+      W toggle = clk & ( st[ 0 ] ^ ones ) & st[ 1 ];
+      W q0 = out[ 0 ] ^ toggle;
+      W q1 = laneSelect< W >( toggle, out[ 0 ], out[ 1 ] );
+      W async = ( prst & clr ) ^ ones;
+      out[ 0 ] = laneSelect< W >( async, prst ^ ones, q0 );
+      out[ 1 ] = laneSelect< W >( async, clr ^ ones, q1 );
+      st[ 0 ] = clk;
+      st[ 1 ] = T;
+      break;
+    }
+  }
+}
+
+/**
+ * @brief The GateInstruction struct is a gate of the netlist packed for the
+ *        interpreters. One and two input gates, which make up most circuits,
+ *        are specialized by arity and carry their signals inline, so they are
+ *        evaluated from a single 16 byte record. Other gates are GENERIC and
+ *        keep their gate index in in0. Invalid gates and inputs are SKIP.
+ */
+struct GateInstruction {
+  enum Code : uint32_t { SKIP, GENERIC, COPY, NOT, AND2, NAND2, OR2, NOR2, XOR2, XNOR2 };
+  Code code;
+  uint32_t out;
+  uint32_t in0;
+  uint32_t in1;
+};
+
+inline GateInstruction compileGate( const Netlist &netlist, uint32_t gate ) {
+  GateInstruction instruction = { GateInstruction::GENERIC, netlist.outputBegin[ gate ], gate, 0 };
+  const uint32_t *in = netlist.fanins.data( ) + netlist.faninBegin[ gate ];
+  const uint32_t inSize = netlist.inputSize( gate );
+  /* Gates with one input reduce to a copy or an inversion. */
+  GateInstruction::Code unary = GateInstruction::GENERIC;
+  GateInstruction::Code binary = GateInstruction::GENERIC;
+  switch( netlist.ops[ gate ] ) {
+      case LogicOp::INPUT:
+      instruction.code = GateInstruction::SKIP;
+      return( instruction );
+      case LogicOp::NODE:
+      case LogicOp::OUTPUT:
+      unary = GateInstruction::COPY;
+      break;
+      case LogicOp::NOT:
+      unary = GateInstruction::NOT;
+      break;
+      case LogicOp::AND:
+      unary = GateInstruction::COPY;
+      binary = GateInstruction::AND2;
+      break;
+      case LogicOp::NAND:
+      unary = GateInstruction::NOT;
+      binary = GateInstruction::NAND2;
+      break;
+      case LogicOp::OR:
+      unary = GateInstruction::COPY;
+      binary = GateInstruction::OR2;
+      break;
+      case LogicOp::NOR:
+      unary = GateInstruction::NOT;
+      binary = GateInstruction::NOR2;
+      break;
+      case LogicOp::XOR:
+      unary = GateInstruction::COPY;
+      binary = GateInstruction::XOR2;
+      break;
+      case LogicOp::XNOR:
+      unary = GateInstruction::NOT;
+      binary = GateInstruction::XNOR2;
+      break;
+      default:
+      break;
+  }
+  if( !netlist.valid[ gate ] ) {
+    instruction.code = GateInstruction::SKIP;
+  }
+  else if( ( inSize == 1 ) && ( unary != GateInstruction::GENERIC ) ) {
+    instruction.code = unary;
+    instruction.in0 = in[ 0 ];
+  }
+  else if( ( inSize == 2 ) && ( binary != GateInstruction::GENERIC ) ) {
+    instruction.code = binary;
+    instruction.in0 = in[ 0 ];
+    instruction.in1 = in[ 1 ];
+  }
+  return( instruction );
+}
+
+/**
+ * @brief compileProgram returns one instruction per gate of the netlist.
+ *        Gates of the same level are independent, so within each run of equal
+ *        level the instructions are grouped by code, which keeps the dispatch
+ *        branch predictable. Instructions [begin, end) are therefore the gates
+ *        [begin, end) whenever begin and end are level boundaries.
+ */
+inline std::vector< GateInstruction > compileProgram( const Netlist &netlist ) {
+  const uint32_t count = netlist.gateCount( );
+  std::vector< GateInstruction > program( count );
+  for( uint32_t gate = 0; gate < count; ++gate ) {
+    program[ gate ] = compileGate( netlist, gate );
+  }
+  uint32_t begin = 0;
+  while( begin < count ) {
+    uint32_t end = begin + 1;
+    while( ( end < count ) && ( netlist.levels[ end ] == netlist.levels[ begin ] ) ) {
+      ++end;
+    }
+    std::stable_sort( program.begin( ) + begin, program.begin( ) + end,
+                      [ ]( const GateInstruction &first, const GateInstruction &second ) {
+      return( first.code < second.code );
+    } );
+    begin = end;
+  }
+  return( program );
+}
+
+template< typename W >
+inline void executeInstruction( const Netlist &netlist, const GateInstruction &instruction, W *signals, W *state ) {
+  const W ones = LogicLanes< W >::ones( );
+  W *out = signals + instruction.out;
+  switch( instruction.code ) {
+      case GateInstruction::SKIP:
+      break;
+      case GateInstruction::GENERIC:
+      evaluateGate< W >( netlist, instruction.in0, signals, state );
+      break;
+      case GateInstruction::COPY:
+      out[ 0 ] = signals[ instruction.in0 ];
+      break;
+      case GateInstruction::NOT:
+      out[ 0 ] = signals[ instruction.in0 ] ^ ones;
+      break;
+      case GateInstruction::AND2:
+      out[ 0 ] = signals[ instruction.in0 ] & signals[ instruction.in1 ];
+      break;
+      case GateInstruction::NAND2:
+      out[ 0 ] = ( signals[ instruction.in0 ] & signals[ instruction.in1 ] ) ^ ones;
+      break;
+      case GateInstruction::OR2:
+      out[ 0 ] = signals[ instruction.in0 ] | signals[ instruction.in1 ];
+      break;
+      case GateInstruction::NOR2:
+      out[ 0 ] = ( signals[ instruction.in0 ] | signals[ instruction.in1 ] ) ^ ones;
+      break;
+      case GateInstruction::XOR2:
+      out[ 0 ] = signals[ instruction.in0 ] ^ signals[ instruction.in1 ];
+      break;
+      case GateInstruction::XNOR2:
+      out[ 0 ] = signals[ instruction.in0 ] ^ signals[ instruction.in1 ] ^ ones;
+      break;
+  }
+}
+
+#endif // NETLISTKERNEL_H
@@ -0,0 +1,406 @@
+#include "netlistoptimizer.h"
+
+#include <algorithm>
+
+const uint32_t NetlistOptimizer::NONE;
+const uint32_t NetlistOptimizer::ZERO;
+const uint32_t NetlistOptimizer::ONE;
+
+NetlistOptimizer::NetlistOptimizer( const Netlist &netlist ) : netlist( netlist ),
+  inputs( netlist.gateCount( ), false ), kept( netlist.gateCount( ), false ), preserveTiming( false ),
+  hashing( true ), eliminated( 0 ), merged( 0 ) {
+}
+
+void NetlistOptimizer::addInput( uint32_t gate ) {
+  inputs[ gate ] = true;
+}
+
+void NetlistOptimizer::keep( uint32_t gate ) {
+  kept[ gate ] = true;
+}
+
+void NetlistOptimizer::setPreserveTiming( bool preserve ) {
+  preserveTiming = preserve;
+}
+
+void NetlistOptimizer::setStructuralHashing( bool hashing ) {
+  this->hashing = hashing;
+}
+
+uint32_t NetlistOptimizer::signal( uint32_t original ) const {
+  return( m_signalMap[ original ] );
+}
+
+uint32_t NetlistOptimizer::gate( uint32_t original ) const {
+  return( m_gateMap[ original ] );
+}
+
+uint32_t NetlistOptimizer::eliminatedGates( ) const {
+  return( eliminated );
+}
+
+uint32_t NetlistOptimizer::mergedGates( ) const {
+  return( merged );
+}
+
+const std::vector< uint32_t > &NetlistOptimizer::signalMap( ) const {
+  return( m_signalMap );
+}
+
+const std::vector< uint32_t > &NetlistOptimizer::gateMap( ) const {
+  return( m_gateMap );
+}
+
+uint32_t NetlistOptimizer::resolve( uint32_t signal ) const {
+  while( ( signal != ZERO ) && ( signal != ONE ) && ( replacement[ signal ] != signal ) ) {
+    signal = replacement[ signal ];
+  }
+  return( signal );
+}
+
+bool NetlistOptimizer::alias( uint32_t gate, uint32_t port, uint32_t signal ) {
+  /* A gate that reads its own output through a loop stays a gate. */
+  signal = resolve( signal );
+  if( signal == netlist.outputBegin[ gate ] + port ) {
+    return( false );
+  }
+  replacement[ netlist.outputBegin[ gate ] + port ] = signal;
+  real[ gate ] = false;
+  return( true );
+}
+
+void NetlistOptimizer::fold( uint32_t gate, uint32_t port, bool value ) {
+  replacement[ netlist.outputBegin[ gate ] + port ] = value ? ONE : ZERO;
+  real[ gate ] = false;
+}
+
+void NetlistOptimizer::invert( uint32_t gate, uint32_t signal ) {
+  if( ( signal == ZERO ) || ( signal == ONE ) ) {
+    fold( gate, 0, signal == ZERO );
+  }
+  else if( ( inverse[ signal ] == NONE ) || !alias( gate, 0, inverse[ signal ] ) ) {
+    /* The gate stays as an inverter, which a later inversion of its output bypasses. */
+    ops[ gate ] = LogicOp::NOT;
+    if( signal != netlist.outputBegin[ gate ] ) {
+      inverse[ netlist.outputBegin[ gate ] ] = signal;
+    }
+  }
+}
+
+void NetlistOptimizer::simplify( uint32_t gate, std::vector< uint32_t > &in ) {
+  const LogicOp op = netlist.ops[ gate ];
+  const uint32_t out = netlist.outputBegin[ gate ];
+  if( !netlist.valid[ gate ] || ( ( op == LogicOp::INPUT ) && !inputs[ gate ] ) ) {
+    /* Invalid gates are never evaluated, so they keep their initial values, as constants do. */
+    for( uint32_t port = 0; port < netlist.outputSize( gate ); ++port ) {
+      fold( gate, port, netlist.initialValues[ out + port ] );
+    }
+    return;
+  }
+  /* The gates of a cycle keep the levels that the loop ranges are found from, so bypassing one of them would let
+   * the readers of the loop run before it settles. */
+  if( ( preserveTiming && ( netlist.delays[ gate ] > 0 ) ) || netlist.isSequential( gate ) ||
+      ( netlist.cycleIndex[ gate ] >= 0 ) ) {
+    return;
+  }
+  switch( op ) {
+      case LogicOp::NODE:
+      alias( gate, 0, in[ 0 ] );
+      break;
+      case LogicOp::NOT:
+      invert( gate, in[ 0 ] );
+      in.resize( 1 );
+      break;
+      case LogicOp::AND:
+      case LogicOp::NAND:
+      case LogicOp::OR:
+      case LogicOp::NOR:
+      case LogicOp::XOR:
+      case LogicOp::XNOR: {
+      const bool isAnd = ( op == LogicOp::AND ) || ( op == LogicOp::NAND );
+      const bool isXor = ( op == LogicOp::XOR ) || ( op == LogicOp::XNOR );
+      bool inverted = ( op == LogicOp::NAND ) || ( op == LogicOp::NOR ) || ( op == LogicOp::XNOR );
+      /* A controlling constant decides the output on its own, and the other constant is dropped. */
+      const uint32_t controlling = isAnd ? ZERO : ONE;
+      std::vector< uint32_t > variables;
+      for( uint32_t signal : in ) {
+        if( ( signal != ZERO ) && ( signal != ONE ) ) {
+          variables.push_back( signal );
+        }
+        else if( isXor ) {
+          inverted ^= ( signal == ONE );
+        }
+        else if( signal == controlling ) {
+          fold( gate, 0, ( controlling == ONE ) != inverted );
+          return;
+        }
+      }
+      if( variables.empty( ) ) {
+        fold( gate, 0, isAnd != inverted );
+      }
+      else if( variables.size( ) == 1 ) {
+        if( inverted ) {
+          invert( gate, variables[ 0 ] );
+        }
+        else {
+          alias( gate, 0, variables[ 0 ] );
+        }
+      }
+      else if( isXor ) {
+        ops[ gate ] = inverted ? LogicOp::XNOR : LogicOp::XOR;
+      }
+      in = variables;
+      break;
+    }
+      case LogicOp::MUX: {
+      uint32_t chosen = NONE;
+      if( ( in[ 2 ] == ZERO ) || ( in[ 2 ] == ONE ) ) {
+        chosen = in[ 2 ] == ONE ? in[ 1 ] : in[ 0 ];
+      }
+      else if( in[ 0 ] == in[ 1 ] ) {
+        chosen = in[ 0 ];
+      }
+      if( ( chosen == ZERO ) || ( chosen == ONE ) ) {
+        fold( gate, 0, chosen == ONE );
+      }
+      else if( chosen != NONE ) {
+        alias( gate, 0, chosen );
+      }
+      break;
+    }
+      case LogicOp::DEMUX:
+      if( in[ 0 ] == ZERO ) {
+        fold( gate, 0, false );
+        fold( gate, 1, false );
+      }
+      else if( ( in[ 1 ] == ZERO ) || ( in[ 1 ] == ONE ) ) {
+        const uint32_t selected = in[ 1 ] == ONE ? 1 : 0;
+        /* A demux that feeds its own data input stays whole. */
+        if( alias( gate, selected, in[ 0 ] ) ) {
+          fold( gate, 1 - selected, false );
+        }
+      }
+      break;
+      default:
+      break;
+  }
+}
+
+/* The operation that stands for op and its complement in the structural hashing keys. */
+static LogicOp positive( LogicOp op ) {
+  switch( op ) {
+      case LogicOp::NAND:
+      return( LogicOp::AND );
+      case LogicOp::NOR:
+      return( LogicOp::OR );
+      case LogicOp::XNOR:
+      return( LogicOp::XOR );
+      default:
+      return( op );
+  }
+}
+
+void NetlistOptimizer::merge( uint32_t gate, std::vector< uint32_t > &in ) {
+  const LogicOp op = ops[ gate ];
+  /* Sequential gates hold their own state, and a gate of a loop may be evaluated before its duplicate settles. */
+  if( !real[ gate ] || ( op == LogicOp::INPUT ) || ( op == LogicOp::OUTPUT ) || netlist.isSequential( gate ) ||
+      looping[ gate ] || ( preserveTiming && ( netlist.delays[ gate ] > 0 ) ) ) {
+    return;
+  }
+  const LogicOp family = positive( op );
+  std::vector< uint32_t > key( in );
+  if( ( family == LogicOp::AND ) || ( family == LogicOp::OR ) || ( family == LogicOp::XOR ) ) {
+    std::sort( key.begin( ), key.end( ) );
+  }
+  key.push_back( static_cast< uint32_t >( family ) );
+  auto found = structures.find( key );
+  if( found == structures.end( ) ) {
+    structures.emplace( std::move( key ), gate );
+    return;
+  }
+  const uint32_t other = found->second;
+  if( ops[ other ] == op ) {
+    for( uint32_t port = 0; port < netlist.outputSize( gate ); ++port ) {
+      alias( gate, port, netlist.outputBegin[ other ] + port );
+    }
+    mergedInto[ gate ] = other;
+    ++merged;
+    return;
+  }
+  /* The complement of the other gate, which may in turn be a duplicate inverter. As an inverter the gate reads the
+   * other one, so it has to be on a lower level, or a level shares its inputs with neither gate waiting for the
+   * other. */
+  if( netlist.levels[ other ] <= netlist.levels[ gate ] ) {
+    return;
+  }
+  invert( gate, netlist.outputBegin[ other ] );
+  in.assign( 1, netlist.outputBegin[ other ] );
+  merge( gate, in );
+}
+
+std::vector< uint8_t > NetlistOptimizer::findLive( ) const {
+  std::vector< uint8_t > live( netlist.gateCount( ), false );
+  std::vector< uint32_t > stack;
+  for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+    if( real[ gate ] && ( ( netlist.ops[ gate ] == LogicOp::OUTPUT ) || netlist.isSequential( gate ) ||
+                          inputs[ gate ] || kept[ gate ] ) ) {
+      stack.push_back( gate );
+    }
+    if( kept[ gate ] ) {
+      /* The values read from a kept gate are those of the signals its ports now stand for. */
+      for( uint32_t signal = netlist.outputBegin[ gate ]; signal < netlist.outputBegin[ gate + 1 ]; ++signal ) {
+        const uint32_t source = resolve( signal );
+        if( ( source != ZERO ) && ( source != ONE ) ) {
+          stack.push_back( netlist.drivers[ source ] );
+        }
+      }
+      for( uint32_t idx = netlist.faninBegin[ gate ]; idx < netlist.faninBegin[ gate + 1 ]; ++idx ) {
+        const uint32_t source = resolve( netlist.fanins[ idx ] );
+        if( ( source != ZERO ) && ( source != ONE ) ) {
+          stack.push_back( netlist.drivers[ source ] );
+        }
+      }
+    }
+  }
+  while( !stack.empty( ) ) {
+    const uint32_t gate = stack.back( );
+    stack.pop_back( );
+    if( live[ gate ] ) {
+      continue;
+    }
+    live[ gate ] = true;
+    for( uint32_t idx = faninBegin[ gate ]; idx < faninBegin[ gate + 1 ]; ++idx ) {
+      const uint32_t source = resolve( fanins[ idx ] );
+      if( ( source != ZERO ) && ( source != ONE ) ) {
+        stack.push_back( netlist.drivers[ source ] );
+      }
+    }
+  }
+  return( live );
+}
+
+void NetlistOptimizer::optimize( Netlist &result ) {
+  const uint32_t gates = netlist.gateCount( );
+  const uint32_t signals = netlist.signalCount( );
+  replacement.resize( signals );
+  for( uint32_t signal = 0; signal < signals; ++signal ) {
+    replacement[ signal ] = signal;
+  }
+  inverse.assign( signals, NONE );
+  real.assign( gates, true );
+  ops = netlist.ops;
+  faninBegin.assign( 1, 0 );
+  fanins.clear( );
+  looping.assign( gates, false );
+  for( uint32_t loop = 0; loop < netlist.loopCount( ); ++loop ) {
+    std::fill( looping.begin( ) + netlist.loopBegin[ loop ], looping.begin( ) + netlist.loopEnd[ loop ], true );
+  }
+  mergedInto.assign( gates, NONE );
+  structures.clear( );
+  merged = 0;
+  /* Gates are simplified in evaluation order, so their fan-ins are already simplified, but for the signals read
+   * through a feedback loop, which are resolved again once every gate is done. */
+  std::vector< uint32_t > in;
+  for( uint32_t gate = 0; gate < gates; ++gate ) {
+    in.clear( );
+    for( uint32_t idx = netlist.faninBegin[ gate ]; idx < netlist.faninBegin[ gate + 1 ]; ++idx ) {
+      in.push_back( resolve( netlist.fanins[ idx ] ) );
+    }
+    simplify( gate, in );
+    if( hashing ) {
+      merge( gate, in );
+    }
+    if( real[ gate ] ) {
+      fanins.insert( fanins.end( ), in.begin( ), in.end( ) );
+    }
+    faninBegin.push_back( static_cast< uint32_t >( fanins.size( ) ) );
+  }
+  const std::vector< uint8_t > live = findLive( );
+
+  /* The constants, if anything still reads them. */
+  bool needed[ 2 ] = { false, false };
+  for( uint32_t gate = 0; gate < gates; ++gate ) {
+    if( live[ gate ] ) {
+      for( uint32_t idx = faninBegin[ gate ]; idx < faninBegin[ gate + 1 ]; ++idx ) {
+        const uint32_t source = resolve( fanins[ idx ] );
+        needed[ 0 ] |= ( source == ZERO );
+        needed[ 1 ] |= ( source == ONE );
+      }
+    }
+    if( kept[ gate ] ) {
+      for( uint32_t signal = netlist.outputBegin[ gate ]; signal < netlist.outputBegin[ gate + 1 ]; ++signal ) {
+        needed[ 0 ] |= ( resolve( signal ) == ZERO );
+        needed[ 1 ] |= ( resolve( signal ) == ONE );
+      }
+      for( uint32_t idx = netlist.faninBegin[ gate ]; idx < netlist.faninBegin[ gate + 1 ]; ++idx ) {
+        needed[ 0 ] |= ( resolve( netlist.fanins[ idx ] ) == ZERO );
+        needed[ 1 ] |= ( resolve( netlist.fanins[ idx ] ) == ONE );
+      }
+    }
+  }
+  /* The constants come first, so they sit above every other gate to keep the levels descending. */
+  int topLevel = 0;
+  for( uint32_t gate = 0; gate < gates; ++gate ) {
+    if( real[ gate ] && live[ gate ] ) {
+      topLevel = std::max( topLevel, netlist.levels[ gate ] );
+    }
+  }
+  result.clear( );
+  uint32_t constants[ 2 ] = { NONE, NONE };
+  for( int value = 0; value < 2; ++value ) {
+    if( needed[ value ] ) {
+      const uint32_t constant = result.addGate( LogicOp::INPUT, 0, 1 );
+      result.setLevel( constant, topLevel + 1 );
+      constants[ value ] = result.outputSignal( constant );
+      result.setInitialValue( constants[ value ], value == 1 );
+    }
+  }
+  m_gateMap.assign( gates, NONE );
+  for( uint32_t gate = 0; gate < gates; ++gate ) {
+    if( !real[ gate ] || !live[ gate ] ) {
+      continue;
+    }
+    const uint32_t added = result.addGate( ops[ gate ], faninBegin[ gate + 1 ] - faninBegin[ gate ],
+                                           netlist.outputSize( gate ) );
+    m_gateMap[ gate ] = added;
+    result.setValid( added, netlist.valid[ gate ] );
+    result.setLevel( added, netlist.levels[ gate ] );
+    result.setDelay( added, netlist.delays[ gate ] );
+    for( uint32_t port = 0; port < netlist.outputSize( gate ); ++port ) {
+      result.setInitialValue( result.outputSignal( added, port ),
+                              netlist.initialValues[ netlist.outputBegin[ gate ] + port ] );
+    }
+    for( uint32_t slot = 0; slot < Netlist::stateSize( ops[ gate ] ); ++slot ) {
+      result.initialState[ result.stateBegin[ added ] + slot ] =
+        netlist.initialState[ netlist.stateBegin[ gate ] + slot ];
+    }
+  }
+  for( uint32_t gate = 0; gate < gates; ++gate ) {
+    if( mergedInto[ gate ] != NONE ) {
+      m_gateMap[ gate ] = m_gateMap[ mergedInto[ gate ] ];
+    }
+  }
+  m_signalMap.assign( signals, NONE );
+  for( uint32_t signal = 0; signal < signals; ++signal ) {
+    const uint32_t source = resolve( signal );
+    if( ( source == ZERO ) || ( source == ONE ) ) {
+      m_signalMap[ signal ] = constants[ source == ONE ? 1 : 0 ];
+    }
+    else if( m_gateMap[ netlist.drivers[ source ] ] != NONE ) {
+      const uint32_t driver = netlist.drivers[ source ];
+      m_signalMap[ signal ] = result.outputSignal( m_gateMap[ driver ], source - netlist.outputBegin[ driver ] );
+    }
+  }
+  for( uint32_t gate = 0; gate < gates; ++gate ) {
+    if( m_gateMap[ gate ] != NONE ) {
+      for( uint32_t idx = faninBegin[ gate ]; idx < faninBegin[ gate + 1 ]; ++idx ) {
+        const uint32_t source = resolve( fanins[ idx ] );
+        result.setFanin( m_gateMap[ gate ], idx - faninBegin[ gate ],
+                         ( source == ZERO ) || ( source == ONE ) ? constants[ source == ONE ? 1 : 0 ] :
+                         m_signalMap[ source ] );
+      }
+    }
+  }
+  result.finalize( );
+  eliminated = gates > result.gateCount( ) ? gates - result.gateCount( ) : 0;
+}
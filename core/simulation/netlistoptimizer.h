@@ -0,0 +1,121 @@
+#ifndef NETLISTOPTIMIZER_H
+#define NETLISTOPTIMIZER_H
+
+#include "netlist.h"
+
+#include <map>
+
+/**
+ * @brief The NetlistOptimizer class builds a smaller netlist that computes
+ *        the same outputs. Constants are propagated through the gates, nodes
+ *        and double inversions are bypassed, and the gates that reach no
+ *        output element, sequential element or kept gate are removed. The
+ *        gates left keep their order and levels.
+ *
+ *        Structural hashing then merges the gates that compute the same
+ *        operation over the same fan-ins, as copies of a box do once
+ *        flattened. A gate that computes the complement of an earlier one,
+ *        such as NAND and AND over the same signals, becomes an inverter of
+ *        it, which the inversions that follow are bypassed through.
+ *
+ *        Every signal of the original netlist is mapped to a signal of the
+ *        result: a bypassed wire is an alias of its source, and a folded one
+ *        reads a constant. Only the signals of removed logic have no match.
+ */
+class NetlistOptimizer {
+public:
+  static const uint32_t NONE = UINT32_MAX;
+
+  explicit NetlistOptimizer( const Netlist &netlist );
+
+  /**
+   * @brief addInput marks an INPUT gate set from outside with setInput( ).
+   *        The other INPUT gates are constants.
+   */
+  void addInput( uint32_t gate );
+
+  /**
+   * @brief keep marks a gate whose input and output values are read from
+   *        outside, such as the elements shown on the scene.
+   */
+  void keep( uint32_t gate );
+
+  /**
+   * @brief setPreserveTiming leaves the gates with a propagation delay as
+   *        they are, for the timed simulation.
+   */
+  void setPreserveTiming( bool preserve );
+
+  /**
+   * @brief setStructuralHashing turns the merging of duplicate gates on or
+   *        off. It is on by default.
+   */
+  void setStructuralHashing( bool hashing );
+
+  /**
+   * @brief optimize writes the optimized netlist to result, finalized.
+   */
+  void optimize( Netlist &result );
+
+  /**
+   * @brief signal returns the signal of result that carries an original
+   *        signal, or NONE. gate returns the gate an original gate became, or
+   *        the one it was merged into, or NONE.
+   */
+  uint32_t signal( uint32_t original ) const;
+  uint32_t gate( uint32_t original ) const;
+
+  /**
+   * @brief eliminatedGates returns how many gates fewer the result has.
+   */
+  uint32_t eliminatedGates( ) const;
+
+  /**
+   * @brief mergedGates returns how many of them were duplicates of another
+   *        gate.
+   */
+  uint32_t mergedGates( ) const;
+
+  const std::vector< uint32_t > &signalMap( ) const;
+  const std::vector< uint32_t > &gateMap( ) const;
+
+private:
+  /* Replacements that stand for the constants, beyond any signal index. */
+  static const uint32_t ZERO = UINT32_MAX - 1;
+  static const uint32_t ONE = UINT32_MAX - 2;
+
+  const Netlist &netlist;
+  std::vector< uint8_t > inputs;
+  std::vector< uint8_t > kept;
+  bool preserveTiming;
+  bool hashing;
+  /* Per original signal: the signal or constant it equals, and the signal it is the inversion of, or NONE. */
+  std::vector< uint32_t > replacement;
+  std::vector< uint32_t > inverse;
+  /* Per original gate: whether it is still a gate, and then its operation and fan-ins. */
+  std::vector< uint8_t > real;
+  std::vector< LogicOp > ops;
+  std::vector< uint32_t > faninBegin;
+  std::vector< uint32_t > fanins;
+  /* Per original gate: whether a feedback loop evaluates it again, and the gate it was merged into, or NONE. */
+  std::vector< uint8_t > looping;
+  std::vector< uint32_t > mergedInto;
+  /* The gate that computes each operation, the fan-ins followed by the operation, with AND standing for NAND, OR for
+   * NOR and XOR for XNOR. */
+  std::map< std::vector< uint32_t >, uint32_t > structures;
+  std::vector< uint32_t > m_signalMap;
+  std::vector< uint32_t > m_gateMap;
+  uint32_t eliminated;
+  uint32_t merged;
+
+  uint32_t resolve( uint32_t signal ) const;
+  void simplify( uint32_t gate, std::vector< uint32_t > &in );
+  void merge( uint32_t gate, std::vector< uint32_t > &in );
+  /* Returns false, leaving the gate as it is, if the port would stand for itself. */
+  bool alias( uint32_t gate, uint32_t port, uint32_t signal );
+  void fold( uint32_t gate, uint32_t port, bool value );
+  void invert( uint32_t gate, uint32_t signal );
+  std::vector< uint8_t > findLive( ) const;
+};
+
+#endif // NETLISTOPTIMIZER_H
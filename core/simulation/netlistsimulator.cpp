@@ -0,0 +1,116 @@
+#include "netlistsimulator.h"
+
+#include <algorithm>
+
+NetlistSimulator::NetlistSimulator( const Netlist &netlist ) :
+  netlist( netlist ),
+  program( compileProgram( netlist ) ),
+  validGates( 0 ),
+  evaluations( 0 ),
+  limit( Netlist::DEFAULT_ITERATION_LIMIT ),
+  loopGates( netlist.loopCount( ), 0 ),
+  oscillating( netlist.cycleCount( ), false ) {
+  for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+    validGates += netlist.valid[ gate ];
+  }
+  uint32_t maxSignals = 0;
+  for( uint32_t loop = 0; loop < netlist.loopCount( ); ++loop ) {
+    for( uint32_t gate = netlist.loopBegin[ loop ]; gate < netlist.loopEnd[ loop ]; ++gate ) {
+      loopGates[ loop ] += netlist.valid[ gate ];
+    }
+    maxSignals = std::max( maxSignals, netlist.loopSignalEnd( loop ) - netlist.loopSignalBegin( loop ) );
+  }
+  feedback.resize( maxSignals );
+  NetlistSimulator::reset( );
+}
+
+NetlistSimulator::~NetlistSimulator( ) {
+}
+
+void NetlistSimulator::reset( ) {
+  signals = netlist.initialValues;
+  state = netlist.initialState;
+  evaluations = 0;
+  std::fill( oscillating.begin( ), oscillating.end( ), false );
+}
+
+void NetlistSimulator::setInput( uint32_t signal, bool value ) {
+  signals[ signal ] = value;
+}
+
+void NetlistSimulator::run( ) {
+  uint64_t evaluated = validGates;
+  uint32_t gate = 0;
+  for( uint32_t loop = 0; loop < netlist.loopCount( ); ++loop ) {
+    execute( gate, netlist.loopBegin[ loop ] );
+    evaluated += ( settle( loop ) - 1 ) * loopGates[ loop ];
+    gate = netlist.loopEnd[ loop ];
+  }
+  execute( gate, netlist.gateCount( ) );
+  evaluations = evaluated;
+}
+
+void NetlistSimulator::execute( uint32_t begin, uint32_t end ) {
+  uint8_t *sig = signals.data( );
+  uint8_t *st = state.data( );
+  for( uint32_t idx = begin; idx < end; ++idx ) {
+    executeInstruction< uint8_t >( netlist, program[ idx ], sig, st );
+  }
+}
+
+uint32_t NetlistSimulator::settle( uint32_t loop ) {
+  const uint32_t first = netlist.loopSignalBegin( loop );
+  const uint32_t size = netlist.loopSignalEnd( loop ) - first;
+  uint32_t passes = 0;
+  bool changed = true;
+  while( changed && ( passes < limit ) ) {
+    for( uint32_t idx = 0; idx < size; ++idx ) {
+      feedback[ idx ] = signals[ netlist.loopSignals[ first + idx ] ];
+    }
+    execute( netlist.loopBegin[ loop ], netlist.loopEnd[ loop ] );
+    ++passes;
+    changed = false;
+    for( uint32_t cycle = netlist.loopCycleBegin[ loop ]; cycle < netlist.loopCycleBegin[ loop + 1 ]; ++cycle ) {
+      bool cycleChanged = false;
+      for( uint32_t idx = netlist.cycleSignalBegin[ cycle ]; idx < netlist.cycleSignalBegin[ cycle + 1 ]; ++idx ) {
+        cycleChanged |= ( feedback[ idx - first ] != signals[ netlist.loopSignals[ idx ] ] );
+      }
+      oscillating[ cycle ] = cycleChanged;
+      changed |= cycleChanged;
+    }
+  }
+  return( passes );
+}
+
+bool NetlistSimulator::value( uint32_t signal ) const {
+  return( signals[ signal ] );
+}
+
+const std::vector< uint8_t > &NetlistSimulator::values( ) const {
+  return( signals );
+}
+
+const std::vector< uint8_t > &NetlistSimulator::stateValues( ) const {
+  return( state );
+}
+
+uint64_t NetlistSimulator::lastEvaluationCount( ) const {
+  return( evaluations );
+}
+
+void NetlistSimulator::setIterationLimit( uint32_t limit ) {
+  this->limit = std::max( limit, 1u );
+}
+
+uint32_t NetlistSimulator::iterationLimit( ) const {
+  return( limit );
+}
+
+bool NetlistSimulator::isOscillating( uint32_t gate ) const {
+  const int cycle = netlist.cycleIndex[ gate ];
+  return( ( cycle >= 0 ) && oscillating[ cycle ] );
+}
+
+bool NetlistSimulator::isSettled( ) const {
+  return( std::find( oscillating.begin( ), oscillating.end( ), 1 ) == oscillating.end( ) );
+}
@@ -0,0 +1,92 @@
+#ifndef NETLISTSIMULATOR_H
+#define NETLISTSIMULATOR_H
+
+#include "netlist.h"
+#include "netlistkernel.h"
+
+/**
+ * @brief The NetlistSimulator class owns the signal and state arrays of a
+ *        Netlist and evaluates every valid gate, in order, once per tick. The
+ *        gates are run from a program of packed instructions, see
+ *        compileProgram( ). The gates of a feedback loop are evaluated again
+ *        within the tick until the loop settles.
+ */
+class NetlistSimulator {
+public:
+  explicit NetlistSimulator( const Netlist &netlist );
+  virtual ~NetlistSimulator( );
+
+  /**
+   * @brief reset restores the initial signal values and the initial state of
+   *        the sequential elements.
+   */
+  virtual void reset( );
+
+  virtual void setInput( uint32_t signal, bool value );
+
+  /**
+   * @brief run evaluates the netlist once, which corresponds to one tick of
+   *        ElementMapping::update( ).
+   */
+  virtual void run( );
+
+  bool value( uint32_t signal ) const;
+  const std::vector< uint8_t > &values( ) const;
+  const std::vector< uint8_t > &stateValues( ) const;
+
+  /**
+   * @brief lastEvaluationCount returns how many gates were evaluated by the
+   *        last call to run( ).
+   */
+  uint64_t lastEvaluationCount( ) const;
+
+  /**
+   * @brief setIterationLimit sets how many times, at most, the gates of a
+   *        feedback loop are evaluated within one tick.
+   */
+  void setIterationLimit( uint32_t limit );
+  uint32_t iterationLimit( ) const;
+
+  /**
+   * @brief isOscillating returns true when gate belongs to a cycle that was
+   *        still changing after the last pass over its loop in the last tick.
+   */
+  bool isOscillating( uint32_t gate ) const;
+
+  /**
+   * @brief isSettled returns true when no cycle was still changing at the
+   *        end of the last tick, so running again with the same inputs
+   *        would change nothing.
+   */
+  bool isSettled( ) const;
+
+protected:
+  const Netlist &netlist;
+  std::vector< uint8_t > signals;
+  std::vector< uint8_t > state;
+  std::vector< GateInstruction > program;
+  uint64_t validGates;
+  uint64_t evaluations;
+  uint32_t limit;
+  /* Valid gates per loop, and whether each cycle was still changing at the end of the last tick. */
+  std::vector< uint64_t > loopGates;
+  std::vector< uint8_t > oscillating;
+
+  /**
+   * @brief execute runs the instructions [begin, end). Loops start and end at
+   *        level boundaries, so these are the gates [begin, end).
+   */
+  virtual void execute( uint32_t begin, uint32_t end );
+
+  /**
+   * @brief settle evaluates the gates of a loop until its loop signals stop
+   *        changing, or the iteration limit is reached, and returns how many
+   *        passes were made.
+   */
+  uint32_t settle( uint32_t loop );
+
+private:
+  std::vector< uint8_t > feedback;
+};
+
+#endif // NETLISTSIMULATOR_H
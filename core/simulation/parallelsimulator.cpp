@@ -0,0 +1,70 @@
+#include "netlistkernel.h"
+#include "parallelsimulator.h"
+
+const uint32_t ParallelSimulator::DEFAULT_MINIMUM_LEVEL_SIZE;
+
+ParallelSimulator::ParallelSimulator( const Netlist &netlist, unsigned threads, uint32_t minimumLevelSize ) :
+  NetlistSimulator( netlist ),
+  pool( threads ? threads : defaultThreadCount( ) ) {
+  /* Gates are stored in evaluation order, so every run of gates with the same level is a set of independent gates.
+   * Consecutive small runs are merged into a single serial segment, unless a feedback loop starts or ends between
+   * them, since the gates of a loop are executed on their own. */
+  const uint32_t count = netlist.gateCount( );
+  std::vector< uint8_t > boundary( count + 1, false );
+  for( uint32_t loop = 0; loop < netlist.loopCount( ); ++loop ) {
+    boundary[ netlist.loopBegin[ loop ] ] = true;
+    boundary[ netlist.loopEnd[ loop ] ] = true;
+  }
+  uint32_t begin = 0;
+  while( begin < count ) {
+    uint32_t end = begin + 1;
+    while( ( end < count ) && ( netlist.levels[ end ] == netlist.levels[ begin ] ) ) {
+      ++end;
+    }
+    bool parallel = ( pool.size( ) > 1 ) && ( end - begin >= minimumLevelSize );
+    if( !parallel && !boundary[ begin ] && !segments.empty( ) && !segments.back( ).parallel ) {
+      segments.back( ).end = end;
+    }
+    else {
+      segments.push_back( { begin, end, parallel } );
+    }
+    begin = end;
+  }
+}
+
+void ParallelSimulator::execute( uint32_t begin, uint32_t end ) {
+  const uint32_t grainDivisor = pool.size( ) * 8;
+  auto first = std::lower_bound( segments.begin( ), segments.end( ), begin, [ ]( const Segment &segment, uint32_t gate ) {
+    return( segment.begin < gate );
+  } );
+  for( auto iter = first; ( iter != segments.end( ) ) && ( iter->begin < end ); ++iter ) {
+    const Segment &segment = *iter;
+    if( segment.parallel ) {
+      uint32_t grain = std::max( ( segment.end - segment.begin ) / grainDivisor, 64u );
+      pool.parallelFor( segment.begin, segment.end, grain, [ this ]( uint32_t begin, uint32_t end ) {
+        evaluateRange( begin, end );
+      } );
+    }
+    else {
+      evaluateRange( segment.begin, segment.end );
+    }
+  }
+}
+
+unsigned ParallelSimulator::threadCount( ) const {
+  return( pool.size( ) );
+}
+
+unsigned ParallelSimulator::defaultThreadCount( ) {
+  return( std::max( std::thread::hardware_concurrency( ), 1u ) );
+}
+
+void ParallelSimulator::evaluateRange( uint32_t begin, uint32_t end ) {
+  /* Segments start and end at level boundaries, so the instructions of a range are the gates of that range. A
+   * parallel range may cut a level, which is safe because the gates of a level are independent. */
+  uint8_t *sig = signals.data( );
+  uint8_t *st = state.data( );
+  for( uint32_t idx = begin; idx < end; ++idx ) {
+    executeInstruction< uint8_t >( netlist, program[ idx ], sig, st );
+  }
+}
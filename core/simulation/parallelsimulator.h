@@ -0,0 +1,42 @@
+#ifndef PARALLELSIMULATOR_H
+#define PARALLELSIMULATOR_H
+
+#include "netlistsimulator.h"
+#include "threadpool.h"
+
+/**
+ * @brief The ParallelSimulator class evaluates each topological level of the
+ *        netlist over a thread pool. Connected gates never share a level, so
+ *        the gates of one level can run in any order, and levels are still
+ *        evaluated in the order of the serial sweep. Levels that are too
+ *        small to pay for the synchronization run on the calling thread.
+ */
+class ParallelSimulator : public NetlistSimulator {
+public:
+  static const uint32_t DEFAULT_MINIMUM_LEVEL_SIZE = 1024;
+
+  /**
+   * @brief ParallelSimulator uses one thread per core when threads is 0.
+   */
+  explicit ParallelSimulator( const Netlist &netlist, unsigned threads = 0,
+                              uint32_t minimumLevelSize = DEFAULT_MINIMUM_LEVEL_SIZE );
+
+  unsigned threadCount( ) const;
+
+  static unsigned defaultThreadCount( );
+
+private:
+  struct Segment {
+    uint32_t begin;
+    uint32_t end;
+    bool parallel;
+  };
+
+  ThreadPool pool;
+  std::vector< Segment > segments;
+
+  void execute( uint32_t begin, uint32_t end ) override;
+  void evaluateRange( uint32_t begin, uint32_t end );
+};
+
+#endif // PARALLELSIMULATOR_H
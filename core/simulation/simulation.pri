@@ -0,0 +1,38 @@
+HEADERS += \
+    $$PWD/logicop.h \
+    $$PWD/netlist.h \
+    $$PWD/netlistkernel.h \
+    $$PWD/levelizer.h \
+    $$PWD/gatekernels.h \
+    $$PWD/netlistsimulator.h \
+    $$PWD/eventdrivensimulator.h \
+    $$PWD/timedsimulator.h \
+    $$PWD/bitparallelsimulator.h \
+    $$PWD/threadpool.h \
+    $$PWD/clockscheduler.h \
+    $$PWD/timestepper.h \
+    $$PWD/spscqueue.h \
+    $$PWD/triplebuffer.h \
+    $$PWD/parallelsimulator.h \
+    $$PWD/nativesimulator.h \
+    $$PWD/nativecompiler.h \
+    $$PWD/simulationbackend.h \
+    $$PWD/simulatorfactory.h \
+    $$PWD/netlistoptimizer.h
+
+SOURCES += \
+    $$PWD/netlist.cpp \
+    $$PWD/levelizer.cpp \
+    $$PWD/gatekernels.cpp \
+    $$PWD/netlistsimulator.cpp \
+    $$PWD/eventdrivensimulator.cpp \
+    $$PWD/timedsimulator.cpp \
+    $$PWD/bitparallelsimulator.cpp \
+    $$PWD/threadpool.cpp \
+    $$PWD/clockscheduler.cpp \
+    $$PWD/timestepper.cpp \
+    $$PWD/parallelsimulator.cpp \
+    $$PWD/nativesimulator.cpp \
+    $$PWD/nativecompiler.cpp \
+    $$PWD/simulatorfactory.cpp \
+    $$PWD/netlistoptimizer.cpp
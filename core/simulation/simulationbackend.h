@@ -0,0 +1,29 @@
+#ifndef SIMULATIONBACKEND_H
+#define SIMULATIONBACKEND_H
+
+#include <cstdint>
+
+/* Simulated milliseconds per tick, which clocks count in. It is also the period of a tick when the simulation runs in
+ * real time. */
+#define GLOBALCLK 10
+
+/* Simulated nanoseconds in a tick. */
+const uint64_t TICK = GLOBALCLK * uint64_t( 1000000 );
+
+/**
+ * @brief The SimulationBackend enum selects how SimulationController evaluates the circuit.
+ *        INTERPRETED runs the LogicElement graph, the others run a compiled Netlist.
+ *        NATIVE translates the Netlist to C++ and runs it as machine code, falling
+ *        back to COMPILED when the host has no working compiler. TIMED runs the
+ *        Netlist in simulated time, with the propagation delay of each gate.
+ */
+enum class SimulationBackend { INTERPRETED, COMPILED, EVENT_DRIVEN, NATIVE, TIMED };
+
+/**
+ * @brief The DelayModel enum selects how the TIMED backend handles a pulse
+ *        shorter than the delay of the gate it goes through: INERTIAL swallows
+ *        it, as real gates do, TRANSPORT passes it on unchanged.
+ */
+enum class DelayModel { INERTIAL, TRANSPORT };
+
+#endif // SIMULATIONBACKEND_H
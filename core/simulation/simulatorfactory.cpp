@@ -0,0 +1,36 @@
+#include "eventdrivensimulator.h"
+#include "nativecompiler.h"
+#include "netlistsimulator.h"
+#include "parallelsimulator.h"
+#include "simulatorfactory.h"
+#include "timedsimulator.h"
+
+#include <QDebug>
+
+const uint32_t SimulatorFactory::DEFAULT_PARALLEL_THRESHOLD;
+
+NetlistSimulator* SimulatorFactory::create( const Netlist &netlist, SimulationBackend backend,
+                                            uint32_t parallelThreshold, DelayModel delayModel,
+                                            NativeCompiler *&native ) {
+  native = nullptr;
+  if( backend == SimulationBackend::EVENT_DRIVEN ) {
+    return( new EventDrivenSimulator( netlist ) );
+  }
+  if( backend == SimulationBackend::TIMED ) {
+    return( new TimedSimulator( netlist, delayModel, TICK ) );
+  }
+  if( backend == SimulationBackend::NATIVE ) {
+    native = new NativeCompiler( );
+    if( native->build( netlist ) ) {
+      return( new NativeSimulator( netlist, native->stepFunction( ) ) );
+    }
+    qDebug( ) << "Native simulation unavailable, using the netlist interpreter:" << native->errorString( );
+    delete native;
+    native = nullptr;
+    return( new NetlistSimulator( netlist ) );
+  }
+  if( ( netlist.gateCount( ) >= parallelThreshold ) && ( ParallelSimulator::defaultThreadCount( ) > 1 ) ) {
+    return( new ParallelSimulator( netlist ) );
+  }
+  return( new NetlistSimulator( netlist ) );
+}
@@ -0,0 +1,34 @@
+#ifndef SIMULATORFACTORY_H
+#define SIMULATORFACTORY_H
+
+#include "netlist.h"
+#include "simulationbackend.h"
+
+class NativeCompiler;
+class NetlistSimulator;
+
+/**
+ * @brief The SimulatorFactory class creates the NetlistSimulator that runs a
+ *        finalized Netlist for a SimulationBackend, so that the editor and
+ *        the headless engine pick the same one.
+ */
+class SimulatorFactory {
+public:
+  /**
+   * @brief DEFAULT_PARALLEL_THRESHOLD is the gate count from which the
+   *        compiled backend evaluates the netlist over several threads.
+   */
+  static const uint32_t DEFAULT_PARALLEL_THRESHOLD = 20000;
+
+  /**
+   * @brief create returns a simulator the caller owns. For the NATIVE
+   *        backend, native is set to the compiler that holds the machine
+   *        code, which must be deleted after the simulator; it is left null
+   *        when no compiler works and the netlist is interpreted instead.
+   *        The TIMED backend advances by one GLOBALCLK tick per run( ).
+   */
+  static NetlistSimulator* create( const Netlist &netlist, SimulationBackend backend, uint32_t parallelThreshold,
+                                   DelayModel delayModel, NativeCompiler *&native );
+};
+
+#endif // SIMULATORFACTORY_H
@@ -0,0 +1,63 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+ * @brief The SpscQueue class is a bounded lock-free queue for exactly one
+ *        producer thread and one consumer thread. The capacity is rounded
+ *        up to a power of two, and push( ) fails instead of blocking when
+ *        the queue is full.
+ */
+template< typename T >
+class SpscQueue {
+public:
+  explicit SpscQueue( size_t capacity ) : mask( roundUp( capacity ) - 1 ), items( new T[ mask + 1 ] ), head( 0 ),
+    tail( 0 ) {
+  }
+
+  bool push( const T &item ) {
+    const size_t pos = tail.load( std::memory_order_relaxed );
+    if( pos - head.load( std::memory_order_acquire ) > mask ) {
+      return( false );
+    }
+    items[ pos & mask ] = item;
+    tail.store( pos + 1, std::memory_order_release );
+    return( true );
+  }
+
+  bool pop( T &item ) {
+    const size_t pos = head.load( std::memory_order_relaxed );
+    if( pos == tail.load( std::memory_order_acquire ) ) {
+      return( false );
+    }
+    item = items[ pos & mask ];
+    head.store( pos + 1, std::memory_order_release );
+    return( true );
+  }
+
+  size_t capacity( ) const {
+    return( mask + 1 );
+  }
+
+private:
+  static size_t roundUp( size_t capacity ) {
+    size_t size = 1;
+    while( size < capacity ) {
+      size <<= 1;
+    }
+    return( size );
+  }
+
+  const size_t mask;
+  std::unique_ptr< T[] > items;
+  /* Written by the consumer only. The padding keeps both ends on different cache lines. */
+  std::atomic< size_t > head;
+  char padding[ 64 - sizeof( std::atomic< size_t > ) ];
+  /* Written by the producer only. */
+  std::atomic< size_t > tail;
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,106 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+namespace {
+  /* Number of polls a worker makes for the next job before going to sleep. Levels of one tick follow each other
+   * quickly, so waking up from a condition variable for each of them would cost more than the work itself. */
+  const int SPIN_COUNT = 4096;
+}
+
+ThreadPool::ThreadPool( unsigned threads ) :
+  threadCount( std::max( threads, 1u ) ),
+  slices( new Slice[ std::max( threads, 1u ) ] ),
+  job( nullptr ),
+  grain( 1 ),
+  generation( 0 ),
+  busy( 0 ),
+  quit( false ) {
+  for( unsigned id = 0; id < threadCount; ++id ) {
+    slices[ id ].next.store( 0 );
+    slices[ id ].end = 0;
+  }
+  for( unsigned id = 1; id < threadCount; ++id ) {
+    workers.emplace_back( &ThreadPool::workerLoop, this, id );
+  }
+}
+
+ThreadPool::~ThreadPool( ) {
+  {
+    std::lock_guard< std::mutex > lock( mutex );
+    quit.store( true );
+  }
+  wake.notify_all( );
+  for( std::thread &worker : workers ) {
+    worker.join( );
+  }
+}
+
+unsigned ThreadPool::size( ) const {
+  return( threadCount );
+}
+
+void ThreadPool::parallelFor( uint32_t begin, uint32_t end, uint32_t grain, const RangeFunction &body ) {
+  if( begin >= end ) {
+    return;
+  }
+  this->grain = std::max( grain, 1u );
+  job = &body;
+  const uint32_t total = end - begin;
+  for( unsigned id = 0; id < threadCount; ++id ) {
+    slices[ id ].next.store( begin + static_cast< uint32_t >( static_cast< uint64_t >( total ) * id / threadCount ),
+                             std::memory_order_relaxed );
+    slices[ id ].end = begin + static_cast< uint32_t >( static_cast< uint64_t >( total ) * ( id + 1 ) / threadCount );
+  }
+  busy.store( threadCount - 1, std::memory_order_relaxed );
+  generation.fetch_add( 1, std::memory_order_release );
+  {
+    /* Taking the lock makes sure that no worker is between checking the generation and going to sleep. */
+    std::lock_guard< std::mutex > lock( mutex );
+  }
+  wake.notify_all( );
+  work( 0 );
+  while( busy.load( std::memory_order_acquire ) != 0 ) {
+    std::this_thread::yield( );
+  }
+  job = nullptr;
+}
+
+void ThreadPool::workerLoop( unsigned id ) {
+  uint64_t seen = 0;
+  while( true ) {
+    int spins = 0;
+    uint64_t current;
+    while( ( current = generation.load( std::memory_order_acquire ) ) == seen ) {
+      if( quit.load( ) ) {
+        return;
+      }
+      if( ++spins < SPIN_COUNT ) {
+        std::this_thread::yield( );
+      }
+      else {
+        std::unique_lock< std::mutex > lock( mutex );
+        wake.wait( lock, [ this, seen ]( ) {
+          return( quit.load( ) || ( generation.load( std::memory_order_acquire ) != seen ) );
+        } );
+      }
+    }
+    seen = current;
+    work( id );
+    busy.fetch_sub( 1, std::memory_order_release );
+  }
+}
+
+void ThreadPool::work( unsigned id ) {
+  /* Own slice first, then steal from the slices of the next threads. */
+  for( unsigned offset = 0; offset < threadCount; ++offset ) {
+    Slice &slice = slices[ ( id + offset ) % threadCount ];
+    while( true ) {
+      uint32_t chunkBegin = slice.next.fetch_add( grain, std::memory_order_relaxed );
+      if( chunkBegin >= slice.end ) {
+        break;
+      }
+      ( *job )( chunkBegin, std::min( chunkBegin + grain, slice.end ) );
+    }
+  }
+}
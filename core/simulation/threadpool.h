@@ -0,0 +1,64 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The ThreadPool class runs a range of independent work items over a
+ *        fixed set of threads. The range is split in one slice per thread,
+ *        and threads that finish their own slice steal chunks from the
+ *        others. parallelFor( ) only returns when the whole range is done,
+ *        so consecutive calls are separated by a barrier.
+ */
+class ThreadPool {
+public:
+  typedef std::function< void ( uint32_t, uint32_t ) > RangeFunction;
+
+  /**
+   * @brief ThreadPool starts threads - 1 workers; the thread that calls
+   *        parallelFor( ) works as well.
+   */
+  explicit ThreadPool( unsigned threads );
+  ~ThreadPool( );
+
+  unsigned size( ) const;
+
+  /**
+   * @brief parallelFor calls body( chunkBegin, chunkEnd ) over chunks of
+   *        at most grain items until [begin, end) is covered.
+   */
+  void parallelFor( uint32_t begin, uint32_t end, uint32_t grain, const RangeFunction &body );
+
+private:
+  struct Slice {
+    std::atomic< uint32_t > next;
+    uint32_t end;
+    /* Keeps the slices of different threads on different cache lines. */
+    char padding[ 64 - sizeof( std::atomic< uint32_t > ) - sizeof( uint32_t ) ];
+  };
+
+  unsigned threadCount;
+  std::unique_ptr< Slice[] > slices;
+  std::vector< std::thread > workers;
+
+  const RangeFunction *job;
+  uint32_t grain;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::atomic< uint64_t > generation;
+  std::atomic< unsigned > busy;
+  std::atomic< bool > quit;
+
+  void workerLoop( unsigned id );
+  void work( unsigned id );
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,162 @@
+#include "netlistkernel.h"
+#include "timedsimulator.h"
+
+#include <algorithm>
+
+const uint64_t TimedSimulator::NEVER;
+
+TimedSimulator::TimedSimulator( const Netlist &netlist, DelayModel model, uint64_t tick ) :
+  NetlistSimulator( netlist ),
+  model( model ),
+  tick( tick ),
+  now( 0 ),
+  sequence( 0 ),
+  deltaLimit( netlist.gateCount( ) + 1 ) {
+  uint32_t maxOutputs = 0;
+  for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+    maxOutputs = std::max( maxOutputs, netlist.outputSize( gate ) );
+  }
+  current.resize( maxOutputs );
+  reset( );
+}
+
+void TimedSimulator::reset( ) {
+  NetlistSimulator::reset( );
+  now = 0;
+  sequence = 0;
+  queue.clear( );
+  projected = signals;
+  generations.assign( netlist.signalCount( ), 0 );
+  active.clear( );
+  pending.assign( netlist.gateCount( ), false );
+  for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+    activate( gate );
+  }
+}
+
+void TimedSimulator::setInput( uint32_t signal, bool value ) {
+  if( signals[ signal ] != value ) {
+    signals[ signal ] = value;
+    projected[ signal ] = value;
+    activateFanout( signal );
+  }
+}
+
+void TimedSimulator::run( ) {
+  advanceTo( now + tick );
+}
+
+void TimedSimulator::advanceTo( uint64_t time ) {
+  uint64_t evaluated = 0;
+  uint32_t delta = 0;
+  while( true ) {
+    if( !active.empty( ) ) {
+      evaluated += evaluate( delta++ );
+      continue;
+    }
+    if( queue.empty( ) || ( queue.front( ).time > time ) ) {
+      break;
+    }
+    if( queue.front( ).time != now ) {
+      now = queue.front( ).time;
+      delta = 0;
+    }
+    while( !queue.empty( ) && ( queue.front( ).time == now ) ) {
+      std::pop_heap( queue.begin( ), queue.end( ), later );
+      const Event event = queue.back( );
+      queue.pop_back( );
+      if( ( event.generation == generations[ event.signal ] ) && ( signals[ event.signal ] != event.value ) ) {
+        signals[ event.signal ] = event.value;
+        activateFanout( event.signal );
+      }
+    }
+    dropStale( );
+  }
+  now = std::max( now, time );
+  evaluations = evaluated;
+}
+
+uint64_t TimedSimulator::time( ) const {
+  return( now );
+}
+
+uint64_t TimedSimulator::nextEvent( ) const {
+  if( !active.empty( ) ) {
+    return( now );
+  }
+  return( queue.empty( ) ? NEVER : queue.front( ).time );
+}
+
+void TimedSimulator::activate( uint32_t gate ) {
+  if( pending[ gate ] || !netlist.valid[ gate ] || ( netlist.ops[ gate ] == LogicOp::INPUT ) ) {
+    return;
+  }
+  pending[ gate ] = true;
+  active.push_back( gate );
+}
+
+void TimedSimulator::activateFanout( uint32_t signal ) {
+  for( uint32_t idx = netlist.fanoutBegin[ signal ]; idx < netlist.fanoutBegin[ signal + 1 ]; ++idx ) {
+    activate( netlist.fanouts[ idx ] );
+  }
+}
+
+uint64_t TimedSimulator::evaluate( uint32_t delta ) {
+  batch.swap( active );
+  uint8_t *sig = signals.data( );
+  uint8_t *st = state.data( );
+  for( uint32_t gate : batch ) {
+    pending[ gate ] = false;
+    const uint32_t begin = netlist.outputBegin[ gate ];
+    const uint32_t end = netlist.outputBegin[ gate + 1 ];
+    /* Sequential gates hold the value their outputs are heading to, not the one they still show. */
+    for( uint32_t signal = begin; signal < end; ++signal ) {
+      current[ signal - begin ] = sig[ signal ];
+      sig[ signal ] = projected[ signal ];
+    }
+    evaluateGate< uint8_t >( netlist, gate, sig, st );
+    uint64_t delay = netlist.delays[ gate ];
+    if( ( delay == 0 ) && ( delta >= deltaLimit ) ) {
+      /* A loop of gates without delay that never settles must still let the time go on. */
+      delay = 1;
+    }
+    for( uint32_t signal = begin; signal < end; ++signal ) {
+      const uint8_t value = sig[ signal ];
+      sig[ signal ] = current[ signal - begin ];
+      if( value != projected[ signal ] ) {
+        schedule( signal, value, now + delay );
+      }
+    }
+  }
+  const uint64_t evaluated = batch.size( );
+  batch.clear( );
+  dropStale( );
+  return( evaluated );
+}
+
+void TimedSimulator::schedule( uint32_t signal, uint8_t value, uint64_t time ) {
+  projected[ signal ] = value;
+  if( model == DelayModel::INERTIAL ) {
+    /* The pending change did not last as long as the delay, so it never shows. */
+    ++generations[ signal ];
+    if( signals[ signal ] == value ) {
+      return;
+    }
+  }
+  queue.push_back( { time, sequence++, signal, generations[ signal ], value } );
+  std::push_heap( queue.begin( ), queue.end( ), later );
+}
+
+void TimedSimulator::dropStale( ) {
+  while( !queue.empty( ) && ( queue.front( ).generation != generations[ queue.front( ).signal ] ) ) {
+    std::pop_heap( queue.begin( ), queue.end( ), later );
+    queue.pop_back( );
+  }
+}
+
+bool TimedSimulator::later( const Event &e1, const Event &e2 ) {
+  if( e1.time != e2.time ) {
+    return( e1.time > e2.time );
+  }
+  return( e1.sequence > e2.sequence );
+}
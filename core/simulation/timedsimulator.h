@@ -0,0 +1,88 @@
+#ifndef TIMEDSIMULATOR_H
+#define TIMEDSIMULATOR_H
+
+#include "netlistsimulator.h"
+#include "simulationbackend.h"
+
+/**
+ * @brief The TimedSimulator class runs the netlist in simulated time,
+ *        counted in nanoseconds. A gate is evaluated when one of its inputs
+ *        changes, and its outputs follow Netlist::delays[ gate ] later. The
+ *        output changes wait as events in a min-heap ordered by time. Events
+ *        that fall at the same time are applied together, then the gates
+ *        they reach are evaluated, again at that time when their delay is
+ *        zero, until nothing changes.
+ */
+class TimedSimulator : public NetlistSimulator {
+public:
+  static const uint64_t NEVER = UINT64_MAX;
+
+  /**
+   * @brief tick is how far run( ) advances the simulated time.
+   */
+  TimedSimulator( const Netlist &netlist, DelayModel model, uint64_t tick );
+
+  /**
+   * @brief reset also sets the time back to zero, and evaluates every gate
+   *        at that time, as the first tick of the other simulators does.
+   */
+  void reset( ) override;
+
+  /**
+   * @brief setInput changes the signal at the current time.
+   */
+  void setInput( uint32_t signal, bool value ) override;
+
+  /**
+   * @brief run advances the simulated time by one tick.
+   */
+  void run( ) override;
+
+  /**
+   * @brief advanceTo applies every event due until time, included.
+   */
+  void advanceTo( uint64_t time );
+  uint64_t time( ) const;
+
+  /**
+   * @brief nextEvent returns the time at which something is next due, or
+   *        NEVER when the circuit is stable.
+   */
+  uint64_t nextEvent( ) const;
+
+private:
+  struct Event {
+    uint64_t time;
+    /* Keeps events of the same time in the order they were scheduled. */
+    uint64_t sequence;
+    uint32_t signal;
+    /* Events scheduled before the last cancellation on their signal are stale. */
+    uint32_t generation;
+    uint8_t value;
+  };
+
+  DelayModel model;
+  uint64_t tick;
+  uint64_t now;
+  uint64_t sequence;
+  std::vector< Event > queue;
+  /* Per signal: the value it will have once its events are applied, and its generation. */
+  std::vector< uint8_t > projected;
+  std::vector< uint32_t > generations;
+  /* Gates to evaluate at the current time, and those being evaluated. */
+  std::vector< uint32_t > active;
+  std::vector< uint32_t > batch;
+  std::vector< uint8_t > pending;
+  std::vector< uint8_t > current;
+  /* Evaluation rounds at the same time after which zero delays count as one nanosecond. */
+  uint32_t deltaLimit;
+
+  void activate( uint32_t gate );
+  void activateFanout( uint32_t signal );
+  uint64_t evaluate( uint32_t delta );
+  void schedule( uint32_t signal, uint8_t value, uint64_t time );
+  void dropStale( );
+  static bool later( const Event &e1, const Event &e2 );
+};
+
+#endif // TIMEDSIMULATOR_H
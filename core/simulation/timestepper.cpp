@@ -0,0 +1,58 @@
+#include "timestepper.h"
+#include "simulationbackend.h"
+
+#include <algorithm>
+
+TimeStepper::TimeStepper( ) : now( 0 ), lastEvaluation( 0 ), dirty( true ) {
+}
+
+TimeStepper::~TimeStepper( ) {
+}
+
+void TimeStepper::step( ) {
+  dirty = true;
+  advanceTo( now + TICK );
+}
+
+void TimeStepper::advanceTo( uint64_t time ) {
+  for( uint64_t next = nextEvaluation( ); ( next != ClockScheduler::NEVER ) && ( next <= time );
+       next = nextEvaluation( ) ) {
+    now = std::max( now, next );
+    /* Clocks with edges at the same time all change before the evaluation. */
+    while( scheduler.nextEdge( ) <= now ) {
+      const uint32_t clock = scheduler.popEdge( );
+      setClock( clock, scheduler.value( clock ) );
+    }
+    dirty = false;
+    lastEvaluation = now;
+    evaluate( );
+  }
+  now = std::max( now, time );
+}
+
+uint64_t TimeStepper::time( ) const {
+  return( now );
+}
+
+uint64_t TimeStepper::nextEvaluation( ) const {
+  if( dirty ) {
+    return( now );
+  }
+  const uint64_t next = std::min( scheduler.nextEdge( ), nextEvent( ) );
+  if( !isSettled( ) ) {
+    /* Loops that did not settle go on changing once per tick, as with a fixed tick rate. */
+    return( std::min( next, lastEvaluation + TICK ) );
+  }
+  return( next );
+}
+
+void TimeStepper::resetTime( ) {
+  now = 0;
+  lastEvaluation = 0;
+  dirty = true;
+  scheduler.clear( );
+}
+
+uint64_t TimeStepper::nextEvent( ) const {
+  return( ClockScheduler::NEVER );
+}
@@ -0,0 +1,70 @@
+#ifndef TIMESTEPPER_H
+#define TIMESTEPPER_H
+
+#include "clockscheduler.h"
+
+#include <cstdint>
+
+/**
+ * @brief The TimeStepper class keeps the simulated time of a circuit, in
+ *        nanoseconds, and evaluates it only when something is due: a clock
+ *        edge from its ClockScheduler, an input change, a gate output of the
+ *        timed backend, or, while a feedback loop keeps changing, the next
+ *        GLOBALCLK tick. Subclasses drive the clocks and run the circuit.
+ */
+class TimeStepper {
+public:
+  TimeStepper( );
+  virtual ~TimeStepper( );
+
+  /**
+   * @brief step advances the time by one GLOBALCLK tick, evaluating the
+   *        circuit at least once. advanceTo evaluates it whenever something
+   *        is due until time, in nanoseconds.
+   */
+  void step( );
+  void advanceTo( uint64_t time );
+  uint64_t time( ) const;
+
+  /**
+   * @brief nextEvaluation returns when the circuit is next due to be
+   *        evaluated, or ClockScheduler::NEVER.
+   */
+  uint64_t nextEvaluation( ) const;
+
+protected:
+  ClockScheduler scheduler;
+  /* Simulated time, and the time of the last evaluation. */
+  uint64_t now;
+  uint64_t lastEvaluation;
+  /* Whether an input changed since the last evaluation. */
+  bool dirty;
+
+  /**
+   * @brief resetTime goes back to time zero, without any clock.
+   */
+  void resetTime( );
+
+  /**
+   * @brief setClock sets the input of a clock of the scheduler, at an edge.
+   */
+  virtual void setClock( uint32_t clock, bool value ) = 0;
+
+  /**
+   * @brief nextEvent returns when the timed backend has a gate output to
+   *        change, or ClockScheduler::NEVER.
+   */
+  virtual uint64_t nextEvent( ) const;
+
+  /**
+   * @brief isSettled returns false while a feedback loop keeps changing.
+   */
+  virtual bool isSettled( ) const = 0;
+
+  /**
+   * @brief evaluate runs the circuit at the current time.
+   */
+  virtual void evaluate( ) = 0;
+};
+
+#endif // TIMESTEPPER_H
@@ -0,0 +1,67 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+/**
+ * @brief The TripleBuffer class hands values from one writer thread to one
+ *        reader thread without locks. The writer fills back( ) and calls
+ *        publish( ); the reader calls fetch( ) and reads front( ). Neither
+ *        side ever waits, and the reader always gets the latest complete
+ *        value, skipping the ones published in between.
+ */
+template< typename T >
+class TripleBuffer {
+public:
+  TripleBuffer( ) : middle( 1 ), backIndex( 2 ), frontIndex( 0 ) {
+  }
+
+  /**
+   * @brief reset sets the three buffers to value. It must not run
+   *        concurrently with the writer or the reader.
+   */
+  void reset( const T &value ) {
+    for( T &buffer : buffers ) {
+      buffer = value;
+    }
+    middle.store( 1 );
+    backIndex = 2;
+    frontIndex = 0;
+  }
+
+  T &back( ) {
+    return( buffers[ backIndex ] );
+  }
+
+  void publish( ) {
+    backIndex = middle.exchange( backIndex | FRESH, std::memory_order_acq_rel ) & INDEX;
+  }
+
+  /**
+   * @brief fetch makes the last published value the front one, and returns
+   *        false when nothing was published since the previous fetch.
+   */
+  bool fetch( ) {
+    if( !( middle.load( std::memory_order_relaxed ) & FRESH ) ) {
+      return( false );
+    }
+    frontIndex = middle.exchange( frontIndex, std::memory_order_acq_rel ) & INDEX;
+    return( true );
+  }
+
+  const T &front( ) const {
+    return( buffers[ frontIndex ] );
+  }
+
+private:
+  static const int INDEX = 3;
+  static const int FRESH = 4;
+
+  T buffers[ 3 ];
+  /* Index of the buffer between the writer and the reader, and whether it holds an unread value. */
+  std::atomic< int > middle;
+  int backIndex;
+  int frontIndex;
+};
+
+#endif // TRIPLEBUFFER_H
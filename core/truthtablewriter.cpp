@@ -0,0 +1,168 @@
+#include "truthtablewriter.h"
+#include "simulation/bitparallelsimulator.h"
+#include "simulation/threadpool.h"
+
+#include <QDataStream>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+const quint32 TruthTableWriter::MAGIC;
+const quint16 TruthTableWriter::VERSION;
+const int TruthTableWriter::MAX_INPUTS;
+const uint64_t TruthTableWriter::CHUNK_ROWS;
+
+TruthTableWriter::TruthTableWriter( const Netlist &netlist ) : netlist( netlist ), format( Format::TEXT ),
+  threads( 0 ) {
+}
+
+void TruthTableWriter::addInput( const QString &name, uint32_t signal ) {
+  inputNames.append( name );
+  inputSignals.push_back( signal );
+}
+
+void TruthTableWriter::addOutput( const QString &name, uint32_t signal ) {
+  outputNames.append( name );
+  outputSignals.push_back( signal );
+}
+
+void TruthTableWriter::setFormat( Format format ) {
+  this->format = format;
+}
+
+void TruthTableWriter::setThreadCount( unsigned threads ) {
+  this->threads = threads;
+}
+
+void TruthTableWriter::setProgress( const ProgressFunction &progress ) {
+  this->progress = progress;
+}
+
+uint64_t TruthTableWriter::rowCount( ) const {
+  return( uint64_t( 1 ) << inputSignals.size( ) );
+}
+
+size_t TruthTableWriter::rowSize( ) const {
+  if( format == Format::TEXT ) {
+    return( outputSignals.size( ) + 1 );
+  }
+  return( ( outputSignals.size( ) + 7 ) / 8 );
+}
+
+bool TruthTableWriter::writeHeader( QIODevice &device ) const {
+  if( format == Format::BINARY ) {
+    QDataStream stream( &device );
+    stream << MAGIC << VERSION << inputNames << outputNames;
+    return( stream.status( ) == QDataStream::Ok );
+  }
+  QStringList inputs( inputNames );
+  QStringList outputs( outputNames );
+  inputs.replaceInStrings( " ", "_" );
+  outputs.replaceInStrings( " ", "_" );
+  const QString header = QString( "# Row N sets input i to bit i of N\n# inputs: %1\n# outputs: %2\n" )
+                         .arg( inputs.join( ' ' ) ).arg( outputs.join( ' ' ) );
+  const QByteArray data = header.toUtf8( );
+  return( device.write( data ) == data.size( ) );
+}
+
+void TruthTableWriter::fillChunk( BitParallelSimulator &simulator, uint64_t first, uint64_t rows,
+                                  QByteArray &chunk ) const {
+  const size_t size = rowSize( );
+  chunk.resize( static_cast< int >( rows * size ) );
+  char *data = chunk.data( );
+  if( format == Format::BINARY ) {
+    std::fill( data, data + chunk.size( ), 0 );
+  }
+  for( uint64_t base = 0; base < rows; base += BitParallelSimulator::LANES ) {
+    for( size_t in = 0; in < inputSignals.size( ); ++in ) {
+      simulator.setInput( inputSignals[ in ], BitParallelSimulator::counterLanes( first + base, static_cast< int >( in ) ) );
+    }
+    simulator.run( );
+    const uint64_t lanes = std::min< uint64_t >( BitParallelSimulator::LANES, rows - base );
+    char *row = data + base * size;
+    for( size_t out = 0; out < outputSignals.size( ); ++out ) {
+      const uint64_t value = simulator.value( outputSignals[ out ] );
+      if( format == Format::TEXT ) {
+        for( uint64_t lane = 0; lane < lanes; ++lane ) {
+          row[ lane * size + out ] = static_cast< char >( '0' + ( ( value >> lane ) & 1 ) );
+        }
+      }
+      else {
+        const char bit = static_cast< char >( 1 << ( out % 8 ) );
+        for( uint64_t lane = 0; lane < lanes; ++lane ) {
+          if( ( value >> lane ) & 1 ) {
+            row[ lane * size + out / 8 ] |= bit;
+          }
+        }
+      }
+    }
+    if( format == Format::TEXT ) {
+      for( uint64_t lane = 0; lane < lanes; ++lane ) {
+        row[ lane * size + size - 1 ] = '\n';
+      }
+    }
+  }
+}
+
+bool TruthTableWriter::write( QIODevice &device ) {
+  if( !netlist.isCombinational( ) ) {
+    throw std::runtime_error( "The truth table needs a circuit without memory elements or feedback loops." );
+  }
+  if( inputSignals.size( ) > static_cast< size_t >( MAX_INPUTS ) ) {
+    throw std::runtime_error( "The truth table is limited to " + std::to_string( MAX_INPUTS ) + " inputs." );
+  }
+  if( outputSignals.empty( ) ) {
+    throw std::runtime_error( "The truth table needs at least one output." );
+  }
+  if( !writeHeader( device ) ) {
+    return( false );
+  }
+  ThreadPool pool( threads > 0 ? threads : std::max( 1u, std::thread::hardware_concurrency( ) ) );
+  /* Two chunks per thread, so that threads that finish early steal work from the others. */
+  const uint32_t slots = pool.size( ) * 2;
+  std::vector< std::unique_ptr< BitParallelSimulator > > simulators;
+  for( uint32_t slot = 0; slot < slots; ++slot ) {
+    simulators.emplace_back( new BitParallelSimulator( netlist ) );
+  }
+  /* The chunks of a round are evaluated while the writer thread writes those of the previous round. */
+  std::vector< QByteArray > rounds[ 2 ] = { std::vector< QByteArray >( slots ), std::vector< QByteArray >( slots ) };
+  std::atomic< bool > failed( false );
+  std::thread writer;
+  const uint64_t total = rowCount( );
+  bool cancelled = false;
+  int current = 0;
+  for( uint64_t first = 0; ( first < total ) && !cancelled; current ^= 1 ) {
+    const uint64_t rows = std::min( total - first, slots * CHUNK_ROWS );
+    const uint32_t chunks = static_cast< uint32_t >( ( rows + CHUNK_ROWS - 1 ) / CHUNK_ROWS );
+    std::vector< QByteArray > &round = rounds[ current ];
+    pool.parallelFor( 0, chunks, 1, [ this, &simulators, &round, first, total ]( uint32_t begin, uint32_t end ) {
+      for( uint32_t chunk = begin; chunk < end; ++chunk ) {
+        const uint64_t start = first + chunk * CHUNK_ROWS;
+        fillChunk( *simulators[ chunk ], start, std::min( CHUNK_ROWS, total - start ), round[ chunk ] );
+      }
+    } );
+    if( writer.joinable( ) ) {
+      writer.join( );
+    }
+    if( failed.load( ) ) {
+      break;
+    }
+    writer = std::thread( [ &device, &round, &failed, chunks ]( ) {
+      for( uint32_t chunk = 0; chunk < chunks; ++chunk ) {
+        if( device.write( round[ chunk ] ) != round[ chunk ].size( ) ) {
+          failed.store( true );
+          return;
+        }
+      }
+    } );
+    first += rows;
+    cancelled = progress && !progress( first, total );
+  }
+  if( writer.joinable( ) ) {
+    writer.join( );
+  }
+  return( !failed.load( ) && !cancelled );
+}
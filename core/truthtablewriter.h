@@ -0,0 +1,88 @@
+#ifndef TRUTHTABLEWRITER_H
+#define TRUTHTABLEWRITER_H
+
+#include "simulation/netlist.h"
+
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <vector>
+
+class BitParallelSimulator;
+
+/**
+ * @brief The TruthTableWriter class streams the full truth table of a
+ *        combinational Netlist to a device. Row N sets input i to bit i of
+ *        N, and holds the values of the outputs only, as the inputs follow
+ *        from the row number. The input space is cut into chunks that
+ *        threads evaluate 64 rows at a time, each on a simulator of its own,
+ *        while the previous chunks are written, so memory use only depends
+ *        on the number of threads.
+ *
+ *        The TEXT format starts with '#' comment lines naming the inputs and
+ *        outputs, then has one line per row with one '0' or '1' character
+ *        per output. The BINARY format starts with a QDataStream header:
+ *        MAGIC, the format version, then the input and output names as
+ *        QStringList; each row then takes ( outputs + 7 ) / 8 bytes, output
+ *        o being bit o % 8 of byte o / 8.
+ */
+class TruthTableWriter {
+public:
+  enum class Format { TEXT, BINARY };
+
+  static const quint32 MAGIC = 0x57505454;
+  static const quint16 VERSION = 1;
+  static const int MAX_INPUTS = 40;
+  /* Rows per chunk; a multiple of 64. */
+  static const uint64_t CHUNK_ROWS = 1 << 16;
+
+  /**
+   * @brief progress is called between chunks with the rows evaluated so far,
+   *        and cancels the export when it returns false.
+   */
+  typedef std::function< bool ( uint64_t rows, uint64_t total ) > ProgressFunction;
+
+  explicit TruthTableWriter( const Netlist &netlist );
+
+  /**
+   * @brief addInput and addOutput add a column read from, or written to,
+   *        a signal of the netlist. The first input is the lowest bit of the
+   *        row number.
+   */
+  void addInput( const QString &name, uint32_t signal );
+  void addOutput( const QString &name, uint32_t signal );
+
+  void setFormat( Format format );
+  /**
+   * @brief setThreadCount sets how many threads evaluate the rows, 0, the
+   *        default, meaning one per core.
+   */
+  void setThreadCount( unsigned threads );
+  void setProgress( const ProgressFunction &progress );
+
+  uint64_t rowCount( ) const;
+
+  /**
+   * @brief write streams the table to device and returns false if writing
+   *        failed or was cancelled. It throws a std::runtime_error when the
+   *        netlist is not combinational or there are too many inputs.
+   */
+  bool write( QIODevice &device );
+
+private:
+  const Netlist &netlist;
+  QStringList inputNames;
+  QStringList outputNames;
+  std::vector< uint32_t > inputSignals;
+  std::vector< uint32_t > outputSignals;
+  Format format;
+  unsigned threads;
+  ProgressFunction progress;
+
+  size_t rowSize( ) const;
+  bool writeHeader( QIODevice &device ) const;
+  void fillChunk( BitParallelSimulator &simulator, uint64_t first, uint64_t rows, QByteArray &chunk ) const;
+};
+
+#endif // TRUTHTABLEWRITER_H
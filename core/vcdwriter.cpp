@@ -0,0 +1,152 @@
+#include "vcdwriter.h"
+
+#include <QDateTime>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+  /* The file is written in blocks of this size. */
+  const int BLOCK_SIZE = 1 << 20;
+  /* How long the writer thread sleeps when there is nothing to write. */
+  const std::chrono::milliseconds IDLE_PERIOD( 2 );
+}
+
+const size_t VcdWriter::DEFAULT_CAPACITY;
+
+VcdWriter::VcdWriter( size_t capacity ) : lastTime( 0 ), changes( capacity ), closing( false ) {
+}
+
+VcdWriter::~VcdWriter( ) {
+  close( );
+}
+
+int VcdWriter::addScope( const QString &name, int parent ) {
+  scopes.push_back( { sanitize( name ), parent } );
+  return( static_cast< int >( scopes.size( ) - 1 ) );
+}
+
+uint32_t VcdWriter::addVariable( int scope, const QString &name ) {
+  names.push_back( sanitize( name ) );
+  variableScopes.push_back( scope );
+  values.push_back( 2 );
+  return( static_cast< uint32_t >( names.size( ) - 1 ) );
+}
+
+bool VcdWriter::open( const QString &fileName ) {
+  close( );
+  file.setFileName( fileName );
+  if( !file.open( QFile::WriteOnly ) ) {
+    return( false );
+  }
+  identifiers.clear( );
+  for( uint32_t variable = 0; variable < names.size( ); ++variable ) {
+    identifiers.push_back( identifier( variable ) );
+  }
+  QByteArray header;
+  header += "$date " + QDateTime::currentDateTime( ).toString( Qt::ISODate ).toUtf8( ) + " $end\n";
+  header += "$version WiredPanda $end\n";
+  header += "$timescale 1ns $end\n";
+  for( int scope = 0; scope < static_cast< int >( scopes.size( ) ); ++scope ) {
+    if( scopes[ static_cast< size_t >( scope ) ].parent < 0 ) {
+      writeScope( scope, header );
+    }
+  }
+  header += "$enddefinitions $end\n";
+  file.write( header );
+  std::fill( values.begin( ), values.end( ), 2 );
+  lastTime = 0;
+  closing.store( false );
+  writer = std::thread( &VcdWriter::write, this );
+  return( true );
+}
+
+bool VcdWriter::isOpen( ) const {
+  return( writer.joinable( ) );
+}
+
+void VcdWriter::change( uint64_t time, uint32_t variable, signed char value ) {
+  if( values[ variable ] == value ) {
+    return;
+  }
+  values[ variable ] = value;
+  lastTime = std::max( lastTime, time );
+  const Change item = { lastTime, variable, value };
+  while( !changes.push( item ) ) {
+    std::this_thread::yield( );
+  }
+}
+
+void VcdWriter::close( ) {
+  if( !writer.joinable( ) ) {
+    return;
+  }
+  closing.store( true, std::memory_order_release );
+  writer.join( );
+  file.close( );
+}
+
+void VcdWriter::writeScope( int scope, QByteArray &out ) const {
+  out += "$scope module " + scopes[ static_cast< size_t >( scope ) ].name.toUtf8( ) + " $end\n";
+  for( uint32_t variable = 0; variable < names.size( ); ++variable ) {
+    if( variableScopes[ variable ] == scope ) {
+      out += "$var wire 1 " + identifiers[ variable ] + " " + names[ variable ].toUtf8( ) + " $end\n";
+    }
+  }
+  for( int child = 0; child < static_cast< int >( scopes.size( ) ); ++child ) {
+    if( scopes[ static_cast< size_t >( child ) ].parent == scope ) {
+      writeScope( child, out );
+    }
+  }
+  out += "$upscope $end\n";
+}
+
+void VcdWriter::write( ) {
+  QByteArray block;
+  block.reserve( BLOCK_SIZE + 64 );
+  bool started = false;
+  uint64_t time = 0;
+  for( ; ; ) {
+    /* Read before draining, so that no change queued before close( ) is missed. */
+    const bool done = closing.load( std::memory_order_acquire );
+    bool idle = true;
+    Change item;
+    while( changes.pop( item ) ) {
+      idle = false;
+      if( !started || ( item.time != time ) ) {
+        block += '#' + QByteArray::number( static_cast< qulonglong >( item.time ) ) + '\n';
+        time = item.time;
+        started = true;
+      }
+      block += item.value < 0 ? 'x' : item.value ? '1' : '0';
+      block += identifiers[ item.variable ];
+      block += '\n';
+      if( block.size( ) >= BLOCK_SIZE ) {
+        file.write( block );
+        block.clear( );
+      }
+    }
+    if( done ) {
+      break;
+    }
+    if( idle ) {
+      std::this_thread::sleep_for( IDLE_PERIOD );
+    }
+  }
+  file.write( block );
+}
+
+QByteArray VcdWriter::identifier( uint32_t variable ) {
+  /* Identifiers are made of the printable characters, from '!' to '~'. */
+  QByteArray id;
+  do {
+    id += static_cast< char >( '!' + variable % 94 );
+    variable /= 94;
+  } while( variable > 0 );
+  return( id );
+}
+
+QString VcdWriter::sanitize( const QString &name ) {
+  QString result = name.simplified( );
+  result.replace( ' ', '_' );
+  return( result.isEmpty( ) ? QString( "unnamed" ) : result );
+}
@@ -0,0 +1,84 @@
+#ifndef VCDWRITER_H
+#define VCDWRITER_H
+
+#include "simulation/spscqueue.h"
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The VcdWriter class writes a Value Change Dump, in nanoseconds, as
+ *        a simulation runs. The scopes and variables are declared before
+ *        open( ), then one thread reports values with change( ), which only
+ *        queues the values that did change. A thread of the writer formats
+ *        them and writes the file in large blocks. When the writer falls
+ *        behind, change( ) waits for room in the queue, so memory use does
+ *        not depend on the length of the run.
+ */
+class VcdWriter {
+public:
+  explicit VcdWriter( size_t capacity = DEFAULT_CAPACITY );
+  ~VcdWriter( );
+
+  static const size_t DEFAULT_CAPACITY = 65536;
+
+  /**
+   * @brief addScope adds a module under parent, or at the top for -1, and
+   *        returns its index. addVariable adds a one bit wire to a scope,
+   *        as every variable needs one. Names are made valid identifiers.
+   */
+  int addScope( const QString &name, int parent = -1 );
+  uint32_t addVariable( int scope, const QString &name );
+
+  /**
+   * @brief open writes the declarations to fileName and starts the writer
+   *        thread, returning false if the file cannot be created.
+   */
+  bool open( const QString &fileName );
+  bool isOpen( ) const;
+
+  /**
+   * @brief change reports the value of a variable at time, 1, 0 or -1 for
+   *        an unknown value. Times must not decrease.
+   */
+  void change( uint64_t time, uint32_t variable, signed char value );
+
+  /**
+   * @brief close writes the pending changes and closes the file.
+   */
+  void close( );
+
+private:
+  struct Scope {
+    QString name;
+    int parent;
+  };
+
+  struct Change {
+    uint64_t time;
+    uint32_t variable;
+    signed char value;
+  };
+
+  std::vector< Scope > scopes;
+  std::vector< QString > names;
+  std::vector< int > variableScopes;
+  std::vector< QByteArray > identifiers;
+  /* The last value queued per variable, 2 before the first one. Only used by the reporting thread. */
+  std::vector< signed char > values;
+  uint64_t lastTime;
+  SpscQueue< Change > changes;
+  std::atomic< bool > closing;
+  std::thread writer;
+  QFile file;
+
+  void writeScope( int scope, QByteArray &out ) const;
+  void write( );
+  static QByteArray identifier( uint32_t variable );
+  static QString sanitize( const QString &name );
+};
+
+#endif // VCDWRITER_H
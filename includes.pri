@@ -1,6 +1,6 @@
 QT       += core gui printsupport charts multimedia widgets
 
-VERSION = 2.6.0
+VERSION = 2.7.0
 
 DEFINES += APP_VERSION=\\\"$$VERSION\\\"
 
@@ -40,6 +40,20 @@ QMAKE_CXXFLAGS_DEBUG += -DDEBUG=1 -Wall
 
 include($$PWD/app/element/element.pri)
 include($$PWD/app/logicelement/logicelement.pri)
+include($$PWD/app/simulation/simulation.pri)
+
+# The simulation core is built as a static library of its own, see core/core.pro.
+INCLUDEPATH += $$PWD/core
+
+win32:CONFIG(release, debug|release): CORE_DIR = $$OUT_PWD/../core/release
+else:win32:CONFIG(debug, debug|release): CORE_DIR = $$OUT_PWD/../core/debug
+else: CORE_DIR = $$OUT_PWD/../core
+
+LIBS += -L$$CORE_DIR -lwpanda-core
+
+win32-g++: PRE_TARGETDEPS += $$CORE_DIR/libwpanda-core.a
+else:win32: PRE_TARGETDEPS += $$CORE_DIR/wpanda-core.lib
+else: PRE_TARGETDEPS += $$CORE_DIR/libwpanda-core.a
 
 SOURCES += \
     $$PWD/app/arduino/codegenerator.cpp \
@@ -55,6 +69,8 @@ SOURCES += \
     $$PWD/app/graphicsviewzoom.cpp \
     $$PWD/app/label.cpp \
     $$PWD/app/listitemwidget.cpp \
+    $$PWD/app/logicanalyzer.cpp \
+    $$PWD/app/truthtabledialog.cpp \
     $$PWD/app/mainwindow.cpp \
     $$PWD/app/nodes/qneconnection.cpp \
     $$PWD/app/nodes/qneport.cpp \
@@ -62,6 +78,7 @@ SOURCES += \
     $$PWD/app/scene.cpp \
     $$PWD/app/serializationfunctions.cpp \
     $$PWD/app/simulationcontroller.cpp \
+    $$PWD/app/simulationworker.cpp \
     $$PWD/app/itemwithid.cpp \
     $$PWD/app/simplewaveform.cpp \
     $$PWD/app/thememanager.cpp \
@@ -72,6 +89,7 @@ SOURCES += \
     $$PWD/app/boxprototypeimpl.cpp \
     $$PWD/app/elementmapping.cpp \
     $$PWD/app/boxmapping.cpp \
+    $$PWD/app/boxtemplate.cpp \
     $$PWD/app/common.cpp
 
 HEADERS  +=  \
@@ -89,6 +107,8 @@ HEADERS  +=  \
     $$PWD/app/graphicsview.h \
     $$PWD/app/label.h \
     $$PWD/app/listitemwidget.h \
+    $$PWD/app/logicanalyzer.h \
+    $$PWD/app/truthtabledialog.h \
     $$PWD/app/mainwindow.h \
     $$PWD/app/nodes/qneconnection.h \
     $$PWD/app/nodes/qneport.h \
@@ -96,6 +116,7 @@ HEADERS  +=  \
     $$PWD/app/scene.h \
     $$PWD/app/serializationfunctions.h \
     $$PWD/app/simulationcontroller.h \
+    $$PWD/app/simulationworker.h \
     $$PWD/app/itemwithid.h \
     $$PWD/app/simplewaveform.h \
     $$PWD/app/thememanager.h \
@@ -106,6 +127,8 @@ HEADERS  +=  \
     $$PWD/app/boxprototypeimpl.h \
     $$PWD/app/elementmapping.h \
     $$PWD/app/boxmapping.h \
+    $$PWD/app/boxtemplate.h \
+    $$PWD/app/circuitdelta.h \
 
 INCLUDEPATH += \
     $$PWD/app \
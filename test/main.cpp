@@ -1,7 +1,11 @@
+#include "testcircuitengine.h"
 #include "testcommands.h"
+#include "testcompiledsimulation.h"
 #include "testelements.h"
 #include "testfiles.h"
+#include "testgatekernels.h"
 #include "testicons.h"
+#include "testlevelizer.h"
 #include "testlogicelements.h"
 #include "testsimulationcontroller.h"
 #include "testwaveform.h"
@@ -21,6 +25,10 @@ int main( int argc, char **argv ) {
   TestCommands testCommands;
   TestWaveForm testWf;
   TestIcons testIcons;
+  TestCompiledSimulation testCompiled;
+  TestGateKernels testGateKernels;
+  TestLevelizer testLevelizer;
+  TestCircuitEngine testCircuitEngine;
   int status = 0;
   status |= QTest::qExec( &testElements, argc, argv );
   status |= QTest::qExec( &testLogicElements, argc, argv );
@@ -29,6 +37,10 @@ int main( int argc, char **argv ) {
   status |= QTest::qExec( &testCommands, argc, argv );
   status |= QTest::qExec( &testWf, argc, argv );
   status |= QTest::qExec( &testIcons, argc, argv );
+  status |= QTest::qExec( &testCompiled, argc, argv );
+  status |= QTest::qExec( &testGateKernels, argc, argv );
+  status |= QTest::qExec( &testLevelizer, argc, argv );
+  status |= QTest::qExec( &testCircuitEngine, argc, argv );
 
   std::cout << ( status ? "Some test failed!" : "All tests have passed!" ) << std::endl;
 
@@ -12,7 +12,11 @@ SOURCES += \
     testcommands.cpp \
     testwaveform.cpp \
     testicons.cpp \
-    testlogicelements.cpp
+    testlogicelements.cpp \
+    testcompiledsimulation.cpp \
+    testgatekernels.cpp \
+    testlevelizer.cpp \
+    testcircuitengine.cpp
 
 HEADERS += \
     testelements.h \
@@ -21,6 +25,10 @@ HEADERS += \
     testcommands.h \
     testwaveform.h \
     testicons.h \
-    testlogicelements.h
+    testlogicelements.h \
+    testcompiledsimulation.h \
+    testgatekernels.h \
+    testlevelizer.h \
+    testcircuitengine.h
 
 DEFINES += CURRENTDIR=\\\"$$_PRO_FILE_PWD_\\\"
@@ -0,0 +1,530 @@
+#include "testcircuitengine.h"
+
+#include "batchsimulation.h"
+#include "circuitbdd.h"
+#include "circuitengine.h"
+#include "circuitloader.h"
+#include "elementmapping.h"
+#include "equivalencechecker.h"
+#include "globalproperties.h"
+#include "input.h"
+#include "qneconnection.h"
+#include "serializationfunctions.h"
+#include "signalhistory.h"
+#include "truthtablewriter.h"
+#include "vcdwriter.h"
+
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <stdexcept>
+
+/* Writes the scene as Editor::save( ) does, but with the elements in the given order, so that the elements of the
+ * loaded model match them one by one. */
+static std::shared_ptr< const CircuitModel > reload( Scene *scene, const QVector< GraphicElement* > &elements ) {
+  QList< QGraphicsItem* > items;
+  for( GraphicElement *elm : elements ) {
+    items.append( elm );
+  }
+  for( QNEConnection *conn : scene->getConnections( ) ) {
+    items.append( conn );
+  }
+  QByteArray data;
+  QDataStream out( &data, QIODevice::WriteOnly );
+  out << QString( "WiredPanda %1" ).arg( GlobalProperties::version );
+  out << scene->sceneRect( );
+  SerializationFunctions::serialize( items, out );
+  QDataStream in( &data, QIODevice::ReadOnly );
+  CircuitLoader loader;
+  return( loader.load( in, GlobalProperties::currentFile ) );
+}
+
+static CircuitElement makeElement( ElementType type, uint32_t inputSize, uint32_t outputSize ) {
+  return( CircuitElement { type, QString( ), QPointF( ), -1, inputSize, outputSize, 0.0f, false, QString( ), -1 } );
+}
+
+void TestCircuitEngine::init( ) {
+  editor = new Editor( this );
+}
+
+void TestCircuitEngine::cleanup( ) {
+  delete editor;
+}
+
+bool TestCircuitEngine::loadExample( const QFileInfo &fileInfo ) {
+  QFile pandaFile( fileInfo.absoluteFilePath( ) );
+  GlobalProperties::currentFile = fileInfo.absoluteFilePath( );
+  if( !pandaFile.open( QFile::ReadOnly ) ) {
+    return( false );
+  }
+  QDataStream ds( &pandaFile );
+  try {
+    editor->load( ds );
+  }
+  catch( std::runtime_error & ) {
+    return( false );
+  }
+  editor->getSimulationController( )->stop( );
+  return( true );
+}
+
+void TestCircuitEngine::testLoader( ) {
+  QDir examplesDir( QString( "%1/../examples/" ).arg( CURRENTDIR ) );
+  QFileInfoList files = examplesDir.entryInfoList( QStringList( ) << "*.panda" );
+  QVERIFY( files.size( ) > 0 );
+  for( const QFileInfo &f : files ) {
+    QVERIFY2( loadExample( f ), f.fileName( ).toUtf8( ) );
+    CircuitLoader loader;
+    std::shared_ptr< const CircuitModel > model;
+    try {
+      model = loader.loadFile( f.absoluteFilePath( ) );
+    }
+    catch( std::runtime_error &e ) {
+      QFAIL( e.what( ) );
+    }
+    QCOMPARE( model->elements.size( ), static_cast< size_t >( editor->getScene( )->getElements( ).size( ) ) );
+    QCOMPARE( model->connections.size( ), static_cast< size_t >( editor->getScene( )->getConnections( ).size( ) ) );
+  }
+}
+
+void TestCircuitEngine::testExamples( ) {
+  QDir examplesDir( QString( "%1/../examples/" ).arg( CURRENTDIR ) );
+  QFileInfoList files = examplesDir.entryInfoList( QStringList( ) << "*.panda" );
+  QVERIFY( files.size( ) > 0 );
+  int compared = 0;
+  for( const QFileInfo &f : files ) {
+    QVERIFY2( loadExample( f ), f.fileName( ).toUtf8( ) );
+    QVector< GraphicElement* > elements = editor->getScene( )->getElements( );
+    std::shared_ptr< const CircuitModel > model = reload( editor->getScene( ), elements );
+    QCOMPARE( model->elements.size( ), static_cast< size_t >( elements.size( ) ) );
+    bool hasClock = false;
+    for( size_t elm = 0; elm < model->elements.size( ); ++elm ) {
+      GraphicElement *graphic = elements[ static_cast< int >( elm ) ];
+      QVERIFY( model->elements[ elm ].type == graphic->elementType( ) );
+      QCOMPARE( model->elements[ elm ].inputSize, static_cast< uint32_t >( graphic->inputSize( ) ) );
+      QCOMPARE( model->elements[ elm ].outputSize, static_cast< uint32_t >( graphic->outputSize( ) ) );
+      hasClock |= graphic->elementType( ) == ElementType::CLOCK;
+    }
+    ElementMapping mapping( elements, GlobalProperties::currentFile );
+    /* The interpreted clocks follow ticks rather than simulated time. */
+    if( hasClock || !mapping.canInitialize( ) ) {
+      continue;
+    }
+    mapping.initialize( );
+    mapping.sort( );
+    CircuitEngine engine( *model );
+    QVector< Input* > inputs;
+    QVector< GraphicElement* > outputs;
+    for( GraphicElement *elm : elements ) {
+      if( Input *in = dynamic_cast< Input* >( elm ) ) {
+        inputs.append( in );
+      }
+      else if( elm->elementGroup( ) == ElementGroup::OUTPUT ) {
+        outputs.append( elm );
+      }
+    }
+    QCOMPARE( engine.inputs( ).size( ), static_cast< size_t >( inputs.size( ) ) );
+    QCOMPARE( engine.outputs( ).size( ), static_cast< size_t >( outputs.size( ) ) );
+    uint seed = 42;
+    for( int tick = 0; tick < 300; ++tick ) {
+      for( int input = 0; input < inputs.size( ); ++input ) {
+        if( tick % 7 == 0 ) {
+          seed = seed * 1103515245 + 12345;
+          inputs[ input ]->setOn( ( seed >> 16 ) & 1 );
+          engine.setInput( input, ( seed >> 16 ) & 1 );
+        }
+      }
+      mapping.update( );
+      engine.step( );
+      for( int output = 0; output < outputs.size( ); ++output ) {
+        LogicElement *logElm = mapping.getLogicElement( outputs[ output ] );
+        const bool valid = logElm->isValid( ) && !mapping.isOscillating( logElm );
+        QVERIFY2( engine.isValid( output ) == valid, f.fileName( ).toUtf8( ) );
+        for( size_t port = 0; valid && ( port < logElm->inputSize( ) ); ++port ) {
+          QVERIFY2( engine.outputValue( output, static_cast< int >( port ) ) == logElm->getInputValue( port ),
+                    f.fileName( ).toUtf8( ) );
+        }
+      }
+    }
+    ++compared;
+  }
+  QVERIFY( compared > 0 );
+}
+
+void TestCircuitEngine::testClock( ) {
+  CircuitModel model;
+  model.elements.push_back( makeElement( ElementType::CLOCK, 0, 1 ) );
+  model.elements.back( ).frequency = 1000.0f;
+  model.elements.push_back( makeElement( ElementType::NOT, 1, 1 ) );
+  model.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  model.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( 1, 0 ) } );
+  model.connections.push_back( { CircuitPort( 1, 0 ), CircuitPort( 2, 0 ) } );
+  CircuitEngine engine( model );
+  QCOMPARE( engine.clocks( ).size( ), size_t( 1 ) );
+  QCOMPARE( engine.outputs( ).size( ), size_t( 1 ) );
+  /* The clock starts high, and toggles every millisecond. */
+  engine.advanceTo( 0 );
+  QVERIFY( engine.isValid( 0 ) );
+  QCOMPARE( engine.outputValue( 0 ), false );
+  engine.advanceTo( 1000000 );
+  QCOMPARE( engine.outputValue( 0 ), true );
+  engine.advanceTo( 1500000 );
+  QCOMPARE( engine.outputValue( 0 ), true );
+  QCOMPARE( engine.time( ), uint64_t( 1500000 ) );
+  engine.advanceTo( 2000000 );
+  QCOMPARE( engine.outputValue( 0 ), false );
+  engine.reset( );
+  QCOMPARE( engine.time( ), uint64_t( 0 ) );
+}
+
+void TestCircuitEngine::testBatch( ) {
+  CircuitModel model;
+  model.elements.push_back( makeElement( ElementType::SWITCH, 0, 1 ) );
+  model.elements.back( ).label = "A";
+  model.elements.push_back( makeElement( ElementType::NOT, 1, 1 ) );
+  model.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  model.elements.back( ).label = "Y";
+  model.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( 1, 0 ) } );
+  model.connections.push_back( { CircuitPort( 1, 0 ), CircuitPort( 2, 0 ) } );
+  CircuitEngine engine( model );
+  BatchSimulation batch( engine );
+  QString script( "# A goes high at the third cycle\n0 A=0\n20ms A=1\n" );
+  QTextStream in( &script );
+  batch.readStimulus( in );
+  QString result;
+  QTextStream out( &result );
+  QVERIFY( batch.run( 4, out ) );
+  out.flush( );
+  QCOMPARE( result, QString( "cycle time A Y\n0 0 0 1\n1 10000000 0 1\n2 20000000 1 0\n3 30000000 1 0\n" ) );
+
+  engine.reset( );
+  batch.setUntil( "Y", false );
+  QString stopped;
+  QTextStream stoppedOut( &stopped );
+  QVERIFY( batch.run( 10, stoppedOut ) );
+  stoppedOut.flush( );
+  QCOMPARE( stopped.count( '\n' ), 4 );
+
+  QString invalid( "0 B=1\n" );
+  QTextStream badIn( &invalid );
+  QVERIFY_EXCEPTION_THROWN( batch.readStimulus( badIn ), std::runtime_error );
+}
+
+void TestCircuitEngine::testVcd( ) {
+  QTemporaryDir dir;
+  QVERIFY( dir.isValid( ) );
+  const QString fileName = dir.filePath( "clock.vcd" );
+  CircuitModel model;
+  model.elements.push_back( makeElement( ElementType::CLOCK, 0, 1 ) );
+  model.elements.back( ).label = "clk";
+  model.elements.back( ).frequency = 100.0f;
+  model.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  model.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( 1, 0 ) } );
+  CircuitEngine engine( model );
+  BatchSimulation batch( engine );
+  {
+    /* A queue of a few changes makes the simulation wait for the writer thread. */
+    VcdWriter vcd( 4 );
+    batch.setRecorder( &vcd );
+    QVERIFY( vcd.open( fileName ) );
+    QString result;
+    QTextStream out( &result );
+    QVERIFY( batch.run( 1000, out ) );
+  }
+  QFile file( fileName );
+  QVERIFY( file.open( QFile::ReadOnly | QFile::Text ) );
+  const QString dump = QString::fromUtf8( file.readAll( ) );
+  QVERIFY( dump.contains( "$timescale 1ns $end" ) );
+  QVERIFY( dump.contains( "$scope module circuit $end" ) );
+  QVERIFY( dump.contains( " clk $end" ) );
+  QVERIFY( dump.contains( " LED_1 $end" ) );
+  /* The clock toggles every 10 ms, over the 10 s of the run. */
+  QVERIFY( dump.contains( "\n#0\n1!\n1\"\n" ) );
+  QVERIFY( dump.contains( "\n#10000000\n0!\n0\"\n" ) );
+  QCOMPARE( dump.count( '#' ), 1000 );
+}
+
+void TestCircuitEngine::testSignalHistory( ) {
+  SignalHistory history;
+  history.reset( 2 );
+  QVERIFY( history.valueAt( 0, 0 ) == SignalHistory::UNKNOWN );
+  history.append( 0, 0, 0 );
+  history.append( 0, 100, 0 );
+  history.append( 0, 100, 1 );
+  history.append( 0, 250, 0 );
+  history.append( 1, 0, -1 );
+  history.append( 1, 300, 1 );
+  QCOMPARE( history.end( ), static_cast< uint64_t >( 300 ) );
+  QVERIFY( history.valueAt( 0, 99 ) == 0 );
+  QVERIFY( history.valueAt( 0, 100 ) == 1 );
+  QVERIFY( history.valueAt( 0, 1000 ) == 0 );
+  QVERIFY( history.valueAt( 1, 299 ) == -1 );
+  /* The rings only take the room of the runs appended, not their share of the default cap. */
+  QVERIFY( history.memoryUsage( ) < 1024 );
+
+  /* Columns of 100 ns: the pulse fills the second one, and ends within the third. */
+  std::vector< signed char > columns( 5 );
+  history.sample( 0, 0, 100, columns );
+  QVERIFY( columns[ 0 ] == 0 );
+  QVERIFY( columns[ 1 ] == 1 );
+  QVERIFY( columns[ 2 ] == SignalHistory::CHANGING );
+  QVERIFY( columns[ 3 ] == 0 );
+  QVERIFY( columns[ 4 ] == SignalHistory::UNKNOWN );
+
+  /* The smallest ring keeps the latest changes only. */
+  history.reset( 1, 0 );
+  for( uint64_t time = 0; time < 1000; ++time ) {
+    history.append( 0, time, time % 2 );
+  }
+  QVERIFY( history.begin( 0 ) > 0 );
+  QVERIFY( history.valueAt( 0, 998 ) == 0 );
+  QVERIFY( history.valueAt( 0, 999 ) == 1 );
+  QVERIFY( history.valueAt( 0, 0 ) == SignalHistory::UNKNOWN );
+  QVERIFY( history.memoryUsage( ) < 1024 );
+}
+
+void TestCircuitEngine::testTruthTable( ) {
+  /* Enough inputs for several chunks over a few threads: LED 0 = in0 AND in1, LED 1 = in16 XOR in17. */
+  const uint32_t inputCount = 18;
+  CircuitModel model;
+  for( uint32_t in = 0; in < inputCount; ++in ) {
+    model.elements.push_back( makeElement( ElementType::SWITCH, 0, 1 ) );
+  }
+  model.elements.push_back( makeElement( ElementType::AND, 2, 1 ) );
+  model.elements.push_back( makeElement( ElementType::XOR, 2, 1 ) );
+  model.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  model.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  model.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( inputCount, 0 ) } );
+  model.connections.push_back( { CircuitPort( 1, 0 ), CircuitPort( inputCount, 1 ) } );
+  model.connections.push_back( { CircuitPort( 16, 0 ), CircuitPort( inputCount + 1, 0 ) } );
+  model.connections.push_back( { CircuitPort( 17, 0 ), CircuitPort( inputCount + 1, 1 ) } );
+  model.connections.push_back( { CircuitPort( inputCount, 0 ), CircuitPort( inputCount + 2, 0 ) } );
+  model.connections.push_back( { CircuitPort( inputCount + 1, 0 ), CircuitPort( inputCount + 3, 0 ) } );
+  CircuitEngine engine( model );
+  TruthTableWriter writer( engine.getNetlist( ) );
+  for( uint32_t in = 0; in < inputCount; ++in ) {
+    writer.addInput( QString( "in%1" ).arg( in ), engine.inputs( )[ in ].signals[ 0 ] );
+  }
+  writer.addOutput( "and", engine.outputs( )[ 0 ].signals[ 0 ] );
+  writer.addOutput( "xor", engine.outputs( )[ 1 ].signals[ 0 ] );
+  writer.setThreadCount( 3 );
+  QCOMPARE( writer.rowCount( ), uint64_t( 1 ) << inputCount );
+
+  QBuffer text;
+  QVERIFY( text.open( QIODevice::WriteOnly ) );
+  QVERIFY( writer.write( text ) );
+  const QList< QByteArray > lines = text.data( ).split( '\n' );
+  QCOMPARE( lines[ 2 ], QByteArray( "# outputs: and xor" ) );
+  /* Three header lines, then one line per row, and the empty string after the last newline. */
+  QCOMPARE( static_cast< uint64_t >( lines.size( ) ), writer.rowCount( ) + 4 );
+  bool matches = true;
+  for( uint64_t row = 0; row < writer.rowCount( ); ++row ) {
+    const char expected[] = { ( row & 3 ) == 3 ? '1' : '0', ( ( row >> 16 ) ^ ( row >> 17 ) ) & 1 ? '1' : '0' };
+    matches = matches && ( lines[ static_cast< int >( row + 3 ) ] == QByteArray( expected, 2 ) );
+  }
+  QVERIFY( matches );
+
+  QBuffer binary;
+  QVERIFY( binary.open( QIODevice::WriteOnly ) );
+  writer.setFormat( TruthTableWriter::Format::BINARY );
+  QVERIFY( writer.write( binary ) );
+  QDataStream header( binary.data( ) );
+  quint32 magic;
+  quint16 version;
+  QStringList inputs, outputs;
+  header >> magic >> version >> inputs >> outputs;
+  QCOMPARE( magic, TruthTableWriter::MAGIC );
+  QCOMPARE( inputs.size( ), static_cast< int >( inputCount ) );
+  QCOMPARE( outputs, QStringList( ) << "and" << "xor" );
+  const QByteArray rows = binary.data( ).mid( static_cast< int >( header.device( )->pos( ) ) );
+  QCOMPARE( static_cast< uint64_t >( rows.size( ) ), writer.rowCount( ) );
+  QCOMPARE( static_cast< int >( rows[ 3 ] ), 1 );
+  QCOMPARE( static_cast< int >( rows[ 1 << 16 ] ), 2 );
+  QCOMPARE( static_cast< int >( rows[ ( 1 << 16 ) | 3 ] ), 3 );
+  QCOMPARE( static_cast< int >( rows[ 3 << 16 ] ), 0 );
+
+  /* Cancelling stops after the first round of chunks, which only covers half the table on a single thread. */
+  QBuffer cancelled;
+  QVERIFY( cancelled.open( QIODevice::WriteOnly ) );
+  writer.setThreadCount( 1 );
+  writer.setProgress( [ ]( uint64_t, uint64_t ) {
+    return( false );
+  } );
+  QVERIFY( !writer.write( cancelled ) );
+  QVERIFY( static_cast< uint64_t >( cancelled.size( ) ) < writer.rowCount( ) );
+}
+
+void TestCircuitEngine::testBdd( ) {
+  /* LED 0 = in0·in4 + in1·in5 + in2·in6 + in3·in7, whose BDD is exponential in the file order of the inputs and
+   * linear once the pairs are interleaved. LED 1 = NOT in0. */
+  CircuitModel model;
+  for( uint32_t in = 0; in < 8; ++in ) {
+    model.elements.push_back( makeElement( ElementType::SWITCH, 0, 1 ) );
+  }
+  for( uint32_t pair = 0; pair < 4; ++pair ) {
+    model.elements.push_back( makeElement( ElementType::AND, 2, 1 ) );
+    model.connections.push_back( { CircuitPort( pair, 0 ), CircuitPort( 8 + pair, 0 ) } );
+    model.connections.push_back( { CircuitPort( pair + 4, 0 ), CircuitPort( 8 + pair, 1 ) } );
+  }
+  model.elements.push_back( makeElement( ElementType::OR, 4, 1 ) );
+  model.elements.push_back( makeElement( ElementType::NOT, 1, 1 ) );
+  model.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  model.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  for( uint32_t pair = 0; pair < 4; ++pair ) {
+    model.connections.push_back( { CircuitPort( 8 + pair, 0 ), CircuitPort( 12, pair ) } );
+  }
+  model.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( 13, 0 ) } );
+  model.connections.push_back( { CircuitPort( 12, 0 ), CircuitPort( 14, 0 ) } );
+  model.connections.push_back( { CircuitPort( 13, 0 ), CircuitPort( 15, 0 ) } );
+  CircuitEngine engine( model );
+  CircuitBdd bdd( engine );
+  QCOMPARE( bdd.inputCount( ), size_t( 8 ) );
+  QCOMPARE( bdd.outputCount( ), size_t( 2 ) );
+  QCOMPARE( bdd.outputNames( ), QStringList( ) << "out0" << "out1" );
+  bool matches = true;
+  for( uint64_t row = 0; row < 256; ++row ) {
+    matches = matches && ( bdd.value( 0, row ) == ( ( row & ( row >> 4 ) & 15 ) != 0 ) );
+    matches = matches && ( bdd.value( 1, row ) == !( row & 1 ) );
+  }
+  QVERIFY( matches );
+  QCOMPARE( bdd.sumOfProducts( 1 ), QString( "in0'" ) );
+  BddManager &manager = bdd.manager( );
+  QCOMPARE( manager.isop( bdd.output( 0 ) ).size( ), size_t( 4 ) );
+  QCOMPARE( manager.satCount( bdd.output( 0 ) ), 256.0 - 81.0 );
+  std::vector< bool > values;
+  QVERIFY( manager.minSat( bdd.output( 0 ), values ) );
+  QCOMPARE( static_cast< int >( std::count( values.begin( ), values.end( ), true ) ), 2 );
+
+  const size_t before = manager.size( bdd.output( 0 ) );
+  manager.reorder( );
+  QVERIFY( manager.size( bdd.output( 0 ) ) < before );
+  QCOMPARE( bdd.value( 0, 0x11 ), true );
+  QCOMPARE( bdd.value( 0, 0x12 ), false );
+
+  CircuitEngine open( openInputModel( ) );
+  CircuitBdd openBdd( open );
+  QCOMPARE( openBdd.inputCount( ), size_t( 1 ) );
+  QCOMPARE( openBdd.value( 0, 0 ), false );
+  QCOMPARE( openBdd.value( 0, 1 ), true );
+  QCOMPARE( openBdd.sumOfProducts( 1 ), QString( "0" ) );
+}
+
+/* LED 0 = a through a box whose second input is left open, reading the value its switch was saved with, and LED 1
+ * = an AND gate with an open input, which is never evaluated. Both read constants that the lowering adds after
+ * them. */
+static CircuitModel openInputModel( ) {
+  CircuitModel box;
+  box.elements.push_back( makeElement( ElementType::SWITCH, 0, 1 ) );
+  box.elements.push_back( makeElement( ElementType::SWITCH, 0, 1 ) );
+  box.elements.back( ).pos = QPointF( 0, 1 );
+  box.elements.back( ).on = true;
+  box.elements.push_back( makeElement( ElementType::AND, 2, 1 ) );
+  box.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  box.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( 2, 0 ) } );
+  box.connections.push_back( { CircuitPort( 1, 0 ), CircuitPort( 2, 1 ) } );
+  box.connections.push_back( { CircuitPort( 2, 0 ), CircuitPort( 3, 0 ) } );
+  CircuitModel model;
+  model.boxes.push_back( std::make_shared< CircuitModel >( box ) );
+  model.elements.push_back( makeElement( ElementType::SWITCH, 0, 1 ) );
+  model.elements.back( ).label = "a";
+  model.elements.push_back( makeElement( ElementType::BOX, 2, 1 ) );
+  model.elements.back( ).file = "box.panda";
+  model.elements.back( ).box = 0;
+  model.elements.push_back( makeElement( ElementType::AND, 2, 1 ) );
+  model.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  model.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  model.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( 1, 0 ) } );
+  model.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( 2, 0 ) } );
+  model.connections.push_back( { CircuitPort( 1, 0 ), CircuitPort( 3, 0 ) } );
+  model.connections.push_back( { CircuitPort( 2, 0 ), CircuitPort( 4, 0 ) } );
+  return( model );
+}
+
+/* s = a XOR b, built from a single gate, with the switches in the given order. */
+static CircuitModel xorModel( bool swapped ) {
+  CircuitModel model;
+  model.elements.push_back( makeElement( ElementType::SWITCH, 0, 1 ) );
+  model.elements.back( ).label = swapped ? "b" : "a";
+  model.elements.push_back( makeElement( ElementType::SWITCH, 0, 1 ) );
+  model.elements.back( ).label = swapped ? "a" : "b";
+  model.elements.push_back( makeElement( ElementType::XOR, 2, 1 ) );
+  model.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  model.elements.back( ).label = "s";
+  model.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( 2, 0 ) } );
+  model.connections.push_back( { CircuitPort( 1, 0 ), CircuitPort( 2, 1 ) } );
+  model.connections.push_back( { CircuitPort( 2, 0 ), CircuitPort( 3, 0 ) } );
+  return( model );
+}
+
+/* s = ( a OR b ) AND ( a NAND b ), or s = a AND b when wrong. */
+static CircuitModel orNandModel( bool wrong ) {
+  CircuitModel model;
+  model.elements.push_back( makeElement( ElementType::SWITCH, 0, 1 ) );
+  model.elements.back( ).label = "a";
+  model.elements.push_back( makeElement( ElementType::SWITCH, 0, 1 ) );
+  model.elements.back( ).label = "b";
+  model.elements.push_back( makeElement( wrong ? ElementType::AND : ElementType::OR, 2, 1 ) );
+  model.elements.push_back( makeElement( wrong ? ElementType::AND : ElementType::NAND, 2, 1 ) );
+  model.elements.push_back( makeElement( ElementType::AND, 2, 1 ) );
+  model.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  model.elements.back( ).label = "s";
+  for( uint32_t gate = 2; gate < 4; ++gate ) {
+    model.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( gate, 0 ) } );
+    model.connections.push_back( { CircuitPort( 1, 0 ), CircuitPort( gate, 1 ) } );
+    model.connections.push_back( { CircuitPort( gate, 0 ), CircuitPort( 4, gate - 2 ) } );
+  }
+  model.connections.push_back( { CircuitPort( 4, 0 ), CircuitPort( 5, 0 ) } );
+  return( model );
+}
+
+void TestCircuitEngine::testEquivalence( ) {
+  CircuitEngine reference( xorModel( true ) );
+  CircuitEngine same( orNandModel( false ) );
+  EquivalenceChecker equivalent( reference, same );
+  QCOMPARE( equivalent.inputNames( ), QStringList( ) << "b" << "a" );
+  QCOMPARE( equivalent.check( ), EquivalenceChecker::Verdict::EQUIVALENT );
+  QVERIFY( equivalent.provedByBdd( ) );
+  QVERIFY( equivalent.counterexample( ).empty( ) );
+
+  CircuitEngine wrong( orNandModel( true ) );
+  EquivalenceChecker different( reference, wrong );
+  QCOMPARE( different.check( ), EquivalenceChecker::Verdict::DIFFERENT );
+  const std::vector< bool > &counterexample = different.counterexample( );
+  /* a XOR b and a AND b differ with both inputs set, but also with only one. */
+  QCOMPARE( std::count( counterexample.begin( ), counterexample.end( ), true ), std::ptrdiff_t( 1 ) );
+  QCOMPARE( different.differingOutputs( ), QStringList( ) << "s" );
+  different.setRandomRounds( 0 );
+  QCOMPARE( different.check( ), EquivalenceChecker::Verdict::DIFFERENT );
+  QVERIFY( different.provedByBdd( ) );
+  QCOMPARE( std::count( counterexample.begin( ), counterexample.end( ), true ), std::ptrdiff_t( 1 ) );
+
+  /* The same outputs as openInputModel( ), without a box or open inputs: a, and a AND NOT a. */
+  CircuitModel plain;
+  plain.elements.push_back( makeElement( ElementType::SWITCH, 0, 1 ) );
+  plain.elements.back( ).label = "a";
+  plain.elements.push_back( makeElement( ElementType::NOT, 1, 1 ) );
+  plain.elements.push_back( makeElement( ElementType::AND, 2, 1 ) );
+  plain.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  plain.elements.push_back( makeElement( ElementType::LED, 1, 0 ) );
+  plain.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( 1, 0 ) } );
+  plain.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( 2, 0 ) } );
+  plain.connections.push_back( { CircuitPort( 1, 0 ), CircuitPort( 2, 1 ) } );
+  plain.connections.push_back( { CircuitPort( 0, 0 ), CircuitPort( 3, 0 ) } );
+  plain.connections.push_back( { CircuitPort( 2, 0 ), CircuitPort( 4, 0 ) } );
+  CircuitEngine open( openInputModel( ) );
+  CircuitEngine closed( plain );
+  EquivalenceChecker openInputs( open, closed );
+  QCOMPARE( openInputs.check( ), EquivalenceChecker::Verdict::EQUIVALENT );
+  QVERIFY( openInputs.provedByBdd( ) );
+  plain.connections.back( ).source = CircuitPort( 1, 0 );
+  CircuitEngine inverted( plain );
+  EquivalenceChecker differentInputs( open, inverted );
+  differentInputs.setRandomRounds( 0 );
+  QCOMPARE( differentInputs.check( ), EquivalenceChecker::Verdict::DIFFERENT );
+  QCOMPARE( differentInputs.differingOutputs( ), QStringList( ) << "out1" );
+
+  CircuitModel renamed = xorModel( false );
+  renamed.elements.back( ).label = "t";
+  CircuitEngine other( renamed );
+  QVERIFY_EXCEPTION_THROWN( EquivalenceChecker checker( reference, other ), std::runtime_error );
+}
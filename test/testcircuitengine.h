@@ -0,0 +1,31 @@
+#ifndef TESTCIRCUITENGINE_H
+#define TESTCIRCUITENGINE_H
+
+#include "editor.h"
+
+#include <QTest>
+
+class TestCircuitEngine : public QObject {
+  Q_OBJECT
+  Editor *editor;
+
+  bool loadExample( const QFileInfo &fileInfo );
+
+private slots:
+
+  /* functions executed by QtTest before and after each test */
+  void init( );
+  void cleanup( );
+
+  void testLoader( );
+  void testExamples( );
+  void testClock( );
+  void testBatch( );
+  void testVcd( );
+  void testSignalHistory( );
+  void testTruthTable( );
+  void testBdd( );
+  void testEquivalence( );
+};
+
+#endif /* TESTCIRCUITENGINE_H */
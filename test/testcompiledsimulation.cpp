@@ -0,0 +1,570 @@
+#include "testcompiledsimulation.h"
+
+#include "and.h"
+#include "clock.h"
+#include "elementinfo.h"
+#include "elementmapping.h"
+#include "globalproperties.h"
+#include "input.h"
+#include "inputbutton.h"
+#include "logicelement/logicand.h"
+#include "nor.h"
+#include "not.h"
+#include "simulation/compiledsimulation.h"
+#include "simulation/eventdrivensimulator.h"
+#include "simulation/nativecompiler.h"
+#include "simulation/netlistkernel.h"
+#include "simulation/netlistoptimizer.h"
+#include "simulation/netlistsimulator.h"
+#include "simulation/parallelsimulator.h"
+
+#include <QSet>
+#include <stdexcept>
+
+/* Runs the circuit for a fixed number of ticks, toggling its inputs in a repeatable way, and returns the value of
+ * every output port at every tick. Invalid ports are reported as -1. */
+static QVector< int > simulate( const QVector< GraphicElement* > &elements, SimulationBackend backend,
+                                quint64 *evaluations = nullptr, bool flatten = false, bool optimize = true ) {
+  QVector< int > results;
+  ElementMapping mapping( elements, GlobalProperties::currentFile );
+  if( !mapping.canInitialize( ) ) {
+    return( results );
+  }
+  mapping.initialize( );
+  mapping.sort( );
+  if( flatten ) {
+    mapping.flatten( );
+  }
+  CompiledSimulation *compiled = nullptr;
+  if( backend != SimulationBackend::INTERPRETED ) {
+    compiled = new CompiledSimulation( &mapping, backend, CompiledSimulation::DEFAULT_PARALLEL_THRESHOLD,
+                                       DelayModel::INERTIAL, optimize );
+  }
+  Clock::reset = true;
+  uint seed = 42;
+  for( int tick = 0; tick < 300; ++tick ) {
+    for( GraphicElement *elm : elements ) {
+      Input *in = dynamic_cast< Input* >( elm );
+      if( in && ( elm->elementType( ) != ElementType::CLOCK ) && ( tick % 7 == 0 ) ) {
+        seed = seed * 1103515245 + 12345;
+        in->setOn( ( seed >> 16 ) & 1 );
+      }
+    }
+    if( compiled ) {
+      compiled->update( );
+      if( evaluations ) {
+        *evaluations += compiled->lastEvaluationCount( );
+      }
+    }
+    else {
+      mapping.update( );
+    }
+    for( GraphicElement *elm : elements ) {
+      if( elm->elementType( ) == ElementType::BOX ) {
+        for( QNEOutputPort *port : elm->outputs( ) ) {
+          LogicPort logicPort = mapping.getLogicPort( port );
+          bool valid = compiled ? compiled->isValid( logicPort.first ) :
+                       ( logicPort.first->isValid( ) && !mapping.isOscillating( logicPort.first ) );
+          if( !valid ) {
+            results.append( -1 );
+          }
+          else if( compiled ) {
+            results.append( compiled->getOutputValue( logicPort.first, logicPort.second ) );
+          }
+          else {
+            results.append( logicPort.first->getOutputValue( logicPort.second ) );
+          }
+        }
+        continue;
+      }
+      LogicElement *logElm = mapping.getLogicElement( elm );
+      bool valid = compiled ? compiled->isValid( logElm ) :
+                   ( logElm->isValid( ) && !mapping.isOscillating( logElm ) );
+      for( size_t port = 0; port < logElm->outputSize( ); ++port ) {
+        if( !valid ) {
+          results.append( -1 );
+        }
+        else if( compiled ) {
+          results.append( compiled->getOutputValue( logElm, port ) );
+        }
+        else {
+          results.append( logElm->getOutputValue( port ) );
+        }
+      }
+    }
+  }
+  delete compiled;
+  return( results );
+}
+
+/* The example circuits that every backend is compared on. */
+static QFileInfoList exampleFiles( ) {
+  QDir examplesDir( QString( "%1/../examples/" ).arg( CURRENTDIR ) );
+  return( examplesDir.entryInfoList( QStringList( ) << "*.panda" ) );
+}
+
+void TestCompiledSimulation::init( ) {
+  editor = new Editor( this );
+}
+
+void TestCompiledSimulation::cleanup( ) {
+  delete editor;
+}
+
+bool TestCompiledSimulation::loadExample( const QFileInfo &fileInfo ) {
+  QFile pandaFile( fileInfo.absoluteFilePath( ) );
+  GlobalProperties::currentFile = fileInfo.absoluteFilePath( );
+  if( !pandaFile.open( QFile::ReadOnly ) ) {
+    return( false );
+  }
+  QDataStream ds( &pandaFile );
+  try {
+    editor->load( ds );
+  }
+  catch( std::runtime_error & ) {
+    return( false );
+  }
+  editor->getSimulationController( )->stop( );
+  return( true );
+}
+
+void TestCompiledSimulation::testBackends_data( ) {
+  QTest::addColumn< int >( "reference" );
+  QTest::addColumn< bool >( "referenceOptimized" );
+  QTest::addColumn< int >( "backend" );
+  QTest::addColumn< bool >( "flatten" );
+  QTest::addColumn< bool >( "fewerEvaluations" );
+  const int interpreted = static_cast< int >( SimulationBackend::INTERPRETED );
+  const int compiled = static_cast< int >( SimulationBackend::COMPILED );
+  QTest::newRow( "compiled" ) << interpreted << true << compiled << false << false;
+  QTest::newRow( "event-driven" ) << compiled << true << static_cast< int >( SimulationBackend::EVENT_DRIVEN ) << false
+                                  << true;
+  QTest::newRow( "native" ) << compiled << true << static_cast< int >( SimulationBackend::NATIVE ) << false << false;
+  QTest::newRow( "flattened" ) << interpreted << true << interpreted << true << false;
+  QTest::newRow( "flattened compiled" ) << interpreted << true << compiled << true << false;
+  /* The optimized netlist shows the same values as the lowered one. */
+  QTest::newRow( "optimized" ) << compiled << false << compiled << false << false;
+}
+
+void TestCompiledSimulation::testBackends( ) {
+  QFETCH( int, reference );
+  QFETCH( bool, referenceOptimized );
+  QFETCH( int, backend );
+  QFETCH( bool, flatten );
+  QFETCH( bool, fewerEvaluations );
+  if( ( backend == static_cast< int >( SimulationBackend::NATIVE ) ) && NativeCompiler::findCompiler( ).isEmpty( ) ) {
+    QSKIP( "No C++ compiler available." );
+  }
+  const QFileInfoList files = exampleFiles( );
+  QVERIFY( files.size( ) > 0 );
+  quint64 referenceEvaluations = 0;
+  quint64 evaluations = 0;
+  for( const QFileInfo &f : files ) {
+    QVERIFY2( loadExample( f ), f.fileName( ).toUtf8( ) );
+    QVector< GraphicElement* > elements = editor->getScene( )->getElements( );
+    QVector< int > expected = simulate( elements, static_cast< SimulationBackend >( reference ), &referenceEvaluations,
+                                        false, referenceOptimized );
+    QVector< int > actual = simulate( elements, static_cast< SimulationBackend >( backend ), &evaluations, flatten );
+    QVERIFY2( expected == actual, f.fileName( ).toUtf8( ) );
+  }
+  if( fewerEvaluations ) {
+    QVERIFY( evaluations < referenceEvaluations );
+  }
+}
+
+void TestCompiledSimulation::testParallel( ) {
+  const QFileInfoList files = exampleFiles( );
+  QVERIFY( files.size( ) > 0 );
+  for( const QFileInfo &f : files ) {
+    QVERIFY2( loadExample( f ), f.fileName( ).toUtf8( ) );
+    ElementMapping mapping( editor->getScene( )->getElements( ), GlobalProperties::currentFile );
+    if( !mapping.canInitialize( ) ) {
+      continue;
+    }
+    mapping.initialize( );
+    mapping.sort( );
+    CompiledSimulation compiled( &mapping );
+    const Netlist &netlist = compiled.getNetlist( );
+    /* Every level is split over the threads, even in small circuits. */
+    NetlistSimulator serial( netlist );
+    ParallelSimulator parallel( netlist, 4, 1 );
+    uint seed = 42;
+    for( int tick = 0; tick < 300; ++tick ) {
+      for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+        if( netlist.ops[ gate ] == LogicOp::INPUT ) {
+          seed = seed * 1103515245 + 12345;
+          if( ( ( seed >> 16 ) % 8 ) == 0 ) {
+            bool value = ( seed >> 20 ) & 1;
+            serial.setInput( netlist.outputSignal( gate ), value );
+            parallel.setInput( netlist.outputSignal( gate ), value );
+          }
+        }
+      }
+      serial.run( );
+      parallel.run( );
+      QVERIFY2( serial.values( ) == parallel.values( ), f.fileName( ).toUtf8( ) );
+    }
+    QCOMPARE( parallel.lastEvaluationCount( ), serial.lastEvaluationCount( ) );
+  }
+}
+
+void TestCompiledSimulation::testProgram( ) {
+  const QFileInfoList files = exampleFiles( );
+  QVERIFY( files.size( ) > 0 );
+  for( const QFileInfo &f : files ) {
+    QVERIFY2( loadExample( f ), f.fileName( ).toUtf8( ) );
+    ElementMapping mapping( editor->getScene( )->getElements( ), GlobalProperties::currentFile );
+    if( !mapping.canInitialize( ) ) {
+      continue;
+    }
+    mapping.initialize( );
+    mapping.sort( );
+    CompiledSimulation compiled( &mapping );
+    const Netlist &netlist = compiled.getNetlist( );
+    std::vector< GateInstruction > program = compileProgram( netlist );
+    QCOMPARE( static_cast< uint32_t >( program.size( ) ), netlist.gateCount( ) );
+    /* Each level holds the instructions of its own gates, in any order. */
+    uint32_t begin = 0;
+    while( begin < netlist.gateCount( ) ) {
+      uint32_t end = begin + 1;
+      while( ( end < netlist.gateCount( ) ) && ( netlist.levels[ end ] == netlist.levels[ begin ] ) ) {
+        ++end;
+      }
+      QSet< uint32_t > outputs;
+      for( uint32_t gate = begin; gate < end; ++gate ) {
+        outputs.insert( netlist.outputBegin[ gate ] );
+      }
+      for( uint32_t idx = begin; idx < end; ++idx ) {
+        QVERIFY( outputs.remove( program[ idx ].out ) );
+        if( idx > begin ) {
+          QVERIFY( program[ idx - 1 ].code <= program[ idx ].code );
+        }
+      }
+      begin = end;
+    }
+  }
+}
+
+void TestCompiledSimulation::testFeedbackLoops( ) {
+  /* A latch made of two cross-coupled NOR gates, and a NOT gate that feeds itself. */
+  Scene *scene = editor->getScene( );
+  InputButton *set = new InputButton( );
+  InputButton *reset = new InputButton( );
+  Nor *norQ = new Nor( );
+  Nor *norQN = new Nor( );
+  Not *ring = new Not( );
+  for( GraphicElement *elm : QVector< GraphicElement* >( { set, reset, norQ, norQN, ring } ) ) {
+    scene->addItem( elm );
+  }
+  QVector< QPair< QNEOutputPort*, QNEInputPort* > > wires = {
+    qMakePair( reset->output( ), norQ->input( 0 ) ), qMakePair( norQN->output( ), norQ->input( 1 ) ),
+    qMakePair( set->output( ), norQN->input( 0 ) ), qMakePair( norQ->output( ), norQN->input( 1 ) ),
+    qMakePair( ring->output( ), ring->input( ) )
+  };
+  for( const auto &wire : wires ) {
+    QNEConnection *conn = new QNEConnection( );
+    scene->addItem( conn );
+    conn->setStart( wire.first );
+    conn->setEnd( wire.second );
+  }
+  for( SimulationBackend backend : { SimulationBackend::INTERPRETED, SimulationBackend::COMPILED,
+                                     SimulationBackend::EVENT_DRIVEN } ) {
+    ElementMapping mapping( scene->getElements( ) );
+    mapping.initialize( );
+    mapping.sort( );
+    QCOMPARE( mapping.feedbackLoops( ).size( ), 2 );
+    CompiledSimulation *compiled = nullptr;
+    if( backend != SimulationBackend::INTERPRETED ) {
+      compiled = new CompiledSimulation( &mapping, backend );
+    }
+    auto tick = [ & ]( ) {
+      if( compiled ) {
+        compiled->update( );
+      }
+      else {
+        mapping.update( );
+      }
+    };
+    auto value = [ & ]( GraphicElement *elm ) {
+      LogicElement *logElm = mapping.getLogicElement( elm );
+      return( compiled ? compiled->getOutputValue( logElm ) : logElm->getOutputValue( ) );
+    };
+    auto valid = [ & ]( GraphicElement *elm ) {
+      LogicElement *logElm = mapping.getLogicElement( elm );
+      return( compiled ? compiled->isValid( logElm ) : ( logElm->isValid( ) && !mapping.isOscillating( logElm ) ) );
+    };
+    /* The latch settles within a single tick, whatever the order its gates are evaluated in. */
+    set->setOn( true );
+    tick( );
+    QVERIFY( value( norQ ) && !value( norQN ) );
+    set->setOn( false );
+    tick( );
+    QVERIFY( value( norQ ) && !value( norQN ) );
+    reset->setOn( true );
+    tick( );
+    QVERIFY( !value( norQ ) && value( norQN ) );
+    QVERIFY( valid( norQ ) && valid( norQN ) );
+    /* The NOT gate never settles, and is shown as invalid. */
+    QVERIFY( !valid( ring ) );
+    reset->setOn( false );
+    delete compiled;
+  }
+}
+
+void TestCompiledSimulation::testTimed( ) {
+  /* a AND NOT a: when a rises, the AND gate sees both inputs high until the NOT gate catches up. */
+  Scene *scene = editor->getScene( );
+  InputButton *in = new InputButton( );
+  Not *notGate = new Not( );
+  And *andGate = new And( );
+  for( GraphicElement *elm : QVector< GraphicElement* >( { in, notGate, andGate } ) ) {
+    scene->addItem( elm );
+  }
+  QVector< QPair< QNEOutputPort*, QNEInputPort* > > wires = {
+    qMakePair( in->output( ), notGate->input( ) ), qMakePair( in->output( ), andGate->input( 0 ) ),
+    qMakePair( notGate->output( ), andGate->input( 1 ) )
+  };
+  for( const auto &wire : wires ) {
+    QNEConnection *conn = new QNEConnection( );
+    scene->addItem( conn );
+    conn->setStart( wire.first );
+    conn->setEnd( wire.second );
+  }
+  notGate->setDelay( 5 );
+  QCOMPARE( notGate->propagationDelay( ), 5u );
+  QCOMPARE( andGate->propagationDelay( ), ElementInfo::defaultDelay( ElementType::AND ) );
+  QCOMPARE( in->propagationDelay( ), 0u );
+  andGate->setDelay( 10 );
+  for( DelayModel model : { DelayModel::INERTIAL, DelayModel::TRANSPORT } ) {
+    ElementMapping mapping( scene->getElements( ) );
+    mapping.initialize( );
+    mapping.sort( );
+    CompiledSimulation compiled( &mapping, SimulationBackend::TIMED, CompiledSimulation::DEFAULT_PARALLEL_THRESHOLD,
+                                 model );
+    QVERIFY( compiled.isTimed( ) );
+    LogicElement *input = mapping.getLogicElement( in );
+    LogicElement *output = mapping.getLogicElement( andGate );
+    compiled.advanceTo( 1000 );
+    QCOMPARE( compiled.nextEvent( ), uint64_t( UINT64_MAX ) );
+    QVERIFY( !compiled.getOutputValue( output ) );
+    compiled.setInput( input, true );
+    compiled.advanceTo( 1000 );
+    QCOMPARE( compiled.nextEvent( ), uint64_t( 1005 ) );
+    /* The NOT output falls at 1005, after the AND gate started to rise, due at 1010. */
+    compiled.advanceTo( 1012 );
+    QCOMPARE( compiled.getOutputValue( output ), model == DelayModel::TRANSPORT );
+    compiled.advanceTo( 1020 );
+    QVERIFY( !compiled.getOutputValue( output ) );
+    QCOMPARE( compiled.nextEvent( ), uint64_t( UINT64_MAX ) );
+    /* An element outside the mapping reads as invalid, rather than as the first gate of the netlist. */
+    LogicAnd outside( 2 );
+    QVERIFY( !compiled.contains( &outside ) );
+    QVERIFY( !compiled.isValid( &outside ) );
+    QCOMPARE( compiled.outputSignal( &outside ), NetlistOptimizer::NONE );
+    QCOMPARE( compiled.inputSignal( &outside, 1 ), NetlistOptimizer::NONE );
+    QVERIFY( !compiled.getOutputValue( &outside ) );
+  }
+}
+
+void TestCompiledSimulation::testOptimizer( ) {
+  /* in -> NODE -> NODE -> NOT -> NOT -> AND with 1 -> OUTPUT, and an OR gate of in and the first NOT gate that
+   * nothing reads. */
+  Netlist netlist;
+  const uint32_t in = netlist.addGate( LogicOp::INPUT, 0, 1 );
+  const uint32_t one = netlist.addGate( LogicOp::INPUT, 0, 1 );
+  netlist.setInitialValue( netlist.outputSignal( one ), true );
+  uint32_t previous = netlist.outputSignal( in );
+  for( LogicOp op : { LogicOp::NODE, LogicOp::NODE, LogicOp::NOT, LogicOp::NOT } ) {
+    const uint32_t gate = netlist.addGate( op, 1, 1 );
+    netlist.setFanin( gate, 0, previous );
+    previous = netlist.outputSignal( gate );
+  }
+  const uint32_t andGate = netlist.addGate( LogicOp::AND, 2, 1 );
+  netlist.setFanin( andGate, 0, previous );
+  netlist.setFanin( andGate, 1, netlist.outputSignal( one ) );
+  const uint32_t dead = netlist.addGate( LogicOp::OR, 2, 1 );
+  netlist.setFanin( dead, 0, netlist.outputSignal( in ) );
+  netlist.setFanin( dead, 1, netlist.outputSignal( andGate - 2 ) );
+  const uint32_t out = netlist.addGate( LogicOp::OUTPUT, 1, 1 );
+  netlist.setFanin( out, 0, netlist.outputSignal( andGate ) );
+  /* Levels as ElementMapping sets them: the sinks on level 1, and each gate above those reading it. */
+  const int levels[] = { 7, 7, 6, 5, 4, 3, 2, 1, 1 };
+  for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+    netlist.setLevel( gate, levels[ gate ] );
+  }
+  netlist.finalize( );
+  NetlistOptimizer optimizer( netlist );
+  optimizer.addInput( in );
+  Netlist result;
+  optimizer.optimize( result );
+  QCOMPARE( result.gateCount( ), 2u );
+  QCOMPARE( optimizer.eliminatedGates( ), 7u );
+  QCOMPARE( optimizer.signal( netlist.outputSignal( andGate ) ), optimizer.signal( netlist.outputSignal( in ) ) );
+  QCOMPARE( optimizer.signal( netlist.outputSignal( dead ) ), NetlistOptimizer::NONE );
+  NetlistSimulator simulator( result );
+  for( bool value : { true, false } ) {
+    simulator.setInput( optimizer.signal( netlist.outputSignal( in ) ), value );
+    simulator.run( );
+    QCOMPARE( simulator.value( optimizer.signal( netlist.outputSignal( out ) ) ), value );
+  }
+}
+
+void TestCompiledSimulation::testStructuralHashing( ) {
+  /* NOT( NAND( a, b ) ), and three copies of a half adder below it, with the operands of AND swapped. */
+  Netlist netlist;
+  const uint32_t a = netlist.addGate( LogicOp::INPUT, 0, 1 );
+  const uint32_t b = netlist.addGate( LogicOp::INPUT, 0, 1 );
+  const uint32_t nand = netlist.addGate( LogicOp::NAND, 2, 1 );
+  netlist.setFanin( nand, 0, netlist.outputSignal( a ) );
+  netlist.setFanin( nand, 1, netlist.outputSignal( b ) );
+  const uint32_t inverter = netlist.addGate( LogicOp::NOT, 1, 1 );
+  netlist.setFanin( inverter, 0, netlist.outputSignal( nand ) );
+  std::vector< uint32_t > sums;
+  std::vector< uint32_t > carries;
+  for( int copy = 0; copy < 3; ++copy ) {
+    const uint32_t sum = netlist.addGate( LogicOp::XOR, 2, 1 );
+    netlist.setFanin( sum, 0, netlist.outputSignal( a ) );
+    netlist.setFanin( sum, 1, netlist.outputSignal( b ) );
+    const uint32_t carry = netlist.addGate( LogicOp::AND, 2, 1 );
+    netlist.setFanin( carry, 0, netlist.outputSignal( b ) );
+    netlist.setFanin( carry, 1, netlist.outputSignal( a ) );
+    sums.push_back( sum );
+    carries.push_back( carry );
+  }
+  const uint32_t sinks = netlist.gateCount( );
+  for( int copy = 0; copy < 3; ++copy ) {
+    const uint32_t out = netlist.addGate( LogicOp::OUTPUT, 2, 2 );
+    netlist.setFanin( out, 0, netlist.outputSignal( sums[ copy ] ) );
+    netlist.setFanin( out, 1, netlist.outputSignal( carries[ copy ] ) );
+  }
+  const uint32_t out = netlist.addGate( LogicOp::OUTPUT, 1, 1 );
+  netlist.setFanin( out, 0, netlist.outputSignal( inverter ) );
+  /* The inputs on level 4, NAND on level 3, the gates it shares with the half adders on level 2. */
+  for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+    netlist.setLevel( gate, gate < nand ? 4 : gate == nand ? 3 : gate < sinks ? 2 : 1 );
+  }
+  netlist.finalize( );
+
+  NetlistOptimizer plain( netlist );
+  plain.addInput( a );
+  plain.addInput( b );
+  plain.setStructuralHashing( false );
+  Netlist unmerged;
+  plain.optimize( unmerged );
+  QCOMPARE( unmerged.gateCount( ), netlist.gateCount( ) );
+
+  NetlistOptimizer optimizer( netlist );
+  optimizer.addInput( a );
+  optimizer.addInput( b );
+  Netlist result;
+  optimizer.optimize( result );
+  /* The copies share the first XOR gate, and each AND gate becomes an inverter of NAND, which is the NOT gate. */
+  QCOMPARE( result.gateCount( ), 9u );
+  QCOMPARE( optimizer.mergedGates( ), 5u );
+  QCOMPARE( optimizer.eliminatedGates( ), 5u );
+  QCOMPARE( optimizer.gate( carries[ 2 ] ), optimizer.gate( carries[ 0 ] ) );
+  QCOMPARE( optimizer.signal( netlist.outputSignal( inverter ) ),
+            optimizer.signal( netlist.outputSignal( carries[ 0 ] ) ) );
+  NetlistSimulator simulator( result );
+  ParallelSimulator parallel( result, 4, 1 );
+  for( int vector = 0; vector < 4; ++vector ) {
+    for( NetlistSimulator *sim : { &simulator, static_cast< NetlistSimulator* >( &parallel ) } ) {
+      sim->setInput( optimizer.signal( netlist.outputSignal( a ) ), vector & 1 );
+      sim->setInput( optimizer.signal( netlist.outputSignal( b ) ), vector & 2 );
+      sim->run( );
+      QCOMPARE( sim->value( optimizer.signal( netlist.fanin( out ) ) ), vector == 3 );
+      QCOMPARE( sim->value( optimizer.signal( netlist.outputSignal( carries[ 1 ] ) ) ), vector == 3 );
+    }
+  }
+
+  /* NAND and AND of the same inputs on the same level: as an inverter of AND, NAND would be evaluated with it. */
+  Netlist siblings;
+  const uint32_t c = siblings.addGate( LogicOp::INPUT, 0, 1 );
+  const uint32_t d = siblings.addGate( LogicOp::INPUT, 0, 1 );
+  const uint32_t siblingNand = siblings.addGate( LogicOp::NAND, 2, 1 );
+  const uint32_t siblingAnd = siblings.addGate( LogicOp::AND, 2, 1 );
+  for( uint32_t gate : { siblingNand, siblingAnd } ) {
+    siblings.setFanin( gate, 0, siblings.outputSignal( c ) );
+    siblings.setFanin( gate, 1, siblings.outputSignal( d ) );
+  }
+  const uint32_t siblingOut = siblings.addGate( LogicOp::OUTPUT, 2, 2 );
+  siblings.setFanin( siblingOut, 0, siblings.outputSignal( siblingNand ) );
+  siblings.setFanin( siblingOut, 1, siblings.outputSignal( siblingAnd ) );
+  for( uint32_t gate = 0; gate < siblings.gateCount( ); ++gate ) {
+    siblings.setLevel( gate, gate < siblingNand ? 3 : gate < siblingOut ? 2 : 1 );
+  }
+  siblings.finalize( );
+  NetlistOptimizer siblingOptimizer( siblings );
+  siblingOptimizer.addInput( c );
+  siblingOptimizer.addInput( d );
+  Netlist siblingResult;
+  siblingOptimizer.optimize( siblingResult );
+  QCOMPARE( siblingResult.gateCount( ), siblings.gateCount( ) );
+  NetlistSimulator siblingSimulator( siblingResult );
+  ParallelSimulator siblingParallel( siblingResult, 4, 1 );
+  for( int vector = 0; vector < 4; ++vector ) {
+    for( NetlistSimulator *sim : { &siblingSimulator, static_cast< NetlistSimulator* >( &siblingParallel ) } ) {
+      sim->setInput( siblingOptimizer.signal( siblings.outputSignal( c ) ), vector & 1 );
+      sim->setInput( siblingOptimizer.signal( siblings.outputSignal( d ) ), vector & 2 );
+      sim->run( );
+      QCOMPARE( sim->value( siblingOptimizer.signal( siblings.outputSignal( siblingNand ) ) ), vector != 3 );
+      QCOMPARE( sim->value( siblingOptimizer.signal( siblings.outputSignal( siblingAnd ) ) ), vector == 3 );
+    }
+  }
+}
+
+void TestCompiledSimulation::testOptimizedLatch( ) {
+  /* A NOR latch whose output goes through a node, both back into the latch and into a chain of AND gates, with
+   * the levels Levelizer gives it. The node is on the cycle, so bypassing it would shrink the loop range and leave
+   * the AND gates reading the latch before it settles. */
+  Netlist netlist;
+  const uint32_t node = netlist.addGate( LogicOp::NODE, 1, 1 );
+  const uint32_t first = netlist.addGate( LogicOp::AND, 2, 1 );
+  const uint32_t set = netlist.addGate( LogicOp::INPUT, 0, 1 );
+  const uint32_t second = netlist.addGate( LogicOp::AND, 2, 1 );
+  const uint32_t reset = netlist.addGate( LogicOp::INPUT, 0, 1 );
+  const uint32_t norSet = netlist.addGate( LogicOp::NOR, 2, 1 );
+  const uint32_t norReset = netlist.addGate( LogicOp::NOR, 2, 1 );
+  const uint32_t led = netlist.addGate( LogicOp::OUTPUT, 1, 1 );
+  netlist.setFanin( node, 0, netlist.outputSignal( norReset ) );
+  netlist.setFanin( first, 0, netlist.outputSignal( node ) );
+  netlist.setFanin( first, 1, netlist.outputSignal( node ) );
+  netlist.setFanin( second, 0, netlist.outputSignal( first ) );
+  netlist.setFanin( second, 1, netlist.outputSignal( node ) );
+  netlist.setFanin( norSet, 0, netlist.outputSignal( set ) );
+  netlist.setFanin( norSet, 1, netlist.outputSignal( node ) );
+  netlist.setFanin( norReset, 0, netlist.outputSignal( reset ) );
+  netlist.setFanin( norReset, 1, netlist.outputSignal( norSet ) );
+  netlist.setFanin( led, 0, netlist.outputSignal( second ) );
+  const int levels[] = { 4, 3, 3, 2, 2, 2, 1, 1 };
+  for( uint32_t gate = 0; gate < netlist.gateCount( ); ++gate ) {
+    netlist.setLevel( gate, levels[ gate ] );
+  }
+  netlist.finalize( );
+  QCOMPARE( netlist.loopCount( ), 1u );
+
+  NetlistOptimizer optimizer( netlist );
+  optimizer.addInput( set );
+  optimizer.addInput( reset );
+  Netlist result;
+  optimizer.optimize( result );
+  QVERIFY( optimizer.gate( node ) != NetlistOptimizer::NONE );
+  NetlistSimulator lowered( netlist );
+  NetlistSimulator optimized( result );
+  EventDrivenSimulator eventDriven( result );
+  /* Set, reset, and the value the latch holds after them. */
+  const bool vectors[][ 3 ] = { { false, true, false }, { false, false, false }, { true, false, true },
+                                { false, false, true }, { false, true, false } };
+  for( const auto &vector : vectors ) {
+    lowered.setInput( netlist.outputSignal( set ), vector[ 0 ] );
+    lowered.setInput( netlist.outputSignal( reset ), vector[ 1 ] );
+    lowered.run( );
+    QCOMPARE( lowered.value( netlist.fanin( led ) ), vector[ 2 ] );
+    for( NetlistSimulator *sim : { &optimized, static_cast< NetlistSimulator* >( &eventDriven ) } ) {
+      sim->setInput( optimizer.signal( netlist.outputSignal( set ) ), vector[ 0 ] );
+      sim->setInput( optimizer.signal( netlist.outputSignal( reset ) ), vector[ 1 ] );
+      sim->run( );
+      QCOMPARE( sim->value( optimizer.signal( netlist.fanin( led ) ) ), vector[ 2 ] );
+    }
+  }
+}
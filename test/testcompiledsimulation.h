@@ -0,0 +1,31 @@
+#ifndef TESTCOMPILEDSIMULATION_H
+#define TESTCOMPILEDSIMULATION_H
+
+#include "editor.h"
+
+#include <QTest>
+
+class TestCompiledSimulation : public QObject {
+  Q_OBJECT
+  Editor *editor;
+
+  bool loadExample( const QFileInfo &fileInfo );
+
+private slots:
+
+  /* functions executed by QtTest before and after each test */
+  void init( );
+  void cleanup( );
+
+  void testBackends_data( );
+  void testBackends( );
+  void testParallel( );
+  void testProgram( );
+  void testFeedbackLoops( );
+  void testTimed( );
+  void testOptimizer( );
+  void testStructuralHashing( );
+  void testOptimizedLatch( );
+};
+
+#endif /* TESTCOMPILEDSIMULATION_H */
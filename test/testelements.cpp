@@ -1,6 +1,8 @@
 #include "testelements.h"
 
 #include "box.h"
+#include "boxmapping.h"
+#include "boxprototype.h"
 #include "demux.h"
 #include "dlatch.h"
 #include "editor.h"
@@ -23,6 +25,7 @@
 
 #include <iostream>
 #include <QDebug>
+#include <QScopedPointer>
 
 TestElements::TestElements( QObject *parent ) : QObject( parent ) {
 
@@ -310,3 +313,31 @@ void TestElements::testBoxes( ) {
     manager.loadBox( &box, f.absoluteFilePath( ) );
   }
 }
+
+void TestElements::testBoxTemplate( ) {
+  BoxManager manager;
+  QDir examplesDir( QString( "%1/../examples/" ).arg( CURRENTDIR ) );
+  QFileInfoList files = examplesDir.entryInfoList( QStringList( ) << "*.panda" );
+  for( const auto &f : files ) {
+    Box box;
+    QVERIFY( manager.loadBox( &box, f.absoluteFilePath( ) ) );
+    BoxPrototype *prototype = box.getPrototype( );
+    QVERIFY( prototype );
+    QScopedPointer< BoxMapping > first( prototype->generateMapping( ) );
+    QScopedPointer< BoxMapping > second( prototype->generateMapping( ) );
+    first->initialize( );
+    second->initialize( );
+    /* Every instance is a copy of the same compiled template, with its own elements. */
+    BoxTemplate firstTemplate( *first );
+    BoxTemplate secondTemplate( *second );
+    QCOMPARE( firstTemplate.ops, secondTemplate.ops );
+    QCOMPARE( firstTemplate.faninBegin, secondTemplate.faninBegin );
+    QCOMPARE( firstTemplate.fanins, secondTemplate.fanins );
+    QCOMPARE( firstTemplate.faninPorts, secondTemplate.faninPorts );
+    QCOMPARE( firstTemplate.inputs.size( ), prototype->inputSize( ) );
+    QCOMPARE( firstTemplate.outputs.size( ), prototype->outputSize( ) );
+    for( int port = 0; port < prototype->outputSize( ); ++port ) {
+      QVERIFY( first->getOutput( port ) != second->getOutput( port ) );
+    }
+  }
+}
@@ -41,6 +41,7 @@ private slots:
 
   void testBox( );
   void testBoxes( );
+  void testBoxTemplate( );
 };
 
 #endif /* TESTELEMENTS_H */
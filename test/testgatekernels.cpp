@@ -0,0 +1,109 @@
+#include "testgatekernels.h"
+
+#include "graphicelement.h"
+#include "logicelement/logicand.h"
+#include "logicelement/logicinput.h"
+#include "logicelement/logicxor.h"
+#include "simulation/gatekernels.h"
+
+#include <vector>
+
+static const GateKernels::Isa allIsas[] = {
+  GateKernels::Isa::SCALAR, GateKernels::Isa::SSE2, GateKernels::Isa::AVX2
+};
+
+void TestGateKernels::testReductions( ) {
+  quint32 seed = 1;
+  for( int test = 0; test < 2000; ++test ) {
+    seed = seed * 1103515245u + 12345u;
+    size_t size = ( seed >> 8 ) % ( MAXIMUMVALIDINPUTSIZE + 1 );
+    size_t offset = ( seed >> 4 ) % 8;
+    std::vector< uint8_t > buffer( size + offset );
+    for( uint8_t &value : buffer ) {
+      seed = seed * 1103515245u + 12345u;
+      /* Mostly set, mostly cleared or random, so that AND and OR do not always exit early. */
+      switch( test % 3 ) {
+          case 0:
+          value = ( ( seed >> 16 ) % 64 ) != 0;
+          break;
+          case 1:
+          value = ( ( seed >> 16 ) % 64 ) == 0;
+          break;
+          default:
+          value = ( seed >> 16 ) & 1;
+          break;
+      }
+    }
+    const uint8_t *values = buffer.data( ) + offset;
+    bool expectedAnd = true, expectedOr = false, expectedXor = false;
+    for( size_t idx = 0; idx < size; ++idx ) {
+      expectedAnd &= values[ idx ] != 0;
+      expectedOr |= values[ idx ] != 0;
+      expectedXor ^= values[ idx ] != 0;
+    }
+    QCOMPARE( GateKernels::reduceAnd( values, size ), expectedAnd );
+    QCOMPARE( GateKernels::reduceOr( values, size ), expectedOr );
+    QCOMPARE( GateKernels::reduceXor( values, size ), expectedXor );
+    for( GateKernels::Isa isa : allIsas ) {
+      if( GateKernels::isSupported( isa ) ) {
+        QCOMPARE( GateKernels::reduceAnd( isa, values, size ), expectedAnd );
+        QCOMPARE( GateKernels::reduceOr( isa, values, size ), expectedOr );
+        QCOMPARE( GateKernels::reduceXor( isa, values, size ), expectedXor );
+      }
+    }
+  }
+}
+
+void TestGateKernels::testWideLogicElements( ) {
+  const int size = MAXIMUMVALIDINPUTSIZE;
+  LogicInput high( true );
+  LogicInput low( false );
+  LogicAnd andGate( size );
+  LogicXor xorGate( size );
+  for( int idx = 0; idx < size; ++idx ) {
+    andGate.connectPredecessor( idx, &high, 0 );
+    xorGate.connectPredecessor( idx, ( idx % 3 ) ? &low : &high, 0 );
+  }
+  andGate.updateLogic( );
+  xorGate.updateLogic( );
+  QCOMPARE( andGate.getOutputValue( ), true );
+  /* 86 inputs out of 256 are connected to high. */
+  QCOMPARE( xorGate.getOutputValue( ), false );
+
+  andGate.connectPredecessor( size - 1, &low, 0 );
+  xorGate.connectPredecessor( size - 1, &low, 0 );
+  andGate.updateLogic( );
+  xorGate.updateLogic( );
+  QCOMPARE( andGate.getOutputValue( ), false );
+  QCOMPARE( xorGate.getOutputValue( ), true );
+}
+
+void TestGateKernels::benchmarkReductions_data( ) {
+  QTest::addColumn< int >( "isa" );
+  QTest::addColumn< int >( "width" );
+  for( GateKernels::Isa isa : allIsas ) {
+    if( !GateKernels::isSupported( isa ) ) {
+      continue;
+    }
+    for( int width : { 2, 8, 16, 32, 64, 128, MAXIMUMVALIDINPUTSIZE } ) {
+      QTest::newRow( QString( "%1/%2" ).arg( GateKernels::isaName( isa ) ).arg( width ).toLatin1( ).constData( ) )
+        << static_cast< int >( isa ) << width;
+    }
+  }
+}
+
+void TestGateKernels::benchmarkReductions( ) {
+  QFETCH( int, isa );
+  QFETCH( int, width );
+  /* All inputs high: the worst case for AND, which has to read every input. */
+  std::vector< uint8_t > values( static_cast< size_t >( width ), 1 );
+  GateKernels::Isa kernel = static_cast< GateKernels::Isa >( isa );
+  bool result = false;
+  QBENCHMARK {
+    for( int repeat = 0; repeat < 1000; ++repeat ) {
+      result ^= GateKernels::reduceAnd( kernel, values.data( ), values.size( ) );
+      result ^= GateKernels::reduceXor( kernel, values.data( ), values.size( ) );
+    }
+  }
+  QCOMPARE( result, false );
+}
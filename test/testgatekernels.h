@@ -0,0 +1,17 @@
+#ifndef TESTGATEKERNELS_H
+#define TESTGATEKERNELS_H
+
+#include <QObject>
+#include <QTest>
+
+class TestGateKernels : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testReductions( );
+  void testWideLogicElements( );
+  void benchmarkReductions_data( );
+  void benchmarkReductions( );
+};
+
+#endif // TESTGATEKERNELS_H
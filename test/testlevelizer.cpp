@@ -0,0 +1,64 @@
+#include "testlevelizer.h"
+
+#include "simulation/levelizer.h"
+
+#include <algorithm>
+#include <vector>
+
+static Levelizer buildLevelizer( const std::vector< std::vector< uint32_t > > &graph ) {
+  std::vector< uint32_t > begin( 1, 0 );
+  std::vector< uint32_t > successors;
+  for( const std::vector< uint32_t > &node : graph ) {
+    successors.insert( successors.end( ), node.begin( ), node.end( ) );
+    begin.push_back( static_cast< uint32_t >( successors.size( ) ) );
+  }
+  return( Levelizer( begin, successors ) );
+}
+
+void TestLevelizer::testPriorities( ) {
+  /* 0 -> 1 -> 2 -> 3, 0 -> 3, and a loop 1 -> 2 -> 1. */
+  Levelizer levelizer = buildLevelizer( { { 1, 3 }, { 2 }, { 1, 3 }, { } } );
+  std::vector< int > priorities;
+  levelizer.levelize( priorities );
+  QCOMPARE( priorities, std::vector< int >( { 4, 3, 2, 1 } ) );
+}
+
+void TestLevelizer::testInvalidatedCone( ) {
+  Levelizer levelizer = buildLevelizer( { { 1 }, { 2 }, { }, { 2 } } );
+  /* Known priorities are reused, even when they are stale. */
+  std::vector< int > priorities = { -1, -1, 5, 1 };
+  levelizer.levelize( priorities );
+  QCOMPARE( priorities, std::vector< int >( { 7, 6, 5, 1 } ) );
+}
+
+void TestLevelizer::testFeedbackLoops( ) {
+  /* Loops { 1, 2, 3 } and { 5 }, the self-loop. 0 and 4 are not part of any loop. */
+  Levelizer levelizer = buildLevelizer( { { 1 }, { 2 }, { 3, 4 }, { 1 }, { 5 }, { 5 } } );
+  std::vector< std::vector< uint32_t > > loops = levelizer.feedbackLoops( );
+  for( std::vector< uint32_t > &loop : loops ) {
+    std::sort( loop.begin( ), loop.end( ) );
+  }
+  std::sort( loops.begin( ), loops.end( ) );
+  QCOMPARE( loops.size( ), static_cast< size_t >( 2 ) );
+  QCOMPARE( loops[ 0 ], std::vector< uint32_t >( { 1, 2, 3 } ) );
+  QCOMPARE( loops[ 1 ], std::vector< uint32_t >( { 5 } ) );
+}
+
+void TestLevelizer::testDeepChain( ) {
+  /* A ripple chain far deeper than the call stack would allow, closed into a single loop. */
+  const uint32_t size = 1000000;
+  std::vector< uint32_t > begin( 1, 0 );
+  std::vector< uint32_t > successors;
+  for( uint32_t node = 0; node < size; ++node ) {
+    successors.push_back( ( node + 1 ) % size );
+    begin.push_back( static_cast< uint32_t >( successors.size( ) ) );
+  }
+  Levelizer levelizer( begin, successors );
+  std::vector< int > priorities;
+  levelizer.levelize( priorities );
+  QCOMPARE( priorities.front( ), static_cast< int >( size ) );
+  QCOMPARE( priorities.back( ), 1 );
+  std::vector< std::vector< uint32_t > > loops = levelizer.feedbackLoops( );
+  QCOMPARE( loops.size( ), static_cast< size_t >( 1 ) );
+  QCOMPARE( loops.front( ).size( ), static_cast< size_t >( size ) );
+}
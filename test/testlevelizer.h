@@ -0,0 +1,17 @@
+#ifndef TESTLEVELIZER_H
+#define TESTLEVELIZER_H
+
+#include <QObject>
+#include <QTest>
+
+class TestLevelizer : public QObject {
+  Q_OBJECT
+
+private slots:
+  void testPriorities( );
+  void testInvalidatedCone( );
+  void testFeedbackLoops( );
+  void testDeepChain( );
+};
+
+#endif // TESTLEVELIZER_H
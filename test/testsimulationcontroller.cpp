@@ -1,8 +1,17 @@
 #include "testsimulationcontroller.h"
 
 #include "and.h"
+#include "clock.h"
+#include "dflipflop.h"
 #include "inputbutton.h"
+#include "inputswitch.h"
 #include "led.h"
+#include "not.h"
+#include "simulation/clockscheduler.h"
+#include "simulationcontroller.h"
+#include "simulationworker.h"
+
+#include <QSignalSpy>
 
 void TestSimulationController::init( ) {
   editor = new Editor( this );
@@ -39,3 +48,167 @@ void TestSimulationController::testCase1( ) {
   QVERIFY( elms.at( 2 ) == andItem );
   QVERIFY( elms.at( 3 ) == led );
 }
+
+static void compareMappings( ElementMapping &patched, const QVector< GraphicElement* > &elements ) {
+  ElementMapping fresh( elements );
+  fresh.initialize( );
+  fresh.sort( );
+  for( GraphicElement *elm : elements ) {
+    LogicElement *patchedElm = patched.getLogicElement( elm );
+    LogicElement *freshElm = fresh.getLogicElement( elm );
+    QVERIFY( patchedElm );
+    QCOMPARE( patchedElm->getPriority( ), freshElm->getPriority( ) );
+    QCOMPARE( patchedElm->isValid( ), freshElm->isValid( ) );
+  }
+}
+
+void TestSimulationController::testApplyDelta( ) {
+  Scene *scene = editor->getScene( );
+  InputButton *btn1 = new InputButton( );
+  InputButton *btn2 = new InputButton( );
+  Not *notItem = new Not( );
+  DFlipFlop *flipflop = new DFlipFlop( );
+  Led *led = new Led( );
+  QVector< QNEConnection* > conns;
+  for( int i = 0; i < 3; ++i ) {
+    conns.append( new QNEConnection( ) );
+    scene->addItem( conns.last( ) );
+  }
+  for( GraphicElement *elm : QVector< GraphicElement* >( { btn1, btn2, notItem, flipflop, led } ) ) {
+    scene->addItem( elm );
+  }
+  conns[ 0 ]->setStart( btn1->output( ) );
+  conns[ 0 ]->setEnd( notItem->input( ) );
+  conns[ 1 ]->setStart( notItem->output( ) );
+  conns[ 1 ]->setEnd( flipflop->input( 0 ) );
+  conns[ 2 ]->setStart( flipflop->output( ) );
+  conns[ 2 ]->setEnd( led->input( ) );
+
+  ElementMapping mapping( scene->getElements( ) );
+  mapping.initialize( );
+  mapping.sort( );
+  LogicElement *logicFlipFlop = mapping.getLogicElement( flipflop );
+
+  /* Adding an AND gate fed by the NOT gate and the second button. */
+  And *andItem = new And( );
+  QNEConnection *andConn1 = new QNEConnection( );
+  QNEConnection *andConn2 = new QNEConnection( );
+  scene->addItem( andItem );
+  scene->addItem( andConn1 );
+  scene->addItem( andConn2 );
+  andConn1->setStart( notItem->output( ) );
+  andConn1->setEnd( andItem->input( 0 ) );
+  andConn2->setStart( btn2->output( ) );
+  andConn2->setEnd( andItem->input( 1 ) );
+  CircuitDelta delta;
+  delta.added.append( andItem->id( ) );
+  QSet< LogicElement* > created;
+  QVERIFY( mapping.applyDelta( delta, scene->getElements( ), created ) );
+  QCOMPARE( created.size( ), 1 );
+  QVERIFY( created.contains( mapping.getLogicElement( andItem ) ) );
+  QCOMPARE( mapping.getLogicElement( flipflop ), logicFlipFlop );
+  compareMappings( mapping, scene->getElements( ) );
+
+  /* Removing it again. */
+  const int andId = andItem->id( );
+  delete andConn1;
+  delete andConn2;
+  scene->removeItem( andItem );
+  delete andItem;
+  delta = CircuitDelta( );
+  delta.removed.append( andId );
+  created.clear( );
+  QVERIFY( mapping.applyDelta( delta, scene->getElements( ), created ) );
+  QVERIFY( created.isEmpty( ) );
+  QCOMPARE( mapping.getLogicElement( flipflop ), logicFlipFlop );
+  compareMappings( mapping, scene->getElements( ) );
+
+  /* Feeding the LED from the NOT gate instead of the flip-flop. */
+  conns[ 2 ]->setStart( notItem->output( ) );
+  delta = CircuitDelta( );
+  delta.rewired.append( led->id( ) );
+  QVERIFY( mapping.applyDelta( delta, scene->getElements( ), created ) );
+  QCOMPARE( mapping.getLogicElement( flipflop ), logicFlipFlop );
+  compareMappings( mapping, scene->getElements( ) );
+}
+
+void TestSimulationController::testWorker( ) {
+  Scene scene;
+  InputSwitch *sw = new InputSwitch( );
+  Not *notItem = new Not( );
+  Led *led = new Led( );
+  QNEConnection *conn1 = new QNEConnection( );
+  QNEConnection *conn2 = new QNEConnection( );
+  scene.addItem( sw );
+  scene.addItem( notItem );
+  scene.addItem( led );
+  scene.addItem( conn1 );
+  scene.addItem( conn2 );
+  /* Gives the thread clock edges to jump to when running as fast as possible. */
+  scene.addItem( new Clock( ) );
+  conn1->setStart( sw->output( ) );
+  conn1->setEnd( notItem->input( ) );
+  conn2->setStart( notItem->output( ) );
+  conn2->setEnd( led->input( ) );
+
+  SimulationController sc( &scene );
+  sc.start( );
+  QVERIFY( sc.isRunning( ) );
+  /* The values reach the scene through the snapshots published by the simulation thread. */
+  auto ledValue = [ & ]( ) {
+    sc.updateAll( );
+    return( static_cast< int >( led->input( )->value( ) ) );
+  };
+  QTRY_COMPARE( ledValue( ), 1 );
+  sw->setOn( true );
+  QTRY_COMPARE( ledValue( ), 0 );
+  sw->setOn( false );
+  QTRY_COMPARE( ledValue( ), 1 );
+
+  /* Running as fast as possible is measured above real time. */
+  QSignalSpy statistics( &sc, &SimulationController::statisticsUpdated );
+  sc.setTickRate( 0 );
+  QTRY_VERIFY_WITH_TIMEOUT( !statistics.isEmpty( ) && ( statistics.last( ).at( 2 ).toDouble( ) > 1.0 ), 5000 );
+
+  /* Synchronous ticks still work, with the thread paused meanwhile. */
+  sc.stop( );
+  QVERIFY( !sc.isRunning( ) );
+  sw->setOn( true );
+  sc.update( );
+  QCOMPARE( ledValue( ), 0 );
+}
+
+void TestSimulationController::testClockScheduler( ) {
+  ClockScheduler scheduler;
+  QCOMPARE( scheduler.nextEdge( ), ClockScheduler::NEVER );
+  const uint32_t slow = scheduler.addClock( 3.0, true, false, 0 );
+  const uint32_t fast = scheduler.addClock( 6.0, true, false, 0 );
+  scheduler.addClock( 1.0, false, true, 0 );
+
+  /* Each clock toggles at its own period, with no drift, and ties come out by clock. */
+  QVector< QPair< uint64_t, uint32_t > > edges;
+  while( scheduler.nextEdge( ) <= 1000000000 ) {
+    const uint64_t time = scheduler.nextEdge( );
+    edges.append( qMakePair( time, scheduler.popEdge( ) ) );
+  }
+  QCOMPARE( edges.size( ), 9 );
+  QCOMPARE( edges.at( 0 ), qMakePair( uint64_t( 166666667 ), fast ) );
+  QCOMPARE( edges.at( 1 ), qMakePair( uint64_t( 333333333 ), slow ) );
+  QCOMPARE( edges.at( 2 ), qMakePair( uint64_t( 333333333 ), fast ) );
+  QCOMPARE( edges.at( 7 ), qMakePair( uint64_t( 1000000000 ), slow ) );
+  QCOMPARE( edges.at( 8 ), qMakePair( uint64_t( 1000000000 ), fast ) );
+  QCOMPARE( scheduler.value( slow ), true );
+  QCOMPARE( scheduler.value( fast ), false );
+  QCOMPARE( scheduler.value( 2 ), true );
+
+  /* A restart drops the edges scheduled before it. */
+  scheduler.restart( fast, 1.0, 1000000000 );
+  QCOMPARE( scheduler.value( fast ), true );
+  QCOMPARE( scheduler.nextEdge( ), uint64_t( 1333333333 ) );
+  QCOMPARE( scheduler.popEdge( ), slow );
+  QCOMPARE( scheduler.nextEdge( ), uint64_t( 1666666667 ) );
+  QCOMPARE( scheduler.popEdge( ), slow );
+  QCOMPARE( scheduler.nextEdge( ), uint64_t( 2000000000 ) );
+  QCOMPARE( scheduler.popEdge( ), slow );
+  QCOMPARE( scheduler.popEdge( ), fast );
+}
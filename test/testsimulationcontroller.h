@@ -17,6 +17,9 @@ private slots:
   void init( );
   void cleanup( );
   void testCase1( );
+  void testApplyDelta( );
+  void testWorker( );
+  void testClockScheduler( );
 };
 
 #endif /* TESTSIMULATIONCONTROLLER_H */